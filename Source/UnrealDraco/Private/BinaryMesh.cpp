@@ -0,0 +1,321 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "BinaryMesh.h"
+
+#include <cstring>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "MappedFile.h"
+#include "draco/core/draco_types.h"
+#include "draco/io/file_writer_factory.h"
+
+namespace draco {
+
+namespace {
+
+constexpr char kBinaryMeshMagic[4] = {'U', 'D', 'B', 'M'};
+constexpr uint32_t kBinaryMeshVersion = 1;
+
+uint64_t AlignOffset(uint64_t offset) {
+  return (offset + kUD_BinaryMeshAlignment - 1) &
+         ~(kUD_BinaryMeshAlignment - 1);
+}
+
+// Pads |buffer| with zeros up to the next section boundary and returns the
+// offset of the section.
+uint64_t StartSection(EncoderBuffer *buffer) {
+  const uint64_t offset = AlignOffset(buffer->size());
+  buffer->buffer()->resize(offset, 0);
+  return offset;
+}
+
+int64_t GetValueSize(DataType data_type, int num_components) {
+  return static_cast<int64_t>(DataTypeLength(data_type)) * num_components;
+}
+
+}  // namespace
+
+std::unique_ptr<UD_BinaryMeshWriter> UD_BinaryMeshWriter::Open(
+    const std::string &file_name) {
+  std::unique_ptr<FileWriterInterface> file =
+      FileWriterFactory::OpenWriter(file_name);
+  if (!file) {
+    return nullptr;
+  }
+  return std::unique_ptr<UD_BinaryMeshWriter>(
+      new UD_BinaryMeshWriter(std::move(file)));
+}
+
+bool UD_BinaryMeshWriter::Write(const PointCloud &pc, const Mesh *mesh) {
+  EncoderBuffer buffer;
+  if (!WriteToBuffer(pc, mesh, &buffer)) {
+    return false;
+  }
+  return file_->Write(buffer.data(), buffer.size());
+}
+
+bool UD_BinaryMeshWriter::WriteToBuffer(const PointCloud &pc,
+                                        const Mesh *mesh,
+                                        EncoderBuffer *out_buffer) {
+  const int num_attributes = pc.num_attributes();
+  UD_BinaryMeshHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kBinaryMeshMagic, sizeof(kBinaryMeshMagic));
+  header.version = kBinaryMeshVersion;
+  header.geometry_type = mesh ? TRIANGULAR_MESH : POINT_CLOUD;
+  header.num_points = pc.num_points();
+  header.num_faces = mesh ? mesh->num_faces() : 0;
+  header.num_attributes = num_attributes;
+
+  // The header and the descriptors are filled in once the section offsets
+  // are known.
+  EncoderBuffer buffer;
+  buffer.Resize(sizeof(header));
+  header.attributes_offset = StartSection(&buffer);
+  buffer.Resize(header.attributes_offset +
+                num_attributes * sizeof(UD_BinaryMeshAttribute));
+  if (mesh && mesh->num_faces() > 0) {
+    header.faces_offset = StartSection(&buffer);
+    buffer.Encode(&mesh->face(FaceIndex(0)),
+                  mesh->num_faces() * sizeof(Mesh::Face));
+  }
+
+  std::vector<UD_BinaryMeshAttribute> descriptors(num_attributes);
+  std::vector<uint32_t> indices;
+  for (int i = 0; i < num_attributes; ++i) {
+    const PointAttribute *const att = pc.attribute(i);
+    UD_BinaryMeshAttribute &desc = descriptors[i];
+    memset(&desc, 0, sizeof(desc));
+    desc.attribute_type = att->attribute_type();
+    desc.data_type = att->data_type();
+    desc.num_components = att->num_components();
+    desc.normalized = att->normalized() ? 1 : 0;
+    desc.unique_id = att->unique_id();
+    desc.element_type =
+        mesh ? mesh->GetAttributeElementType(i) : MESH_CORNER_ATTRIBUTE;
+    desc.num_values = static_cast<uint32_t>(att->size());
+
+    const int64_t value_size =
+        GetValueSize(att->data_type(), att->num_components());
+    if (value_size <= 0) {
+      return false;
+    }
+    desc.values_offset = StartSection(&buffer);
+    if (att->byte_stride() == value_size && att->size() > 0) {
+      buffer.Encode(att->GetAddress(AttributeValueIndex(0)),
+                    value_size * att->size());
+    } else {
+      for (AttributeValueIndex v(0); v < static_cast<uint32_t>(att->size());
+           ++v) {
+        buffer.Encode(att->GetAddress(v), value_size);
+      }
+    }
+    if (!att->is_mapping_identity()) {
+      indices.resize(pc.num_points());
+      for (PointIndex p(0); p < pc.num_points(); ++p) {
+        indices[p.value()] = att->mapped_index(p).value();
+      }
+      desc.indices_offset = StartSection(&buffer);
+      buffer.Encode(indices.data(), indices.size() * sizeof(uint32_t));
+    }
+  }
+  header.file_size = buffer.size();
+
+  char *const data = buffer.buffer()->data();
+  memcpy(data, &header, sizeof(header));
+  if (num_attributes > 0) {
+    memcpy(data + header.attributes_offset, descriptors.data(),
+           num_attributes * sizeof(UD_BinaryMeshAttribute));
+  }
+  out_buffer->Encode(buffer.data(), buffer.size());
+  return true;
+}
+
+std::unique_ptr<UD_BinaryMeshReader> UD_BinaryMeshReader::Open(
+    const std::string &file_name) {
+  std::unique_ptr<UD_MappedFile> file(new UD_MappedFile());
+  if (!file->Open(file_name)) {
+    return nullptr;
+  }
+  const char *const data = file->data();
+  const size_t data_size = file->size();
+  std::unique_ptr<UD_BinaryMeshReader> reader(
+      new UD_BinaryMeshReader(std::move(file), data, data_size));
+  if (!reader->Validate()) {
+    return nullptr;
+  }
+  return reader;
+}
+
+std::unique_ptr<UD_BinaryMeshReader> UD_BinaryMeshReader::OpenBuffer(
+    const char *data, size_t data_size) {
+  std::unique_ptr<UD_BinaryMeshReader> reader(
+      new UD_BinaryMeshReader(nullptr, data, data_size));
+  if (!reader->Validate()) {
+    return nullptr;
+  }
+  return reader;
+}
+
+UD_BinaryMeshReader::UD_BinaryMeshReader(std::unique_ptr<UD_MappedFile> file,
+                                         const char *data, size_t data_size)
+    : file_(std::move(file)),
+      data_(data),
+      data_size_(data_size),
+      header_(reinterpret_cast<const UD_BinaryMeshHeader *>(data)),
+      attributes_(nullptr) {}
+
+UD_BinaryMeshReader::~UD_BinaryMeshReader() = default;
+
+bool UD_BinaryMeshReader::IsBinaryMesh(const char *data, size_t data_size) {
+  return data_size >= sizeof(UD_BinaryMeshHeader) &&
+         memcmp(data, kBinaryMeshMagic, sizeof(kBinaryMeshMagic)) == 0;
+}
+
+bool UD_BinaryMeshReader::Validate() {
+  // The descriptors are read in place and contain 64-bit fields.
+  if (!IsBinaryMesh(data_, data_size_) ||
+      reinterpret_cast<uintptr_t>(data_) % alignof(uint64_t) != 0) {
+    return false;
+  }
+  const UD_BinaryMeshHeader &header = *header_;
+  if (header.version != kBinaryMeshVersion ||
+      header.file_size != data_size_ ||
+      (header.geometry_type != TRIANGULAR_MESH &&
+       header.geometry_type != POINT_CLOUD)) {
+    return false;
+  }
+  // Returns true when [offset, offset + size) is an aligned range inside the
+  // file.
+  const auto is_section = [this](uint64_t offset, uint64_t size) {
+    return offset % kUD_BinaryMeshAlignment == 0 && offset <= data_size_ &&
+           size <= data_size_ - offset;
+  };
+  if (!is_section(header.attributes_offset,
+                  static_cast<uint64_t>(header.num_attributes) *
+                      sizeof(UD_BinaryMeshAttribute))) {
+    return false;
+  }
+  if (header.num_faces > 0 &&
+      (header.geometry_type != TRIANGULAR_MESH ||
+       !is_section(header.faces_offset,
+                   static_cast<uint64_t>(header.num_faces) *
+                       sizeof(Mesh::Face)))) {
+    return false;
+  }
+  const UD_BinaryMeshAttribute *const attributes =
+      reinterpret_cast<const UD_BinaryMeshAttribute *>(
+          data_ + header.attributes_offset);
+  for (uint32_t i = 0; i < header.num_attributes; ++i) {
+    const UD_BinaryMeshAttribute &desc = attributes[i];
+    const DataType data_type = static_cast<DataType>(desc.data_type);
+    if (data_type <= DT_INVALID || data_type >= DT_TYPES_COUNT ||
+        desc.num_components <= 0 || desc.num_components > 127 ||
+        desc.attribute_type < GeometryAttribute::INVALID ||
+        desc.attribute_type >= GeometryAttribute::NAMED_ATTRIBUTES_COUNT ||
+        desc.element_type < MESH_VERTEX_ATTRIBUTE ||
+        desc.element_type > MESH_FACE_ATTRIBUTE) {
+      return false;
+    }
+    const uint64_t value_size = GetValueSize(data_type, desc.num_components);
+    if (value_size == 0 ||
+        !is_section(desc.values_offset, value_size * desc.num_values)) {
+      return false;
+    }
+    if (desc.indices_offset != 0 &&
+        !is_section(desc.indices_offset,
+                    static_cast<uint64_t>(header.num_points) *
+                        sizeof(uint32_t))) {
+      return false;
+    }
+    if (desc.indices_offset == 0 && desc.num_values < header.num_points) {
+      return false;
+    }
+  }
+  attributes_ = attributes;
+  return true;
+}
+
+const Mesh::Face *UD_BinaryMeshReader::faces() const {
+  if (header_->num_faces == 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const Mesh::Face *>(data_ + header_->faces_offset);
+}
+
+const uint8_t *UD_BinaryMeshReader::values(int att_id) const {
+  return reinterpret_cast<const uint8_t *>(data_ +
+                                           attributes_[att_id].values_offset);
+}
+
+const uint32_t *UD_BinaryMeshReader::indices(int att_id) const {
+  if (attributes_[att_id].indices_offset == 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const uint32_t *>(
+      data_ + attributes_[att_id].indices_offset);
+}
+
+StatusOr<std::unique_ptr<PointCloud>> UD_BinaryMeshReader::ReadGeometry()
+    const {
+  const UD_BinaryMeshHeader &header = *header_;
+  std::unique_ptr<PointCloud> pc;
+  Mesh *mesh = nullptr;
+  if (is_mesh()) {
+    mesh = new Mesh();
+    pc.reset(mesh);
+    mesh->SetNumFaces(header.num_faces);
+    const Mesh::Face *const in_faces = faces();
+    for (uint32_t i = 0; i < header.num_faces; ++i) {
+      const Mesh::Face &face = in_faces[i];
+      if (face[0] >= header.num_points || face[1] >= header.num_points ||
+          face[2] >= header.num_points) {
+        return Status(Status::DRACO_ERROR, "Invalid face in binary mesh.");
+      }
+      mesh->SetFace(FaceIndex(i), face);
+    }
+  } else {
+    pc.reset(new PointCloud());
+  }
+  pc->set_num_points(header.num_points);
+
+  for (uint32_t i = 0; i < header.num_attributes; ++i) {
+    const UD_BinaryMeshAttribute &desc = attributes_[i];
+    const DataType data_type = static_cast<DataType>(desc.data_type);
+    const int64_t value_size = GetValueSize(data_type, desc.num_components);
+    GeometryAttribute ga;
+    ga.Init(static_cast<GeometryAttribute::Type>(desc.attribute_type),
+            nullptr, static_cast<int8_t>(desc.num_components), data_type,
+            desc.normalized != 0, value_size, 0);
+    std::unique_ptr<PointAttribute> pa(new PointAttribute(ga));
+    pa->Reset(desc.num_values);
+    if (desc.num_values > 0) {
+      memcpy(pa->buffer()->data(), values(i), value_size * desc.num_values);
+    }
+    const uint32_t *const in_indices = indices(i);
+    if (in_indices == nullptr) {
+      pa->SetIdentityMapping();
+    } else {
+      pa->SetExplicitMapping(header.num_points);
+      for (uint32_t p = 0; p < header.num_points; ++p) {
+        if (in_indices[p] >= desc.num_values) {
+          return Status(Status::DRACO_ERROR,
+                        "Invalid value index in binary mesh.");
+        }
+        pa->SetPointMapEntry(PointIndex(p), AttributeValueIndex(in_indices[p]));
+      }
+    }
+    const int att_id = pc->AddAttribute(std::move(pa));
+    // AddAttribute() assigns the attribute id as unique id, restore the
+    // original one so that metadata and glTF style lookups keep working.
+    pc->attribute(att_id)->set_unique_id(desc.unique_id);
+    if (mesh) {
+      mesh->SetAttributeElementType(
+          att_id, static_cast<MeshAttributeElementType>(desc.element_type));
+    }
+  }
+  return pc;
+}
+
+}  // namespace draco
@@ -0,0 +1,238 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "BulkGeometryBuilder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "ParallelDeduplication.h"
+
+namespace draco {
+
+namespace {
+
+// Values or faces processed per parallel task.
+constexpr int kBlockSize = 16384;
+
+int NumBlocks(uint32_t size) {
+  return static_cast<int>((size + kBlockSize - 1) / kBlockSize);
+}
+
+// Adds an attribute of a value per point with an identity mapping to |pc|.
+// Returns nullptr for an invalid format.
+PointAttribute *AddPointAttribute(PointCloud *pc,
+                                  GeometryAttribute::Type attribute_type,
+                                  int8_t num_components, DataType data_type,
+                                  bool normalized) {
+  const int32_t component_size = DataTypeLength(data_type);
+  if (num_components <= 0 || component_size <= 0) {
+    return nullptr;
+  }
+  GeometryAttribute va;
+  va.Init(attribute_type, nullptr, num_components, data_type, normalized,
+          component_size * num_components, 0);
+  const int att_id = pc->AddAttribute(va, true, pc->num_points());
+  return att_id < 0 ? nullptr : pc->attribute(att_id);
+}
+
+void CopyInterleavedValues(const uint8_t *values, int64_t byte_stride,
+                           PointAttribute *att) {
+  const uint32_t num_values = static_cast<uint32_t>(att->size());
+  const int64_t value_size = att->byte_stride();
+  if (byte_stride == 0) {
+    byte_stride = value_size;
+  }
+  ParallelFor(NumBlocks(num_values), [&](int32 block) {
+    const uint32_t begin = static_cast<uint32_t>(block) * kBlockSize;
+    const uint32_t end = std::min(begin + kBlockSize, num_values);
+    uint8_t *const dst = att->GetAddress(AttributeValueIndex(begin));
+    const uint8_t *const src = values + begin * byte_stride;
+    if (byte_stride == value_size) {
+      memcpy(dst, src, (end - begin) * value_size);
+      return;
+    }
+    for (uint32_t i = 0; i < end - begin; ++i) {
+      memcpy(dst + i * value_size, src + i * byte_stride, value_size);
+    }
+  });
+}
+
+template <typename ComponentT>
+void CopyPlanarValues(const void *const *components, PointAttribute *att) {
+  const uint32_t num_values = static_cast<uint32_t>(att->size());
+  const int num_components = att->num_components();
+  ParallelFor(NumBlocks(num_values), [&](int32 block) {
+    const uint32_t begin = static_cast<uint32_t>(block) * kBlockSize;
+    const uint32_t end = std::min(begin + kBlockSize, num_values);
+    ComponentT *const dst = reinterpret_cast<ComponentT *>(
+        att->GetAddress(AttributeValueIndex(begin)));
+    // A component at a time, so that every source array is read in order.
+    for (int c = 0; c < num_components; ++c) {
+      const ComponentT *const src =
+          static_cast<const ComponentT *>(components[c]) + begin;
+      for (uint32_t i = 0; i < end - begin; ++i) {
+        dst[i * num_components + c] = src[i];
+      }
+    }
+  });
+}
+
+int AddInterleaved(PointCloud *pc, GeometryAttribute::Type attribute_type,
+                   int8_t num_components, DataType data_type, bool normalized,
+                   const void *values, int64_t byte_stride) {
+  if (pc == nullptr || (values == nullptr && pc->num_points() > 0) ||
+      byte_stride < 0) {
+    return -1;
+  }
+  PointAttribute *const att = AddPointAttribute(
+      pc, attribute_type, num_components, data_type, normalized);
+  if (att == nullptr) {
+    return -1;
+  }
+  CopyInterleavedValues(static_cast<const uint8_t *>(values), byte_stride,
+                        att);
+  return pc->num_attributes() - 1;
+}
+
+int AddPlanar(PointCloud *pc, GeometryAttribute::Type attribute_type,
+              int8_t num_components, DataType data_type, bool normalized,
+              const void *const *components) {
+  if (pc == nullptr || components == nullptr) {
+    return -1;
+  }
+  for (int c = 0; c < num_components; ++c) {
+    if (components[c] == nullptr && pc->num_points() > 0) {
+      return -1;
+    }
+  }
+  PointAttribute *const att = AddPointAttribute(
+      pc, attribute_type, num_components, data_type, normalized);
+  if (att == nullptr) {
+    return -1;
+  }
+  switch (DataTypeLength(data_type)) {
+    case 1:
+      CopyPlanarValues<uint8_t>(components, att);
+      break;
+    case 2:
+      CopyPlanarValues<uint16_t>(components, att);
+      break;
+    case 4:
+      CopyPlanarValues<uint32_t>(components, att);
+      break;
+    default:
+      CopyPlanarValues<uint64_t>(components, att);
+      break;
+  }
+  return pc->num_attributes() - 1;
+}
+
+// Same deduplication as the Finalize() of the Draco builders.
+bool DeduplicatePoints(PointCloud *pc, Mesh *mesh) {
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+  if (!UD_DeduplicateAttributeValues(pc)) {
+    return false;
+  }
+#endif
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+  UD_DeduplicatePointIds(pc, mesh);
+#endif
+  return true;
+}
+
+}  // namespace
+
+void UD_PointCloudBulkBuilder::Start(PointIndex::ValueType num_points) {
+  point_cloud_.reset(new PointCloud());
+  point_cloud_->set_num_points(num_points);
+}
+
+int UD_PointCloudBulkBuilder::AddAttribute(
+    GeometryAttribute::Type attribute_type, int8_t num_components,
+    DataType data_type, bool normalized, const void *values,
+    int64_t byte_stride) {
+  return AddInterleaved(point_cloud_.get(), attribute_type, num_components,
+                        data_type, normalized, values, byte_stride);
+}
+
+int UD_PointCloudBulkBuilder::AddPlanarAttribute(
+    GeometryAttribute::Type attribute_type, int8_t num_components,
+    DataType data_type, bool normalized, const void *const *components) {
+  return AddPlanar(point_cloud_.get(), attribute_type, num_components,
+                   data_type, normalized, components);
+}
+
+std::unique_ptr<PointCloud> UD_PointCloudBulkBuilder::Finalize(
+    bool deduplicate_points) {
+  if (point_cloud_ == nullptr) {
+    return nullptr;
+  }
+  if (deduplicate_points && !DeduplicatePoints(point_cloud_.get(), nullptr)) {
+    point_cloud_.reset();
+    return nullptr;
+  }
+  return std::move(point_cloud_);
+}
+
+void UD_MeshBulkBuilder::Start(PointIndex::ValueType num_points,
+                               FaceIndex::ValueType num_faces,
+                               const uint32_t *indices) {
+  mesh_.reset(new Mesh());
+  mesh_->set_num_points(num_points);
+  valid_faces_ = indices != nullptr || num_faces == 0;
+  if (!valid_faces_) {
+    return;
+  }
+  mesh_->SetNumFaces(num_faces);
+  std::atomic<bool> valid(true);
+  ParallelFor(NumBlocks(num_faces), [&](int32 block) {
+    const uint32_t begin = static_cast<uint32_t>(block) * kBlockSize;
+    const uint32_t end = std::min(begin + kBlockSize, num_faces);
+    bool block_valid = true;
+    for (FaceIndex f(begin); f < end; ++f) {
+      const uint32_t *const face_indices = indices + 3 * f.value();
+      Mesh::Face face;
+      for (int c = 0; c < 3; ++c) {
+        block_valid &= face_indices[c] < num_points;
+        face[c] = PointIndex(face_indices[c]);
+      }
+      mesh_->SetFace(f, face);
+    }
+    if (!block_valid) {
+      valid.store(false, std::memory_order_relaxed);
+    }
+  });
+  valid_faces_ = valid.load(std::memory_order_relaxed);
+}
+
+int UD_MeshBulkBuilder::AddAttribute(GeometryAttribute::Type attribute_type,
+                                     int8_t num_components, DataType data_type,
+                                     bool normalized, const void *values,
+                                     int64_t byte_stride) {
+  return AddInterleaved(mesh_.get(), attribute_type, num_components, data_type,
+                        normalized, values, byte_stride);
+}
+
+int UD_MeshBulkBuilder::AddPlanarAttribute(
+    GeometryAttribute::Type attribute_type, int8_t num_components,
+    DataType data_type, bool normalized, const void *const *components) {
+  return AddPlanar(mesh_.get(), attribute_type, num_components, data_type,
+                   normalized, components);
+}
+
+std::unique_ptr<Mesh> UD_MeshBulkBuilder::Finalize(bool deduplicate_points) {
+  if (mesh_ == nullptr) {
+    return nullptr;
+  }
+  if (!valid_faces_ ||
+      (deduplicate_points && !DeduplicatePoints(mesh_.get(), mesh_.get()))) {
+    mesh_.reset();
+    return nullptr;
+  }
+  return std::move(mesh_);
+}
+
+}  // namespace draco
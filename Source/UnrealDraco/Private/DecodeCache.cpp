@@ -0,0 +1,255 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "DecodeCache.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "BinaryMesh.h"
+#include "FileHelper.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/hash_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Default budget of the process-wide cache.
+constexpr size_t kDefaultDecodeCacheBudget = 256 * 1024 * 1024;
+
+}  // namespace
+
+UD_DecodeCache::UD_DecodeCache(size_t byte_budget)
+    : byte_budget_(byte_budget),
+      size_in_bytes_(0),
+      num_hits_(0),
+      num_disk_hits_(0),
+      num_misses_(0) {}
+
+UD_DecodeCache &UD_DecodeCache::Get() {
+  static UD_DecodeCache cache(kDefaultDecodeCacheBudget);
+  return cache;
+}
+
+StatusOr<UD_DecodedGeometry> UD_DecodeCache::Decode(const char *data,
+                                                    size_t data_size,
+                                                    Decoder *decoder,
+                                                    UD_DecodeStats *out_stats) {
+  if (data == nullptr || data_size == 0) {
+    return Status(Status::INVALID_PARAMETER, "Empty input buffer.");
+  }
+  UD_DecodeStats stats;
+  if (out_stats == nullptr) {
+    out_stats = &stats;
+  }
+  *out_stats = UD_DecodeStats();
+  const Key key = {FingerprintString(data, data_size),
+                   HashDecoderOptions(decoder)};
+  std::string disk_directory;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = lookup_.find(key);
+    if (it != lookup_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      ++num_hits_;
+      out_stats->origin = UD_MEMORY_CACHE;
+      out_stats->geometry_type =
+          it->second->geometry.mesh ? TRIANGULAR_MESH : POINT_CLOUD;
+      return it->second->geometry;
+    }
+    // The attribute transform data of skipped transforms is not stored in
+    // .udm files, so such decodes bypass the disk tier.
+    if (key.options_hash == 0) {
+      disk_directory = disk_directory_;
+    }
+  }
+
+  // Decode outside of the lock so that unrelated assets decode in parallel.
+  UD_DecodedGeometry geometry;
+  std::unique_ptr<PointCloud> pc;
+  if (!disk_directory.empty()) {
+    pc = LoadFromDisk(disk_directory, key, &geometry.mesh);
+  }
+  if (pc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_disk_hits_;
+    out_stats->origin = UD_DISK_CACHE;
+    out_stats->geometry_type = geometry.mesh ? TRIANGULAR_MESH : POINT_CLOUD;
+  } else {
+    DecoderBuffer buffer;
+    buffer.Init(data, data_size);
+    auto statusor = UD_DecodeWithStats(&buffer, *decoder->options(), out_stats);
+    if (!statusor.ok()) {
+      return statusor.status();
+    }
+    pc = std::move(statusor).value();
+    if (pc == nullptr) {
+      return Status(Status::DRACO_ERROR, "Failed to decode the geometry.");
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++num_misses_;
+    }
+    const bool is_mesh = out_stats->geometry_type == TRIANGULAR_MESH;
+    if (!disk_directory.empty()) {
+      StoreOnDisk(disk_directory, key, *pc,
+                  is_mesh ? static_cast<const Mesh *>(pc.get()) : nullptr);
+    }
+    if (is_mesh) {
+      geometry.mesh = static_cast<const Mesh *>(pc.get());
+    }
+  }
+  geometry.pc = std::move(pc);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Insert(key, geometry);
+  return geometry;
+}
+
+void UD_DecodeCache::SetByteBudget(size_t byte_budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  byte_budget_ = byte_budget;
+  EvictToBudget();
+}
+
+size_t UD_DecodeCache::byte_budget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return byte_budget_;
+}
+
+void UD_DecodeCache::SetDiskDirectory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  disk_directory_ = directory;
+}
+
+void UD_DecodeCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lookup_.clear();
+  size_in_bytes_ = 0;
+}
+
+size_t UD_DecodeCache::size_in_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+int64_t UD_DecodeCache::num_hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_hits_;
+}
+
+int64_t UD_DecodeCache::num_disk_hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_disk_hits_;
+}
+
+int64_t UD_DecodeCache::num_misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_misses_;
+}
+
+size_t UD_DecodeCache::EstimateGeometrySize(const PointCloud &pc,
+                                            const Mesh *mesh) {
+  size_t size = mesh ? sizeof(Mesh) : sizeof(PointCloud);
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const PointAttribute *const att = pc.attribute(i);
+    size += sizeof(PointAttribute);
+    if (att->buffer()) {
+      size += att->buffer()->data_size();
+    }
+    size += att->indices_map_size() * sizeof(AttributeValueIndex);
+  }
+  if (mesh) {
+    size += mesh->num_faces() * sizeof(Mesh::Face);
+  }
+  return size;
+}
+
+uint64_t UD_DecodeCache::HashDecoderOptions(Decoder *decoder) {
+  // Skipped attribute transforms are the only options that change the
+  // decoded output.
+  uint64_t hash = 0;
+  for (int i = 0; i < GeometryAttribute::NAMED_ATTRIBUTES_COUNT; ++i) {
+    if (decoder->options()->GetAttributeBool(
+            static_cast<GeometryAttribute::Type>(i),
+            "skip_attribute_transform", false)) {
+      hash |= 1ull << i;
+    }
+  }
+  return hash;
+}
+
+std::string UD_DecodeCache::GetDiskPath(const std::string &directory,
+                                        const Key &key) {
+  char name[64];
+  snprintf(name, sizeof(name), "%016" PRIx64 "_%04" PRIx64 ".udm",
+           key.fingerprint, key.options_hash);
+  return directory + "/" + name;
+}
+
+std::unique_ptr<PointCloud> UD_DecodeCache::LoadFromDisk(
+    const std::string &directory, const Key &key, const Mesh **out_mesh) {
+  const std::string path = GetDiskPath(directory, key);
+  const std::unique_ptr<UD_BinaryMeshReader> reader =
+      UD_BinaryMeshReader::Open(path);
+  if (!reader) {
+    return nullptr;
+  }
+  auto statusor = reader->ReadGeometry();
+  if (!statusor.ok()) {
+    UDWARNING1("Ignoring corrupted decode cache entry %s",
+               UTF8_TO_TCHAR(path.c_str()));
+    return nullptr;
+  }
+  std::unique_ptr<PointCloud> pc = std::move(statusor).value();
+  *out_mesh = reader->is_mesh() ? static_cast<const Mesh *>(pc.get()) : nullptr;
+  return pc;
+}
+
+void UD_DecodeCache::StoreOnDisk(const std::string &directory,
+                                 const Key &key, const PointCloud &pc,
+                                 const Mesh *mesh) {
+  // Metadata is not stored in .udm files, such geometry is only kept in
+  // memory.
+  if (pc.GetMetadata() != nullptr) {
+    return;
+  }
+  const std::string path = GetDiskPath(directory, key);
+  const std::unique_ptr<UD_BinaryMeshWriter> writer =
+      UD_BinaryMeshWriter::Open(path);
+  if (!writer || !writer->Write(pc, mesh)) {
+    UDWARNING1("Failed to write decode cache entry %s",
+               UTF8_TO_TCHAR(path.c_str()));
+  }
+}
+
+void UD_DecodeCache::Insert(const Key &key,
+                            const UD_DecodedGeometry &geometry) {
+  const size_t size = EstimateGeometrySize(*geometry.pc, geometry.mesh);
+  if (size > byte_budget_) {
+    return;
+  }
+  const auto it = lookup_.find(key);
+  if (it != lookup_.end()) {
+    // Another thread decoded the same buffer concurrently.
+    size_in_bytes_ -= it->second->size;
+    entries_.erase(it->second);
+    lookup_.erase(it);
+  }
+  entries_.push_front(Entry{key, geometry, size});
+  lookup_[key] = entries_.begin();
+  size_in_bytes_ += size;
+  EvictToBudget();
+}
+
+void UD_DecodeCache::EvictToBudget() {
+  while (size_in_bytes_ > byte_budget_ && !entries_.empty()) {
+    const Entry &last = entries_.back();
+    size_in_bytes_ -= last.size;
+    lookup_.erase(last.key);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace draco
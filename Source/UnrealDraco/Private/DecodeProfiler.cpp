@@ -0,0 +1,409 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "DecodeProfiler.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "draco/compression/attributes/attributes_decoder_interface.h"
+#include "draco/compression/attributes/linear_sequencer.h"
+#include "draco/compression/attributes/sequential_attribute_decoders_controller.h"
+#include "draco/compression/attributes/sequential_integer_attribute_decoder.h"
+#include "draco/compression/attributes/sequential_normal_attribute_decoder.h"
+#include "draco/compression/attributes/sequential_quantization_attribute_decoder.h"
+#include "draco/compression/mesh/mesh_edgebreaker_decoder.h"
+#include "draco/compression/mesh/mesh_sequential_decoder.h"
+#include "draco/compression/point_cloud/point_cloud_decoder.h"
+#include "draco/compression/point_cloud/point_cloud_kd_tree_decoder.h"
+#include "draco/compression/point_cloud/point_cloud_sequential_decoder.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+namespace {
+
+double ToMs(double seconds) { return seconds * 1000.0; }
+
+// Prediction scheme, time and input bytes of one attribute decoded by a
+// ProfiledSequentialDecoder.
+struct AttributeRecord {
+  bool resolved = false;
+  int prediction_scheme = PREDICTION_NONE;
+  double ms = 0.0;
+  int64_t bytes = 0;
+};
+
+// Indexed by point cloud attribute id.
+typedef std::vector<AttributeRecord> AttributeRecords;
+
+// Sequential attribute decoder of type BaseT that records its prediction
+// scheme and the time and input of each of its stages.
+template <class BaseT>
+class ProfiledSequentialDecoder : public BaseT {
+ public:
+  explicit ProfiledSequentialDecoder(AttributeRecords *records)
+      : records_(records) {}
+
+  bool DecodePortableAttribute(const std::vector<PointIndex> &point_ids,
+                               DecoderBuffer *in_buffer) override {
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeAttribute);
+    record().resolved = true;
+    return Measure(in_buffer, [&]() {
+      return BaseT::DecodePortableAttribute(point_ids, in_buffer);
+    });
+  }
+
+  bool DecodeDataNeededByPortableTransform(
+      const std::vector<PointIndex> &point_ids,
+      DecoderBuffer *in_buffer) override {
+    return Measure(in_buffer, [&]() {
+      return BaseT::DecodeDataNeededByPortableTransform(point_ids, in_buffer);
+    });
+  }
+
+  bool TransformAttributeToOriginalFormat(
+      const std::vector<PointIndex> &point_ids) override {
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeAttributeTransform);
+    return Measure(nullptr, [&]() {
+      return BaseT::TransformAttributeToOriginalFormat(point_ids);
+    });
+  }
+
+ protected:
+  bool InitPredictionScheme(PredictionSchemeInterface *ps) override {
+    record().prediction_scheme = ps->GetPredictionMethod();
+    return BaseT::InitPredictionScheme(ps);
+  }
+
+ private:
+  AttributeRecord &record() {
+    const size_t att_id = static_cast<size_t>(this->attribute_id());
+    if (records_->size() <= att_id) {
+      records_->resize(att_id + 1);
+    }
+    return (*records_)[att_id];
+  }
+
+  template <class FunctionT>
+  bool Measure(const DecoderBuffer *buffer, FunctionT function) {
+    const double start = FPlatformTime::Seconds();
+    const int64_t begin = buffer ? buffer->decoded_size() : 0;
+    const bool ok = function();
+    AttributeRecord &att_record = record();
+    att_record.ms += ToMs(FPlatformTime::Seconds() - start);
+    att_record.bytes += buffer ? buffer->decoded_size() - begin : 0;
+    return ok;
+  }
+
+  AttributeRecords *const records_;
+};
+
+// SequentialAttributeDecodersController creating profiled decoders for the
+// same decoder types.
+class ProfiledAttributeDecodersController
+    : public SequentialAttributeDecodersController {
+ public:
+  ProfiledAttributeDecodersController(
+      std::unique_ptr<PointsSequencer> sequencer, AttributeRecords *records)
+      : SequentialAttributeDecodersController(std::move(sequencer)),
+        records_(records) {}
+
+ protected:
+  std::unique_ptr<SequentialAttributeDecoder> CreateSequentialDecoder(
+      uint8_t decoder_type) override {
+    switch (decoder_type) {
+      case SEQUENTIAL_ATTRIBUTE_ENCODER_GENERIC:
+        return std::unique_ptr<SequentialAttributeDecoder>(
+            new ProfiledSequentialDecoder<SequentialAttributeDecoder>(
+                records_));
+      case SEQUENTIAL_ATTRIBUTE_ENCODER_INTEGER:
+        return std::unique_ptr<SequentialAttributeDecoder>(
+            new ProfiledSequentialDecoder<SequentialIntegerAttributeDecoder>(
+                records_));
+      case SEQUENTIAL_ATTRIBUTE_ENCODER_QUANTIZATION:
+        return std::unique_ptr<SequentialAttributeDecoder>(
+            new ProfiledSequentialDecoder<
+                SequentialQuantizationAttributeDecoder>(records_));
+      case SEQUENTIAL_ATTRIBUTE_ENCODER_NORMALS:
+        return std::unique_ptr<SequentialAttributeDecoder>(
+            new ProfiledSequentialDecoder<SequentialNormalAttributeDecoder>(
+                records_));
+      default:
+        break;
+    }
+    return nullptr;
+  }
+
+ private:
+  AttributeRecords *const records_;
+};
+
+// The sequential decoders create every attributes decoder with a linear
+// sequencer over all points, which the profiler can do as well. The other
+// decoders build theirs from private traversal data.
+template <class DecoderT>
+struct HasLinearAttributesDecoders : std::false_type {};
+template <>
+struct HasLinearAttributesDecoders<MeshSequentialDecoder> : std::true_type {};
+template <>
+struct HasLinearAttributesDecoders<PointCloudSequentialDecoder>
+    : std::true_type {};
+
+void AddPredictionSchemeStats(int prediction_scheme, int num_attributes,
+                              int64_t num_values, double ms, int64_t bytes,
+                              UD_DecodeStats *stats) {
+  std::vector<UD_PredictionSchemeStats> &schemes = stats->prediction_schemes;
+  auto it = std::find_if(schemes.begin(), schemes.end(),
+                         [&](const UD_PredictionSchemeStats &scheme) {
+                           return scheme.prediction_scheme ==
+                                  prediction_scheme;
+                         });
+  if (it == schemes.end()) {
+    UD_PredictionSchemeStats scheme;
+    scheme.prediction_scheme = prediction_scheme;
+    it = schemes.insert(
+        std::upper_bound(schemes.begin(), schemes.end(), scheme,
+                         [](const UD_PredictionSchemeStats &a,
+                            const UD_PredictionSchemeStats &b) {
+                           return a.prediction_scheme < b.prediction_scheme;
+                         }),
+        scheme);
+  }
+  it->num_attributes += num_attributes;
+  it->num_values += num_values;
+  it->ms += ms;
+  it->bytes += bytes;
+}
+
+// Wraps one of the concrete Draco decoders and measures the protected
+// pipeline hooks that PointCloudDecoder::Decode() calls in order:
+// InitializeDecoder, DecodeGeometryData, CreateAttributesDecoder,
+// DecodeAllAttributes and OnAttributesDecoded.
+template <class DecoderT>
+class UD_ProfiledDecoder : public DecoderT {
+ public:
+  explicit UD_ProfiledDecoder(UD_DecodeStats *stats) : stats_(stats) {}
+
+  // Marks the beginning of the decode. Everything up to InitializeDecoder()
+  // is accounted as header and metadata.
+  void BeginDecode(const DecoderBuffer &buffer) {
+    stage_start_ = FPlatformTime::Seconds();
+    input_begin_ = buffer.data_head();
+    stage_position_ = 0;
+  }
+
+ protected:
+  bool InitializeDecoder() override {
+    EndStage(&stats_->header_ms, &stats_->header_bytes);
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeInitialize);
+    const bool ok = DecoderT::InitializeDecoder();
+    EndStage(&stats_->initialize_ms, &stats_->initialize_bytes);
+    return ok;
+  }
+
+  bool DecodeGeometryData() override {
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeConnectivity);
+    const bool ok = DecoderT::DecodeGeometryData();
+    EndStage(&stats_->connectivity_ms, &stats_->connectivity_bytes);
+    return ok;
+  }
+
+  bool CreateAttributesDecoder(int32_t att_decoder_id) override {
+    return CreateAttributesDecoder(att_decoder_id,
+                                   HasLinearAttributesDecoders<DecoderT>());
+  }
+
+  bool DecodeAllAttributes() override {
+    EndStage(&stats_->attribute_setup_ms, &stats_->attribute_setup_bytes);
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeAttributes);
+    const PointCloud *const pc = this->point_cloud();
+    for (int i = 0; i < this->num_attributes_decoders(); ++i) {
+      // attributes_decoder() only exposes a const pointer, but the decoder is
+      // owned by this object and DecodeAllAttributes() is where the base
+      // class runs it.
+      AttributesDecoderInterface *const att_decoder =
+          const_cast<AttributesDecoderInterface *>(
+              this->attributes_decoder(i));
+      UD_AttributeDecoderStats att_stats;
+      att_stats.offset = stage_position_;
+      for (int j = 0; j < att_decoder->GetNumAttributes(); ++j) {
+        const int32_t att_id = att_decoder->GetAttributeId(j);
+        att_stats.attribute_ids.push_back(att_id);
+        att_stats.attribute_types.push_back(
+            pc->attribute(att_id)->attribute_type());
+      }
+      // The data of an integer attribute starts with its prediction scheme.
+      DecoderBuffer scheme_buffer(*this->buffer());
+      {
+        TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodeAttributesDecoder);
+        if (!att_decoder->DecodeAttributes(this->buffer())) {
+          return false;
+        }
+      }
+      EndStage(&att_stats.ms, &att_stats.bytes);
+      stats_->attributes_ms += att_stats.ms;
+      stats_->attributes_bytes += att_stats.bytes;
+      AddPredictionSchemes(att_decoder, att_stats, &scheme_buffer);
+      stats_->attribute_decoders.push_back(std::move(att_stats));
+    }
+    return true;
+  }
+
+  bool OnAttributesDecoded() override {
+    TRACE_CPUPROFILER_EVENT_SCOPE(UD_DecodePostProcess);
+    const bool ok = DecoderT::OnAttributesDecoded();
+    int64_t unused_bytes = 0;
+    EndStage(&stats_->post_decode_ms, &unused_bytes);
+    return ok;
+  }
+
+ private:
+  bool CreateAttributesDecoder(int32_t att_decoder_id, std::false_type) {
+    return DecoderT::CreateAttributesDecoder(att_decoder_id);
+  }
+
+  bool CreateAttributesDecoder(int32_t att_decoder_id, std::true_type) {
+    return this->SetAttributesDecoder(
+        att_decoder_id,
+        std::unique_ptr<AttributesDecoder>(
+            new ProfiledAttributeDecodersController(
+                std::unique_ptr<PointsSequencer>(
+                    new LinearSequencer(this->point_cloud()->num_points())),
+                &records_)));
+  }
+
+  // Adds the attributes of |att_decoder| to the prediction scheme stats, one
+  // by one when they were decoded by profiled decoders. |scheme_buffer| is at
+  // the start of the decoder data.
+  void AddPredictionSchemes(AttributesDecoderInterface *att_decoder,
+                            const UD_AttributeDecoderStats &att_stats,
+                            DecoderBuffer *scheme_buffer) {
+    const PointCloud *const pc = this->point_cloud();
+    bool resolved = true;
+    int64_t num_values = 0;
+    for (const int32_t att_id : att_stats.attribute_ids) {
+      resolved &= static_cast<size_t>(att_id) < records_.size() &&
+                  records_[att_id].resolved;
+      num_values += pc->attribute(att_id)->size();
+    }
+    if (resolved) {
+      for (const int32_t att_id : att_stats.attribute_ids) {
+        const AttributeRecord &record = records_[att_id];
+        AddPredictionSchemeStats(record.prediction_scheme, 1,
+                                 pc->attribute(att_id)->size(), record.ms,
+                                 record.bytes, stats_);
+      }
+      return;
+    }
+    int prediction_scheme = PREDICTION_UNDEFINED;
+    if (std::is_same<DecoderT, PointCloudKdTreeDecoder>::value) {
+      prediction_scheme = PREDICTION_NONE;
+    } else if (att_stats.attribute_ids.size() == 1) {
+      // Only the integer decoders, which have a portable attribute, write a
+      // prediction scheme.
+      int8_t method = PREDICTION_NONE;
+      if (att_decoder->GetPortableAttribute(att_stats.attribute_ids[0]) !=
+              nullptr &&
+          !scheme_buffer->Decode(&method)) {
+        method = PREDICTION_UNDEFINED;
+      }
+      if (method >= PREDICTION_NONE && method < NUM_PREDICTION_SCHEMES) {
+        prediction_scheme = method;
+      }
+    }
+    AddPredictionSchemeStats(
+        prediction_scheme, static_cast<int>(att_stats.attribute_ids.size()),
+        num_values, att_stats.ms, att_stats.bytes, stats_);
+  }
+
+  // Stores the time and input consumed since the previous stage ended.
+  // Positions are taken relative to the start of the input because the
+  // Edgebreaker decoder re-initializes the buffer after the connectivity.
+  void EndStage(double *out_ms, int64_t *out_bytes) {
+    const double now = FPlatformTime::Seconds();
+    const int64_t position = this->buffer()->data_head() - input_begin_;
+    *out_ms = ToMs(now - stage_start_);
+    *out_bytes = position - stage_position_;
+    stage_start_ = now;
+    stage_position_ = position;
+  }
+
+  UD_DecodeStats *const stats_;
+  AttributeRecords records_;
+  const char *input_begin_ = nullptr;
+  double stage_start_ = 0.0;
+  int64_t stage_position_ = 0;
+};
+
+template <class DecoderT>
+Status DecodePointCloud(DecoderBuffer *in_buffer,
+                        const DecoderOptions &options, UD_DecodeStats *stats,
+                        PointCloud *out_pc) {
+  UD_ProfiledDecoder<DecoderT> decoder(stats);
+  decoder.BeginDecode(*in_buffer);
+  return decoder.Decode(options, in_buffer, out_pc);
+}
+
+template <class DecoderT>
+Status DecodeMesh(DecoderBuffer *in_buffer, const DecoderOptions &options,
+                  UD_DecodeStats *stats, Mesh *out_mesh) {
+  UD_ProfiledDecoder<DecoderT> decoder(stats);
+  decoder.BeginDecode(*in_buffer);
+  return decoder.Decode(options, in_buffer, out_mesh);
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PointCloud>> UD_DecodeWithStats(
+    DecoderBuffer *in_buffer, const DecoderOptions &options,
+    UD_DecodeStats *out_stats) {
+  TRACE_CPUPROFILER_EVENT_SCOPE(UD_Decode);
+  *out_stats = UD_DecodeStats();
+  const double start = FPlatformTime::Seconds();
+
+  // Peek at the header to pick the same decoder that draco::Decoder would.
+  DecoderBuffer header_buffer(*in_buffer);
+  DracoHeader header;
+  DRACO_RETURN_IF_ERROR(
+      PointCloudDecoder::DecodeHeader(&header_buffer, &header));
+  out_stats->geometry_type =
+      static_cast<EncodedGeometryType>(header.encoder_type);
+  out_stats->encoder_method = header.encoder_method;
+
+  std::unique_ptr<PointCloud> pc;
+  if (header.encoder_type == TRIANGULAR_MESH) {
+    std::unique_ptr<Mesh> mesh(new Mesh());
+    if (header.encoder_method == MESH_SEQUENTIAL_ENCODING) {
+      DRACO_RETURN_IF_ERROR(DecodeMesh<MeshSequentialDecoder>(
+          in_buffer, options, out_stats, mesh.get()));
+    } else if (header.encoder_method == MESH_EDGEBREAKER_ENCODING) {
+      DRACO_RETURN_IF_ERROR(DecodeMesh<MeshEdgebreakerDecoder>(
+          in_buffer, options, out_stats, mesh.get()));
+    } else {
+      return Status(Status::DRACO_ERROR, "Unsupported encoding method.");
+    }
+    out_stats->num_faces = mesh->num_faces();
+    pc = std::move(mesh);
+  } else if (header.encoder_type == POINT_CLOUD) {
+    pc.reset(new PointCloud());
+    if (header.encoder_method == POINT_CLOUD_SEQUENTIAL_ENCODING) {
+      DRACO_RETURN_IF_ERROR(DecodePointCloud<PointCloudSequentialDecoder>(
+          in_buffer, options, out_stats, pc.get()));
+    } else if (header.encoder_method == POINT_CLOUD_KD_TREE_ENCODING) {
+      DRACO_RETURN_IF_ERROR(DecodePointCloud<PointCloudKdTreeDecoder>(
+          in_buffer, options, out_stats, pc.get()));
+    } else {
+      return Status(Status::DRACO_ERROR, "Unsupported encoding method.");
+    }
+  } else {
+    return Status(Status::DRACO_ERROR, "Unsupported geometry type.");
+  }
+  out_stats->num_points = pc->num_points();
+  out_stats->total_ms = ToMs(FPlatformTime::Seconds() - start);
+  return pc;
+}
+
+}  // namespace draco
@@ -0,0 +1,351 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "DracoBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "MeshReader.h"
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/io/file_utils.h"
+#include "draco/io/mesh_io.h"
+#include "draco/io/parser_utils.h"
+#include "draco/point_cloud/point_cloud_builder.h"
+
+namespace draco {
+
+namespace {
+
+constexpr double kMegaByte = 1024.0 * 1024.0;
+
+double PerSecond(double amount, double ms) {
+  return ms > 0.0 ? amount * 1000.0 / ms : 0.0;
+}
+
+// Tracks the physical memory used by one measurement above a baseline. The
+// process peak never decreases, so it only tells about the measurement when the
+// measurement raised it. Otherwise the samples taken while its buffers are
+// alive are the best available bound.
+class MemoryTracker {
+ public:
+  MemoryTracker() {
+    const FPlatformMemoryStats stats = FPlatformMemory::GetStats();
+    baseline_ = stats.UsedPhysical;
+    peak_before_ = stats.PeakUsedPhysical;
+    max_sample_ = baseline_;
+  }
+
+  void Sample() {
+    max_sample_ = std::max<uint64_t>(max_sample_,
+                                     FPlatformMemory::GetStats().UsedPhysical);
+  }
+
+  uint64_t PeakDelta() const {
+    const uint64_t peak_after = FPlatformMemory::GetStats().PeakUsedPhysical;
+    const uint64_t peak =
+        peak_after > peak_before_ ? std::max(peak_after, max_sample_)
+                                  : max_sample_;
+    return peak > baseline_ ? peak - baseline_ : 0;
+  }
+
+ private:
+  uint64_t baseline_;
+  uint64_t peak_before_;
+  uint64_t max_sample_;
+};
+
+}  // namespace
+
+double UD_BenchmarkResult::CompressionRatio() const {
+  return encoded_bytes > 0 ? static_cast<double>(raw_bytes) / encoded_bytes
+                           : 0.0;
+}
+
+double UD_BenchmarkResult::EncodeMegaBytesPerSecond() const {
+  return PerSecond(raw_bytes / kMegaByte, encode_ms);
+}
+
+double UD_BenchmarkResult::DecodeMegaBytesPerSecond() const {
+  return PerSecond(raw_bytes / kMegaByte, decode_ms);
+}
+
+double UD_BenchmarkResult::DecodeTrianglesPerSecond() const {
+  return PerSecond(num_faces, decode_ms);
+}
+
+double UD_BenchmarkResult::DecodePointsPerSecond() const {
+  return PerSecond(num_points, decode_ms);
+}
+
+UD_Benchmark::UD_Benchmark()
+    : compression_levels_({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}),
+      quantizations_({{"default", 11, 10, 8, 8}, {"high", 16, 12, 10, 12}}),
+      parallelogram_searches_({UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE}),
+      repetitions_(3) {}
+
+void UD_Benchmark::AddSyntheticCorpus() {
+  for (int segments : {64, 256, 1024}) {
+    AddGeometry("sphere_" + std::to_string(segments), CreateSphere(segments),
+                true);
+  }
+  for (int num_points : {100000, 1000000}) {
+    AddGeometry("noise_" + std::to_string(num_points),
+                CreateNoisyPointCloud(num_points, 7), false);
+  }
+}
+
+bool UD_Benchmark::AddFile(const std::string &file_name) {
+  const std::string extension = parser::ToLower(
+      file_name.size() >= 4 ? file_name.substr(file_name.size() - 4)
+                            : file_name);
+  std::string name;
+  SplitPath(file_name, nullptr, &name);
+  if (extension == ".drc") {
+    std::vector<char> data;
+    if (!ReadFileToBuffer(file_name, &data) || data.empty()) {
+      return false;
+    }
+    DecoderBuffer buffer;
+    buffer.Init(data.data(), data.size());
+    auto type_statusor = Decoder::GetEncodedGeometryType(&buffer);
+    if (!type_statusor.ok()) {
+      return false;
+    }
+    Decoder decoder;
+    if (type_statusor.value() == TRIANGULAR_MESH) {
+      auto statusor = decoder.DecodeMeshFromBuffer(&buffer);
+      if (!statusor.ok()) {
+        return false;
+      }
+      AddGeometry(name, std::move(statusor).value(), true);
+    } else {
+      auto statusor = decoder.DecodePointCloudFromBuffer(&buffer);
+      if (!statusor.ok()) {
+        return false;
+      }
+      AddGeometry(name, std::move(statusor).value(), false);
+    }
+    return true;
+  }
+  auto statusor = UD_ReadMeshFromFile(file_name);
+  if (!statusor.ok()) {
+    return false;
+  }
+  std::unique_ptr<Mesh> mesh = std::move(statusor).value();
+  const bool is_mesh = mesh->num_faces() > 0;
+  AddGeometry(name, std::move(mesh), is_mesh);
+  return true;
+}
+
+void UD_Benchmark::AddGeometry(const std::string &name,
+                               std::unique_ptr<PointCloud> pc, bool is_mesh) {
+  if (pc == nullptr) {
+    return;
+  }
+  CorpusEntry entry;
+  entry.name = name;
+  entry.pc = std::move(pc);
+  entry.is_mesh = is_mesh;
+  corpus_.push_back(std::move(entry));
+}
+
+std::vector<UD_BenchmarkResult> UD_Benchmark::Run() const {
+  std::vector<UD_BenchmarkResult> results;
+  for (const CorpusEntry &entry : corpus_) {
+    for (const UD_BenchmarkQuantization &q : quantizations_) {
+      for (int level : compression_levels_) {
+        for (size_t i = 0; i < parallelogram_searches_.size(); ++i) {
+          if (i > 0 && (!entry.is_mesh || level < 9)) {
+            break;
+          }
+          results.push_back(
+              Measure(entry, level, q, parallelogram_searches_[i]));
+        }
+      }
+    }
+  }
+  return results;
+}
+
+UD_BenchmarkResult UD_Benchmark::Measure(
+    const CorpusEntry &entry, int compression_level,
+    const UD_BenchmarkQuantization &q, UD_ParallelogramSearch search) const {
+  const Mesh *const mesh =
+      entry.is_mesh ? static_cast<const Mesh *>(entry.pc.get()) : nullptr;
+  UD_BenchmarkResult result;
+  result.name = entry.name;
+  result.is_mesh = entry.is_mesh;
+  result.compression_level = compression_level;
+  result.quantization = q.label;
+  result.parallelogram_search = search;
+  result.num_points = entry.pc->num_points();
+  result.num_faces = mesh ? mesh->num_faces() : 0;
+  result.raw_bytes = ComputeRawSize(*entry.pc, mesh);
+
+  Encoder encoder;
+  encoder.SetAttributeQuantization(GeometryAttribute::POSITION,
+                                   q.position_bits);
+  encoder.SetAttributeQuantization(GeometryAttribute::TEX_COORD,
+                                   q.tex_coord_bits);
+  encoder.SetAttributeQuantization(GeometryAttribute::NORMAL, q.normal_bits);
+  encoder.SetAttributeQuantization(GeometryAttribute::GENERIC,
+                                   q.generic_bits);
+  const int speed = 10 - compression_level;
+  encoder.SetSpeedOptions(speed, speed);
+
+  EncoderOptions mesh_options = EncoderOptions::CreateDefaultOptions();
+  if (mesh) {
+    mesh_options = UD_CreateExpertEncoderOptions(encoder, *mesh);
+    UD_SetParallelogramSearch(search, &mesh_options);
+  }
+
+  MemoryTracker memory;
+  EncoderBuffer buffer;
+  result.encode_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(repetitions_, 1); ++i) {
+    buffer.Clear();
+    // The search sets the prediction it chose in the options, so every
+    // repetition starts from a copy.
+    EncoderOptions options = mesh_options;
+    const double start = FPlatformTime::Seconds();
+    const Status status =
+        mesh ? UD_EncodeMeshWithParallelogramSearch(*mesh, &options, &buffer)
+             : encoder.EncodePointCloudToBuffer(*entry.pc, &buffer);
+    const double elapsed_ms = (FPlatformTime::Seconds() - start) * 1000.0;
+    if (!status.ok()) {
+      return result;
+    }
+    result.encode_ms = std::min(result.encode_ms, elapsed_ms);
+  }
+  result.encoded_bytes = buffer.size();
+  memory.Sample();
+
+  result.decode_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(repetitions_, 1); ++i) {
+    DecoderBuffer decoder_buffer;
+    decoder_buffer.Init(buffer.data(), buffer.size());
+    Decoder decoder;
+    const double start = FPlatformTime::Seconds();
+    // Kept until the memory is sampled.
+    std::unique_ptr<PointCloud> decoded;
+    if (mesh) {
+      auto statusor = decoder.DecodeMeshFromBuffer(&decoder_buffer);
+      if (statusor.ok()) {
+        decoded = std::move(statusor).value();
+      }
+    } else {
+      auto statusor = decoder.DecodePointCloudFromBuffer(&decoder_buffer);
+      if (statusor.ok()) {
+        decoded = std::move(statusor).value();
+      }
+    }
+    const double elapsed_ms = (FPlatformTime::Seconds() - start) * 1000.0;
+    if (decoded == nullptr) {
+      return result;
+    }
+    result.decode_ms = std::min(result.decode_ms, elapsed_ms);
+    memory.Sample();
+  }
+  result.peak_memory_delta_bytes = memory.PeakDelta();
+  result.ok = true;
+  return result;
+}
+
+size_t UD_Benchmark::ComputeRawSize(const PointCloud &pc, const Mesh *mesh) {
+  size_t size = 0;
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const PointAttribute *const att = pc.attribute(i);
+    size += att->size() * att->byte_stride();
+    size += att->indices_map_size() * sizeof(AttributeValueIndex);
+  }
+  if (mesh) {
+    size += mesh->num_faces() * sizeof(Mesh::Face);
+  }
+  return size;
+}
+
+std::unique_ptr<Mesh> UD_Benchmark::CreateSphere(int num_segments) {
+  const int n = num_segments + 1;
+  const uint32_t num_points = n * n;
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  mesh->set_num_points(num_points);
+
+  GeometryAttribute pos;
+  pos.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+           sizeof(float) * 3, 0);
+  PointAttribute *const pos_att =
+      mesh->attribute(mesh->AddAttribute(pos, true, num_points));
+  GeometryAttribute normal;
+  normal.Init(GeometryAttribute::NORMAL, nullptr, 3, DT_FLOAT32, false,
+              sizeof(float) * 3, 0);
+  PointAttribute *const normal_att =
+      mesh->attribute(mesh->AddAttribute(normal, true, num_points));
+  GeometryAttribute tex_coord;
+  tex_coord.Init(GeometryAttribute::TEX_COORD, nullptr, 2, DT_FLOAT32, false,
+                 sizeof(float) * 2, 0);
+  PointAttribute *const tex_coord_att =
+      mesh->attribute(mesh->AddAttribute(tex_coord, true, num_points));
+
+  const double pi = 3.14159265358979323846;
+  for (int y = 0; y < n; ++y) {
+    const double v = static_cast<double>(y) / num_segments;
+    const double theta = v * pi;
+    for (int x = 0; x < n; ++x) {
+      const double u = static_cast<double>(x) / num_segments;
+      const double phi = u * 2.0 * pi;
+      const float dir[3] = {
+          static_cast<float>(std::sin(theta) * std::cos(phi)),
+          static_cast<float>(std::cos(theta)),
+          static_cast<float>(std::sin(theta) * std::sin(phi))};
+      const float p[3] = {dir[0] * 100.f, dir[1] * 100.f, dir[2] * 100.f};
+      const float uv[2] = {static_cast<float>(u), static_cast<float>(v)};
+      const AttributeValueIndex index(y * n + x);
+      pos_att->SetAttributeValue(index, p);
+      normal_att->SetAttributeValue(index, dir);
+      tex_coord_att->SetAttributeValue(index, uv);
+    }
+  }
+  for (int y = 0; y < num_segments; ++y) {
+    for (int x = 0; x < num_segments; ++x) {
+      const PointIndex a(y * n + x);
+      const PointIndex b(y * n + x + 1);
+      const PointIndex c((y + 1) * n + x);
+      const PointIndex d((y + 1) * n + x + 1);
+      mesh->AddFace({{a, c, b}});
+      mesh->AddFace({{b, c, d}});
+    }
+  }
+  return mesh;
+}
+
+std::unique_ptr<PointCloud> UD_Benchmark::CreateNoisyPointCloud(
+    int num_points, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> position(-100.f, 100.f);
+  std::uniform_int_distribution<int> color(0, 255);
+
+  PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int color_att_id =
+      builder.AddAttribute(GeometryAttribute::COLOR, 3, DT_UINT8);
+  for (PointIndex i(0); i < static_cast<uint32_t>(num_points); ++i) {
+    const float p[3] = {position(generator), position(generator),
+                        position(generator)};
+    const uint8_t c[3] = {static_cast<uint8_t>(color(generator)),
+                          static_cast<uint8_t>(color(generator)),
+                          static_cast<uint8_t>(color(generator))};
+    builder.SetAttributeValueForPoint(pos_att_id, i, p);
+    builder.SetAttributeValueForPoint(color_att_id, i, c);
+  }
+  return builder.Finalize(false);
+}
+
+}  // namespace draco
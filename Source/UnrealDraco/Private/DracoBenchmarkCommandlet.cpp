@@ -0,0 +1,240 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "DracoBenchmarkCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+#include "FileHelper.h"
+#include "DracoBenchmark.h"
+#include "KernelBenchmark.h"
+
+static const TCHAR* GetParallelogramSearchName(draco::UD_ParallelogramSearch Search)
+{
+	switch (Search)
+	{
+	case draco::UD_PARALLELOGRAM_SEARCH_SAMPLED:
+		return TEXT("sampled");
+	case draco::UD_PARALLELOGRAM_SEARCH_SINGLE:
+		return TEXT("single");
+	default:
+		return TEXT("exhaustive");
+	}
+}
+
+// Results of the default exhaustive search keep the keys of older reports.
+static FString GetResultKey(const FString& Name, const FString& Quantization, int32 CompressionLevel, const FString& Search)
+{
+	if (Search.IsEmpty() || Search == TEXT("exhaustive"))
+	{
+		return FString::Printf(TEXT("%s|%s|%d"), *Name, *Quantization, CompressionLevel);
+	}
+	return FString::Printf(TEXT("%s|%s|%d|%s"), *Name, *Quantization, CompressionLevel, *Search);
+}
+
+static FString GetResultKey(const FJsonObject& Object)
+{
+	FString Search;
+	Object.TryGetStringField(TEXT("parallelogram_search"), Search);
+	return GetResultKey(Object.GetStringField(TEXT("name")), Object.GetStringField(TEXT("quantization")),
+		static_cast<int32>(Object.GetNumberField(TEXT("compression_level"))), Search);
+}
+
+static TSharedRef<FJsonObject> ResultToJson(const draco::UD_BenchmarkResult& Result)
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("name"), UTF8_TO_TCHAR(Result.name.c_str()));
+	Json->SetStringField(TEXT("kind"), Result.is_mesh ? TEXT("mesh") : TEXT("point_cloud"));
+	Json->SetNumberField(TEXT("compression_level"), Result.compression_level);
+	Json->SetStringField(TEXT("quantization"), UTF8_TO_TCHAR(Result.quantization.c_str()));
+	Json->SetStringField(TEXT("parallelogram_search"), GetParallelogramSearchName(Result.parallelogram_search));
+	Json->SetBoolField(TEXT("ok"), Result.ok);
+	Json->SetNumberField(TEXT("num_points"), Result.num_points);
+	Json->SetNumberField(TEXT("num_faces"), Result.num_faces);
+	Json->SetNumberField(TEXT("raw_bytes"), static_cast<double>(Result.raw_bytes));
+	Json->SetNumberField(TEXT("encoded_bytes"), static_cast<double>(Result.encoded_bytes));
+	Json->SetNumberField(TEXT("compression_ratio"), Result.CompressionRatio());
+	Json->SetNumberField(TEXT("encode_ms"), Result.encode_ms);
+	Json->SetNumberField(TEXT("decode_ms"), Result.decode_ms);
+	Json->SetNumberField(TEXT("encode_mb_per_s"), Result.EncodeMegaBytesPerSecond());
+	Json->SetNumberField(TEXT("decode_mb_per_s"), Result.DecodeMegaBytesPerSecond());
+	Json->SetNumberField(TEXT("triangles_per_s"), Result.DecodeTrianglesPerSecond());
+	Json->SetNumberField(TEXT("points_per_s"), Result.DecodePointsPerSecond());
+	Json->SetNumberField(TEXT("peak_memory_delta_mb"), Result.peak_memory_delta_bytes / (1024.0 * 1024.0));
+	return Json;
+}
+
+static TSharedRef<FJsonObject> KernelResultToJson(const draco::UD_KernelBenchmarkResult& Result)
+{
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("kernel"), UTF8_TO_TCHAR(Result.kernel.c_str()));
+	Json->SetStringField(TEXT("name"), UTF8_TO_TCHAR(Result.name.c_str()));
+	Json->SetNumberField(TEXT("num_entries"), Result.num_entries);
+	Json->SetNumberField(TEXT("reference_ms"), Result.reference_ms);
+	Json->SetNumberField(TEXT("optimized_ms"), Result.optimized_ms);
+	Json->SetNumberField(TEXT("speedup"), Result.Speedup());
+	Json->SetBoolField(TEXT("identical"), Result.identical);
+	return Json;
+}
+
+// Lists every result of |Report| that regressed against |Baseline|. Returns the number of regressions.
+static int32 CompareWithBaseline(const TArray<TSharedPtr<FJsonValue>>& Report, const TArray<TSharedPtr<FJsonValue>>& Baseline, float Tolerance)
+{
+	TMap<FString, TSharedPtr<FJsonObject>> BaselineByKey;
+	for (const TSharedPtr<FJsonValue>& Value : Baseline)
+	{
+		const TSharedPtr<FJsonObject> Object = Value->AsObject();
+		if (Object.IsValid())
+		{
+			BaselineByKey.Add(GetResultKey(*Object), Object);
+		}
+	}
+
+	int32 NumRegressions = 0;
+	for (const TSharedPtr<FJsonValue>& Value : Report)
+	{
+		const TSharedPtr<FJsonObject> Object = Value->AsObject();
+		const FString Key = GetResultKey(*Object);
+		const TSharedPtr<FJsonObject>* Previous = BaselineByKey.Find(Key);
+		if (Previous == nullptr)
+		{
+			continue;
+		}
+		if (Object->GetBoolField(TEXT("ok")) != (*Previous)->GetBoolField(TEXT("ok")))
+		{
+			UE_LOG(UDLog, Warning, TEXT("Regression %s: status changed."), *Key);
+			++NumRegressions;
+			continue;
+		}
+		for (const TCHAR* Field : { TEXT("encode_ms"), TEXT("decode_ms"), TEXT("encoded_bytes") })
+		{
+			const double Current = Object->GetNumberField(Field);
+			const double Old = (*Previous)->GetNumberField(Field);
+			if (Old > 0.0 && Current > Old * (1.0 + Tolerance))
+			{
+				UE_LOG(UDLog, Warning, TEXT("Regression %s: %s %.3f -> %.3f (+%.1f%%)."), *Key, Field, Old, Current, (Current / Old - 1.0) * 100.0);
+				++NumRegressions;
+			}
+		}
+	}
+	return NumRegressions;
+}
+
+UDracoBenchmarkCommandlet::UDracoBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDracoBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString CorpusDirectory;
+	FString OutFile = FPaths::ProjectSavedDir() / TEXT("DracoBenchmark.json");
+	FString BaselineFile;
+	float Tolerance = 0.1f;
+	FParse::Value(*Params, TEXT("corpus="), CorpusDirectory);
+	FParse::Value(*Params, TEXT("out="), OutFile);
+	FParse::Value(*Params, TEXT("baseline="), BaselineFile);
+	FParse::Value(*Params, TEXT("tolerance="), Tolerance);
+
+	draco::UD_Benchmark Benchmark;
+	if (FParse::Param(*Params, TEXT("quick")))
+	{
+		Benchmark.set_compression_levels({ 0, 7, 10 });
+		Benchmark.set_repetitions(1);
+	}
+	// Compares the position prediction searches at compression levels 9 and 10.
+	if (FParse::Param(*Params, TEXT("parallelogram")))
+	{
+		Benchmark.set_parallelogram_searches({ draco::UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE,
+			draco::UD_PARALLELOGRAM_SEARCH_SAMPLED, draco::UD_PARALLELOGRAM_SEARCH_SINGLE });
+	}
+	// Also times the plugin's attribute kernels against the Draco ones.
+	const bool bKernels = FParse::Param(*Params, TEXT("kernels"));
+	draco::UD_KernelBenchmark KernelBenchmark;
+	Benchmark.AddSyntheticCorpus();
+	if (bKernels)
+	{
+		KernelBenchmark.AddSyntheticCorpus();
+	}
+	if (!CorpusDirectory.IsEmpty())
+	{
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *(CorpusDirectory / TEXT("*")), true, false);
+		for (const FString& File : Files)
+		{
+			const FString Extension = FPaths::GetExtension(File).ToLower();
+			if (Extension != TEXT("obj") && Extension != TEXT("ply") && Extension != TEXT("drc"))
+			{
+				continue;
+			}
+			const FString Path = CorpusDirectory / File;
+			if (!Benchmark.AddFile(std::string(TCHAR_TO_UTF8(*Path))))
+			{
+				UE_LOG(UDLog, Warning, TEXT("Skipping unreadable corpus file %s."), *Path);
+			}
+			else if (bKernels && Extension != TEXT("drc"))
+			{
+				KernelBenchmark.AddFile(std::string(TCHAR_TO_UTF8(*Path)));
+			}
+		}
+	}
+
+	const std::vector<draco::UD_BenchmarkResult> Results = Benchmark.Run();
+	TArray<TSharedPtr<FJsonValue>> JsonResults;
+	for (const draco::UD_BenchmarkResult& Result : Results)
+	{
+		JsonResults.Add(MakeShared<FJsonValueObject>(ResultToJson(Result)));
+		UE_LOG(UDLog, Display, TEXT("%-24s %-8s cl%-2d %-10s %10.2f ms enc %10.2f ms dec %8.2f MB/s ratio %6.2f"),
+			UTF8_TO_TCHAR(Result.name.c_str()), UTF8_TO_TCHAR(Result.quantization.c_str()), Result.compression_level,
+			GetParallelogramSearchName(Result.parallelogram_search), Result.encode_ms, Result.decode_ms, Result.DecodeMegaBytesPerSecond(), Result.CompressionRatio());
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("draco_version"), TEXT("1.3.6"));
+	Report->SetArrayField(TEXT("results"), JsonResults);
+	if (bKernels)
+	{
+		TArray<TSharedPtr<FJsonValue>> JsonKernels;
+		for (const draco::UD_KernelBenchmarkResult& Result : KernelBenchmark.Run())
+		{
+			JsonKernels.Add(MakeShared<FJsonValueObject>(KernelResultToJson(Result)));
+			UE_LOG(UDLog, Display, TEXT("%-24s %-20s %10.3f ms ref %10.3f ms opt x%5.2f %s"),
+				UTF8_TO_TCHAR(Result.name.c_str()), UTF8_TO_TCHAR(Result.kernel.c_str()), Result.reference_ms, Result.optimized_ms,
+				Result.Speedup(), Result.identical ? TEXT("identical") : TEXT("MISMATCH"));
+		}
+		Report->SetArrayField(TEXT("kernels"), JsonKernels);
+	}
+	FString ReportText;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportText);
+	FJsonSerializer::Serialize(Report, Writer);
+	if (!FFileHelper::SaveStringToFile(ReportText, *OutFile))
+	{
+		UE_LOG(UDLog, Error, TEXT("Failed to write benchmark report %s."), *OutFile);
+		return 1;
+	}
+	UE_LOG(UDLog, Display, TEXT("Benchmark report saved to %s."), *OutFile);
+
+	if (BaselineFile.IsEmpty())
+	{
+		return 0;
+	}
+	FString BaselineText;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineText, *BaselineFile) ||
+		!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), Baseline) || !Baseline.IsValid())
+	{
+		UE_LOG(UDLog, Error, TEXT("Failed to read baseline report %s."), *BaselineFile);
+		return 1;
+	}
+	const int32 NumRegressions = CompareWithBaseline(JsonResults, Baseline->GetArrayField(TEXT("results")), Tolerance);
+	UE_LOG(UDLog, Display, TEXT("%d regressions against %s."), NumRegressions, *BaselineFile);
+	return NumRegressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "EncodeCache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "draco/core/hash_utils.h"
+#include "draco/io/file_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Part of every key. Bump it when the vendored Draco library is upgraded so
+// that bitstreams produced by the previous encoder are not reused.
+constexpr char kEncodeCacheVersion[] = "draco-1.3.6/1";
+
+bool CopyFile(const std::string &src, const std::string &dst) {
+  std::vector<char> data;
+  if (!ReadFileToBuffer(src, &data)) {
+    return false;
+  }
+  return WriteBufferToFile(data.data(), data.size(), dst);
+}
+
+uint64_t FingerprintBuffer(const std::vector<char> &data) {
+  return data.empty() ? 0 : FingerprintString(data.data(), data.size());
+}
+
+// Returns the extension of the container UFlib_DracoUtilities::Encoder()
+// writes to |file|.
+std::string GetContainerExtension(const std::string &file) {
+  return LowercaseFileExtension(file) == "glb" ? "glb" : "drc";
+}
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Returns the files named by the mtllib statements of the OBJ |input|,
+// resolved like ObjDecoder does.
+std::vector<std::string> FindMaterialLibraries(const std::string &file_name,
+                                               const std::vector<char> &input) {
+  std::vector<std::string> libraries;
+  const char *p = input.data();
+  const char *const end = p + input.size();
+  while (p < end) {
+    const char *line_end = static_cast<const char *>(
+        memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+    while (p < line_end && IsSpace(*p)) {
+      ++p;
+    }
+    if (line_end - p > 6 && memcmp(p, "mtllib", 6) == 0) {
+      p += 6;
+      while (p < line_end && IsSpace(*p)) {
+        ++p;
+      }
+      const char *name_end = p;
+      while (name_end < line_end && !IsSpace(*name_end)) {
+        ++name_end;
+      }
+      if (name_end > p) {
+        libraries.push_back(GetFullPath(std::string(p, name_end), file_name));
+      }
+    }
+    p = line_end + 1;
+  }
+  return libraries;
+}
+
+}  // namespace
+
+UD_EncodeCache::UD_EncodeCache(const std::string &directory)
+    : directory_(directory) {}
+
+uint64_t UD_EncodeCache::ComputeKey(const std::string &file_name,
+                                    const std::vector<char> &input,
+                                    const std::string &serialized_options,
+                                    const std::string &out_file) {
+  const std::string salt = serialized_options + "|" +
+                           GetContainerExtension(out_file) + "|" +
+                           kEncodeCacheVersion;
+  uint64_t key = HashCombine(FingerprintBuffer(input),
+                             FingerprintString(salt.data(), salt.size()));
+  if (LowercaseFileExtension(file_name) != "obj") {
+    return key;
+  }
+  for (const std::string &library : FindMaterialLibraries(file_name, input)) {
+    // A missing library still changes the key, so that creating it later
+    // invalidates the entry.
+    std::vector<char> data;
+    ReadFileToBuffer(library, &data);
+    key = HashCombine(key, FingerprintString(library.data(), library.size()));
+    key = HashCombine(key, FingerprintBuffer(data));
+  }
+  return key;
+}
+
+bool UD_EncodeCache::Fetch(uint64_t key, const std::string &out_file) const {
+  if (!IsValid()) {
+    return false;
+  }
+  const std::string path = GetEntryPath(key, out_file);
+  if (GetFileSize(path) == 0) {
+    return false;
+  }
+  return CopyFile(path, out_file);
+}
+
+bool UD_EncodeCache::Store(uint64_t key, const std::string &file) const {
+  if (!IsValid()) {
+    return false;
+  }
+  return CopyFile(file, GetEntryPath(key, file));
+}
+
+std::string UD_EncodeCache::GetEntryPath(uint64_t key,
+                                         const std::string &file) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%016" PRIx64 ".%s", key,
+           GetContainerExtension(file).c_str());
+  return directory_ + "/" + name;
+}
+
+}  // namespace draco
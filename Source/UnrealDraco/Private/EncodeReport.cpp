@@ -0,0 +1,442 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "EncodeReport.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "DecodeProfiler.h"
+#include "draco/compression/attributes/prediction_schemes/mesh_prediction_scheme_constrained_multi_parallelogram_shared.h"
+#include "draco/compression/bit_coders/rans_bit_decoder.h"
+#include "draco/compression/entropy/rans_symbol_decoder.h"
+#include "draco/compression/entropy/shannon_entropy.h"
+#include "draco/compression/entropy/symbol_decoding.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/varint_decoding.h"
+
+namespace draco {
+
+namespace {
+
+// Size of the fixed Draco header ("DRACO", version, encoder type and method,
+// flags). Anything the decoder reads before InitializeDecoder() beyond this
+// is metadata.
+constexpr int64_t kDracoHeaderSize = 11;
+
+// Attribute encoders chosen by SequentialAttributeEncodersController.
+enum SequentialCoding {
+  CODING_GENERIC,
+  CODING_INTEGER,
+  CODING_QUANTIZATION,
+  CODING_NORMALS,
+};
+
+SequentialCoding GetSequentialCoding(const PointAttribute &att,
+                                     const EncoderOptions &options,
+                                     int32_t att_id) {
+  switch (att.data_type()) {
+    case DT_UINT8:
+    case DT_INT8:
+    case DT_UINT16:
+    case DT_INT16:
+    case DT_UINT32:
+    case DT_INT32:
+      return CODING_INTEGER;
+    case DT_FLOAT32:
+      if (options.GetAttributeInt(att_id, "quantization_bits", -1) > 0) {
+        return att.attribute_type() == GeometryAttribute::NORMAL
+                   ? CODING_NORMALS
+                   : CODING_QUANTIZATION;
+      }
+      return CODING_GENERIC;
+    default:
+      return CODING_GENERIC;
+  }
+}
+
+template <int unique_symbols_bit_length_t>
+bool SkipRawSymbolTable(DecoderBuffer *buffer) {
+  RAnsSymbolDecoder<unique_symbols_bit_length_t> decoder;
+  return decoder.Create(buffer);
+}
+
+// Advances |buffer| past the probability table of a raw symbol stream coded
+// with |max_bit_length| bits per symbol, see DecodeRawSymbols().
+bool SkipRawSymbolTable(int max_bit_length, DecoderBuffer *buffer) {
+  switch (max_bit_length) {
+    case 1: return SkipRawSymbolTable<1>(buffer);
+    case 2: return SkipRawSymbolTable<2>(buffer);
+    case 3: return SkipRawSymbolTable<3>(buffer);
+    case 4: return SkipRawSymbolTable<4>(buffer);
+    case 5: return SkipRawSymbolTable<5>(buffer);
+    case 6: return SkipRawSymbolTable<6>(buffer);
+    case 7: return SkipRawSymbolTable<7>(buffer);
+    case 8: return SkipRawSymbolTable<8>(buffer);
+    case 9: return SkipRawSymbolTable<9>(buffer);
+    case 10: return SkipRawSymbolTable<10>(buffer);
+    case 11: return SkipRawSymbolTable<11>(buffer);
+    case 12: return SkipRawSymbolTable<12>(buffer);
+    case 13: return SkipRawSymbolTable<13>(buffer);
+    case 14: return SkipRawSymbolTable<14>(buffer);
+    case 15: return SkipRawSymbolTable<15>(buffer);
+    case 16: return SkipRawSymbolTable<16>(buffer);
+    case 17: return SkipRawSymbolTable<17>(buffer);
+    case 18: return SkipRawSymbolTable<18>(buffer);
+    default: return false;
+  }
+}
+
+// Reads an entropy coded symbol stream, splitting its size into the rANS
+// probability table and the symbol data. Tagged streams interleave tables and
+// raw bits, so they are accounted as symbols only.
+bool MeasureSymbols(uint32_t num_values, int num_components,
+                    DecoderBuffer *buffer, UD_AttributeSizeReport *report) {
+  if (num_values == 0) {
+    return true;
+  }
+  const int64_t start = buffer->decoded_size();
+  std::vector<uint32_t> symbols(num_values);
+  DecoderBuffer symbols_buffer(*buffer);
+  if (!DecodeSymbols(num_values, num_components, &symbols_buffer,
+                     symbols.data())) {
+    return false;
+  }
+  const int64_t size = symbols_buffer.decoded_size() - start;
+
+  uint8_t scheme;
+  if (!buffer->Peek(&scheme)) {
+    return false;
+  }
+  int64_t table_size = 0;
+  if (scheme == SYMBOL_CODING_RAW) {
+    DecoderBuffer table_buffer(*buffer);
+    uint8_t max_bit_length;
+    table_buffer.Advance(1);
+    if (!table_buffer.Decode(&max_bit_length) ||
+        !SkipRawSymbolTable(max_bit_length, &table_buffer)) {
+      return false;
+    }
+    table_size = table_buffer.decoded_size() - start;
+  }
+  buffer->Advance(size);
+
+  ShannonEntropyTracker tracker;
+  tracker.Push(symbols.data(), static_cast<int>(symbols.size()));
+  report->entropy_table_bytes = table_size;
+  report->symbol_bytes = size - table_size;
+  report->num_symbols = num_values;
+  report->estimated_entropy_bytes =
+      (tracker.GetNumberOfDataBits() + tracker.GetNumberOfRAnsTableBits() +
+       7) /
+      8;
+  return true;
+}
+
+bool SkipTransformData(int transform, DecoderBuffer *buffer) {
+  int64_t size = 0;
+  switch (transform) {
+    case PREDICTION_TRANSFORM_NONE:
+    case PREDICTION_TRANSFORM_DELTA:
+      return true;
+    case PREDICTION_TRANSFORM_WRAP:
+    case PREDICTION_TRANSFORM_NORMAL_OCTAHEDRON_CANONICALIZED:
+      size = 2 * sizeof(int32_t);
+      break;
+    case PREDICTION_TRANSFORM_NORMAL_OCTAHEDRON:
+      size = sizeof(int32_t);
+      break;
+    default:
+      return false;
+  }
+  if (buffer->remaining_size() < size) {
+    return false;
+  }
+  buffer->Advance(size);
+  return true;
+}
+
+bool SkipRAnsBits(DecoderBuffer *buffer) {
+  RAnsBitDecoder decoder;
+  if (!decoder.StartDecoding(buffer)) {
+    return false;
+  }
+  decoder.EndDecoding();
+  return true;
+}
+
+// Advances |buffer| past the data written by EncodePredictionData() of the
+// given scheme (bitstream 2.2 layout).
+bool SkipPredictionData(int method, int transform, DecoderBuffer *buffer) {
+  switch (method) {
+    case PREDICTION_NONE:
+      return true;
+    case PREDICTION_DIFFERENCE:
+    case MESH_PREDICTION_PARALLELOGRAM:
+    case MESH_PREDICTION_MULTI_PARALLELOGRAM:
+      return SkipTransformData(transform, buffer);
+    case MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM:
+      for (int i = 0; i < constrained_multi_parallelogram::kMaxNumParallelograms;
+           ++i) {
+        uint32_t num_flags;
+        if (!DecodeVarint<uint32_t>(&num_flags, buffer)) {
+          return false;
+        }
+        if (num_flags > 0 && !SkipRAnsBits(buffer)) {
+          return false;
+        }
+      }
+      return SkipTransformData(transform, buffer);
+    case MESH_PREDICTION_TEX_COORDS_PORTABLE: {
+      int32_t num_orientations;
+      if (!buffer->Decode(&num_orientations) || num_orientations < 0 ||
+          !SkipRAnsBits(buffer)) {
+        return false;
+      }
+      return SkipTransformData(transform, buffer);
+    }
+    case MESH_PREDICTION_GEOMETRIC_NORMAL:
+      return SkipTransformData(transform, buffer) && SkipRAnsBits(buffer);
+    default:
+      return false;
+  }
+}
+
+// Walks the portable data of one attribute written by a sequential attribute
+// encoder: prediction header, values and prediction data.
+bool MeasurePortableAttribute(const PointAttribute &att, SequentialCoding coding,
+                              DecoderBuffer *buffer,
+                              UD_AttributeSizeReport *report) {
+  const uint32_t num_entries = static_cast<uint32_t>(att.size());
+  if (coding == CODING_GENERIC) {
+    const int64_t size = num_entries * att.byte_stride();
+    if (buffer->remaining_size() < size) {
+      return false;
+    }
+    buffer->Advance(size);
+    report->symbol_bytes = size;
+    return true;
+  }
+
+  const int64_t header_start = buffer->decoded_size();
+  int8_t method;
+  if (!buffer->Decode(&method)) {
+    return false;
+  }
+  report->prediction_scheme = method;
+  if (method != PREDICTION_NONE) {
+    int8_t transform;
+    if (!buffer->Decode(&transform)) {
+      return false;
+    }
+    report->prediction_transform = transform;
+  }
+  uint8_t compressed;
+  if (!buffer->Decode(&compressed)) {
+    return false;
+  }
+  const int num_components =
+      coding == CODING_NORMALS ? 2 : att.num_components();
+  const uint32_t num_values = num_entries * num_components;
+  if (compressed > 0) {
+    report->header_bytes = buffer->decoded_size() - header_start;
+    if (!MeasureSymbols(num_values, num_components, buffer, report)) {
+      return false;
+    }
+  } else {
+    uint8_t num_bytes;
+    if (!buffer->Decode(&num_bytes)) {
+      return false;
+    }
+    report->header_bytes = buffer->decoded_size() - header_start;
+    const int64_t size = static_cast<int64_t>(num_values) * num_bytes;
+    if (buffer->remaining_size() < size) {
+      return false;
+    }
+    buffer->Advance(size);
+    report->symbol_bytes = size;
+  }
+
+  const int64_t prediction_start = buffer->decoded_size();
+  if (!SkipPredictionData(method, report->prediction_transform, buffer)) {
+    return false;
+  }
+  report->prediction_data_bytes = buffer->decoded_size() - prediction_start;
+  return true;
+}
+
+int64_t GetTransformDataSize(const PointAttribute &att,
+                             SequentialCoding coding) {
+  switch (coding) {
+    case CODING_QUANTIZATION:
+      // Minimum values, range and quantization bits.
+      return att.num_components() * sizeof(float) + sizeof(float) + 1;
+    case CODING_NORMALS:
+      // Quantization bits.
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+// Splits the data of one sequential attributes decoder into its attributes.
+// Returns false when the walk does not end exactly at the end of the data.
+bool MeasureAttributesDecoder(const PointCloud &pc,
+                              const EncoderOptions &options,
+                              const PointCloud &decoded,
+                              const UD_AttributeDecoderStats &stats,
+                              DecoderBuffer *buffer,
+                              std::vector<UD_AttributeSizeReport> *reports) {
+  buffer->StartDecodingFrom(stats.offset);
+  std::vector<SequentialCoding> codings;
+  for (size_t i = 0; i < stats.attribute_ids.size(); ++i) {
+    const PointAttribute &att = *decoded.attribute(stats.attribute_ids[i]);
+    const int32_t att_id = pc.GetAttributeIdByUniqueId(att.unique_id());
+    if (att_id < 0) {
+      return false;
+    }
+    codings.push_back(GetSequentialCoding(*pc.attribute(att_id), options,
+                                          att_id));
+    if (!MeasurePortableAttribute(att, codings.back(), buffer,
+                                  &(*reports)[i])) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < stats.attribute_ids.size(); ++i) {
+    const PointAttribute &att = *decoded.attribute(stats.attribute_ids[i]);
+    (*reports)[i].transform_bytes = GetTransformDataSize(att, codings[i]);
+    buffer->Advance((*reports)[i].transform_bytes);
+  }
+  return buffer->decoded_size() == stats.offset + stats.bytes;
+}
+
+}  // namespace
+
+StatusOr<UD_EncodeReport> UD_BuildEncodeReport(const PointCloud &pc,
+                                               const EncoderOptions &options,
+                                               const EncoderBuffer &buffer) {
+  DecoderBuffer in_buffer;
+  in_buffer.Init(buffer.data(), buffer.size());
+  DecoderOptions decoder_options;
+  UD_DecodeStats stats;
+  auto statusor = UD_DecodeWithStats(&in_buffer, decoder_options, &stats);
+  if (!statusor.ok()) {
+    return statusor.status();
+  }
+  const std::unique_ptr<PointCloud> decoded = std::move(statusor).value();
+
+  UD_EncodeReport report;
+  report.total_bytes = static_cast<int64_t>(buffer.size());
+  int64_t offset = 0;
+  const auto add_section = [&report, &offset](const std::string &name,
+                                              int64_t size) {
+    UD_EncodeSection section;
+    section.name = name;
+    section.offset = offset;
+    section.size = size;
+    report.sections.push_back(section);
+    offset += size;
+  };
+  add_section("header", kDracoHeaderSize);
+  add_section("metadata", stats.header_bytes - kDracoHeaderSize);
+  add_section("encoder data", stats.initialize_bytes);
+  add_section("connectivity", stats.connectivity_bytes);
+  add_section("attribute setup", stats.attribute_setup_bytes);
+
+  // Point clouds encoded with the kd-tree encoder do not use the sequential
+  // attribute layout.
+  const bool sequential =
+      !(stats.geometry_type == POINT_CLOUD &&
+        stats.encoder_method == POINT_CLOUD_KD_TREE_ENCODING);
+  // Version bytes follow the "DRACO" string.
+  const uint8_t version_major = static_cast<uint8_t>(buffer.data()[5]);
+  const uint8_t version_minor = static_cast<uint8_t>(buffer.data()[6]);
+  DecoderBuffer attribute_buffer;
+  attribute_buffer.Init(buffer.data(), buffer.size(),
+                        DRACO_BITSTREAM_VERSION(version_major, version_minor));
+  for (size_t i = 0; i < stats.attribute_decoders.size(); ++i) {
+    const UD_AttributeDecoderStats &decoder_stats = stats.attribute_decoders[i];
+    add_section("attributes encoder " + std::to_string(i),
+                decoder_stats.bytes);
+
+    std::vector<UD_AttributeSizeReport> reports(
+        decoder_stats.attribute_ids.size());
+    for (size_t j = 0; j < reports.size(); ++j) {
+      const PointAttribute *const att =
+          decoded->attribute(decoder_stats.attribute_ids[j]);
+      reports[j].attribute_type = att->attribute_type();
+      reports[j].unique_id = att->unique_id();
+    }
+    bool resolved = sequential;
+    if (resolved) {
+      std::vector<UD_AttributeSizeReport> measured = reports;
+      resolved = MeasureAttributesDecoder(pc, options, *decoded, decoder_stats,
+                                          &attribute_buffer, &measured);
+      if (resolved) {
+        reports = measured;
+      }
+    }
+    if (!resolved && reports.size() == 1) {
+      // The total is still exact for a decoder with a single attribute.
+      reports[0].symbol_bytes = decoder_stats.bytes;
+    }
+    for (UD_AttributeSizeReport &att_report : reports) {
+      att_report.resolved = resolved;
+      report.attributes.push_back(att_report);
+    }
+  }
+  return report;
+}
+
+std::string UD_EncodeReport::ToString() const {
+  std::string text;
+  char line[256];
+  snprintf(line, sizeof(line), "Encoded size: %" PRId64 " bytes\n",
+           total_bytes);
+  text += line;
+  for (const UD_EncodeSection &section : sections) {
+    snprintf(line, sizeof(line),
+             "  %-22s offset %10" PRId64 "  size %10" PRId64 " (%5.1f%%)\n",
+             section.name.c_str(), section.offset, section.size,
+             total_bytes > 0 ? 100.0 * section.size / total_bytes : 0.0);
+    text += line;
+  }
+  for (const UD_AttributeSizeReport &att : attributes) {
+    snprintf(line, sizeof(line),
+             "  %s (unique id %d):\n",
+             GeometryAttribute::TypeToString(att.attribute_type).c_str(),
+             att.unique_id);
+    text += line;
+    if (!att.resolved) {
+      // Attributes sharing an unresolved encoder are only known in total,
+      // see the matching section above.
+      if (att.TotalBytes() > 0) {
+        snprintf(line, sizeof(line),
+                 "    layout not available, %" PRId64 " bytes\n",
+                 att.TotalBytes());
+      } else {
+        snprintf(line, sizeof(line), "    layout not available\n");
+      }
+      text += line;
+      continue;
+    }
+    snprintf(line, sizeof(line),
+             "    prediction %d transform %d: header %" PRId64
+             ", entropy tables %" PRId64 ", symbols %" PRId64
+             ", prediction data %" PRId64 ", transform %" PRId64 "\n",
+             att.prediction_scheme, att.prediction_transform, att.header_bytes,
+             att.entropy_table_bytes, att.symbol_bytes,
+             att.prediction_data_bytes, att.transform_bytes);
+    text += line;
+    if (att.num_symbols > 0) {
+      snprintf(line, sizeof(line),
+               "    %" PRId64 " symbols, Shannon estimate %" PRId64
+               " bytes vs %" PRId64 " actual\n",
+               att.num_symbols, att.estimated_entropy_bytes,
+               att.entropy_table_bytes + att.symbol_bytes);
+      text += line;
+    }
+  }
+  return text;
+}
+
+}  // namespace draco
@@ -0,0 +1,378 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "EncoderTuner.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include "draco/compression/decode.h"
+
+namespace draco {
+
+namespace {
+
+// Applies |prediction| to every attribute of |type| in |pc|.
+Status SetPredictionScheme(const PointCloud &pc, GeometryAttribute::Type type,
+                           int prediction, ExpertEncoder *encoder) {
+  if (prediction == PREDICTION_UNDEFINED) {
+    return OkStatus();
+  }
+  for (int i = 0; i < pc.NumNamedAttributes(type); ++i) {
+    DRACO_RETURN_IF_ERROR(encoder->SetAttributePredictionScheme(
+        pc.GetNamedAttributeId(type, i), prediction));
+  }
+  return OkStatus();
+}
+
+// UD_PARALLELOGRAM_SEARCH_SAMPLED encodes 1 / kSampleFraction of the faces,
+// at most kMaxSampleFaces, split into runs of consecutive faces spread over
+// the mesh so that the sample keeps the local connectivity the parallelogram
+// predictors depend on. Below kMinSampledMeshFaces the sample would be too
+// small to choose from and the constrained prediction is kept, as Draco does.
+constexpr uint32_t kSampleFraction = 16;
+constexpr uint32_t kMaxSampleFaces = 16384;
+constexpr uint32_t kMinSampledMeshFaces = 32768;
+constexpr int kNumSampleSegments = 8;
+
+// Position predictions compared by UD_PARALLELOGRAM_SEARCH_SAMPLED, the
+// faster one first.
+constexpr int kNumSearchCandidates = 2;
+constexpr int kSearchCandidates[kNumSearchCandidates] = {
+    MESH_PREDICTION_PARALLELOGRAM,
+    MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM};
+
+// Copies faces [first, last) of |mesh| and the attribute values of their
+// points, keeping the attribute ids.
+std::unique_ptr<Mesh> ExtractFaces(const Mesh &mesh, uint32_t first,
+                                   uint32_t last) {
+  std::unique_ptr<Mesh> sample(new Mesh());
+  std::unordered_map<uint32_t, PointIndex> point_map;
+  std::vector<PointIndex> sample_points;
+  for (uint32_t f = first; f < last; ++f) {
+    Mesh::Face face = mesh.face(FaceIndex(f));
+    for (int c = 0; c < 3; ++c) {
+      const auto it = point_map.emplace(
+          face[c].value(),
+          PointIndex(static_cast<uint32_t>(sample_points.size())));
+      if (it.second) {
+        sample_points.push_back(face[c]);
+      }
+      face[c] = it.first->second;
+    }
+    sample->AddFace(face);
+  }
+  const uint32_t num_points = static_cast<uint32_t>(sample_points.size());
+  sample->set_num_points(num_points);
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const src = mesh.attribute(i);
+    GeometryAttribute att;
+    att.Init(src->attribute_type(), nullptr, src->num_components(),
+             src->data_type(), src->normalized(), src->byte_stride(), 0);
+    PointAttribute *const dst =
+        sample->attribute(sample->AddAttribute(att, true, num_points));
+    for (uint32_t p = 0; p < num_points; ++p) {
+      dst->SetAttributeValue(
+          AttributeValueIndex(p),
+          src->GetAddress(src->mapped_index(sample_points[p])));
+    }
+  }
+  return sample;
+}
+
+Status EncodeWithPositionPrediction(const Mesh &mesh,
+                                    const EncoderOptions &options,
+                                    int position_id, int prediction,
+                                    EncoderBuffer *out_buffer) {
+  ExpertEncoder encoder(mesh);
+  encoder.Reset(options);
+  DRACO_RETURN_IF_ERROR(
+      encoder.SetAttributePredictionScheme(position_id, prediction));
+  return encoder.EncodeToBuffer(out_buffer);
+}
+
+// Returns the candidate whose encodes of the sample segments of |mesh| are
+// the smallest in total. The segments are independent meshes, so all of them
+// are encoded in parallel.
+int SelectCandidateOnSample(const Mesh &mesh, int position_id,
+                            const EncoderOptions &options) {
+  const uint32_t num_faces = mesh.num_faces();
+  const uint32_t segment_faces =
+      std::min(num_faces / kSampleFraction, kMaxSampleFaces) /
+      kNumSampleSegments;
+  std::unique_ptr<Mesh> segments[kNumSampleSegments];
+  ParallelFor(kNumSampleSegments, [&](int32 segment) {
+    const uint32_t first = static_cast<uint32_t>(
+        static_cast<uint64_t>(num_faces) * segment / kNumSampleSegments);
+    segments[segment] = ExtractFaces(mesh, first, first + segment_faces);
+  });
+  size_t sizes[kNumSearchCandidates][kNumSampleSegments];
+  ParallelFor(kNumSearchCandidates * kNumSampleSegments, [&](int32 task) {
+    const int candidate = task % kNumSearchCandidates;
+    const int segment = task / kNumSearchCandidates;
+    EncoderBuffer buffer;
+    sizes[candidate][segment] =
+        EncodeWithPositionPrediction(*segments[segment], options, position_id,
+                                     kSearchCandidates[candidate], &buffer)
+                .ok()
+            ? buffer.size()
+            : std::numeric_limits<size_t>::max() / kNumSampleSegments;
+  });
+  int best = 0;
+  size_t best_size = std::numeric_limits<size_t>::max();
+  for (int candidate = 0; candidate < kNumSearchCandidates; ++candidate) {
+    size_t size = 0;
+    for (int segment = 0; segment < kNumSampleSegments; ++segment) {
+      size += sizes[candidate][segment];
+    }
+    // Ties go to the faster single parallelogram.
+    if (size < best_size) {
+      best = candidate;
+      best_size = size;
+    }
+  }
+  return kSearchCandidates[best];
+}
+
+}  // namespace
+
+UD_ParallelogramSearch UD_GetParallelogramSearch(
+    const EncoderOptions &options) {
+  return static_cast<UD_ParallelogramSearch>(options.GetGlobalInt(
+      "ud_parallelogram_search", UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE));
+}
+
+EncoderOptions UD_CreateExpertEncoderOptions(const Encoder &encoder,
+                                             const PointCloud &pc) {
+  EncoderOptions options = EncoderOptions::CreateEmptyOptions();
+  options.SetGlobalOptions(encoder.options().GetGlobalOptions());
+  options.SetFeatureOptions(encoder.options().GetFeaturelOptions());
+  for (int i = 0; i < pc.num_attributes(); ++i) {
+    const Options *const att_options = encoder.options().FindAttributeOptions(
+        pc.attribute(i)->attribute_type());
+    if (att_options != nullptr) {
+      options.SetAttributeOptions(i, *att_options);
+    }
+  }
+  return options;
+}
+
+Status UD_EncodeMeshWithParallelogramSearch(const Mesh &mesh,
+                                            EncoderOptions *options,
+                                            EncoderBuffer *out_buffer) {
+  const UD_ParallelogramSearch search = UD_GetParallelogramSearch(*options);
+  const int position_id =
+      mesh.GetNamedAttributeId(GeometryAttribute::POSITION);
+  // Draco only uses constrained multi-parallelogram prediction below speed 2
+  // and on meshes with at least 40 points.
+  if (search != UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE && position_id >= 0 &&
+      options->GetSpeed() < 2 && mesh.num_points() >= 40 &&
+      mesh.num_faces() > 0 &&
+      !options->IsAttributeOptionSet(position_id, "prediction_scheme")) {
+    if (search == UD_PARALLELOGRAM_SEARCH_SINGLE) {
+      options->SetAttributeInt(position_id, "prediction_scheme",
+                               MESH_PREDICTION_PARALLELOGRAM);
+    } else if (mesh.num_faces() < kMinSampledMeshFaces) {
+      options->SetAttributeInt(
+          position_id, "prediction_scheme",
+          MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM);
+    } else {
+      options->SetAttributeInt(
+          position_id, "prediction_scheme",
+          SelectCandidateOnSample(mesh, position_id, *options));
+    }
+  }
+  ExpertEncoder encoder(mesh);
+  encoder.Reset(*options);
+  return encoder.EncodeToBuffer(out_buffer);
+}
+
+Status UD_EncoderConfig::Apply(const PointCloud &pc,
+                               ExpertEncoder *encoder) const {
+  encoder->SetSpeedOptions(speed, speed);
+  if (encoding_method >= 0) {
+    encoder->SetEncodingMethod(encoding_method);
+  }
+  if (encoding_submethod >= 0) {
+    encoder->SetEncodingSubmethod(encoding_submethod);
+  }
+  DRACO_RETURN_IF_ERROR(SetPredictionScheme(pc, GeometryAttribute::POSITION,
+                                            position_prediction, encoder));
+  DRACO_RETURN_IF_ERROR(SetPredictionScheme(pc, GeometryAttribute::TEX_COORD,
+                                            tex_coord_prediction, encoder));
+  DRACO_RETURN_IF_ERROR(SetPredictionScheme(pc, GeometryAttribute::NORMAL,
+                                            normal_prediction, encoder));
+  return OkStatus();
+}
+
+UD_EncoderTuner::UD_EncoderTuner(
+    const PointCloud &pc, const Mesh *mesh,
+    const std::array<int, GeometryAttribute::NAMED_ATTRIBUTES_COUNT>
+        &quantization_bits)
+    : pc_(pc),
+      mesh_(mesh),
+      quantization_bits_(quantization_bits),
+      decode_repetitions_(3) {}
+
+StatusOr<UD_EncoderTrial> UD_EncoderTuner::Tune(double max_decode_ms) {
+  const std::vector<UD_EncoderConfig> candidates = GenerateCandidates();
+  trials_.assign(candidates.size(), UD_EncoderTrial());
+  std::vector<EncoderBuffer> buffers(candidates.size());
+
+  // Encoding is independent per candidate and runs in parallel. Decodes are
+  // timed one after another so that they do not compete for cores.
+  ParallelFor(static_cast<int32>(candidates.size()), [&](int32 i) {
+    trials_[i].config = candidates[i];
+    trials_[i].ok = Encode(candidates[i], &buffers[i]).ok();
+    trials_[i].encoded_size = buffers[i].size();
+  });
+  for (size_t i = 0; i < trials_.size(); ++i) {
+    if (trials_[i].ok) {
+      trials_[i].decode_ms = MeasureDecodeTime(buffers[i]);
+      trials_[i].ok = trials_[i].decode_ms >= 0.0;
+    }
+  }
+  MarkParetoOptimal();
+
+  const UD_EncoderTrial *best = nullptr;
+  const UD_EncoderTrial *fastest = nullptr;
+  for (const UD_EncoderTrial &trial : trials_) {
+    if (!trial.ok) {
+      continue;
+    }
+    if (fastest == nullptr || trial.decode_ms < fastest->decode_ms) {
+      fastest = &trial;
+    }
+    if (max_decode_ms > 0.0 && trial.decode_ms > max_decode_ms) {
+      continue;
+    }
+    if (best == nullptr || trial.encoded_size < best->encoded_size ||
+        (trial.encoded_size == best->encoded_size &&
+         trial.decode_ms < best->decode_ms)) {
+      best = &trial;
+    }
+  }
+  if (best == nullptr) {
+    best = fastest;
+  }
+  if (best == nullptr) {
+    return Status(Status::DRACO_ERROR, "No candidate configuration encoded.");
+  }
+  return *best;
+}
+
+std::vector<UD_EncoderConfig> UD_EncoderTuner::GenerateCandidates() const {
+  std::vector<UD_EncoderConfig> candidates;
+  if (mesh_ == nullptr || mesh_->num_faces() == 0) {
+    for (int method = POINT_CLOUD_SEQUENTIAL_ENCODING;
+         method <= POINT_CLOUD_KD_TREE_ENCODING; ++method) {
+      for (int speed : {0, 5, 10}) {
+        UD_EncoderConfig config;
+        config.encoding_method = method;
+        config.speed = speed;
+        candidates.push_back(config);
+      }
+    }
+    return candidates;
+  }
+
+  UD_EncoderConfig sequential;
+  sequential.encoding_method = MESH_SEQUENTIAL_ENCODING;
+  sequential.speed = 10;
+  candidates.push_back(sequential);
+
+  // Only explore prediction schemes for attributes that are present.
+  std::vector<int> tex_coord_predictions = {PREDICTION_UNDEFINED};
+  if (pc_.NumNamedAttributes(GeometryAttribute::TEX_COORD) > 0) {
+    tex_coord_predictions = {MESH_PREDICTION_TEX_COORDS_PORTABLE,
+                             PREDICTION_DIFFERENCE};
+  }
+  std::vector<int> normal_predictions = {PREDICTION_UNDEFINED};
+  if (pc_.NumNamedAttributes(GeometryAttribute::NORMAL) > 0) {
+    normal_predictions = {MESH_PREDICTION_GEOMETRIC_NORMAL,
+                          PREDICTION_DIFFERENCE};
+  }
+  for (int submethod : {MESH_EDGEBREAKER_STANDARD_ENCODING,
+                        MESH_EDGEBREAKER_VALENCE_ENCODING}) {
+    for (int position :
+         {MESH_PREDICTION_PARALLELOGRAM,
+          MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM,
+          PREDICTION_DIFFERENCE}) {
+      for (int tex_coord : tex_coord_predictions) {
+        for (int normal : normal_predictions) {
+          UD_EncoderConfig config;
+          config.encoding_method = MESH_EDGEBREAKER_ENCODING;
+          config.encoding_submethod = submethod;
+          config.speed = submethod == MESH_EDGEBREAKER_VALENCE_ENCODING ? 0 : 5;
+          config.position_prediction = position;
+          config.tex_coord_prediction = tex_coord;
+          config.normal_prediction = normal;
+          candidates.push_back(config);
+        }
+      }
+    }
+  }
+  return candidates;
+}
+
+Status UD_EncoderTuner::Encode(const UD_EncoderConfig &config,
+                               EncoderBuffer *buffer) const {
+  std::unique_ptr<ExpertEncoder> encoder(
+      mesh_ && mesh_->num_faces() > 0 ? new ExpertEncoder(*mesh_)
+                                      : new ExpertEncoder(pc_));
+  for (int i = 0; i < pc_.num_attributes(); ++i) {
+    const GeometryAttribute::Type type = pc_.attribute(i)->attribute_type();
+    if (type >= 0 && type < GeometryAttribute::NAMED_ATTRIBUTES_COUNT &&
+        quantization_bits_[type] > 0) {
+      encoder->SetAttributeQuantization(i, quantization_bits_[type]);
+    }
+  }
+  DRACO_RETURN_IF_ERROR(config.Apply(pc_, encoder.get()));
+  return encoder->EncodeToBuffer(buffer);
+}
+
+double UD_EncoderTuner::MeasureDecodeTime(const EncoderBuffer &buffer) const {
+  double best_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(decode_repetitions_, 1); ++i) {
+    DecoderBuffer decoder_buffer;
+    decoder_buffer.Init(buffer.data(), buffer.size());
+    Decoder decoder;
+    const double start = FPlatformTime::Seconds();
+    const bool ok =
+        mesh_ && mesh_->num_faces() > 0
+            ? decoder.DecodeMeshFromBuffer(&decoder_buffer).ok()
+            : decoder.DecodePointCloudFromBuffer(&decoder_buffer).ok();
+    const double elapsed_ms = (FPlatformTime::Seconds() - start) * 1000.0;
+    if (!ok) {
+      return -1.0;
+    }
+    best_ms = std::min(best_ms, elapsed_ms);
+  }
+  return best_ms;
+}
+
+void UD_EncoderTuner::MarkParetoOptimal() {
+  for (UD_EncoderTrial &trial : trials_) {
+    if (!trial.ok) {
+      continue;
+    }
+    trial.pareto_optimal = true;
+    for (const UD_EncoderTrial &other : trials_) {
+      if (!other.ok || &other == &trial) {
+        continue;
+      }
+      if (other.encoded_size <= trial.encoded_size &&
+          other.decode_ms <= trial.decode_ms &&
+          (other.encoded_size < trial.encoded_size ||
+           other.decode_ms < trial.decode_ms)) {
+        trial.pareto_optimal = false;
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace draco
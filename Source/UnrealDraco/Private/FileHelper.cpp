@@ -19,6 +19,8 @@
 #include "draco/core/cycle_timer.h"
 #include "draco/io/file_utils.h"
 #include "draco/io/file_writer_factory.h"
+#include "EncoderTuner.h"
+#include "GlbWriter.h"
 
 DEFINE_LOG_CATEGORY(UDLog)
 
@@ -110,20 +112,35 @@ size_t UD_FileReader::GetFileSize() {
 
 
 
+// Writes an encoded geometry to |file|, wrapped in a GLB container when the
+// file name ends in .glb.
+static bool WriteEncodedBufferToFile(const draco::EncoderBuffer& buffer, const std::string& file) {
+	if (draco::LowercaseFileExtension(file) == "glb") {
+		const draco::Status status = draco::UD_GlbWriter().WriteToFile(buffer.data(), buffer.size(), file);
+		if (!status.ok()) {
+			UDWARNING1("Failed to write the GLB file.\n %s", UTF8_TO_TCHAR(status.error_msg()));
+			return false;
+		}
+		return true;
+	}
+	return draco::WriteBufferToFile(buffer.data(), buffer.size(), file);
+}
+
 int EncodeMeshToFile(const draco::Mesh& mesh, const std::string& file,
 	draco::Encoder* encoder) {
 	draco::CycleTimer timer;
 	// Encode the geometry.
 	draco::EncoderBuffer buffer;
 	timer.Start();
-	const draco::Status status = encoder->EncodeMeshToBuffer(mesh, &buffer);
+	draco::EncoderOptions options = draco::UD_CreateExpertEncoderOptions(*encoder, mesh);
+	const draco::Status status = draco::UD_EncodeMeshWithParallelogramSearch(mesh, &options, &buffer);
 	if (!status.ok()) {
-		UDWARNING1("Failed to encode the mesh.\n %s", status.error_msg());
+		UDWARNING1("Failed to encode the mesh.\n %s", UTF8_TO_TCHAR(status.error_msg()));
 		return -1;
 	}
 	timer.Stop();
 	// Save the encoded geometry into a file.
-	if (!draco::WriteBufferToFile(buffer.data(), buffer.size(), file)) {
+	if (!WriteEncodedBufferToFile(buffer, file)) {
 		UDWARNING("Failed to create the output file.\n");
 		return -1;
 	}
@@ -139,13 +156,13 @@ int EncodePointCloudToFile(const draco::PointCloud& pc, const std::string& file,
 	timer.Start();
 	const draco::Status status = encoder->EncodePointCloudToBuffer(pc, &buffer);
 	if (!status.ok()) {
-		UDWARNING1("Failed to encode the point cloud.\n %s", status.error_msg());
+		UDWARNING1("Failed to encode the point cloud.\n %s", UTF8_TO_TCHAR(status.error_msg()));
 
 		return -1;
 	}
 	timer.Stop();
 	// Save the encoded geometry into a file.
-	if (!draco::WriteBufferToFile(buffer.data(), buffer.size(), file)) {
+	if (!WriteEncodedBufferToFile(buffer, file)) {
 		UDWARNING("Failed to write the output file.\n");
 		return -1;
 	}
@@ -153,6 +170,27 @@ int EncodePointCloudToFile(const draco::PointCloud& pc, const std::string& file,
 	return 0;
 }
 
+int EncodeWithExpertEncoderToFile(draco::ExpertEncoder* encoder,
+	const std::string& file) {
+	draco::CycleTimer timer;
+	// Encode the geometry.
+	draco::EncoderBuffer buffer;
+	timer.Start();
+	const draco::Status status = encoder->EncodeToBuffer(&buffer);
+	if (!status.ok()) {
+		UDWARNING1("Failed to encode the geometry.\n %s", UTF8_TO_TCHAR(status.error_msg()));
+		return -1;
+	}
+	timer.Stop();
+	// Save the encoded geometry into a file.
+	if (!WriteEncodedBufferToFile(buffer, file)) {
+		UDWARNING("Failed to write the output file.\n");
+		return -1;
+	}
+	UE_LOG(UDLog, Log, TEXT("Encoded geometry saved to %s (%" PRId64 " ms to encode).\n\nEncoded size = %zu bytes\n\n"), file.c_str(), timer.GetInMs(), buffer.size());
+	return 0;
+}
+
 void SplitPathPrivate(const std::string& full_path,
 	std::string* out_folder_path,
 	std::string* out_file_name) {
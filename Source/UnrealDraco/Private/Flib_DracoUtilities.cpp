@@ -4,9 +4,27 @@
 
 #include "Flib_DracoUtilities.h"
 
+#include <array>
 #include <iostream>
+#include <limits>
 
 #include "FileHelper.h"
+#include "DecodeCache.h"
+#include "EncodeCache.h"
+#include "QuantizationTuner.h"
+#include "EncoderTuner.h"
+#include "EncodeReport.h"
+#include "MeshReader.h"
+#include "GlbReader.h"
+#include "GlbWriter.h"
+#include "BinaryMesh.h"
+#include "ObjWriter.h"
+#include "PlyWriter.h"
+#include "MeshArchive.h"
+#include "ParallelDeduplication.h"
+#include "ParallelMeshCleanup.h"
+#include "ParallelMeshStripifier.h"
+#include "VertexCacheOptimizer.h"
 
 #if defined(ERROR)
 #define DRACO_MACRO_TEMP_ERROR      ERROR
@@ -18,6 +36,7 @@
 #include "draco/io/mesh_io.h"
 #include "draco/core/options.h"
 #include "draco/io/file_reader_factory.h"
+#include "draco/io/file_utils.h"
 #include "draco/point_cloud/point_cloud.h"
 #include "draco/io/point_cloud_io.h"
 #include "draco/compression/encode.h"
@@ -25,8 +44,6 @@
 #include "draco/io/file_utils.h"
 #include "draco/io/file_utils.h"
 #include "draco/io/parser_utils.h"
-#include "draco/io/obj_encoder.h"
-#include "draco/io/ply_encoder.h"
 
 #if defined(DRACO_MACRO_TEMP_ERROR)
 #define ERROR           DRACO_MACRO_TEMP_ERROR
@@ -38,71 +55,101 @@
  
 
 
-bool UFlib_DracoUtilities::Encoder(const FString& inFileName, const FString& outFileName, FOptions options)
+// Returns the bits needed by the most demanding attribute of |type|, or
+// |current_bits| when the attribute is absent or skipped.
+static int TuneQuantizationBits(const draco::PointCloud& pc, const draco::UD_QuantizationTuner& tuner,
+	draco::GeometryAttribute::Type type, float tolerance, int current_bits)
+{
+	if (current_bits <= 0 || pc.NumNamedAttributes(type) == 0)
+	{
+		return current_bits;
+	}
+	int bits = -1;
+	for (int i = 0; i < pc.NumNamedAttributes(type); ++i)
+	{
+		bits = FMath::Max(bits, tuner.FindMinimalBits(*pc.GetNamedAttribute(type, i), tolerance));
+	}
+	return bits > 0 ? bits : current_bits;
+}
+
+static void AutoTuneQuantization(const draco::PointCloud& pc, FOptions* options)
 {
+	const draco::UD_QuantizationTuner tuner(options->error_metric == EQuantizationErrorMetric::RMS
+		? draco::UD_RMS_ERROR
+		: draco::UD_MAX_ERROR);
+	options->pos_quantization_bits = TuneQuantizationBits(pc, tuner, draco::GeometryAttribute::POSITION,
+		options->pos_tolerance, options->pos_quantization_bits);
+	options->tex_coords_quantization_bits = TuneQuantizationBits(pc, tuner, draco::GeometryAttribute::TEX_COORD,
+		options->tex_coords_tolerance, options->tex_coords_quantization_bits);
+	options->normals_quantization_bits = TuneQuantizationBits(pc, tuner, draco::GeometryAttribute::NORMAL,
+		options->normals_tolerance_degrees, options->normals_quantization_bits);
+	UE_LOG(UDLog, Log, TEXT("Auto-tuned quantization bits: position %d, tex coords %d, normals %d.\n"),
+		options->pos_quantization_bits, options->tex_coords_quantization_bits, options->normals_quantization_bits);
+}
+
+// Loads |inFile| and prepares it for encoding with |options|: skipped
+// attributes are removed and quantization is auto-tuned when requested.
+// |inData| holds the contents of |inFile| when the caller already read them,
+// otherwise nullptr. Returns nullptr on failure.
+static std::unique_ptr<draco::PointCloud> LoadEncoderInput(const std::string& inFile, const std::vector<char>* inData, FOptions& options, draco::Mesh** outMesh)
+{
+	std::unique_ptr<draco::PointCloud> pc;
+	*outMesh = nullptr;
 	if (options.pos_quantization_bits > 30)
 	{
 		UDWARNING("error: The maximum number of quantization bits for the position attribute is 30.\n");
-		return false;
+		return nullptr;
 	}
 	if (options.tex_coords_quantization_bits > 30)
 	{
 		UDWARNING("error: The maximum number of quantization bits for the texture coordinate attribute is 30.\n");
-		return false;
+		return nullptr;
 	}
 	if (options.normals_quantization_bits > 30)
 	{
 		UDWARNING("error: The maximum number of quantization bits for the normal attribute is 30.\n");
-		return false;
+		return nullptr;
 	}
 	if (options.generic_quantization_bits > 30)
 	{
 		UDWARNING("error: The maximum number of quantization bits for generic attribute is 30.\n");
-		return false;
+		return nullptr;
 	}
-	if (inFileName.IsEmpty() || outFileName.IsEmpty())
-	{
-		UDWARNING("Error: inFileName or outFileName is invalid.\n");
-		return false;
-	}
-	std::unique_ptr<draco::PointCloud> pc;
-	draco::Mesh *mesh = nullptr;
-	std::string inFile(TCHAR_TO_UTF8(*inFileName));
-	std::string outFile(TCHAR_TO_UTF8(*outFileName));
-	
 	if (!options.is_point_cloud)
 	{
-		draco::Options opt;
-
-		auto maybe_mesh = draco::ReadMeshFromFile(inFile, opt, nullptr);
+		auto maybe_mesh = inData
+			? draco::UD_ReadMeshFromBuffer(inFile, inData->data(), inData->size())
+			: draco::UD_ReadMeshFromFile(inFile);
 
 		if (!maybe_mesh.ok())
 		{
 			UDWARNING("Failed loading the input mesh\n");
-			return false;
+			return nullptr;
 		}
-		mesh = maybe_mesh.value().get();
+		*outMesh = maybe_mesh.value().get();
 		pc = std::move(maybe_mesh).value();
 	}
 	else
 	{
-		auto maybe_pc = draco::ReadPointCloudFromFile(inFile);
+		auto maybe_pc = inData
+			? draco::UD_ReadPointCloudFromBuffer(inFile, inData->data(), inData->size())
+			: draco::UD_ReadPointCloudFromFile(inFile);
 		if (!maybe_pc.ok())
 		{
 			UDWARNING("Failed loading the input point cloud\n");
-			return false;
+			return nullptr;
 		}
 		pc = std::move(maybe_pc).value();
 	}
 	if (options.pos_quantization_bits < 0)
 	{
 		UDWARNING("Error: Position attribute cannot be skipped.\n");
-		return false;
+		return nullptr;
 	}
 	if (options.pos_quantization_bits < 0)
 	{
 		UDWARNING("Error: Position attribute cannot be skipped.\n");
-		return false;
+		return nullptr;
 	}
 	if (options.tex_coords_quantization_bits < 0) {
 		if (pc->NumNamedAttributes(draco::GeometryAttribute::TEX_COORD) > 0) {
@@ -134,9 +181,114 @@ bool UFlib_DracoUtilities::Encoder(const FString& inFileName, const FString& out
 #ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
 	if (options.tex_coords_deleted || options.normals_deleted ||
 		options.generic_deleted) {
-		pc->DeduplicatePointIds();
+		draco::UD_DeduplicatePointIds(pc.get(), *outMesh);
 	}
 #endif
+	if (options.cleanup_mesh && *outMesh != nullptr)
+	{
+		if (!draco::UD_CleanupMesh(*outMesh, draco::MeshCleanupOptions()))
+		{
+			UDWARNING("Failed cleaning up the input mesh\n");
+			return nullptr;
+		}
+	}
+	if (options.auto_tune_quantization)
+	{
+		AutoTuneQuantization(*pc, &options);
+	}
+	return pc;
+}
+
+static std::array<int, draco::GeometryAttribute::NAMED_ATTRIBUTES_COUNT> GetQuantizationBits(const FOptions& options)
+{
+	std::array<int, draco::GeometryAttribute::NAMED_ATTRIBUTES_COUNT> bits;
+	bits.fill(0);
+	bits[draco::GeometryAttribute::POSITION] = options.pos_quantization_bits;
+	bits[draco::GeometryAttribute::TEX_COORD] = options.tex_coords_quantization_bits;
+	bits[draco::GeometryAttribute::NORMAL] = options.normals_quantization_bits;
+	bits[draco::GeometryAttribute::GENERIC] = options.generic_quantization_bits;
+	return bits;
+}
+
+static draco::UD_EncoderConfig ToEncoderConfig(const FEncoderConfig& config)
+{
+	draco::UD_EncoderConfig out;
+	out.encoding_method = config.encoding_method;
+	out.encoding_submethod = config.encoding_submethod;
+	out.speed = config.speed;
+	out.position_prediction = config.position_prediction_scheme;
+	out.tex_coord_prediction = config.tex_coords_prediction_scheme;
+	out.normal_prediction = config.normals_prediction_scheme;
+	return out;
+}
+
+static FEncoderConfig FromEncoderConfig(const draco::UD_EncoderConfig& config)
+{
+	FEncoderConfig out;
+	out.valid = true;
+	out.encoding_method = config.encoding_method;
+	out.encoding_submethod = config.encoding_submethod;
+	out.speed = config.speed;
+	out.position_prediction_scheme = config.position_prediction;
+	out.tex_coords_prediction_scheme = config.tex_coord_prediction;
+	out.normals_prediction_scheme = config.normal_prediction;
+	return out;
+}
+
+// Creates an expert encoder with the quantization of |options| and either its encoder
+// configuration or the speed derived from the compression level.
+static std::unique_ptr<draco::ExpertEncoder> CreateExpertEncoder(const draco::PointCloud& pc, const draco::Mesh* mesh, const FOptions& options)
+{
+	std::unique_ptr<draco::ExpertEncoder> expert_encoder(mesh && mesh->num_faces() > 0
+		? new draco::ExpertEncoder(*mesh)
+		: new draco::ExpertEncoder(pc));
+	const std::array<int, draco::GeometryAttribute::NAMED_ATTRIBUTES_COUNT> bits = GetQuantizationBits(options);
+	for (int i = 0; i < pc.num_attributes(); ++i)
+	{
+		const draco::GeometryAttribute::Type type = pc.attribute(i)->attribute_type();
+		if (type >= 0 && type < draco::GeometryAttribute::NAMED_ATTRIBUTES_COUNT && bits[type] > 0)
+		{
+			expert_encoder->SetAttributeQuantization(i, bits[type]);
+		}
+	}
+	if (!options.encoder_config.valid)
+	{
+		const int speed = 10 - options.compression_level;
+		expert_encoder->SetSpeedOptions(speed, speed);
+		draco::UD_SetParallelogramSearch(static_cast<draco::UD_ParallelogramSearch>(options.parallelogram_search), &expert_encoder->options());
+		return expert_encoder;
+	}
+	const draco::Status status = ToEncoderConfig(options.encoder_config).Apply(pc, expert_encoder.get());
+	if (!status.ok())
+	{
+		UDWARNING1("Invalid encoder configuration.\n %s", UTF8_TO_TCHAR(status.error_msg()));
+		return nullptr;
+	}
+	return expert_encoder;
+}
+
+// Encodes the geometry returned by LoadEncoderInput() to |outFile|. The
+// Draco encoder is only configured when no encoder configuration replaces it.
+static bool EncodeGeometryToFile(const draco::PointCloud& pc, const draco::Mesh* mesh, const std::string& outFile, const FOptions& options)
+{
+	const bool input_is_mesh = mesh && mesh->num_faces() > 0;
+	// GLB holds a single Draco compressed triangle mesh, so point clouds are
+	// rejected before spending time on an encode that cannot be written.
+	if (draco::LowercaseFileExtension(outFile) == "glb" && !input_is_mesh)
+	{
+		UDWARNING1("GLB output requires a triangle mesh, %s cannot hold a point cloud. Use .drc instead.\n", UTF8_TO_TCHAR(outFile.c_str()));
+		return false;
+	}
+	if (options.encoder_config.valid)
+	{
+		// A configuration found by TuneEncoder replaces the speed heuristics.
+		std::unique_ptr<draco::ExpertEncoder> expert_encoder = CreateExpertEncoder(pc, mesh, options);
+		if (!expert_encoder)
+		{
+			return false;
+		}
+		return draco::EncodeWithExpertEncoderToFile(expert_encoder.get(), outFile) != -1;
+	}
 	const int speed = 10 - options.compression_level;
 
 
@@ -158,133 +310,469 @@ bool UFlib_DracoUtilities::Encoder(const FString& inFileName, const FString& out
 			options.generic_quantization_bits);
 	}
 	encoder.SetSpeedOptions(speed, speed);
+	draco::UD_SetParallelogramSearch(static_cast<draco::UD_ParallelogramSearch>(options.parallelogram_search), &encoder.options());
 
 	int ret = -1;
-	const bool input_is_mesh = mesh && mesh->num_faces() > 0;
 	if (input_is_mesh)
 	{
 		ret = draco::EncodeMeshToFile(*mesh, outFile, &encoder);
 	}
 	else
 	{
-		ret = draco::EncodePointCloudToFile(*pc.get(), outFile, &encoder);
+		ret = draco::EncodePointCloudToFile(pc, outFile, &encoder);
 	}
 
 	if (ret != -1 && options.compression_level < 10)
 	{
 		UDWARNING("For better compression, increase the compression level up to '-cl 10");
 	}
-	return true;
+	return ret != -1;
 }
 
-bool UFlib_DracoUtilities::Decoder(const FString& inFileName, const FString& outFileName)
+bool UFlib_DracoUtilities::Encoder(const FString& inFileName, const FString& outFileName, FOptions options)
 {
 	if (inFileName.IsEmpty() || outFileName.IsEmpty())
 	{
-		UDWARNING("Decoder : invalid file name.\n");
+		UDWARNING("Error: inFileName or outFileName is invalid.\n");
 		return false;
 	}
+	draco::Mesh *mesh = nullptr;
 	std::string inFile(TCHAR_TO_UTF8(*inFileName));
 	std::string outFile(TCHAR_TO_UTF8(*outFileName));
-	std::vector<char> data;
-	if (!draco::ReadFileToBuffer(inFile, &data)) 
+	std::unique_ptr<draco::PointCloud> pc = LoadEncoderInput(inFile, nullptr, options, &mesh);
+	if (!pc)
 	{
-		UDWARNING("Failed opening the input file.\n");
 		return false;
 	}
-	if (data.empty()) 
+	return EncodeGeometryToFile(*pc, mesh, outFile, options);
+}
+
+bool UFlib_DracoUtilities::TuneEncoder(const FString& inFileName, FOptions options, float maxDecodeMs, FEncoderConfig& outConfig)
+{
+	if (inFileName.IsEmpty())
 	{
-		UDWARNING("Empty input file.\n");
+		UDWARNING("TuneEncoder : invalid file name.\n");
 		return false;
 	}
+	draco::Mesh *mesh = nullptr;
+	std::string inFile(TCHAR_TO_UTF8(*inFileName));
+	std::unique_ptr<draco::PointCloud> pc = LoadEncoderInput(inFile, nullptr, options, &mesh);
+	if (!pc)
+	{
+		return false;
+	}
+	draco::UD_EncoderTuner tuner(*pc, mesh, GetQuantizationBits(options));
+	auto statusor = tuner.Tune(maxDecodeMs);
+	if (!statusor.ok())
+	{
+		UDWARNING1("TuneEncoder : %s\n", UTF8_TO_TCHAR(statusor.status().error_msg()));
+		return false;
+	}
+	const draco::UD_EncoderTrial& best = statusor.value();
+	for (const draco::UD_EncoderTrial& trial : tuner.trials())
+	{
+		if (trial.ok && trial.pareto_optimal)
+		{
+			UE_LOG(UDLog, Log, TEXT("Pareto candidate: method %d submethod %d predictions %d/%d/%d, %zu bytes, %.2f ms to decode.\n"),
+				trial.config.encoding_method, trial.config.encoding_submethod, trial.config.position_prediction,
+				trial.config.tex_coord_prediction, trial.config.normal_prediction, trial.encoded_size, trial.decode_ms);
+		}
+	}
+	UE_LOG(UDLog, Log, TEXT("Chosen encoder configuration: %zu bytes, %.2f ms to decode.\n"), best.encoded_size, best.decode_ms);
+	outConfig = FromEncoderConfig(best.config);
+	return true;
+}
 
-	draco::DecoderBuffer buffer;
-	buffer.Init(data.data(), data.size());
-
-	draco::CycleTimer timer;
-	// Decode the input data into a geometry.
-	std::unique_ptr<draco::PointCloud> pc;
-	draco::Mesh* mesh = nullptr;
+// Serializes every option that changes the encoded bitstream.
+static std::string SerializeOptions(const FOptions& options)
+{
+	char text[384];
+	snprintf(text, sizeof(text), "pc=%d;pos=%d;tex=%d;nrm=%d;gen=%d;cl=%d;meta=%d;auto=%d;metric=%d;tol=%g,%g,%g;pgram=%d;clean=%d;cfg=%d,%d,%d,%d,%d,%d,%d",
+		options.is_point_cloud ? 1 : 0,
+		options.pos_quantization_bits,
+		options.tex_coords_quantization_bits,
+		options.normals_quantization_bits,
+		options.generic_quantization_bits,
+		options.compression_level,
+		options.use_metadata ? 1 : 0,
+		options.auto_tune_quantization ? 1 : 0,
+		static_cast<int>(options.error_metric),
+		options.pos_tolerance,
+		options.tex_coords_tolerance,
+		options.normals_tolerance_degrees,
+		static_cast<int>(options.parallelogram_search),
+		options.cleanup_mesh ? 1 : 0,
+		options.encoder_config.valid ? 1 : 0,
+		options.encoder_config.encoding_method,
+		options.encoder_config.encoding_submethod,
+		options.encoder_config.speed,
+		options.encoder_config.position_prediction_scheme,
+		options.encoder_config.tex_coords_prediction_scheme,
+		options.encoder_config.normals_prediction_scheme);
+	return text;
+}
 
-	auto type_statusor = draco::Decoder::GetEncodedGeometryType(&buffer);
-	if (!type_statusor.ok()) 
+bool UFlib_DracoUtilities::EncoderReport(const FString& inFileName, FOptions options, FString& outReport)
+{
+	if (inFileName.IsEmpty())
 	{
-		UDWARNING1("Failed to decode the input file %s\n", type_statusor.status().error_msg_string().c_str());
+		UDWARNING("EncoderReport : invalid file name.\n");
 		return false;
 	}
-	const draco::EncodedGeometryType geom_type = type_statusor.value();
+	draco::Mesh *mesh = nullptr;
+	std::string inFile(TCHAR_TO_UTF8(*inFileName));
+	std::unique_ptr<draco::PointCloud> pc = LoadEncoderInput(inFile, nullptr, options, &mesh);
+	if (!pc)
+	{
+		return false;
+	}
+	std::unique_ptr<draco::ExpertEncoder> expert_encoder = CreateExpertEncoder(*pc, mesh, options);
+	if (!expert_encoder)
+	{
+		return false;
+	}
+	// The parallelogram search leaves the chosen prediction in the options the report reads.
+	draco::EncoderBuffer buffer;
+	const draco::Status status = mesh && mesh->num_faces() > 0
+		? draco::UD_EncodeMeshWithParallelogramSearch(*mesh, &expert_encoder->options(), &buffer)
+		: expert_encoder->EncodeToBuffer(&buffer);
+	if (!status.ok())
+	{
+		UDWARNING1("Failed to encode the geometry.\n %s", UTF8_TO_TCHAR(status.error_msg()));
+		return false;
+	}
+	auto statusor = draco::UD_BuildEncodeReport(*pc, expert_encoder->options(), buffer);
+	if (!statusor.ok())
+	{
+		UDWARNING1("Failed to build the encode report.\n %s", UTF8_TO_TCHAR(statusor.status().error_msg()));
+		return false;
+	}
+	outReport = UTF8_TO_TCHAR(statusor.value().ToString().c_str());
+	UE_LOG(UDLog, Log, TEXT("%s"), *outReport);
+	return true;
+}
+
+FEncodeBatchStats UFlib_DracoUtilities::EncoderBatch(const TArray<FString>& inFileNames, const TArray<FString>& outFileNames, FOptions options, const FString& cacheDirectory)
+{
+	FEncodeBatchStats stats;
+	if (inFileNames.Num() != outFileNames.Num())
+	{
+		UDWARNING("EncoderBatch : inFileNames and outFileNames differ in length.\n");
+		stats.failures = inFileNames.Num();
+		return stats;
+	}
+	const draco::UD_EncodeCache cache(std::string(TCHAR_TO_UTF8(*cacheDirectory)));
+	const std::string serializedOptions = SerializeOptions(options);
 
-	if (geom_type == draco::TRIANGULAR_MESH) {
-		timer.Start();
-		draco::Decoder decoder;
-		auto statusor = decoder.DecodeMeshFromBuffer(&buffer);
-		if (!statusor.ok()) 
+	for (int32 i = 0; i < inFileNames.Num(); ++i)
+	{
+		std::string inFile(TCHAR_TO_UTF8(*inFileNames[i]));
+		std::string outFile(TCHAR_TO_UTF8(*outFileNames[i]));
+		std::vector<char> input;
+		if (!draco::ReadFileToBuffer(inFile, &input))
 		{
-			UDWARNING1("Failed to decode the input file %s\n", statusor.status().error_msg_string().c_str());
-			return false;
+			UDWARNING1("EncoderBatch : failed reading %s\n", *inFileNames[i]);
+			++stats.failures;
+			continue;
 		}
-		std::unique_ptr<draco::Mesh> in_mesh = std::move(statusor).value();
-		timer.Stop();
-		if (in_mesh) {
-			mesh = in_mesh.get();
-			pc = std::move(in_mesh);
+		const uint64_t key = draco::UD_EncodeCache::ComputeKey(inFile, input, serializedOptions, outFile);
+		if (cache.Fetch(key, outFile))
+		{
+			++stats.hits;
+			continue;
+		}
+		// The input is parsed from the bytes read for the key.
+		FOptions fileOptions = options;
+		draco::Mesh *mesh = nullptr;
+		std::unique_ptr<draco::PointCloud> pc = LoadEncoderInput(inFile, &input, fileOptions, &mesh);
+		if (!pc || !EncodeGeometryToFile(*pc, mesh, outFile, fileOptions))
+		{
+			++stats.failures;
+			continue;
 		}
+		++stats.misses;
+		cache.Store(key, outFile);
 	}
-	else if (geom_type == draco::POINT_CLOUD) {
-		// Failed to decode it as mesh, so let's try to decode it as a point cloud.
-		timer.Start();
-		draco::Decoder decoder;
-		auto statusor = decoder.DecodePointCloudFromBuffer(&buffer);
-		if (!statusor.ok()) 
+	UE_LOG(UDLog, Log, TEXT("Encode batch: %d cached, %d encoded, %d failed.\n"), stats.hits, stats.misses, stats.failures);
+	return stats;
+}
+
+bool UFlib_DracoUtilities::CreateArchive(const TArray<FString>& inFileNames, const FString& outFileName, bool trainSymbolModel)
+{
+	if (outFileName.IsEmpty())
+	{
+		UDWARNING("CreateArchive : invalid file name.\n");
+		return false;
+	}
+	draco::UD_MeshArchiveWriter archive;
+	archive.set_train_symbol_model(trainSymbolModel);
+	for (const FString& inFileName : inFileNames)
+	{
+		const draco::Status status = archive.AddFile(std::string(TCHAR_TO_UTF8(*inFileName)));
+		if (!status.ok())
 		{
-			UDWARNING1("Failed to decode the input file %s\n", statusor.status().error_msg_string().c_str());
+			UDWARNING1("CreateArchive : %s\n", UTF8_TO_TCHAR(status.error_msg()));
 			return false;
 		}
-		pc = std::move(statusor).value();
-		timer.Stop();
 	}
-
-	if (pc == nullptr) {
-		UDWARNING("Failed to decode the input file.\n");
+	const draco::Status status = archive.WriteToFile(std::string(TCHAR_TO_UTF8(*outFileName)));
+	if (!status.ok())
+	{
+		UDWARNING1("CreateArchive : %s\n", UTF8_TO_TCHAR(status.error_msg()));
 		return false;
 	}
-	const std::string extension = draco::parser::ToLower(
+	return true;
+}
+
+static void ToDecodeStats(const draco::UD_DecodeStats& stats, FDecodeStats& outStats)
+{
+	outStats = FDecodeStats();
+	outStats.from_cache = stats.origin != draco::UD_DECODED;
+	outStats.header_ms = stats.header_ms + stats.initialize_ms;
+	outStats.connectivity_ms = stats.connectivity_ms;
+	outStats.attribute_setup_ms = stats.attribute_setup_ms;
+	outStats.attributes_ms = stats.attributes_ms;
+	outStats.post_decode_ms = stats.post_decode_ms;
+	outStats.total_ms = stats.total_ms;
+	outStats.connectivity_bytes = static_cast<int>(stats.connectivity_bytes);
+	outStats.attributes_bytes = static_cast<int>(stats.attributes_bytes);
+	outStats.symbols_ms = static_cast<float>(stats.symbols_ms);
+	const int64_t symbolStreams = stats.symbol_table_hits + stats.symbol_table_misses;
+	outStats.symbol_table_hit_rate = symbolStreams == 0 ? 0.0f : static_cast<float>(stats.symbol_table_hits) / symbolStreams;
+	for (const draco::UD_AttributeDecoderStats& decoderStats : stats.attribute_decoders)
+	{
+		outStats.attribute_decoders_ms.Add(decoderStats.ms);
+	}
+	for (const draco::UD_PredictionSchemeStats& schemeStats : stats.prediction_schemes)
+	{
+		FDecodePredictionSchemeStats scheme;
+		scheme.prediction_scheme = schemeStats.prediction_scheme;
+		scheme.attribute_count = schemeStats.num_attributes;
+		scheme.value_count = static_cast<int>(schemeStats.num_values);
+		scheme.ms = static_cast<float>(schemeStats.ms);
+		scheme.bytes = static_cast<int>(schemeStats.bytes);
+		outStats.prediction_schemes.Add(scheme);
+	}
+}
+
+bool UFlib_DracoUtilities::Decoder(const FString& inFileName, const FString& outFileName)
+{
+	FDecodeStats stats;
+	return DecoderWithStats(inFileName, outFileName, stats);
+}
+
+bool UFlib_DracoUtilities::DecoderWithStats(const FString& inFileName, const FString& outFileName, FDecodeStats& outStats)
+{
+	TArray<int32> stripIndices;
+	return DecoderWithOptions(inFileName, outFileName, FDecodeOptions(), outStats, stripIndices);
+}
+
+static void LogDecodeStats(const draco::UD_DecodeStats& stats)
+{
+	if (stats.symbol_table_hits + stats.symbol_table_misses > 0)
+	{
+		UE_LOG(UDLog, Log, TEXT("Symbols: %.3f ms (%lld bytes), %lld of %lld rANS tables ready.\n"),
+			stats.symbols_ms, static_cast<long long>(stats.symbols_bytes), static_cast<long long>(stats.symbol_table_hits),
+			static_cast<long long>(stats.symbol_table_hits + stats.symbol_table_misses));
+	}
+	if (stats.origin != draco::UD_DECODED)
+	{
+		return;
+	}
+	UE_LOG(UDLog, Log, TEXT("Decode stages: header %.3f ms, connectivity %.3f ms (%lld bytes), attribute setup %.3f ms, attributes %.3f ms (%lld bytes), post %.3f ms.\n"),
+		stats.header_ms + stats.initialize_ms, stats.connectivity_ms, static_cast<long long>(stats.connectivity_bytes), stats.attribute_setup_ms,
+		stats.attributes_ms, static_cast<long long>(stats.attributes_bytes), stats.post_decode_ms);
+	for (const draco::UD_PredictionSchemeStats& schemeStats : stats.prediction_schemes)
+	{
+		UE_LOG(UDLog, Log, TEXT("  prediction scheme %d: %d attributes, %lld values, %.3f ms (%lld bytes).\n"),
+			schemeStats.prediction_scheme, schemeStats.num_attributes, static_cast<long long>(schemeStats.num_values),
+			schemeStats.ms, static_cast<long long>(schemeStats.bytes));
+	}
+}
+
+static std::string GetOutputExtension(const std::string& outFile)
+{
+	return draco::parser::ToLower(
 		outFile.size() >= 4
 		? outFile.substr(outFile.size() - 4)
 		: outFile);
+}
+
+// Applies the post-decode processing of options to the decoded geometry and writes it to outFile
+// in the format of its extension. encodedData is the bitstream of the geometry, GLB output stores
+// it as is.
+static bool WriteDecodedGeometry(const draco::UD_DecodedGeometry& geometry, const char* encodedData, size_t encodedSize,
+	const std::string& outFile, const FDecodeOptions& options, FDecodeStats& outStats, TArray<int32>& outStripIndices)
+{
+	const draco::PointCloud* pc = geometry.pc.get();
+	const draco::Mesh* mesh = geometry.mesh;
+
+	if (pc == nullptr) {
+		UDWARNING("Failed to decode the input file.\n");
+		return false;
+	}
+	const std::string extension = GetOutputExtension(outFile);
+
+	// The cached geometry is shared, the reordered mesh is a copy. Edgebreaker
+	// decodes faces in its own traversal order whatever order they were encoded in,
+	// so this is the only place the order can be chosen.
+	std::unique_ptr<draco::Mesh> optimizedMesh;
+	if (options.optimize_vertex_cache && mesh && mesh->num_faces() > 0) {
+		if (extension == ".glb") {
+			UE_LOG(UDLog, Log, TEXT("GLB output keeps the encoded bitstream, vertex cache optimization skipped.\n"));
+		}
+		else {
+			const int cacheSize = FMath::Max(options.vertex_cache_size, 1);
+			const double reorderStart = FPlatformTime::Seconds();
+			const draco::UD_VertexCacheStats before = draco::UD_ComputeVertexCacheStats(*mesh, cacheSize);
+			optimizedMesh = draco::UD_OptimizeVertexCache(*mesh, cacheSize);
+			const draco::UD_VertexCacheStats after = draco::UD_ComputeVertexCacheStats(*optimizedMesh, cacheSize);
+			outStats.vertex_cache_ms = static_cast<float>((FPlatformTime::Seconds() - reorderStart) * 1000.0);
+			outStats.acmr_before = static_cast<float>(before.acmr);
+			outStats.acmr_after = static_cast<float>(after.acmr);
+			outStats.atvr_before = static_cast<float>(before.atvr);
+			outStats.atvr_after = static_cast<float>(after.atvr);
+			UE_LOG(UDLog, Log, TEXT("Vertex cache (%d entries): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%.3f ms).\n"),
+				cacheSize, before.acmr, after.acmr, before.atvr, after.atvr, outStats.vertex_cache_ms);
+			mesh = optimizedMesh.get();
+			pc = mesh;
+		}
+	}
+	if (options.generate_triangle_strips && mesh) {
+		const double stripsStart = FPlatformTime::Seconds();
+		draco::UD_ParallelMeshStripifier stripifier;
+		std::vector<uint32_t> stripIndices;
+		if (stripifier.GenerateTriangleStripsWithPrimitiveRestart(*mesh, std::numeric_limits<uint32_t>::max(), &stripIndices)) {
+			outStats.strips_ms = static_cast<float>((FPlatformTime::Seconds() - stripsStart) * 1000.0);
+			outStats.strip_count = stripifier.num_strips();
+			outStats.strip_index_count = static_cast<int>(stripIndices.size());
+			// The restart index 0xffffffff reads as -1.
+			outStripIndices.SetNumUninitialized(outStats.strip_index_count);
+			if (!stripIndices.empty()) {
+				FMemory::Memcpy(outStripIndices.GetData(), stripIndices.data(), stripIndices.size() * sizeof(uint32_t));
+			}
+			UE_LOG(UDLog, Log, TEXT("Triangle strips: %d strips, %d indices for %d faces in %d regions (%.3f ms).\n"),
+				outStats.strip_count, outStats.strip_index_count, static_cast<int>(mesh->num_faces()), stripifier.num_regions(), outStats.strips_ms);
+		}
+		else {
+			UDWARNING("Triangle strips require a position attribute.\n");
+		}
+	}
 
 	if (extension == ".obj") {
-		draco::ObjEncoder obj_encoder;
+		draco::UD_ObjWriter obj_writer;
 		if (mesh) {
-			if (!obj_encoder.EncodeToFile(*mesh, outFile)) {
+			if (!obj_writer.WriteToFile(*mesh, outFile)) {
 				UDWARNING("Failed to store the decoded mesh as OBJ.\n");
 				return false;
 			}
 		}
 		else {
-			if (!obj_encoder.EncodeToFile(*pc.get(), outFile)) {
+			if (!obj_writer.WriteToFile(*pc, outFile)) {
 				UDWARNING("Failed to store the decoded point cloud as OBJ.\n");
 				return false;
 			}
 		}
 	}
 	else if (extension == ".ply") {
-		draco::PlyEncoder ply_encoder;
+		draco::UD_PlyWriter ply_writer;
 		if (mesh) {
-			if (!ply_encoder.EncodeToFile(*mesh, outFile)) {
+			if (!ply_writer.WriteToFile(*mesh, outFile)) {
 				UDWARNING("Failed to store the decoded mesh as PLY.\n");
 				return false;
 			}
 		}
 		else {
-			if (!ply_encoder.EncodeToFile(*pc.get(), outFile)) {
+			if (!ply_writer.WriteToFile(*pc, outFile)) {
 				UDWARNING("Failed to store the decoded point cloud as PLY.\n");
 				return false;
 			}
 		}
 	}
+	else if (extension == ".glb") {
+		// The bitstream is stored as is, only the glTF description is new.
+		if (!mesh) {
+			UDWARNING("GLB output requires a mesh.\n");
+			return false;
+		}
+		const draco::Status status = draco::UD_GlbWriter().WriteToFile(encodedData, encodedSize, *mesh, outFile);
+		if (!status.ok()) {
+			UDWARNING1("Failed to store the decoded mesh as GLB.\n %s", UTF8_TO_TCHAR(status.error_msg()));
+			return false;
+		}
+	}
+	else if (extension == ".udm") {
+		const std::unique_ptr<draco::UD_BinaryMeshWriter> writer = draco::UD_BinaryMeshWriter::Open(outFile);
+		if (!writer || !writer->Write(*pc, mesh)) {
+			UDWARNING("Failed to store the decoded geometry as UDM.\n");
+			return false;
+		}
+	}
 	else {
-		UDWARNING("Invalid extension of the output file. Use either .ply or .obj.\n");
+		UDWARNING("Invalid extension of the output file. Use .ply, .obj, .glb or .udm.\n");
+		return false;
+	}
+	return true;
+}
+
+bool UFlib_DracoUtilities::DecoderWithOptions(const FString& inFileName, const FString& outFileName, FDecodeOptions options, FDecodeStats& outStats, TArray<int32>& outStripIndices)
+{
+	outStripIndices.Reset();
+	if (inFileName.IsEmpty() || outFileName.IsEmpty())
+	{
+		UDWARNING("Decoder : invalid file name.\n");
+		return false;
+	}
+	std::string inFile(TCHAR_TO_UTF8(*inFileName));
+	std::string outFile(TCHAR_TO_UTF8(*outFileName));
+	std::vector<char> data;
+	if (!draco::ReadFileToBuffer(inFile, &data)) 
+	{
+		UDWARNING("Failed opening the input file.\n");
+		return false;
+	}
+	if (data.empty()) 
+	{
+		UDWARNING("Empty input file.\n");
+		return false;
+	}
+
+	// GLB files are decoded from the Draco bitstream they carry.
+	const char* encodedData = data.data();
+	size_t encodedSize = data.size();
+	if (draco::UD_GlbReader::IsGlb(data.data(), data.size()))
+	{
+		auto primitive = draco::UD_GlbReader::FindDracoPrimitive(data.data(), data.size());
+		if (!primitive.ok())
+		{
+			UDWARNING1("Failed to read the GLB file %s\n", UTF8_TO_TCHAR(primitive.status().error_msg()));
+			return false;
+		}
+		encodedData = primitive.value().data;
+		encodedSize = primitive.value().size;
+	}
+
+	draco::CycleTimer timer;
+	// Decode the input data into a geometry, reusing a previous decode of the
+	// same buffer when it is still cached.
+	timer.Start();
+	draco::Decoder decoder;
+	draco::UD_DecodeStats stats;
+	auto statusor = draco::UD_DecodeCache::Get().Decode(encodedData, encodedSize, &decoder, &stats);
+	if (!statusor.ok())
+	{
+		UDWARNING1("Failed to decode the input file %s\n", UTF8_TO_TCHAR(statusor.status().error_msg_string().c_str()));
+		return false;
+	}
+	timer.Stop();
+	LogDecodeStats(stats);
+	if (stats.origin != draco::UD_DECODED)
+	{
+		stats.total_ms = timer.GetInMs();
+	}
+	ToDecodeStats(stats, outStats);
+	if (!WriteDecodedGeometry(statusor.value(), encodedData, encodedSize, outFile, options, outStats, outStripIndices))
+	{
 		return false;
 	}
 	UDWARNING2("Decoded geometry saved to %s (%" PRId64 " ms to decode)\n",outFile.c_str(), timer.GetInMs());
@@ -292,4 +780,93 @@ bool UFlib_DracoUtilities::Decoder(const FString& inFileName, const FString& out
 	return true;
 }
 
+bool UFlib_DracoUtilities::ReadArchive(const FString& archiveFileName, TArray<FString>& outMemberNames)
+{
+	outMemberNames.Reset();
+	const std::unique_ptr<draco::UD_MeshArchiveReader> archive = draco::UD_MeshArchiveReader::Open(std::string(TCHAR_TO_UTF8(*archiveFileName)));
+	if (!archive)
+	{
+		UDWARNING1("ReadArchive : failed to open the archive %s.\n", *archiveFileName);
+		return false;
+	}
+	outMemberNames.Reserve(archive->num_members());
+	for (int i = 0; i < archive->num_members(); ++i)
+	{
+		outMemberNames.Add(UTF8_TO_TCHAR(archive->member_name(i).c_str()));
+	}
+	return true;
+}
 
+bool UFlib_DracoUtilities::DecodeArchiveEntry(const FString& archiveFileName, const FString& memberName, const FString& outFileName, FDecodeOptions options, FDecodeStats& outStats, TArray<int32>& outStripIndices)
+{
+	outStripIndices.Reset();
+	if (archiveFileName.IsEmpty() || outFileName.IsEmpty())
+	{
+		UDWARNING("DecodeArchiveEntry : invalid file name.\n");
+		return false;
+	}
+	const std::string outFile(TCHAR_TO_UTF8(*outFileName));
+	const std::unique_ptr<draco::UD_MeshArchiveReader> archive = draco::UD_MeshArchiveReader::Open(std::string(TCHAR_TO_UTF8(*archiveFileName)));
+	if (!archive)
+	{
+		UDWARNING1("DecodeArchiveEntry : failed to open the archive %s.\n", *archiveFileName);
+		return false;
+	}
+	const int index = archive->FindMember(std::string(TCHAR_TO_UTF8(*memberName)));
+	if (index < 0)
+	{
+		UDWARNING2("DecodeArchiveEntry : %s has no member %s.\n", *archiveFileName, *memberName);
+		return false;
+	}
+
+	draco::CycleTimer timer;
+	timer.Start();
+	archive->set_decode_cache(&draco::UD_DecodeCache::Get());
+	draco::UD_DecodeStats stats;
+	auto statusor = archive->DecodeMember(index, &stats);
+	if (!statusor.ok())
+	{
+		UDWARNING1("DecodeArchiveEntry : %s\n", UTF8_TO_TCHAR(statusor.status().error_msg()));
+		return false;
+	}
+	timer.Stop();
+	LogDecodeStats(stats);
+	if (stats.origin != draco::UD_DECODED)
+	{
+		stats.total_ms = timer.GetInMs();
+	}
+	ToDecodeStats(stats, outStats);
+
+	// Only GLB output needs the bitstream, coded members are decoded once more for it.
+	std::vector<char> bitstream;
+	if (GetOutputExtension(outFile) == ".glb")
+	{
+		const draco::Status status = archive->ReadMemberBitstream(index, &bitstream);
+		if (!status.ok())
+		{
+			UDWARNING1("DecodeArchiveEntry : %s\n", UTF8_TO_TCHAR(status.error_msg()));
+			return false;
+		}
+	}
+	if (!WriteDecodedGeometry(statusor.value(), bitstream.data(), bitstream.size(), outFile, options, outStats, outStripIndices))
+	{
+		return false;
+	}
+	UDWARNING2("Decoded archive member saved to %s (%" PRId64 " ms to decode)\n", UTF8_TO_TCHAR(outFile.c_str()), timer.GetInMs());
+	return true;
+}
+
+void UFlib_DracoUtilities::SetDecodeCacheBudget(int32 budgetInMegaBytes)
+{
+	draco::UD_DecodeCache::Get().SetByteBudget(static_cast<size_t>(FMath::Max(budgetInMegaBytes, 0)) * 1024 * 1024);
+}
+
+void UFlib_DracoUtilities::SetDecodeCacheDirectory(const FString& directory)
+{
+	draco::UD_DecodeCache::Get().SetDiskDirectory(std::string(TCHAR_TO_UTF8(*directory)));
+}
+
+void UFlib_DracoUtilities::ClearDecodeCache()
+{
+	draco::UD_DecodeCache::Get().Clear();
+}
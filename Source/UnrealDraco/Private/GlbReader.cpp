@@ -0,0 +1,205 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "GlbReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "MappedFile.h"
+#include "draco/compression/decode.h"
+#include "draco/core/decoder_buffer.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+constexpr uint32_t kGlbVersion = 2;
+constexpr uint32_t kGlbJsonChunk = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kGlbBinChunk = 0x004E4942;   // "BIN\0"
+constexpr size_t kGlbHeaderSize = 12;
+constexpr size_t kGlbChunkHeaderSize = 8;
+
+uint32_t ReadUint32(const char *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Returns the |index|-th object of the top-level array |name|, or nullptr.
+TSharedPtr<FJsonObject> GetArrayObject(const FJsonObject &gltf,
+                                       const TCHAR *name, int32 index) {
+  const TArray<TSharedPtr<FJsonValue>> *array = nullptr;
+  if (!gltf.TryGetArrayField(name, array) || index < 0 ||
+      index >= array->Num()) {
+    return nullptr;
+  }
+  return (*array)[index]->AsObject();
+}
+
+// Returns the KHR_draco_mesh_compression object of the first primitive that
+// has one, or nullptr.
+TSharedPtr<FJsonObject> FindDracoExtension(const FJsonObject &gltf) {
+  const TArray<TSharedPtr<FJsonValue>> *meshes = nullptr;
+  if (!gltf.TryGetArrayField(TEXT("meshes"), meshes)) {
+    return nullptr;
+  }
+  for (const TSharedPtr<FJsonValue> &mesh : *meshes) {
+    const TSharedPtr<FJsonObject> mesh_object = mesh->AsObject();
+    const TArray<TSharedPtr<FJsonValue>> *primitives = nullptr;
+    if (!mesh_object.IsValid() ||
+        !mesh_object->TryGetArrayField(TEXT("primitives"), primitives)) {
+      continue;
+    }
+    for (const TSharedPtr<FJsonValue> &primitive : *primitives) {
+      const TSharedPtr<FJsonObject> primitive_object = primitive->AsObject();
+      const TSharedPtr<FJsonObject> *extensions = nullptr;
+      const TSharedPtr<FJsonObject> *draco_extension = nullptr;
+      if (primitive_object.IsValid() &&
+          primitive_object->TryGetObjectField(TEXT("extensions"),
+                                              extensions) &&
+          (*extensions)->TryGetObjectField(TEXT("KHR_draco_mesh_compression"),
+                                           draco_extension)) {
+        return *draco_extension;
+      }
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+bool UD_GlbReader::IsGlb(const char *data, size_t data_size) {
+  return data_size >= kGlbHeaderSize && ReadUint32(data) == kGlbMagic;
+}
+
+StatusOr<UD_GlbDracoPrimitive> UD_GlbReader::FindDracoPrimitive(
+    const char *data, size_t data_size) {
+  if (!IsGlb(data, data_size)) {
+    return Status(Status::DRACO_ERROR, "Not a GLB file.");
+  }
+  if (ReadUint32(data + 4) != kGlbVersion) {
+    return Status(Status::UNSUPPORTED_VERSION, "Unsupported GLB version.");
+  }
+  const size_t file_size = std::min<size_t>(ReadUint32(data + 8), data_size);
+
+  // The JSON chunk comes first, followed by an optional binary chunk.
+  const char *json = nullptr;
+  size_t json_size = 0;
+  const char *bin = nullptr;
+  size_t bin_size = 0;
+  size_t offset = kGlbHeaderSize;
+  while (offset + kGlbChunkHeaderSize <= file_size) {
+    const size_t chunk_size = ReadUint32(data + offset);
+    const uint32_t chunk_type = ReadUint32(data + offset + 4);
+    offset += kGlbChunkHeaderSize;
+    if (chunk_size > file_size - offset) {
+      return Status(Status::DRACO_ERROR, "Truncated GLB chunk.");
+    }
+    if (chunk_type == kGlbJsonChunk && json == nullptr) {
+      json = data + offset;
+      json_size = chunk_size;
+    } else if (chunk_type == kGlbBinChunk && bin == nullptr) {
+      bin = data + offset;
+      bin_size = chunk_size;
+    }
+    offset += chunk_size;
+  }
+  if (json == nullptr) {
+    return Status(Status::DRACO_ERROR, "GLB file without a JSON chunk.");
+  }
+
+  const FUTF8ToTCHAR json_text(json, static_cast<int32>(json_size));
+  TSharedPtr<FJsonObject> gltf;
+  if (!FJsonSerializer::Deserialize(
+          TJsonReaderFactory<>::Create(
+              FString(json_text.Length(), json_text.Get())),
+          gltf) ||
+      !gltf.IsValid()) {
+    return Status(Status::DRACO_ERROR, "Invalid glTF JSON.");
+  }
+
+  const TSharedPtr<FJsonObject> draco_extension = FindDracoExtension(*gltf);
+  if (!draco_extension.IsValid()) {
+    return Status(Status::DRACO_ERROR,
+                  "No primitive uses KHR_draco_mesh_compression.");
+  }
+  int32 buffer_view_index = -1;
+  draco_extension->TryGetNumberField(TEXT("bufferView"), buffer_view_index);
+  const TSharedPtr<FJsonObject> buffer_view =
+      GetArrayObject(*gltf, TEXT("bufferViews"), buffer_view_index);
+  if (!buffer_view.IsValid()) {
+    return Status(Status::DRACO_ERROR, "Invalid Draco buffer view.");
+  }
+  int32 buffer_index = -1;
+  int64 byte_offset = 0;
+  int64 byte_length = -1;
+  buffer_view->TryGetNumberField(TEXT("buffer"), buffer_index);
+  buffer_view->TryGetNumberField(TEXT("byteOffset"), byte_offset);
+  buffer_view->TryGetNumberField(TEXT("byteLength"), byte_length);
+  // Only the first buffer can refer to the binary chunk, all other buffers
+  // are external files.
+  const TSharedPtr<FJsonObject> buffer =
+      GetArrayObject(*gltf, TEXT("buffers"), buffer_index);
+  if (buffer_index != 0 || !buffer.IsValid() ||
+      buffer->HasField(TEXT("uri")) || bin == nullptr) {
+    return Status(Status::DRACO_ERROR,
+                  "Draco data is not stored in the GLB binary chunk.");
+  }
+  if (byte_offset < 0 || byte_length < 0 ||
+      static_cast<uint64_t>(byte_offset) + byte_length > bin_size) {
+    return Status(Status::DRACO_ERROR, "Draco buffer view out of range.");
+  }
+
+  UD_GlbDracoPrimitive primitive;
+  primitive.data = bin + byte_offset;
+  primitive.size = static_cast<size_t>(byte_length);
+  const TSharedPtr<FJsonObject> *attributes = nullptr;
+  if (draco_extension->TryGetObjectField(TEXT("attributes"), attributes)) {
+    for (const auto &attribute : (*attributes)->Values) {
+      double unique_id = -1;
+      if (!attribute.Value.IsValid() ||
+          !attribute.Value->TryGetNumber(unique_id) || unique_id < 0) {
+        return Status(Status::DRACO_ERROR, "Invalid Draco attribute id.");
+      }
+      primitive.attributes.push_back(
+          std::make_pair(std::string(TCHAR_TO_UTF8(*attribute.Key)),
+                         static_cast<int>(unique_id)));
+    }
+  }
+  return primitive;
+}
+
+StatusOr<std::unique_ptr<Mesh>> UD_GlbReader::ReadFromFile(
+    const std::string &file_name) {
+  UD_MappedFile file;
+  if (!file.Open(file_name)) {
+    return Status(Status::IO_ERROR, "Unable to read input file.");
+  }
+  return ReadFromBuffer(file.data(), file.size());
+}
+
+StatusOr<std::unique_ptr<Mesh>> UD_GlbReader::ReadFromBuffer(
+    const char *data, size_t data_size) {
+  DRACO_ASSIGN_OR_RETURN(const UD_GlbDracoPrimitive primitive,
+                         FindDracoPrimitive(data, data_size));
+  DecoderBuffer buffer;
+  buffer.Init(primitive.data, primitive.size);
+  Decoder decoder;
+  DRACO_ASSIGN_OR_RETURN(std::unique_ptr<Mesh> mesh,
+                         decoder.DecodeMeshFromBuffer(&buffer));
+  for (const auto &attribute : primitive.attributes) {
+    if (mesh->GetAttributeByUniqueId(attribute.second) == nullptr) {
+      return Status(Status::DRACO_ERROR,
+                    "KHR_draco_mesh_compression refers to a missing "
+                    "attribute: " + attribute.first);
+    }
+  }
+  return mesh;
+}
+
+}  // namespace draco
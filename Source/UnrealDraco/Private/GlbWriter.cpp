@@ -0,0 +1,362 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "GlbWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "FileHelper.h"
+#include "draco/compression/decode.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/io/file_writer_factory.h"
+#include "draco/io/file_writer_interface.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+constexpr uint32_t kGlbVersion = 2;
+constexpr uint32_t kGlbJsonChunk = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kGlbBinChunk = 0x004E4942;   // "BIN\0"
+constexpr int kGlbHeaderSize = 12;
+constexpr int kGlbChunkHeaderSize = 8;
+
+// glTF accessor component types.
+constexpr int kGltfByte = 5120;
+constexpr int kGltfUnsignedByte = 5121;
+constexpr int kGltfShort = 5122;
+constexpr int kGltfUnsignedShort = 5123;
+constexpr int kGltfUnsignedInt = 5125;
+constexpr int kGltfFloat = 5126;
+constexpr int kGltfTriangles = 4;
+
+// Returns 0 for the data types glTF accessors cannot hold.
+int GetGltfComponentType(DataType data_type) {
+  switch (data_type) {
+    case DT_INT8:
+      return kGltfByte;
+    case DT_UINT8:
+      return kGltfUnsignedByte;
+    case DT_INT16:
+      return kGltfShort;
+    case DT_UINT16:
+      return kGltfUnsignedShort;
+    case DT_UINT32:
+      return kGltfUnsignedInt;
+    case DT_FLOAT32:
+      return kGltfFloat;
+    default:
+      break;
+  }
+  return 0;
+}
+
+// Names the data types for the warnings about dropped attributes.
+const TCHAR *GetDataTypeName(DataType data_type) {
+  static const TCHAR *const kNames[] = {
+      TEXT("invalid"), TEXT("int8"),   TEXT("uint8"),   TEXT("int16"),
+      TEXT("uint16"),  TEXT("int32"),  TEXT("uint32"),  TEXT("int64"),
+      TEXT("uint64"),  TEXT("float32"), TEXT("float64"), TEXT("bool")};
+  return data_type >= 0 && data_type < DT_TYPES_COUNT ? kNames[data_type]
+                                                      : kNames[DT_INVALID];
+}
+
+const TCHAR *GetGltfAccessorType(int num_components) {
+  switch (num_components) {
+    case 1:
+      return TEXT("SCALAR");
+    case 2:
+      return TEXT("VEC2");
+    case 3:
+      return TEXT("VEC3");
+    case 4:
+      return TEXT("VEC4");
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+// glTF only allows floats and normalized unsigned bytes or shorts for
+// texture coordinates and colors.
+bool IsGltfColorOrTexCoordType(const PointAttribute &att) {
+  return att.data_type() == DT_FLOAT32 ||
+         (att.normalized() && (att.data_type() == DT_UINT8 ||
+                               att.data_type() == DT_UINT16));
+}
+
+// Returns the glTF semantic of the |index|-th attribute of its type, or an
+// application specific "_NAME_<index>" semantic when the attribute does not
+// meet the requirements of the standard one.
+FString GetGltfSemantic(const PointAttribute &att, int index) {
+  const int num_components = att.num_components();
+  switch (att.attribute_type()) {
+    case GeometryAttribute::POSITION:
+      if (index == 0 && num_components == 3 &&
+          att.data_type() == DT_FLOAT32) {
+        return TEXT("POSITION");
+      }
+      return FString::Printf(TEXT("_POSITION_%d"), index);
+    case GeometryAttribute::NORMAL:
+      if (index == 0 && num_components == 3 &&
+          att.data_type() == DT_FLOAT32) {
+        return TEXT("NORMAL");
+      }
+      return FString::Printf(TEXT("_NORMAL_%d"), index);
+    case GeometryAttribute::TEX_COORD:
+      if (num_components == 2 && IsGltfColorOrTexCoordType(att)) {
+        return FString::Printf(TEXT("TEXCOORD_%d"), index);
+      }
+      return FString::Printf(TEXT("_TEXCOORD_%d"), index);
+    case GeometryAttribute::COLOR:
+      if ((num_components == 3 || num_components == 4) &&
+          IsGltfColorOrTexCoordType(att)) {
+        return FString::Printf(TEXT("COLOR_%d"), index);
+      }
+      return FString::Printf(TEXT("_COLOR_%d"), index);
+    default:
+      break;
+  }
+  return FString::Printf(TEXT("_GENERIC_%d"), index);
+}
+
+TSharedRef<FJsonObject> MakeAccessor(int component_type, int64_t count,
+                                     const TCHAR *type) {
+  TSharedRef<FJsonObject> accessor = MakeShared<FJsonObject>();
+  accessor->SetNumberField(TEXT("componentType"), component_type);
+  accessor->SetNumberField(TEXT("count"), static_cast<double>(count));
+  accessor->SetStringField(TEXT("type"), type);
+  return accessor;
+}
+
+TArray<TSharedPtr<FJsonValue>> MakeNumberArray(const float *values,
+                                               int num_values) {
+  TArray<TSharedPtr<FJsonValue>> array;
+  for (int i = 0; i < num_values; ++i) {
+    array.Add(MakeShared<FJsonValueNumber>(values[i]));
+  }
+  return array;
+}
+
+// Adds the min/max bounds that glTF requires for POSITION accessors.
+void SetPositionBounds(const PointAttribute &att, FJsonObject *accessor) {
+  std::array<float, 3> min_values;
+  std::array<float, 3> max_values;
+  min_values.fill(std::numeric_limits<float>::max());
+  max_values.fill(std::numeric_limits<float>::lowest());
+  std::array<float, 3> value;
+  for (AttributeValueIndex i(0); i < static_cast<uint32_t>(att.size()); ++i) {
+    att.ConvertValue<float>(i, 3, &value[0]);
+    for (int c = 0; c < 3; ++c) {
+      min_values[c] = std::min(min_values[c], value[c]);
+      max_values[c] = std::max(max_values[c], value[c]);
+    }
+  }
+  accessor->SetArrayField(TEXT("min"), MakeNumberArray(&min_values[0], 3));
+  accessor->SetArrayField(TEXT("max"), MakeNumberArray(&max_values[0], 3));
+}
+
+TArray<TSharedPtr<FJsonValue>> MakeSingleton(
+    const TSharedRef<FJsonObject> &object) {
+  TArray<TSharedPtr<FJsonValue>> array;
+  array.Add(MakeShared<FJsonValueObject>(object));
+  return array;
+}
+
+// Builds the glTF document of a single mesh whose Draco bitstream of
+// |encoded_size| bytes is the whole binary buffer.
+FString BuildGltfJson(const Mesh &mesh, size_t encoded_size) {
+  TArray<TSharedPtr<FJsonValue>> accessors;
+  accessors.Add(MakeShared<FJsonValueObject>(
+      MakeAccessor(kGltfUnsignedInt, 3 * static_cast<int64_t>(mesh.num_faces()),
+                   TEXT("SCALAR"))));
+
+  TSharedRef<FJsonObject> primitive_attributes = MakeShared<FJsonObject>();
+  TSharedRef<FJsonObject> draco_attributes = MakeShared<FJsonObject>();
+  std::array<int, GeometryAttribute::NAMED_ATTRIBUTES_COUNT + 1> type_counts;
+  type_counts.fill(0);
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute &att = *mesh.attribute(i);
+    const int component_type = GetGltfComponentType(att.data_type());
+    const TCHAR *const accessor_type =
+        GetGltfAccessorType(att.num_components());
+    if (component_type == 0 || accessor_type == nullptr ||
+        (att.data_type() == DT_UINT32 && att.normalized())) {
+      // Still decoded by readers of the bitstream, but not reachable through
+      // the glTF primitive.
+      UE_LOG(UDLog, Warning,
+             TEXT("GLB output drops attribute %d (%s, %d components of %s): "
+                  "glTF has no accessor for it."),
+             att.unique_id(),
+             UTF8_TO_TCHAR(
+                 GeometryAttribute::TypeToString(att.attribute_type()).c_str()),
+             att.num_components(), GetDataTypeName(att.data_type()));
+      continue;
+    }
+    const int type_index =
+        att.attribute_type() >= 0 &&
+                att.attribute_type() < GeometryAttribute::NAMED_ATTRIBUTES_COUNT
+            ? att.attribute_type()
+            : GeometryAttribute::NAMED_ATTRIBUTES_COUNT;
+    const FString semantic = GetGltfSemantic(att, type_counts[type_index]++);
+
+    TSharedRef<FJsonObject> accessor =
+        MakeAccessor(component_type, mesh.num_points(), accessor_type);
+    if (att.normalized()) {
+      accessor->SetBoolField(TEXT("normalized"), true);
+    }
+    if (semantic == TEXT("POSITION")) {
+      SetPositionBounds(att, &accessor.Get());
+    }
+    primitive_attributes->SetNumberField(semantic, accessors.Num());
+    draco_attributes->SetNumberField(semantic, att.unique_id());
+    accessors.Add(MakeShared<FJsonValueObject>(accessor));
+  }
+
+  TSharedRef<FJsonObject> draco_extension = MakeShared<FJsonObject>();
+  draco_extension->SetNumberField(TEXT("bufferView"), 0);
+  draco_extension->SetObjectField(TEXT("attributes"), draco_attributes);
+  TSharedRef<FJsonObject> primitive_extensions = MakeShared<FJsonObject>();
+  primitive_extensions->SetObjectField(TEXT("KHR_draco_mesh_compression"),
+                                       draco_extension);
+
+  TSharedRef<FJsonObject> primitive = MakeShared<FJsonObject>();
+  primitive->SetObjectField(TEXT("attributes"), primitive_attributes);
+  primitive->SetNumberField(TEXT("indices"), 0);
+  primitive->SetNumberField(TEXT("mode"), kGltfTriangles);
+  primitive->SetObjectField(TEXT("extensions"), primitive_extensions);
+  TSharedRef<FJsonObject> gltf_mesh = MakeShared<FJsonObject>();
+  gltf_mesh->SetArrayField(TEXT("primitives"), MakeSingleton(primitive));
+
+  TSharedRef<FJsonObject> node = MakeShared<FJsonObject>();
+  node->SetNumberField(TEXT("mesh"), 0);
+  TSharedRef<FJsonObject> scene = MakeShared<FJsonObject>();
+  TArray<TSharedPtr<FJsonValue>> scene_nodes;
+  scene_nodes.Add(MakeShared<FJsonValueNumber>(0));
+  scene->SetArrayField(TEXT("nodes"), scene_nodes);
+
+  TSharedRef<FJsonObject> buffer_view = MakeShared<FJsonObject>();
+  buffer_view->SetNumberField(TEXT("buffer"), 0);
+  buffer_view->SetNumberField(TEXT("byteOffset"), 0);
+  buffer_view->SetNumberField(TEXT("byteLength"),
+                              static_cast<double>(encoded_size));
+  TSharedRef<FJsonObject> buffer = MakeShared<FJsonObject>();
+  buffer->SetNumberField(TEXT("byteLength"), static_cast<double>(encoded_size));
+
+  TSharedRef<FJsonObject> asset = MakeShared<FJsonObject>();
+  asset->SetStringField(TEXT("version"), TEXT("2.0"));
+  asset->SetStringField(TEXT("generator"), TEXT("UnrealDraco"));
+  TArray<TSharedPtr<FJsonValue>> extensions;
+  extensions.Add(
+      MakeShared<FJsonValueString>(TEXT("KHR_draco_mesh_compression")));
+
+  TSharedRef<FJsonObject> gltf = MakeShared<FJsonObject>();
+  gltf->SetObjectField(TEXT("asset"), asset);
+  gltf->SetArrayField(TEXT("extensionsUsed"), extensions);
+  gltf->SetArrayField(TEXT("extensionsRequired"), extensions);
+  gltf->SetNumberField(TEXT("scene"), 0);
+  gltf->SetArrayField(TEXT("scenes"), MakeSingleton(scene));
+  gltf->SetArrayField(TEXT("nodes"), MakeSingleton(node));
+  gltf->SetArrayField(TEXT("meshes"), MakeSingleton(gltf_mesh));
+  gltf->SetArrayField(TEXT("accessors"), accessors);
+  gltf->SetArrayField(TEXT("bufferViews"), MakeSingleton(buffer_view));
+  gltf->SetArrayField(TEXT("buffers"), MakeSingleton(buffer));
+
+  FString text;
+  const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>>
+      writer =
+          TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(
+              &text);
+  FJsonSerializer::Serialize(gltf, writer);
+  return text;
+}
+
+void EncodeUint32(uint32_t value, EncoderBuffer *out_buffer) {
+  out_buffer->Encode(&value, sizeof(value));
+}
+
+}  // namespace
+
+Status UD_GlbWriter::WriteToFile(const char *encoded_data, size_t encoded_size,
+                                 const Mesh &mesh,
+                                 const std::string &file_name) {
+  std::unique_ptr<FileWriterInterface> file =
+      FileWriterFactory::OpenWriter(file_name);
+  if (!file) {
+    return Status(Status::DRACO_ERROR, "Failed to open the output file.");
+  }
+  EncoderBuffer buffer;
+  DRACO_RETURN_IF_ERROR(
+      WriteToBuffer(encoded_data, encoded_size, mesh, &buffer));
+  if (!file->Write(buffer.data(), buffer.size())) {
+    return Status(Status::DRACO_ERROR, "Failed to write the output file.");
+  }
+  return OkStatus();
+}
+
+Status UD_GlbWriter::WriteToFile(const char *encoded_data, size_t encoded_size,
+                                 const std::string &file_name) {
+  DecoderBuffer in_buffer;
+  in_buffer.Init(encoded_data, encoded_size);
+  auto type_statusor = Decoder::GetEncodedGeometryType(&in_buffer);
+  if (!type_statusor.ok()) {
+    return type_statusor.status();
+  }
+  if (type_statusor.value() != TRIANGULAR_MESH) {
+    return Status(Status::DRACO_ERROR,
+                  "GLB output requires a triangle mesh, the bitstream holds a "
+                  "point cloud.");
+  }
+  Decoder decoder;
+  auto statusor = decoder.DecodeMeshFromBuffer(&in_buffer);
+  if (!statusor.ok()) {
+    return statusor.status();
+  }
+  return WriteToFile(encoded_data, encoded_size, *statusor.value(), file_name);
+}
+
+Status UD_GlbWriter::WriteToBuffer(const char *encoded_data,
+                                   size_t encoded_size, const Mesh &mesh,
+                                   EncoderBuffer *out_buffer) {
+  const FTCHARToUTF8 json(*BuildGltfJson(mesh, encoded_size));
+  // Both chunks are padded to four bytes, JSON with spaces and the binary
+  // chunk with zeros.
+  const uint32_t json_size = (json.Length() + 3) & ~3u;
+  const uint32_t bin_size = (static_cast<uint32_t>(encoded_size) + 3) & ~3u;
+  const uint64_t total_size = static_cast<uint64_t>(kGlbHeaderSize) +
+                              kGlbChunkHeaderSize + json_size +
+                              kGlbChunkHeaderSize + bin_size;
+  if (total_size > std::numeric_limits<uint32_t>::max()) {
+    return Status(Status::DRACO_ERROR, "Mesh is too large for a GLB file.");
+  }
+
+  EncodeUint32(kGlbMagic, out_buffer);
+  EncodeUint32(kGlbVersion, out_buffer);
+  EncodeUint32(static_cast<uint32_t>(total_size), out_buffer);
+
+  EncodeUint32(json_size, out_buffer);
+  EncodeUint32(kGlbJsonChunk, out_buffer);
+  out_buffer->Encode(json.Get(), json.Length());
+  for (uint32_t i = json.Length(); i < json_size; ++i) {
+    out_buffer->Encode(' ');
+  }
+
+  EncodeUint32(bin_size, out_buffer);
+  EncodeUint32(kGlbBinChunk, out_buffer);
+  out_buffer->Encode(encoded_data, encoded_size);
+  for (size_t i = encoded_size; i < bin_size; ++i) {
+    out_buffer->Encode('\0');
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,434 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "KernelBenchmark.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "BulkGeometryBuilder.h"
+#include "DracoBenchmark.h"
+#include "MeshReader.h"
+#include "OctahedronBulk.h"
+#include "ParallelDeduplication.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
+#include "draco/io/file_utils.h"
+#include "draco/mesh/triangle_soup_mesh_builder.h"
+#include "draco/point_cloud/point_cloud_builder.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int kNormalQuantizationBits = 8;
+
+// Fastest of |repetitions| runs of |kernel|, in milliseconds.
+double TimeKernel(int repetitions, const std::function<void()> &kernel) {
+  double best_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(repetitions, 1); ++i) {
+    const double start = FPlatformTime::Seconds();
+    kernel();
+    best_ms = std::min(best_ms, (FPlatformTime::Seconds() - start) * 1000.0);
+  }
+  return best_ms;
+}
+
+// Copy of |mesh| with a point and a value of every attribute per corner, the
+// way mesh readers build meshes before deduplication.
+std::unique_ptr<Mesh> ExpandToCorners(const Mesh &mesh) {
+  const uint32_t num_faces = mesh.num_faces();
+  const uint32_t num_corners = num_faces * 3;
+  std::unique_ptr<Mesh> out(new Mesh());
+  out->SetNumFaces(num_faces);
+  out->set_num_points(num_corners);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const uint32_t c = f.value() * 3;
+    out->SetFace(f, {{PointIndex(c), PointIndex(c + 1), PointIndex(c + 2)}});
+  }
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const src = mesh.attribute(i);
+    std::unique_ptr<PointAttribute> dst(new PointAttribute());
+    dst->Init(src->attribute_type(), src->num_components(), src->data_type(),
+              src->normalized(), num_corners);
+    for (FaceIndex f(0); f < num_faces; ++f) {
+      for (int c = 0; c < 3; ++c) {
+        dst->SetAttributeValue(AttributeValueIndex(f.value() * 3 + c),
+                               src->GetAddressOfMappedIndex(mesh.face(f)[c]));
+      }
+    }
+    out->AddAttribute(std::move(dst));
+  }
+  return out;
+}
+
+// Whether |a| and |b| have the same points, attribute values and mappings.
+bool SamePoints(const PointCloud &a, const PointCloud &b) {
+  if (a.num_points() != b.num_points() ||
+      a.num_attributes() != b.num_attributes()) {
+    return false;
+  }
+  for (int i = 0; i < a.num_attributes(); ++i) {
+    const PointAttribute *const att_a = a.attribute(i);
+    const PointAttribute *const att_b = b.attribute(i);
+    if (att_a->size() != att_b->size() ||
+        att_a->is_mapping_identity() != att_b->is_mapping_identity()) {
+      return false;
+    }
+    const int value_size =
+        DataTypeLength(att_a->data_type()) * att_a->num_components();
+    for (AttributeValueIndex v(0); v < static_cast<uint32_t>(att_a->size());
+         ++v) {
+      if (memcmp(att_a->GetAddress(v), att_b->GetAddress(v), value_size) !=
+          0) {
+        return false;
+      }
+    }
+    for (PointIndex p(0); p < a.num_points(); ++p) {
+      if (att_a->mapped_index(p) != att_b->mapped_index(p)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether |a| and |b| have the same faces, attribute values and mappings.
+bool SameGeometry(const Mesh &a, const Mesh &b) {
+  if (a.num_faces() != b.num_faces()) {
+    return false;
+  }
+  for (FaceIndex f(0); f < a.num_faces(); ++f) {
+    if (a.face(f) != b.face(f)) {
+      return false;
+    }
+  }
+  return SamePoints(a, b);
+}
+
+// Fastest of |repetitions| runs of |kernel| on a fresh mesh made by |prepare|
+// outside of the timing, in milliseconds. The mesh of the last run is
+// returned in |out_mesh|.
+double TimeKernelOnCopies(int repetitions,
+                          const std::function<std::unique_ptr<Mesh>()> &prepare,
+                          const std::function<void(Mesh *)> &kernel,
+                          std::unique_ptr<Mesh> *out_mesh) {
+  double best_ms = std::numeric_limits<double>::max();
+  for (int i = 0; i < std::max(repetitions, 1); ++i) {
+    *out_mesh = prepare();
+    const double start = FPlatformTime::Seconds();
+    kernel(out_mesh->get());
+    best_ms = std::min(best_ms, (FPlatformTime::Seconds() - start) * 1000.0);
+  }
+  return best_ms;
+}
+
+// Attribute value deduplication of a mesh with a value per corner, with
+// PointCloud::DeduplicateAttributeValues() against
+// UD_DeduplicateAttributeValues().
+UD_KernelBenchmarkResult MeasureValueDeduplication(const std::string &name,
+                                                   const Mesh &mesh,
+                                                   int repetitions) {
+  UD_KernelBenchmarkResult result;
+  result.kernel = "dedup_values";
+  result.name = name;
+  result.num_entries = static_cast<int>(mesh.num_faces()) * 3;
+  const auto prepare = [&]() { return ExpandToCorners(mesh); };
+
+  std::unique_ptr<Mesh> reference;
+  result.reference_ms = TimeKernelOnCopies(
+      repetitions, prepare,
+      [](Mesh *target) { target->DeduplicateAttributeValues(); }, &reference);
+  std::unique_ptr<Mesh> optimized;
+  result.optimized_ms = TimeKernelOnCopies(
+      repetitions, prepare,
+      [](Mesh *target) { UD_DeduplicateAttributeValues(target); }, &optimized);
+  result.identical = SameGeometry(*reference, *optimized);
+  return result;
+}
+
+// Point id deduplication of a mesh with a point per corner and deduplicated
+// attribute values, with PointCloud::DeduplicatePointIds() against
+// UD_DeduplicatePointIds().
+UD_KernelBenchmarkResult MeasurePointIdDeduplication(const std::string &name,
+                                                     const Mesh &mesh,
+                                                     int repetitions) {
+  UD_KernelBenchmarkResult result;
+  result.kernel = "dedup_point_ids";
+  result.name = name;
+  result.num_entries = static_cast<int>(mesh.num_faces()) * 3;
+  const auto prepare = [&]() {
+    std::unique_ptr<Mesh> expanded = ExpandToCorners(mesh);
+    UD_DeduplicateAttributeValues(expanded.get());
+    return expanded;
+  };
+
+  std::unique_ptr<Mesh> reference;
+  result.reference_ms = TimeKernelOnCopies(
+      repetitions, prepare,
+      [](Mesh *target) { target->DeduplicatePointIds(); }, &reference);
+  std::unique_ptr<Mesh> optimized;
+  result.optimized_ms = TimeKernelOnCopies(
+      repetitions, prepare,
+      [](Mesh *target) { UD_DeduplicatePointIds(target, target); },
+      &optimized);
+  result.identical = SameGeometry(*reference, *optimized);
+  return result;
+}
+
+// Attribute values of every corner of a mesh, laid out as an in-memory
+// source holds them: an array per attribute, one interleaved vertex buffer and
+// an array per component.
+struct CornerArrays {
+  uint32_t num_corners = 0;
+  std::vector<std::vector<uint8_t>> values;
+  std::vector<uint8_t> vertices;
+  int64_t vertex_size = 0;
+  std::vector<int64_t> vertex_offsets;
+  std::vector<std::vector<std::vector<uint8_t>>> components;
+};
+
+CornerArrays GetCornerArrays(const Mesh &mesh) {
+  CornerArrays arrays;
+  arrays.num_corners = mesh.num_faces() * 3;
+  const int num_attributes = mesh.num_attributes();
+  for (int i = 0; i < num_attributes; ++i) {
+    const PointAttribute *const att = mesh.attribute(i);
+    arrays.vertex_offsets.push_back(arrays.vertex_size);
+    arrays.vertex_size += att->byte_stride();
+  }
+  arrays.values.resize(num_attributes);
+  arrays.vertices.resize(arrays.num_corners * arrays.vertex_size);
+  arrays.components.resize(num_attributes);
+  for (int i = 0; i < num_attributes; ++i) {
+    const PointAttribute *const att = mesh.attribute(i);
+    const int64_t value_size = att->byte_stride();
+    const int component_size = DataTypeLength(att->data_type());
+    arrays.values[i].resize(arrays.num_corners * value_size);
+    arrays.components[i].assign(
+        att->num_components(),
+        std::vector<uint8_t>(arrays.num_corners * component_size));
+    for (uint32_t c = 0; c < arrays.num_corners; ++c) {
+      const uint8_t *const value = att->GetAddressOfMappedIndex(
+          mesh.face(FaceIndex(c / 3))[c % 3]);
+      memcpy(&arrays.values[i][c * value_size], value, value_size);
+      memcpy(&arrays.vertices[c * arrays.vertex_size +
+                              arrays.vertex_offsets[i]],
+             value, value_size);
+      for (int k = 0; k < att->num_components(); ++k) {
+        memcpy(&arrays.components[i][k][c * component_size],
+               value + k * component_size, component_size);
+      }
+    }
+  }
+  return arrays;
+}
+
+// Mesh building from the corners of a mesh, with a TriangleSoupMeshBuilder
+// call per face and attribute against a UD_MeshBulkBuilder fed with the
+// interleaved vertex buffer and a sequential index buffer. Both deduplicate.
+UD_KernelBenchmarkResult MeasureMeshBuilding(const std::string &name,
+                                             const Mesh &mesh,
+                                             int repetitions) {
+  UD_KernelBenchmarkResult result;
+  result.kernel = "mesh_builder";
+  result.name = name;
+  const CornerArrays arrays = GetCornerArrays(mesh);
+  const uint32_t num_faces = mesh.num_faces();
+  result.num_entries = static_cast<int>(arrays.num_corners);
+  std::vector<uint32_t> indices(arrays.num_corners);
+  for (uint32_t c = 0; c < arrays.num_corners; ++c) {
+    indices[c] = c;
+  }
+
+  std::unique_ptr<Mesh> reference;
+  result.reference_ms = TimeKernel(repetitions, [&]() {
+    TriangleSoupMeshBuilder builder;
+    builder.Start(num_faces);
+    for (int i = 0; i < mesh.num_attributes(); ++i) {
+      const PointAttribute *const att = mesh.attribute(i);
+      const int att_id = builder.AddAttribute(
+          att->attribute_type(), att->num_components(), att->data_type());
+      const int64_t value_size = att->byte_stride();
+      const uint8_t *const values = arrays.values[i].data();
+      for (FaceIndex f(0); f < num_faces; ++f) {
+        const uint8_t *const face_values = values + f.value() * 3 * value_size;
+        builder.SetAttributeValuesForFace(att_id, f, face_values,
+                                          face_values + value_size,
+                                          face_values + 2 * value_size);
+      }
+    }
+    reference = builder.Finalize();
+  });
+  std::unique_ptr<Mesh> optimized;
+  result.optimized_ms = TimeKernel(repetitions, [&]() {
+    UD_MeshBulkBuilder builder;
+    builder.Start(arrays.num_corners, num_faces, indices.data());
+    for (int i = 0; i < mesh.num_attributes(); ++i) {
+      const PointAttribute *const att = mesh.attribute(i);
+      builder.AddAttribute(att->attribute_type(), att->num_components(),
+                           att->data_type(), false,
+                           arrays.vertices.data() + arrays.vertex_offsets[i],
+                           arrays.vertex_size);
+    }
+    optimized = builder.Finalize(true);
+  });
+  result.identical = reference != nullptr && optimized != nullptr &&
+                     SameGeometry(*reference, *optimized);
+  return result;
+}
+
+// Point cloud building from the corners of a mesh, with a PointCloudBuilder
+// call per point and attribute against a UD_PointCloudBulkBuilder fed with an
+// array per component. Both deduplicate.
+UD_KernelBenchmarkResult MeasurePointCloudBuilding(const std::string &name,
+                                                   const Mesh &mesh,
+                                                   int repetitions) {
+  UD_KernelBenchmarkResult result;
+  result.kernel = "point_cloud_builder";
+  result.name = name;
+  const CornerArrays arrays = GetCornerArrays(mesh);
+  result.num_entries = static_cast<int>(arrays.num_corners);
+
+  std::unique_ptr<PointCloud> reference;
+  result.reference_ms = TimeKernel(repetitions, [&]() {
+    PointCloudBuilder builder;
+    builder.Start(arrays.num_corners);
+    for (int i = 0; i < mesh.num_attributes(); ++i) {
+      const PointAttribute *const att = mesh.attribute(i);
+      const int att_id = builder.AddAttribute(
+          att->attribute_type(), att->num_components(), att->data_type());
+      const int64_t value_size = att->byte_stride();
+      for (PointIndex p(0); p < arrays.num_corners; ++p) {
+        builder.SetAttributeValueForPoint(
+            att_id, p, &arrays.values[i][p.value() * value_size]);
+      }
+    }
+    reference = builder.Finalize(true);
+  });
+  std::unique_ptr<PointCloud> optimized;
+  std::vector<const void *> components;
+  result.optimized_ms = TimeKernel(repetitions, [&]() {
+    UD_PointCloudBulkBuilder builder;
+    builder.Start(arrays.num_corners);
+    for (int i = 0; i < mesh.num_attributes(); ++i) {
+      const PointAttribute *const att = mesh.attribute(i);
+      components.clear();
+      for (const std::vector<uint8_t> &component : arrays.components[i]) {
+        components.push_back(component.data());
+      }
+      builder.AddPlanarAttribute(att->attribute_type(), att->num_components(),
+                                 att->data_type(), false, components.data());
+    }
+    optimized = builder.Finalize(true);
+  });
+  result.identical = reference != nullptr && optimized != nullptr &&
+                     SamePoints(*reference, *optimized);
+  return result;
+}
+
+// Octahedral quantization of the normals and their conversion back to unit
+// vectors, with the per value OctahedronToolBox conversions against the bulk
+// conversions of OctahedronBulk.h.
+UD_KernelBenchmarkResult MeasureOctahedralNormals(const std::string &name,
+                                                  const Mesh &mesh,
+                                                  int repetitions) {
+  UD_KernelBenchmarkResult result;
+  result.kernel = "octahedral_normals";
+  result.name = name;
+  const PointAttribute *const att =
+      mesh.GetNamedAttribute(GeometryAttribute::NORMAL);
+  OctahedronToolBox tool_box;
+  if (att == nullptr || att->num_components() != 3 ||
+      !tool_box.SetQuantizationBits(kNormalQuantizationBits)) {
+    return result;
+  }
+  const int num_normals = static_cast<int>(att->size());
+  std::vector<float> normals(num_normals * 3);
+  for (AttributeValueIndex i(0); i < num_normals; ++i) {
+    att->ConvertValue<float>(i, 3, &normals[i.value() * 3]);
+  }
+  result.num_entries = num_normals;
+
+  std::vector<int32_t> reference_coords(num_normals * 2);
+  std::vector<float> reference_vectors(num_normals * 3);
+  result.reference_ms = TimeKernel(repetitions, [&]() {
+    for (int i = 0; i < num_normals; ++i) {
+      tool_box.FloatVectorToQuantizedOctahedralCoords(
+          &normals[i * 3], &reference_coords[i * 2],
+          &reference_coords[i * 2 + 1]);
+    }
+    for (int i = 0; i < num_normals; ++i) {
+      tool_box.QuantizedOctaherdalCoordsToUnitVector(
+          reference_coords[i * 2], reference_coords[i * 2 + 1],
+          &reference_vectors[i * 3]);
+    }
+  });
+  std::vector<int32_t> optimized_coords(num_normals * 2);
+  std::vector<float> optimized_vectors(num_normals * 3);
+  result.optimized_ms = TimeKernel(repetitions, [&]() {
+    UD_FloatVectorsToQuantizedOctahedralCoords(
+        tool_box, normals.data(), num_normals, optimized_coords.data());
+    UD_QuantizedOctahedralCoordsToUnitVectors(tool_box,
+                                              optimized_coords.data(),
+                                              num_normals,
+                                              optimized_vectors.data());
+  });
+  result.identical = optimized_coords == reference_coords &&
+                     optimized_vectors == reference_vectors;
+  return result;
+}
+
+}  // namespace
+
+UD_KernelBenchmark::UD_KernelBenchmark() : repetitions_(5) {}
+
+void UD_KernelBenchmark::AddSyntheticCorpus() {
+  for (int segments : {64, 256, 1024}) {
+    AddMesh("sphere_" + std::to_string(segments),
+            UD_Benchmark::CreateSphere(segments));
+  }
+}
+
+bool UD_KernelBenchmark::AddFile(const std::string &file_name) {
+  auto statusor = UD_ReadMeshFromFile(file_name);
+  if (!statusor.ok() || statusor.value()->num_faces() == 0) {
+    return false;
+  }
+  std::string name;
+  SplitPath(file_name, nullptr, &name);
+  AddMesh(name, std::move(statusor).value());
+  return true;
+}
+
+void UD_KernelBenchmark::AddMesh(const std::string &name,
+                                 std::unique_ptr<Mesh> mesh) {
+  if (mesh == nullptr) {
+    return;
+  }
+  CorpusEntry entry;
+  entry.name = name;
+  entry.mesh = std::move(mesh);
+  corpus_.push_back(std::move(entry));
+}
+
+std::vector<UD_KernelBenchmarkResult> UD_KernelBenchmark::Run() const {
+  std::vector<UD_KernelBenchmarkResult> results;
+  for (const CorpusEntry &entry : corpus_) {
+    results.push_back(
+        MeasureOctahedralNormals(entry.name, *entry.mesh, repetitions_));
+    results.push_back(
+        MeasureValueDeduplication(entry.name, *entry.mesh, repetitions_));
+    results.push_back(
+        MeasurePointIdDeduplication(entry.name, *entry.mesh, repetitions_));
+    results.push_back(
+        MeasureMeshBuilding(entry.name, *entry.mesh, repetitions_));
+    results.push_back(
+        MeasurePointCloudBuilding(entry.name, *entry.mesh, repetitions_));
+  }
+  return results;
+}
+
+}  // namespace draco
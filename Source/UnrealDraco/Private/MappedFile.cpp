@@ -0,0 +1,48 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "MappedFile.h"
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "draco/io/file_utils.h"
+
+namespace draco {
+
+UD_MappedFile::UD_MappedFile() : data_(nullptr), size_(0) {}
+
+UD_MappedFile::~UD_MappedFile() {
+  // The region must be unmapped before its file handle is closed.
+  region_.reset();
+  handle_.reset();
+}
+
+bool UD_MappedFile::Open(const std::string &file_name) {
+  region_.reset();
+  handle_.reset();
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+
+  IPlatformFile &platform_file = FPlatformFileManager::Get().GetPlatformFile();
+  handle_.reset(platform_file.OpenMapped(UTF8_TO_TCHAR(file_name.c_str())));
+  if (handle_ != nullptr && handle_->GetFileSize() > 0) {
+    region_.reset(handle_->MapRegion());
+    if (region_ != nullptr) {
+      data_ = reinterpret_cast<const char *>(region_->GetMappedPtr());
+      size_ = static_cast<size_t>(region_->GetMappedSize());
+      return true;
+    }
+  }
+  region_.reset();
+  handle_.reset();
+
+  if (!ReadFileToBuffer(file_name, &buffer_)) {
+    return false;
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+}
+
+}  // namespace draco
@@ -0,0 +1,405 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "MeshArchive.h"
+
+#include <cstring>
+#include <limits>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "MappedFile.h"
+#include "SymbolModel.h"
+#include "draco/compression/decode.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/hash_utils.h"
+#include "draco/core/varint_decoding.h"
+#include "draco/core/varint_encoding.h"
+#include "draco/io/file_utils.h"
+
+namespace draco {
+
+namespace {
+
+constexpr char kArchiveMagic[4] = {'U', 'D', 'A', 'R'};
+// Version 2 added the symbol model and coded members.
+constexpr uint32_t kArchiveVersion = 2;
+
+// The directory is followed by the symbol model of the archive.
+constexpr uint32_t kArchiveSymbolModelFlag = 1;
+
+struct ArchiveHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t num_members;
+  uint32_t flags;
+  // The members start right after the header, the directory follows them.
+  uint64_t directory_offset;
+};
+
+// Trains the symbol model of the bytes of all members. Its id is derived from
+// its probabilities, so that readers can register it without clashing with
+// the models of other archives.
+std::unique_ptr<UD_SymbolModel> TrainSymbolModel(const std::vector<char> &data) {
+  std::vector<uint64_t> frequencies(256, 0);
+  for (const char c : data) {
+    ++frequencies[static_cast<uint8_t>(c)];
+  }
+  const std::unique_ptr<UD_SymbolModel> model =
+      UD_SymbolModel::Train(0, frequencies.data(), 256);
+  if (model == nullptr) {
+    return nullptr;
+  }
+  EncoderBuffer table;
+  model->EncodeTable(&table);
+  const uint32_t id =
+      static_cast<uint32_t>(FingerprintString(table.data(), table.size()));
+  DecoderBuffer buffer;
+  buffer.Init(table.data(), table.size());
+  return UD_SymbolModel::DecodeTable(id, false, &buffer);
+}
+
+// Returns the model registered under the id of |model|, registering |model|
+// first when there is none. Returns nullptr when the id is taken by a
+// different model.
+const UD_SymbolModel *RegisterSymbolModel(
+    std::unique_ptr<UD_SymbolModel> model) {
+  UD_SymbolModelRegistry &registry = UD_SymbolModelRegistry::Get();
+  const uint32_t id = model->id();
+  EncoderBuffer table;
+  model->EncodeTable(&table);
+  registry.Register(std::move(model));
+  const UD_SymbolModel *const registered = registry.Find(id);
+  EncoderBuffer registered_table;
+  registered->EncodeTable(&registered_table);
+  if (registered_table.size() != table.size() ||
+      memcmp(registered_table.data(), table.data(), table.size()) != 0) {
+    return nullptr;
+  }
+  return registered;
+}
+
+StatusOr<UD_DecodedGeometry> DecodeGeometry(const char *data,
+                                            size_t data_size,
+                                            UD_DecodeCache *cache,
+                                            UD_DecodeStats *out_stats) {
+  Decoder decoder;
+  if (cache) {
+    return cache->Decode(data, data_size, &decoder, out_stats);
+  }
+  DecoderBuffer buffer;
+  buffer.Init(data, data_size);
+  UD_DecodedGeometry geometry;
+  if (out_stats) {
+    DRACO_ASSIGN_OR_RETURN(
+        std::unique_ptr<PointCloud> pc,
+        UD_DecodeWithStats(&buffer, *decoder.options(), out_stats));
+    if (out_stats->geometry_type == TRIANGULAR_MESH) {
+      geometry.mesh = static_cast<const Mesh *>(pc.get());
+    }
+    geometry.pc = std::move(pc);
+    return geometry;
+  }
+  DRACO_ASSIGN_OR_RETURN(const EncodedGeometryType geometry_type,
+                         Decoder::GetEncodedGeometryType(&buffer));
+  if (geometry_type == TRIANGULAR_MESH) {
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<Mesh> mesh,
+                           decoder.DecodeMeshFromBuffer(&buffer));
+    geometry.mesh = mesh.get();
+    geometry.pc = std::move(mesh);
+  } else {
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> pc,
+                           decoder.DecodePointCloudFromBuffer(&buffer));
+    geometry.pc = std::move(pc);
+  }
+  return geometry;
+}
+
+}  // namespace
+
+Status UD_MeshArchiveWriter::AddMember(const std::string &name,
+                                       const char *data, size_t data_size) {
+  if (name.empty()) {
+    return Status(Status::INVALID_PARAMETER, "Empty archive member name.");
+  }
+  if (!name_to_index_.emplace(name, num_members()).second) {
+    return Status(Status::INVALID_PARAMETER,
+                  "Duplicate archive member name: " + name);
+  }
+  names_.push_back(name);
+  sizes_.push_back(data_size);
+  data_.insert(data_.end(), data, data + data_size);
+  return OkStatus();
+}
+
+Status UD_MeshArchiveWriter::AddFile(const std::string &file_name) {
+  std::vector<char> data;
+  if (!ReadFileToBuffer(file_name, &data)) {
+    return Status(Status::IO_ERROR, "Unable to read " + file_name);
+  }
+  std::string folder;
+  std::string name;
+  SplitPath(file_name, &folder, &name);
+  const size_t extension = name.find_last_of('.');
+  if (extension != std::string::npos && extension > 0) {
+    name = name.substr(0, extension);
+  }
+  return AddMember(name, data.data(), data.size());
+}
+
+Status UD_MeshArchiveWriter::WriteToFile(const std::string &file_name) const {
+  EncoderBuffer buffer;
+  WriteToBuffer(&buffer);
+  if (!WriteBufferToFile(buffer.data(), buffer.size(), file_name)) {
+    return Status(Status::IO_ERROR, "Failed to write " + file_name);
+  }
+  return OkStatus();
+}
+
+void UD_MeshArchiveWriter::WriteToBuffer(EncoderBuffer *out_buffer) const {
+  std::unique_ptr<UD_SymbolModel> model;
+  if (train_symbol_model_ && !data_.empty()) {
+    model = TrainSymbolModel(data_);
+  }
+  // Members coded with the model, left empty for those stored as they are.
+  std::vector<EncoderBuffer> coded(num_members());
+  std::vector<size_t> offsets(num_members());
+  size_t offset = 0;
+  for (int i = 0; i < num_members(); ++i) {
+    offsets[i] = offset;
+    offset += sizes_[i];
+  }
+  if (model != nullptr) {
+    ParallelFor(num_members(), [&](int32 i) {
+      const uint8_t *const bytes =
+          reinterpret_cast<const uint8_t *>(data_.data()) + offsets[i];
+      const std::vector<uint32_t> symbols(bytes, bytes + sizes_[i]);
+      EncoderBuffer buffer;
+      // Only kept when it pays for the decoded size in the directory.
+      if (UD_EncodeSymbols(symbols.data(), static_cast<int>(symbols.size()),
+                           1, model.get(), nullptr, &buffer) &&
+          buffer.size() + 4 < sizes_[i]) {
+        coded[i] = std::move(buffer);
+      }
+    });
+  }
+  bool has_coded_members = false;
+  size_t members_size = 0;
+  for (int i = 0; i < num_members(); ++i) {
+    has_coded_members |= coded[i].size() > 0;
+    members_size += coded[i].size() > 0 ? coded[i].size() : sizes_[i];
+  }
+
+  ArchiveHeader header;
+  memcpy(header.magic, kArchiveMagic, sizeof(kArchiveMagic));
+  header.version = kArchiveVersion;
+  header.num_members = num_members();
+  header.flags = has_coded_members ? kArchiveSymbolModelFlag : 0;
+  header.directory_offset = sizeof(header) + members_size;
+  out_buffer->Encode(header);
+  for (int i = 0; i < num_members(); ++i) {
+    if (coded[i].size() > 0) {
+      out_buffer->Encode(coded[i].data(), coded[i].size());
+    } else {
+      out_buffer->Encode(data_.data() + offsets[i], sizes_[i]);
+    }
+  }
+  // The lowest bit of the size tells coded members, which are followed by the
+  // size of their bitstream.
+  for (int i = 0; i < num_members(); ++i) {
+    if (coded[i].size() > 0) {
+      EncodeVarint(static_cast<uint64_t>(coded[i].size()) << 1 | 1,
+                   out_buffer);
+      EncodeVarint(static_cast<uint64_t>(sizes_[i]), out_buffer);
+    } else {
+      EncodeVarint(static_cast<uint64_t>(sizes_[i]) << 1, out_buffer);
+    }
+    EncodeVarint(static_cast<uint32_t>(names_[i].size()), out_buffer);
+    out_buffer->Encode(names_[i].data(), names_[i].size());
+  }
+  if (has_coded_members) {
+    model->Encode(out_buffer);
+  }
+}
+
+std::unique_ptr<UD_MeshArchiveReader> UD_MeshArchiveReader::Open(
+    const std::string &file_name) {
+  std::unique_ptr<UD_MappedFile> file(new UD_MappedFile());
+  if (!file->Open(file_name)) {
+    return nullptr;
+  }
+  const char *const data = file->data();
+  const size_t data_size = file->size();
+  std::unique_ptr<UD_MeshArchiveReader> reader(
+      new UD_MeshArchiveReader(std::move(file), data, data_size));
+  if (!reader->ReadDirectory()) {
+    return nullptr;
+  }
+  return reader;
+}
+
+std::unique_ptr<UD_MeshArchiveReader> UD_MeshArchiveReader::OpenBuffer(
+    const char *data, size_t data_size) {
+  std::unique_ptr<UD_MeshArchiveReader> reader(
+      new UD_MeshArchiveReader(nullptr, data, data_size));
+  if (!reader->ReadDirectory()) {
+    return nullptr;
+  }
+  return reader;
+}
+
+UD_MeshArchiveReader::UD_MeshArchiveReader(std::unique_ptr<UD_MappedFile> file,
+                                           const char *data, size_t data_size)
+    : file_(std::move(file)),
+      data_(data),
+      data_size_(data_size),
+      cache_(nullptr) {}
+
+UD_MeshArchiveReader::~UD_MeshArchiveReader() = default;
+
+bool UD_MeshArchiveReader::ReadDirectory() {
+  DecoderBuffer buffer;
+  buffer.Init(data_, data_size_);
+  ArchiveHeader header;
+  if (!buffer.Decode(&header) ||
+      memcmp(header.magic, kArchiveMagic, sizeof(kArchiveMagic)) != 0 ||
+      header.version < 1 || header.version > kArchiveVersion ||
+      header.directory_offset < sizeof(header) ||
+      header.directory_offset > data_size_) {
+    return false;
+  }
+  DecoderBuffer directory;
+  directory.Init(data_ + header.directory_offset,
+                 data_size_ - header.directory_offset);
+  size_t offset = sizeof(header);
+  for (uint32_t i = 0; i < header.num_members; ++i) {
+    uint64_t size;
+    uint64_t bitstream_size = 0;
+    uint32_t name_length;
+    if (!DecodeVarint(&size, &directory)) {
+      return false;
+    }
+    if (header.version >= 2) {
+      if ((size & 1) && (!DecodeVarint(&bitstream_size, &directory) ||
+                         bitstream_size == 0 ||
+                         bitstream_size > std::numeric_limits<int>::max())) {
+        return false;
+      }
+      size >>= 1;
+    }
+    if (size > header.directory_offset - offset ||
+        !DecodeVarint(&name_length, &directory) ||
+        name_length > directory.remaining_size()) {
+      return false;
+    }
+    std::string name(directory.data_head(), name_length);
+    directory.Advance(name_length);
+    if (!name_to_index_.emplace(name, static_cast<int>(i)).second) {
+      return false;
+    }
+    names_.push_back(std::move(name));
+    offsets_.push_back(offset);
+    sizes_.push_back(static_cast<size_t>(size));
+    bitstream_sizes_.push_back(static_cast<size_t>(bitstream_size));
+    offset += static_cast<size_t>(size);
+  }
+  if (header.version >= 2 && (header.flags & kArchiveSymbolModelFlag)) {
+    std::unique_ptr<UD_SymbolModel> model = UD_SymbolModel::Decode(&directory);
+    if (model == nullptr || RegisterSymbolModel(std::move(model)) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int UD_MeshArchiveReader::FindMember(const std::string &name) const {
+  const auto it = name_to_index_.find(name);
+  return it == name_to_index_.end() ? -1 : it->second;
+}
+
+Status UD_MeshArchiveReader::ReadMemberBitstream(
+    int index, std::vector<char> *out_bitstream,
+    UD_DecodeStats *out_stats) const {
+  if (index < 0 || index >= num_members()) {
+    return Status(Status::INVALID_PARAMETER, "Invalid archive member index.");
+  }
+  if (!member_coded(index)) {
+    out_bitstream->assign(member_data(index),
+                          member_data(index) + member_size(index));
+    return OkStatus();
+  }
+  const double start = FPlatformTime::Seconds();
+  std::vector<uint32_t> symbols(bitstream_sizes_[index]);
+  DecoderBuffer buffer;
+  buffer.Init(member_data(index), member_size(index));
+  if (!UD_DecodeSymbols(static_cast<uint32_t>(symbols.size()), 1, &buffer,
+                        symbols.data(), out_stats)) {
+    return Status(Status::DRACO_ERROR,
+                  "Failed to decode archive member " + names_[index]);
+  }
+  out_bitstream->assign(symbols.begin(), symbols.end());
+  if (out_stats) {
+    out_stats->symbols_ms += (FPlatformTime::Seconds() - start) * 1000.0;
+    out_stats->symbols_bytes += static_cast<int64_t>(member_size(index));
+  }
+  return OkStatus();
+}
+
+StatusOr<UD_DecodedGeometry> UD_MeshArchiveReader::DecodeMember(
+    int index, UD_DecodeStats *out_stats) const {
+  if (index < 0 || index >= num_members()) {
+    return Status(Status::INVALID_PARAMETER, "Invalid archive member index.");
+  }
+  if (!member_coded(index)) {
+    return DecodeGeometry(member_data(index), member_size(index), cache_,
+                          out_stats);
+  }
+  UD_DecodeStats symbol_stats;
+  std::vector<char> bitstream;
+  DRACO_RETURN_IF_ERROR(ReadMemberBitstream(
+      index, &bitstream, out_stats ? &symbol_stats : nullptr));
+  auto statusor =
+      DecodeGeometry(bitstream.data(), bitstream.size(), cache_, out_stats);
+  // The geometry decode starts its stats afresh.
+  if (statusor.ok() && out_stats) {
+    out_stats->symbols_ms = symbol_stats.symbols_ms;
+    out_stats->symbols_bytes = symbol_stats.symbols_bytes;
+    out_stats->symbol_table_hits = symbol_stats.symbol_table_hits;
+    out_stats->symbol_table_misses = symbol_stats.symbol_table_misses;
+    out_stats->total_ms += symbol_stats.symbols_ms;
+  }
+  return statusor;
+}
+
+StatusOr<UD_DecodedGeometry> UD_MeshArchiveReader::DecodeMember(
+    const std::string &name, UD_DecodeStats *out_stats) const {
+  const int index = FindMember(name);
+  if (index < 0) {
+    return Status(Status::INVALID_PARAMETER, "No archive member " + name);
+  }
+  return DecodeMember(index, out_stats);
+}
+
+Status UD_MeshArchiveReader::DecodeMembers(
+    const std::vector<int> &indices,
+    std::vector<UD_DecodedGeometry> *out_geometry) const {
+  const int32 num_indices = static_cast<int32>(indices.size());
+  out_geometry->assign(num_indices, UD_DecodedGeometry());
+  std::vector<Status> statuses(num_indices);
+  ParallelFor(num_indices, [&](int32 i) {
+    auto statusor = DecodeMember(indices[i]);
+    if (statusor.ok()) {
+      (*out_geometry)[i] = std::move(statusor).value();
+    } else {
+      statuses[i] = statusor.status();
+    }
+  });
+  for (const Status &status : statuses) {
+    if (!status.ok()) {
+      out_geometry->clear();
+      return status;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,158 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "MeshReader.h"
+
+#include "BinaryMesh.h"
+#include "GlbReader.h"
+#include "ObjReader.h"
+#include "PlyReader.h"
+#include "draco/compression/decode.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/io/file_utils.h"
+#include "draco/io/mesh_io.h"
+#include "draco/io/ply_decoder.h"
+#include "draco/io/point_cloud_io.h"
+
+namespace draco {
+
+StatusOr<std::unique_ptr<Mesh>> UD_ReadMeshFromFile(
+    const std::string &file_name) {
+  const std::string extension = LowercaseFileExtension(file_name);
+  if (extension == "obj") {
+    UD_ObjReader reader;
+    auto statusor = reader.ReadFromFile(file_name);
+    if (statusor.ok()) {
+      return statusor;
+    }
+  } else if (extension == "ply") {
+    UD_PlyReader reader;
+    auto statusor = reader.ReadMeshFromFile(file_name);
+    if (statusor.ok()) {
+      return statusor;
+    }
+  } else if (extension == "glb") {
+    UD_GlbReader reader;
+    return reader.ReadFromFile(file_name);
+  } else if (extension == "udm") {
+    const std::unique_ptr<UD_BinaryMeshReader> reader =
+        UD_BinaryMeshReader::Open(file_name);
+    if (!reader || !reader->is_mesh()) {
+      return Status(Status::DRACO_ERROR, "Invalid binary mesh file.");
+    }
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> pc,
+                           reader->ReadGeometry());
+    return std::unique_ptr<Mesh>(static_cast<Mesh *>(pc.release()));
+  }
+  return ReadMeshFromFile(file_name);
+}
+
+StatusOr<std::unique_ptr<PointCloud>> UD_ReadPointCloudFromFile(
+    const std::string &file_name) {
+  const std::string extension = LowercaseFileExtension(file_name);
+  if (extension == "ply") {
+    UD_PlyReader reader;
+    auto statusor = reader.ReadPointCloudFromFile(file_name);
+    if (statusor.ok()) {
+      return statusor;
+    }
+  } else if (extension == "glb") {
+    UD_GlbReader reader;
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> pc,
+                           reader.ReadFromFile(file_name));
+    return pc;
+  } else if (extension == "udm") {
+    const std::unique_ptr<UD_BinaryMeshReader> reader =
+        UD_BinaryMeshReader::Open(file_name);
+    if (!reader) {
+      return Status(Status::DRACO_ERROR, "Invalid binary mesh file.");
+    }
+    return reader->ReadGeometry();
+  }
+  return ReadPointCloudFromFile(file_name);
+}
+
+StatusOr<std::unique_ptr<Mesh>> UD_ReadMeshFromBuffer(
+    const std::string &file_name, const char *data, size_t data_size) {
+  const std::string extension = LowercaseFileExtension(file_name);
+  if (extension == "obj") {
+    UD_ObjReader reader;
+    auto statusor = reader.ReadFromBuffer(data, data_size, file_name);
+    if (statusor.ok()) {
+      return statusor;
+    }
+    return ReadMeshFromFile(file_name);
+  }
+  if (extension == "ply") {
+    std::unique_ptr<Mesh> mesh(new Mesh());
+    UD_PlyReader reader;
+    if (reader.ReadFromBuffer(data, data_size, mesh.get(), mesh.get()).ok()) {
+      return mesh;
+    }
+    mesh.reset(new Mesh());
+    DecoderBuffer buffer;
+    buffer.Init(data, data_size);
+    PlyDecoder decoder;
+    DRACO_RETURN_IF_ERROR(decoder.DecodeFromBuffer(&buffer, mesh.get()));
+    return mesh;
+  }
+  if (extension == "glb") {
+    UD_GlbReader reader;
+    return reader.ReadFromBuffer(data, data_size);
+  }
+  if (extension == "udm") {
+    const std::unique_ptr<UD_BinaryMeshReader> reader =
+        UD_BinaryMeshReader::OpenBuffer(data, data_size);
+    if (!reader || !reader->is_mesh()) {
+      return Status(Status::DRACO_ERROR, "Invalid binary mesh file.");
+    }
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> pc,
+                           reader->ReadGeometry());
+    return std::unique_ptr<Mesh>(static_cast<Mesh *>(pc.release()));
+  }
+  // Other files are Draco bitstreams, as in ReadMeshFromFile().
+  DecoderBuffer buffer;
+  buffer.Init(data, data_size);
+  Decoder decoder;
+  return decoder.DecodeMeshFromBuffer(&buffer);
+}
+
+StatusOr<std::unique_ptr<PointCloud>> UD_ReadPointCloudFromBuffer(
+    const std::string &file_name, const char *data, size_t data_size) {
+  const std::string extension = LowercaseFileExtension(file_name);
+  if (extension == "obj") {
+    return ReadPointCloudFromFile(file_name);
+  }
+  if (extension == "ply") {
+    std::unique_ptr<PointCloud> pc(new PointCloud());
+    UD_PlyReader reader;
+    if (reader.ReadFromBuffer(data, data_size, pc.get(), nullptr).ok()) {
+      return pc;
+    }
+    pc.reset(new PointCloud());
+    DecoderBuffer buffer;
+    buffer.Init(data, data_size);
+    PlyDecoder decoder;
+    DRACO_RETURN_IF_ERROR(decoder.DecodeFromBuffer(&buffer, pc.get()));
+    return pc;
+  }
+  if (extension == "glb") {
+    UD_GlbReader reader;
+    DRACO_ASSIGN_OR_RETURN(std::unique_ptr<PointCloud> pc,
+                           reader.ReadFromBuffer(data, data_size));
+    return pc;
+  }
+  if (extension == "udm") {
+    const std::unique_ptr<UD_BinaryMeshReader> reader =
+        UD_BinaryMeshReader::OpenBuffer(data, data_size);
+    if (!reader) {
+      return Status(Status::DRACO_ERROR, "Invalid binary mesh file.");
+    }
+    return reader->ReadGeometry();
+  }
+  DecoderBuffer buffer;
+  buffer.Init(data, data_size);
+  Decoder decoder;
+  return decoder.DecodePointCloudFromBuffer(&buffer);
+}
+
+}  // namespace draco
@@ -0,0 +1,727 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "ObjReader.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "MappedFile.h"
+#include "ParallelDeduplication.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/io/file_utils.h"
+#include "draco/io/parser_utils.h"
+
+namespace draco {
+
+namespace {
+
+constexpr size_t kDefaultChunkSize = 4 << 20;
+
+enum ObjStatementType {
+  OBJ_USEMTL = 0,
+  OBJ_MTLLIB,
+  OBJ_OBJECT,
+};
+
+// Definitions found in one line range by the counting pass.
+struct ObjChunk {
+  const char *begin = nullptr;
+  const char *end = nullptr;
+  bool ok = true;
+
+  int64_t num_positions = 0;
+  int64_t num_tex_coords = 0;
+  int64_t num_normals = 0;
+  int64_t num_faces = 0;
+  // usemtl, mtllib and o statements in file order.
+  std::vector<std::pair<ObjStatementType, std::string>> statements;
+
+  // Set by the merge step: values parsed before this range and the material
+  // and sub-object that are active at its start.
+  int64_t first_position = 0;
+  int64_t first_tex_coord = 0;
+  int64_t first_normal = 0;
+  int64_t first_face = 0;
+  int start_material = 0;
+  int start_sub_object = 0;
+};
+
+// Attributes of the output mesh the parsing pass writes into.
+struct ObjTargets {
+  Mesh *mesh = nullptr;
+  int64_t num_positions = 0;
+  int64_t num_tex_coords = 0;
+  int64_t num_normals = 0;
+  PointAttribute *pos_att = nullptr;
+  PointAttribute *tex_att = nullptr;
+  PointAttribute *norm_att = nullptr;
+  PointAttribute *material_att = nullptr;
+  PointAttribute *sub_obj_att = nullptr;
+  const std::unordered_map<std::string, int> *material_name_to_id = nullptr;
+  const std::unordered_map<std::string, int> *obj_name_to_id = nullptr;
+};
+
+// Characters isspace() accepts in the "C" locale, which parser_utils uses.
+inline bool IsSpace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char *SkipSpaces(const char *p, const char *end) {
+  while (p < end && IsSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+inline bool StartsWith(const char *p, const char *end, const char *keyword,
+                       size_t length) {
+  return static_cast<size_t>(end - p) >= length &&
+         std::memcmp(p, keyword, length) == 0;
+}
+
+// Rest of the line after leading whitespace, up to the first '\r' or '\n'.
+// Matches parser::ParseLine() as used for material names.
+std::string ParseName(const char *p, const char *end) {
+  p = SkipSpaces(p, end);
+  const char *name_end = p;
+  while (name_end < end && *name_end != '\r') {
+    ++name_end;
+  }
+  return std::string(p, name_end);
+}
+
+// First whitespace delimited token after leading whitespace. Matches
+// parser::ParseString().
+std::string ParseToken(const char *p, const char *end) {
+  p = SkipSpaces(p, end);
+  const char *token_end = p;
+  while (token_end < end && !IsSpace(*token_end)) {
+    ++token_end;
+  }
+  return std::string(p, token_end);
+}
+
+// Same as parser::ParseUnsignedInt() and parser::ParseSignedInt().
+bool ParseUnsignedInt(const char **pp, const char *end, uint32_t *value) {
+  const char *p = *pp;
+  uint32_t v = 0;
+  bool have_digits = false;
+  while (p < end && IsDigit(*p)) {
+    v *= 10;
+    v += (*p - '0');
+    ++p;
+    have_digits = true;
+  }
+  if (!have_digits) {
+    return false;
+  }
+  *pp = p;
+  *value = v;
+  return true;
+}
+
+bool ParseSignedInt(const char **pp, const char *end, int32_t *value) {
+  const char *p = *pp;
+  if (p >= end) {
+    return false;
+  }
+  const int sign = parser::GetSignValue(*p);
+  if (sign != 0) {
+    ++p;
+  }
+  uint32_t v;
+  if (!ParseUnsignedInt(&p, end, &v)) {
+    return false;
+  }
+  *value = (sign < 0) ? -v : v;
+  *pp = p;
+  return true;
+}
+
+// Uses the same arithmetic as parser::ParseFloat() so that the parsed values
+// match ObjDecoder bit for bit.
+bool ParseFloat(const char **pp, const char *end, float *value) {
+  const char *p = SkipSpaces(*pp, end);
+  if (p >= end) {
+    return false;
+  }
+  int sign = parser::GetSignValue(*p);
+  if (sign != 0) {
+    ++p;
+  } else {
+    sign = 1;
+  }
+
+  bool have_digits = false;
+  double v = 0.0;
+  while (p < end && IsDigit(*p)) {
+    v *= 10.0;
+    v += (*p - '0');
+    ++p;
+    have_digits = true;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    double fraction = 1.0;
+    while (p < end && IsDigit(*p)) {
+      fraction *= 0.1;
+      v += (*p - '0') * fraction;
+      ++p;
+      have_digits = true;
+    }
+  }
+
+  if (!have_digits) {
+    const char *text = p;
+    while (p < end && !IsSpace(*p)) {
+      ++p;
+    }
+    const std::string word(text, p);
+    if (word == "inf" || word == "Inf") {
+      v = std::numeric_limits<double>::infinity();
+    } else if (word == "nan" || word == "NaN") {
+      v = nan("");
+    } else {
+      return false;
+    }
+  } else if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    int32_t exponent = 0;
+    if (!ParseSignedInt(&p, end, &exponent)) {
+      return false;
+    }
+    v *= pow(10.0, exponent);
+  }
+
+  *value = (sign < 0) ? -v : v;
+  *pp = p;
+  return true;
+}
+
+// Same as ObjDecoder::ParseVertexIndices().
+bool ParseVertexIndices(const char **pp, const char *end,
+                        std::array<int32_t, 3> *out_indices) {
+  const char *p = *pp;
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  if (!ParseSignedInt(&p, end, &(*out_indices)[0]) ||
+      (*out_indices)[0] == 0) {
+    return false;
+  }
+  (*out_indices)[1] = (*out_indices)[2] = 0;
+  *pp = p;
+  if (p >= end || *p != '/') {
+    return true;
+  }
+  ++p;
+  if (p >= end) {
+    return false;
+  }
+  if (*p != '/') {
+    if (!ParseSignedInt(&p, end, &(*out_indices)[1]) ||
+        (*out_indices)[1] == 0) {
+      return false;
+    }
+  }
+  if (p < end && *p == '/') {
+    ++p;
+    if (!ParseSignedInt(&p, end, &(*out_indices)[2]) ||
+        (*out_indices)[2] == 0) {
+      return false;
+    }
+  }
+  *pp = p;
+  return true;
+}
+
+// Number of whitespace separated entries on a face line.
+int CountFaceEntries(const char *p, const char *end) {
+  int num_entries = 0;
+  while (p < end) {
+    p = SkipSpaces(p, end);
+    if (p == end) {
+      break;
+    }
+    ++num_entries;
+    while (p < end && !IsSpace(*p)) {
+      ++p;
+    }
+  }
+  return num_entries;
+}
+
+// Resolves a one based or relative OBJ index to an attribute value index.
+// Returns false for indices outside of the parsed values.
+bool ResolveIndex(int32_t index, int64_t num_parsed, int64_t num_values,
+                  AttributeValueIndex *out_index) {
+  int64_t value = 0;
+  if (index > 0) {
+    value = index - 1;
+  } else if (index < 0) {
+    value = num_parsed + index;
+  }
+  if (value < 0 || value >= num_values) {
+    return false;
+  }
+  *out_index = AttributeValueIndex(static_cast<uint32_t>(value));
+  return true;
+}
+
+// Counting pass over one line range. Mirrors ObjDecoder::ParseDefinition()
+// in counting mode.
+void CountChunk(ObjChunk *chunk) {
+  const char *p = chunk->begin;
+  while (p < chunk->end) {
+    const char *line_end = static_cast<const char *>(
+        std::memchr(p, '\n', chunk->end - p));
+    if (line_end == nullptr) {
+      line_end = chunk->end;
+    }
+    const char *c = SkipSpaces(p, line_end);
+    p = line_end + 1;
+    if (c == line_end || *c == '#') {
+      continue;
+    }
+    const size_t length = line_end - c;
+    if (length >= 2 && c[0] == 'v' && c[1] == ' ') {
+      ++chunk->num_positions;
+    } else if (length >= 2 && c[0] == 'v' && c[1] == 'n') {
+      ++chunk->num_normals;
+    } else if (length >= 2 && c[0] == 'v' && c[1] == 't') {
+      ++chunk->num_tex_coords;
+    } else if (c[0] == 'f') {
+      const int num_entries = CountFaceEntries(c + 1, line_end);
+      if (num_entries < 3 || num_entries > 4) {
+        chunk->ok = false;
+        return;
+      }
+      chunk->num_faces += num_entries - 2;
+    } else if (StartsWith(c, line_end, "usemtl", 6)) {
+      std::string name = ParseName(c + 6, line_end);
+      if (name.empty()) {
+        // ObjDecoder consumes the following line in this case.
+        chunk->ok = false;
+        return;
+      }
+      chunk->statements.emplace_back(OBJ_USEMTL, std::move(name));
+    } else if (StartsWith(c, line_end, "mtllib", 6)) {
+      chunk->statements.emplace_back(OBJ_MTLLIB, ParseToken(c + 6, line_end));
+    } else if (StartsWith(c, line_end, "o ", 2)) {
+      std::string name = ParseToken(c + 1, line_end);
+      if (!name.empty()) {
+        chunk->statements.emplace_back(OBJ_OBJECT, std::move(name));
+      }
+    }
+  }
+}
+
+// Parsing pass over one line range. Values are written at the offsets found
+// by the merge step.
+void ParseChunk(const ObjTargets &targets, ObjChunk *chunk) {
+  int64_t num_positions = chunk->first_position;
+  int64_t num_tex_coords = chunk->first_tex_coord;
+  int64_t num_normals = chunk->first_normal;
+  int64_t num_faces = chunk->first_face;
+  int material = chunk->start_material;
+  int sub_object = chunk->start_sub_object;
+
+  float *const pos_data =
+      targets.pos_att
+          ? reinterpret_cast<float *>(targets.pos_att->buffer()->data())
+          : nullptr;
+  float *const tex_data =
+      targets.tex_att
+          ? reinterpret_cast<float *>(targets.tex_att->buffer()->data())
+          : nullptr;
+  float *const norm_data =
+      targets.norm_att
+          ? reinterpret_cast<float *>(targets.norm_att->buffer()->data())
+          : nullptr;
+
+  // Same as ObjDecoder::MapPointToVertexIndices().
+  auto map_point = [&](PointIndex point,
+                       const std::array<int32_t, 3> &indices) -> bool {
+    AttributeValueIndex value;
+    if (!ResolveIndex(indices[0], num_positions, targets.num_positions,
+                      &value)) {
+      return false;
+    }
+    targets.pos_att->SetPointMapEntry(point, value);
+    if (targets.tex_att) {
+      if (!ResolveIndex(indices[1], num_tex_coords, targets.num_tex_coords,
+                        &value)) {
+        return false;
+      }
+      targets.tex_att->SetPointMapEntry(point, value);
+    }
+    if (targets.norm_att) {
+      if (!ResolveIndex(indices[2], num_normals, targets.num_normals,
+                        &value)) {
+        return false;
+      }
+      targets.norm_att->SetPointMapEntry(point, value);
+    }
+    if (targets.material_att) {
+      targets.material_att->SetPointMapEntry(point,
+                                             AttributeValueIndex(material));
+    }
+    if (targets.sub_obj_att) {
+      targets.sub_obj_att->SetPointMapEntry(point,
+                                            AttributeValueIndex(sub_object));
+    }
+    return true;
+  };
+
+  const char *p = chunk->begin;
+  while (p < chunk->end) {
+    const char *line_end = static_cast<const char *>(
+        std::memchr(p, '\n', chunk->end - p));
+    if (line_end == nullptr) {
+      line_end = chunk->end;
+    }
+    const char *c = SkipSpaces(p, line_end);
+    p = line_end + 1;
+    if (c == line_end || *c == '#') {
+      continue;
+    }
+    const size_t length = line_end - c;
+    if (length >= 2 && c[0] == 'v' && c[1] == ' ') {
+      const char *q = c + 2;
+      float *const out = pos_data + 3 * num_positions;
+      for (int i = 0; i < 3; ++i) {
+        if (!ParseFloat(&q, line_end, out + i)) {
+          chunk->ok = false;
+          return;
+        }
+      }
+      ++num_positions;
+    } else if (length >= 2 && c[0] == 'v' && c[1] == 'n') {
+      const char *q = c + 2;
+      float *const out = norm_data + 3 * num_normals;
+      for (int i = 0; i < 3; ++i) {
+        if (!ParseFloat(&q, line_end, out + i)) {
+          chunk->ok = false;
+          return;
+        }
+      }
+      ++num_normals;
+    } else if (length >= 2 && c[0] == 'v' && c[1] == 't') {
+      const char *q = c + 2;
+      float *const out = tex_data + 2 * num_tex_coords;
+      for (int i = 0; i < 2; ++i) {
+        if (!ParseFloat(&q, line_end, out + i)) {
+          chunk->ok = false;
+          return;
+        }
+      }
+      ++num_tex_coords;
+    } else if (c[0] == 'f') {
+      const char *q = c + 1;
+      std::array<int32_t, 3> indices[4];
+      int num_valid_indices = 0;
+      for (int i = 0; i < 4; ++i) {
+        if (!ParseVertexIndices(&q, line_end, &indices[i])) {
+          if (i == 3) {
+            break;
+          }
+          chunk->ok = false;
+          return;
+        }
+        ++num_valid_indices;
+      }
+      // Quads are split into (0, 1, 2) and (0, 2, 3).
+      const int num_triangles = num_valid_indices - 2;
+      if (num_faces + num_triangles >
+          chunk->first_face + chunk->num_faces) {
+        chunk->ok = false;
+        return;
+      }
+      for (int t = 0; t < num_triangles; ++t) {
+        const int corners[3] = {0, t + 1, t + 2};
+        Mesh::Face face;
+        for (int i = 0; i < 3; ++i) {
+          face[i] = PointIndex(static_cast<uint32_t>(3 * num_faces + i));
+          if (!map_point(face[i], indices[corners[i]])) {
+            chunk->ok = false;
+            return;
+          }
+        }
+        targets.mesh->SetFace(FaceIndex(static_cast<uint32_t>(num_faces)),
+                              face);
+        ++num_faces;
+      }
+    } else if (StartsWith(c, line_end, "usemtl", 6)) {
+      if (targets.material_att) {
+        const auto it =
+            targets.material_name_to_id->find(ParseName(c + 6, line_end));
+        if (it != targets.material_name_to_id->end()) {
+          material = it->second;
+        }
+      }
+    } else if (StartsWith(c, line_end, "o ", 2)) {
+      const std::string name = ParseToken(c + 1, line_end);
+      const auto it = targets.obj_name_to_id->find(name);
+      if (it != targets.obj_name_to_id->end()) {
+        sub_object = it->second;
+      }
+    }
+  }
+  if (num_faces != chunk->first_face + chunk->num_faces) {
+    chunk->ok = false;
+  }
+}
+
+// Registers the materials of a material library the way
+// ObjDecoder::ParseMaterialFile() does. Missing files are ignored.
+void ParseMaterialFile(const std::string &file_name,
+                       std::unordered_map<std::string, int> *name_to_id,
+                       int *num_materials) {
+  std::vector<char> data;
+  if (!ReadFileToBuffer(file_name, &data)) {
+    return;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(data.data(), data.size());
+  while (true) {
+    parser::SkipWhitespace(&buffer);
+    char c;
+    if (!buffer.Peek(&c)) {
+      break;
+    }
+    std::array<char, 6> keyword;
+    if (c != '#' && buffer.Peek(&keyword) &&
+        std::memcmp(&keyword[0], "newmtl", 6) == 0) {
+      buffer.Advance(6);
+      parser::SkipWhitespace(&buffer);
+      std::string name;
+      parser::ParseLine(&buffer, &name);
+      if (!name.empty()) {
+        (*name_to_id)[name] = (*num_materials)++;
+      }
+      continue;
+    }
+    parser::SkipLine(&buffer);
+  }
+}
+
+// Generic attribute holding one id per material or sub-object, typed like
+// ObjDecoder does.
+int AddIdAttribute(int num_ids, Mesh *mesh) {
+  GeometryAttribute va;
+  if (num_ids < 256) {
+    va.Init(GeometryAttribute::GENERIC, nullptr, 1, DT_UINT8, false, 1, 0);
+  } else if (num_ids < (1 << 16)) {
+    va.Init(GeometryAttribute::GENERIC, nullptr, 1, DT_UINT16, false, 2, 0);
+  } else {
+    va.Init(GeometryAttribute::GENERIC, nullptr, 1, DT_UINT32, false, 4, 0);
+  }
+  const int att_id = mesh->AddAttribute(va, false, num_ids);
+  for (int i = 0; i < num_ids; ++i) {
+    mesh->attribute(att_id)->SetAttributeValue(AttributeValueIndex(i), &i);
+  }
+  return att_id;
+}
+
+}  // namespace
+
+UD_ObjReader::UD_ObjReader()
+    : chunk_size_(kDefaultChunkSize), deduplicate_input_values_(true) {}
+
+StatusOr<std::unique_ptr<Mesh>> UD_ObjReader::ReadFromFile(
+    const std::string &file_name) {
+  UD_MappedFile file;
+  if (!file.Open(file_name)) {
+    return Status(Status::IO_ERROR, "Unable to read input file.");
+  }
+  return ReadFromBuffer(file.data(), file.size(), file_name);
+}
+
+StatusOr<std::unique_ptr<Mesh>> UD_ObjReader::ReadFromBuffer(
+    const char *data, size_t data_size) {
+  return ReadFromBuffer(data, data_size, std::string());
+}
+
+StatusOr<std::unique_ptr<Mesh>> UD_ObjReader::ReadFromBuffer(
+    const char *data, size_t data_size, const std::string &file_name) {
+  // Split the input into ranges that start at the beginning of a line.
+  std::vector<ObjChunk> chunks;
+  const char *const data_end = data + data_size;
+  const char *begin = data;
+  while (begin < data_end) {
+    const char *end = data_end;
+    if (static_cast<size_t>(data_end - begin) > chunk_size_) {
+      const char *line_end = static_cast<const char *>(std::memchr(
+          begin + chunk_size_, '\n', data_end - begin - chunk_size_));
+      if (line_end != nullptr) {
+        end = line_end + 1;
+      }
+    }
+    ObjChunk chunk;
+    chunk.begin = begin;
+    chunk.end = end;
+    chunks.push_back(std::move(chunk));
+    begin = end;
+  }
+  const int32 num_chunks = static_cast<int32>(chunks.size());
+
+  ParallelFor(num_chunks, [&](int32 index) { CountChunk(&chunks[index]); });
+
+  // Merge the counts in file order and replay the material and object
+  // statements to assign ids in order of first appearance.
+  std::unordered_map<std::string, int> material_name_to_id;
+  std::unordered_map<std::string, int> obj_name_to_id;
+  int num_materials = 0;
+  int64_t num_positions = 0;
+  int64_t num_tex_coords = 0;
+  int64_t num_normals = 0;
+  int64_t num_faces = 0;
+  const std::string *last_material = nullptr;
+  const std::string *last_object = nullptr;
+  std::vector<std::pair<const std::string *, const std::string *>>
+      chunk_start_names(chunks.size());
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    ObjChunk &chunk = chunks[i];
+    if (!chunk.ok) {
+      return Status(Status::DRACO_ERROR, "Unsupported OBJ definition.");
+    }
+    chunk.first_position = num_positions;
+    chunk.first_tex_coord = num_tex_coords;
+    chunk.first_normal = num_normals;
+    chunk.first_face = num_faces;
+    chunk_start_names[i] = std::make_pair(last_material, last_object);
+    num_positions += chunk.num_positions;
+    num_tex_coords += chunk.num_tex_coords;
+    num_normals += chunk.num_normals;
+    num_faces += chunk.num_faces;
+    for (const auto &statement : chunk.statements) {
+      const std::string &name = statement.second;
+      if (statement.first == OBJ_USEMTL) {
+        if (material_name_to_id.find(name) == material_name_to_id.end()) {
+          material_name_to_id[name] = num_materials++;
+        }
+        last_material = &name;
+      } else if (statement.first == OBJ_MTLLIB) {
+        // Only one material library is used, the same as in ObjDecoder.
+        if (material_name_to_id.empty() && !name.empty()) {
+          ParseMaterialFile(GetFullPath(name, file_name),
+                            &material_name_to_id, &num_materials);
+        }
+      } else {
+        if (obj_name_to_id.find(name) == obj_name_to_id.end()) {
+          const int id = static_cast<int>(obj_name_to_id.size());
+          obj_name_to_id[name] = id;
+        }
+        last_object = &name;
+      }
+    }
+  }
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    if (chunk_start_names[i].first != nullptr) {
+      chunks[i].start_material =
+          material_name_to_id[*chunk_start_names[i].first];
+    }
+    if (chunk_start_names[i].second != nullptr) {
+      chunks[i].start_sub_object = obj_name_to_id[*chunk_start_names[i].second];
+    }
+  }
+
+  const int64_t max_points = std::numeric_limits<int32_t>::max();
+  if (num_positions > max_points || num_tex_coords > max_points ||
+      num_normals > max_points || 3 * num_faces > max_points) {
+    return Status(Status::DRACO_ERROR, "OBJ input is too large.");
+  }
+
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  bool use_identity_mapping = false;
+  if (num_faces == 0) {
+    // Without faces every position is a point of a point cloud.
+    if (num_positions == 0) {
+      return Status(Status::DRACO_ERROR, "No position attribute");
+    }
+    if (num_tex_coords > 0 && num_tex_coords != num_positions) {
+      return Status(Status::DRACO_ERROR,
+                    "Invalid number of texture coordinates for a point cloud");
+    }
+    if (num_normals > 0 && num_normals != num_positions) {
+      return Status(Status::DRACO_ERROR,
+                    "Invalid number of normals for a point cloud");
+    }
+    use_identity_mapping = true;
+    mesh->set_num_points(static_cast<uint32_t>(num_positions));
+  } else {
+    mesh->SetNumFaces(num_faces);
+    mesh->set_num_points(static_cast<uint32_t>(3 * num_faces));
+  }
+
+  ObjTargets targets;
+  targets.mesh = mesh.get();
+  targets.num_positions = num_positions;
+  targets.num_tex_coords = num_tex_coords;
+  targets.num_normals = num_normals;
+  targets.material_name_to_id = &material_name_to_id;
+  targets.obj_name_to_id = &obj_name_to_id;
+  if (num_positions > 0) {
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::POSITION, nullptr, 3, DT_FLOAT32, false,
+            sizeof(float) * 3, 0);
+    targets.pos_att = mesh->attribute(mesh->AddAttribute(
+        va, use_identity_mapping, static_cast<uint32_t>(num_positions)));
+  }
+  if (num_tex_coords > 0) {
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::TEX_COORD, nullptr, 2, DT_FLOAT32, false,
+            sizeof(float) * 2, 0);
+    targets.tex_att = mesh->attribute(mesh->AddAttribute(
+        va, use_identity_mapping, static_cast<uint32_t>(num_tex_coords)));
+  }
+  if (num_normals > 0) {
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::NORMAL, nullptr, 3, DT_FLOAT32, false,
+            sizeof(float) * 3, 0);
+    targets.norm_att = mesh->attribute(mesh->AddAttribute(
+        va, use_identity_mapping, static_cast<uint32_t>(num_normals)));
+  }
+  if (num_faces > 0) {
+    if (num_positions == 0) {
+      return Status(Status::DRACO_ERROR, "Faces without positions.");
+    }
+    if (num_materials > 0) {
+      targets.material_att =
+          mesh->attribute(AddIdAttribute(num_materials, mesh.get()));
+    }
+    if (!obj_name_to_id.empty()) {
+      targets.sub_obj_att = mesh->attribute(
+          AddIdAttribute(static_cast<int>(obj_name_to_id.size()), mesh.get()));
+    }
+  }
+
+  ParallelFor(num_chunks,
+              [&](int32 index) { ParseChunk(targets, &chunks[index]); });
+  for (const ObjChunk &chunk : chunks) {
+    if (!chunk.ok) {
+      return Status(Status::DRACO_ERROR, "Unsupported OBJ definition.");
+    }
+  }
+
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+  if (deduplicate_input_values_) {
+    UD_DeduplicateAttributeValues(mesh.get());
+  }
+#endif
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+  UD_DeduplicatePointIds(mesh.get(), mesh.get());
+#endif
+  return mesh;
+}
+
+}  // namespace draco
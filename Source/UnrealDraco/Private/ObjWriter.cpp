@@ -0,0 +1,261 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "ObjWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "draco/io/file_writer_factory.h"
+#include "draco/io/file_writer_interface.h"
+#include "draco/io/obj_encoder.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int64_t kDefaultBlockSize = 1 << 15;
+
+// Upper bounds of the length of one formatted number and one line.
+constexpr int kMaxNumberLength = 32;
+constexpr int kMaxLineLength = 4 + 3 * (kMaxNumberLength + 1);
+
+enum ObjSection {
+  OBJ_POSITIONS = 0,
+  OBJ_TEX_COORDS,
+  OBJ_NORMALS,
+  OBJ_FACES,
+};
+
+// Range of lines of one section formatted by one task.
+struct ObjBlock {
+  ObjSection section;
+  int64_t begin;
+  int64_t end;
+};
+
+// Writes the shortest decimal representation of |val| that parses back to
+// the same float.
+char *FormatFloat(float val, char *out) {
+#if defined(__cpp_lib_to_chars)
+  return std::to_chars(out, out + kMaxNumberLength, val).ptr;
+#else
+  // %.9g always round-trips, shorter precisions are tried first.
+  int length = 0;
+  for (int precision = 6; precision <= 9; ++precision) {
+    length = snprintf(out, kMaxNumberLength, "%.*g", precision, val);
+    if (precision == 9 || strtof(out, nullptr) == val) {
+      break;
+    }
+  }
+  return out + length;
+#endif
+}
+
+char *FormatUint(uint32_t val, char *out) {
+  char digits[10];
+  int num_digits = 0;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + val % 10);
+    val /= 10;
+  } while (val != 0);
+  while (num_digits > 0) {
+    *out++ = digits[--num_digits];
+  }
+  return out;
+}
+
+// Appends "<prefix> a b c\n" lines for the attribute values in [begin, end).
+// Values with fewer components than |num_components| are padded with zeros
+// like in ObjEncoder.
+void FormatValues(const PointAttribute &att, const char *prefix,
+                  int num_components, int64_t begin, int64_t end,
+                  std::string *out) {
+  const size_t prefix_length = strlen(prefix);
+  std::array<float, 3> value;
+  char line[kMaxLineLength];
+  for (int64_t i = begin; i < end; ++i) {
+    att.ConvertValue<float>(AttributeValueIndex(static_cast<uint32_t>(i)),
+                            static_cast<int8_t>(num_components), &value[0]);
+    char *p = line;
+    memcpy(p, prefix, prefix_length);
+    p += prefix_length;
+    for (int c = 0; c < num_components; ++c) {
+      *p++ = ' ';
+      p = FormatFloat(value[c], p);
+    }
+    *p++ = '\n';
+    out->append(line, p - line);
+  }
+}
+
+// Appends "f p/t/n p/t/n p/t/n" lines for the faces in [begin, end) with the
+// same index layout as ObjEncoder::EncodeFaceCorner().
+void FormatFaces(const Mesh &mesh, const PointAttribute &pos_att,
+                 const PointAttribute *tex_att, const PointAttribute *norm_att,
+                 int64_t begin, int64_t end, std::string *out) {
+  char line[kMaxLineLength];
+  for (int64_t i = begin; i < end; ++i) {
+    const Mesh::Face &face = mesh.face(FaceIndex(static_cast<uint32_t>(i)));
+    char *p = line;
+    *p++ = 'f';
+    for (int c = 0; c < 3; ++c) {
+      const PointIndex point = face[c];
+      *p++ = ' ';
+      p = FormatUint(pos_att.mapped_index(point).value() + 1, p);
+      if (tex_att || norm_att) {
+        *p++ = '/';
+        if (tex_att) {
+          p = FormatUint(tex_att->mapped_index(point).value() + 1, p);
+        }
+        if (norm_att) {
+          *p++ = '/';
+          p = FormatUint(norm_att->mapped_index(point).value() + 1, p);
+        }
+      }
+    }
+    *p++ = '\n';
+    out->append(line, p - line);
+  }
+}
+
+void AddBlocks(ObjSection section, int64_t num_lines, int64_t block_size,
+               std::vector<ObjBlock> *blocks) {
+  for (int64_t begin = 0; begin < num_lines; begin += block_size) {
+    blocks->push_back(
+        {section, begin, std::min(begin + block_size, num_lines)});
+  }
+}
+
+}  // namespace
+
+UD_ObjWriter::UD_ObjWriter() : block_size_(kDefaultBlockSize) {}
+
+bool UD_ObjWriter::WriteToFile(const PointCloud &pc,
+                               const std::string &file_name) {
+  return WriteToFileInternal(pc, nullptr, file_name);
+}
+
+bool UD_ObjWriter::WriteToFile(const Mesh &mesh,
+                               const std::string &file_name) {
+  return WriteToFileInternal(mesh, &mesh, file_name);
+}
+
+bool UD_ObjWriter::WriteToBuffer(const PointCloud &pc,
+                                 EncoderBuffer *out_buffer) {
+  return WriteToBufferInternal(pc, nullptr, out_buffer);
+}
+
+bool UD_ObjWriter::WriteToBuffer(const Mesh &mesh, EncoderBuffer *out_buffer) {
+  return WriteToBufferInternal(mesh, &mesh, out_buffer);
+}
+
+bool UD_ObjWriter::WriteToFileInternal(const PointCloud &pc, const Mesh *mesh,
+                                       const std::string &file_name) {
+  if (pc.GetMetadata() != nullptr) {
+    ObjEncoder encoder;
+    return mesh ? encoder.EncodeToFile(*mesh, file_name)
+                : encoder.EncodeToFile(pc, file_name);
+  }
+  std::unique_ptr<FileWriterInterface> file =
+      FileWriterFactory::OpenWriter(file_name);
+  if (!file) {
+    return false;
+  }
+  std::vector<std::string> blocks;
+  if (!Format(pc, mesh, &blocks)) {
+    return false;
+  }
+  for (const std::string &block : blocks) {
+    if (!file->Write(block.data(), block.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool UD_ObjWriter::WriteToBufferInternal(const PointCloud &pc,
+                                         const Mesh *mesh,
+                                         EncoderBuffer *out_buffer) {
+  if (pc.GetMetadata() != nullptr) {
+    ObjEncoder encoder;
+    return mesh ? encoder.EncodeToBuffer(*mesh, out_buffer)
+                : encoder.EncodeToBuffer(pc, out_buffer);
+  }
+  std::vector<std::string> blocks;
+  if (!Format(pc, mesh, &blocks)) {
+    return false;
+  }
+  size_t total_size = 0;
+  for (const std::string &block : blocks) {
+    total_size += block.size();
+  }
+  out_buffer->buffer()->reserve(out_buffer->size() + total_size);
+  for (const std::string &block : blocks) {
+    out_buffer->Encode(block.data(), block.size());
+  }
+  return true;
+}
+
+bool UD_ObjWriter::Format(const PointCloud &pc, const Mesh *mesh,
+                          std::vector<std::string> *out_blocks) const {
+  const PointAttribute *const pos_att =
+      pc.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pos_att == nullptr || pos_att->size() == 0) {
+    return false;
+  }
+  const PointAttribute *tex_att =
+      pc.GetNamedAttribute(GeometryAttribute::TEX_COORD);
+  if (tex_att != nullptr && tex_att->size() == 0) {
+    tex_att = nullptr;
+  }
+  const PointAttribute *norm_att =
+      pc.GetNamedAttribute(GeometryAttribute::NORMAL);
+  if (norm_att != nullptr && norm_att->size() == 0) {
+    norm_att = nullptr;
+  }
+
+  const int64_t block_size = std::max<int64_t>(block_size_, 1);
+  std::vector<ObjBlock> blocks;
+  AddBlocks(OBJ_POSITIONS, pos_att->size(), block_size, &blocks);
+  if (tex_att) {
+    AddBlocks(OBJ_TEX_COORDS, tex_att->size(), block_size, &blocks);
+  }
+  if (norm_att) {
+    AddBlocks(OBJ_NORMALS, norm_att->size(), block_size, &blocks);
+  }
+  if (mesh) {
+    AddBlocks(OBJ_FACES, mesh->num_faces(), block_size, &blocks);
+  }
+
+  out_blocks->assign(blocks.size(), std::string());
+  ParallelFor(static_cast<int32>(blocks.size()), [&](int32 index) {
+    const ObjBlock &block = blocks[index];
+    std::string &out = (*out_blocks)[index];
+    out.reserve((block.end - block.begin) * 32);
+    switch (block.section) {
+      case OBJ_POSITIONS:
+        FormatValues(*pos_att, "v", 3, block.begin, block.end, &out);
+        break;
+      case OBJ_TEX_COORDS:
+        FormatValues(*tex_att, "vt", 2, block.begin, block.end, &out);
+        break;
+      case OBJ_NORMALS:
+        FormatValues(*norm_att, "vn", 3, block.begin, block.end, &out);
+        break;
+      case OBJ_FACES:
+        FormatFaces(*mesh, *pos_att, tex_att, norm_att, block.begin,
+                    block.end, &out);
+        break;
+    }
+  });
+  return true;
+}
+
+}  // namespace draco
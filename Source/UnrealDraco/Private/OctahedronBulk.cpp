@@ -0,0 +1,220 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "OctahedronBulk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace draco {
+
+namespace {
+
+// Values per block. The per component arrays of a block stay in L1.
+constexpr int kBlockSize = 64;
+
+// CanonicalizeOctahedralCoords() on one block. The conditions of its
+// else-if chain are evaluated up front and each one masks the later ones.
+// Conditions are 0 or 1 integers combined with & and |. Bools combined with
+// && and || turn into branches, which keep loops from being vectorized.
+void CanonicalizeBlock(int32_t max_value, int32_t center_value, int n,
+                       int32_t *s, int32_t *t) {
+  for (int i = 0; i < n; ++i) {
+    const int32_t si = s[i];
+    const int32_t ti = t[i];
+    const int32_t corner = ((si == 0) & (ti == 0)) |
+                           ((si == 0) & (ti == max_value)) |
+                           ((si == max_value) & (ti == 0));
+    const int32_t flip_t = (1 - corner) &
+                           (((si == 0) & (ti > center_value)) |
+                            ((si == max_value) & (ti < center_value)));
+    const int32_t flip_s = (1 - corner) & (1 - flip_t) &
+                           (((ti == max_value) & (si < center_value)) |
+                            ((ti == 0) & (si > center_value)));
+    const int32_t flipped_s = flip_s ? 2 * center_value - si : si;
+    const int32_t flipped_t = flip_t ? 2 * center_value - ti : ti;
+    s[i] = corner ? max_value : flipped_s;
+    t[i] = corner ? max_value : flipped_t;
+  }
+}
+
+// |condition| ? |a| : |b| for a 0 or 1 |condition|, selecting the bits. A
+// select between floats is only vectorized when the compiler may compute both
+// sides, which GCC does not assume without -fno-trapping-math: it sinks the
+// operations of a side under a branch instead. Integer operations on the bits
+// keep both sides computed whatever the floating point options.
+inline float SelectFloat(int32_t condition, float a, float b) {
+  uint32_t a_bits;
+  uint32_t b_bits;
+  memcpy(&a_bits, &a, sizeof(a));
+  memcpy(&b_bits, &b, sizeof(b));
+  const uint32_t mask = 0u - static_cast<uint32_t>(condition);
+  const uint32_t bits = (a_bits & mask) | (b_bits & ~mask);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// static_cast<int32_t>(std::floor(value)) for |value| below 2^31, without
+// the library call that std::floor() is on targets without SSE4.1.
+inline int32_t FloorToInt(double value) {
+  const int32_t truncated = static_cast<int32_t>(value);
+  return truncated - (truncated > value ? 1 : 0);
+}
+
+}  // namespace
+
+void UD_FloatVectorsToQuantizedOctahedralCoords(
+    const OctahedronToolBox &tool_box, const float *vectors, int num_vectors,
+    int32_t *out_coords) {
+  const int32_t max_value = tool_box.max_value();
+  const int32_t center_value = tool_box.center_value();
+  int32_t s[kBlockSize];
+  int32_t t[kBlockSize];
+  for (int begin = 0; begin < num_vectors; begin += kBlockSize) {
+    const int n = std::min(kBlockSize, num_vectors - begin);
+    const float *const block = vectors + begin * 3;
+    for (int i = 0; i < n; ++i) {
+      const double x = block[i * 3];
+      const double y = block[i * 3 + 1];
+      const double z = block[i * 3 + 2];
+      // Project on the octahedron with an abs sum of one.
+      const double abs_sum = std::abs(x) + std::abs(y) + std::abs(z);
+      // Degenerate vectors become (1, 0, 0). The inputs are selected rather
+      // than the scaled values: floating point operations are not moved under
+      // a condition, where they may raise exceptions.
+      const int32_t valid = abs_sum > 1e-6;
+      const double scale = 1.0 / (valid ? abs_sum : 1.0);
+      const double sx = (valid ? x : 1.0) * scale;
+      const double sy = (valid ? y : 0.0) * scale;
+      const double sz = (valid ? z : 0.0) * scale;
+
+      // Scale to an abs sum of exactly the center value.
+      const int32_t v0 = FloorToInt(sx * center_value + 0.5);
+      int32_t v1 = FloorToInt(sy * center_value + 0.5);
+      int32_t v2 = center_value - std::abs(v0) - std::abs(v1);
+      const int32_t excess = std::min(v2, 0);
+      v1 += v1 > 0 ? excess : -excess;
+      v2 = std::max(v2, 0);
+      v2 = sz < 0 ? -v2 : v2;
+
+      // IntegerVectorToQuantizedOctahedralCoords() before canonicalization.
+      const int32_t left_s =
+          v1 < 0 ? std::abs(v2) : max_value - std::abs(v2);
+      const int32_t left_t =
+          v2 < 0 ? std::abs(v1) : max_value - std::abs(v1);
+      s[i] = v0 >= 0 ? v1 + center_value : left_s;
+      t[i] = v0 >= 0 ? v2 + center_value : left_t;
+    }
+    CanonicalizeBlock(max_value, center_value, n, s, t);
+    int32_t *const out = out_coords + begin * 2;
+    for (int i = 0; i < n; ++i) {
+      out[i * 2] = s[i];
+      out[i * 2 + 1] = t[i];
+    }
+  }
+}
+
+void UD_QuantizedOctahedralCoordsToUnitVectors(
+    const OctahedronToolBox &tool_box, const int32_t *coords, int num_coords,
+    float *out_vectors) {
+  // The tool box computes in float, with double constants. Every double
+  // operation on float operands rounds back to the same float, so the float
+  // operations below give the same results.
+  const float scale = 1.0f / static_cast<float>(tool_box.max_value());
+  float x[kBlockSize];
+  float y[kBlockSize];
+  float z[kBlockSize];
+  for (int begin = 0; begin < num_coords; begin += kBlockSize) {
+    const int n = std::min(kBlockSize, num_coords - begin);
+    const int32_t *const block = coords + begin * 2;
+    for (int i = 0; i < n; ++i) {
+      const float in_s = block[i * 2] * scale;
+      const float in_t = block[i * 2 + 1] * scale;
+      const float in_spt = in_s + in_t;
+      const float in_smt = in_s - in_t;
+      const int32_t right = (in_spt >= 0.5f) & (in_spt <= 1.5f) &
+                            (in_smt >= -0.5f) & (in_smt <= 0.5f);
+      // Left hemisphere: mirror around the closest diamond edge. x - y is
+      // x + -y exactly, so each edge is an offset plus a signed coordinate.
+      // The offsets are computed from 0 or 1 masks, which unlike chains of
+      // selects vectorize.
+      const int32_t below = in_spt <= 0.5f;
+      const int32_t above = (1 - below) & (in_spt >= 1.5f);
+      const int32_t left = (1 - below) & (1 - above) & (in_smt <= -0.5f);
+      const int32_t other = 1 - below - above - left;
+      const float mirror_sign = SelectFloat(below | above, -1.0f, 1.0f);
+      const float offset_s = 0.5f + static_cast<float>(above - left);
+      const float offset_t = 0.5f + static_cast<float>(above - other);
+      const float mirrored_s = offset_s + mirror_sign * in_t;
+      const float mirrored_t = offset_t + mirror_sign * in_s;
+      const float s = SelectFloat(right, in_s, mirrored_s);
+      const float t = SelectFloat(right, in_t, mirrored_t);
+      const float spt = s + t;
+      const float smt = s - t;
+      y[i] = 2.0f * s - 1.0f;
+      z[i] = 2.0f * t - 1.0f;
+      x[i] = std::min(std::min(2.0f * spt - 1.0f, 3.0f - 2.0f * spt),
+                      std::min(2.0f * smt + 1.0f, 1.0f - 2.0f * smt)) *
+             SelectFloat(right, 1.0f, -1.0f);
+    }
+    float *const out = out_vectors + begin * 3;
+    for (int i = 0; i < n; ++i) {
+      const float norm_squared = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+      const int32_t valid = static_cast<double>(norm_squared) >= 1e-6;
+      // Floating point operations are not moved under a condition, where
+      // they may raise exceptions, so both sides of a select are computed.
+      const float d = 1.0f / std::sqrt(valid ? norm_squared : 1.0f);
+      const float nx = x[i] * d;
+      const float ny = y[i] * d;
+      const float nz = z[i] * d;
+      out[i * 3] = valid ? nx : 0.0f;
+      out[i * 3 + 1] = valid ? ny : 0.0f;
+      out[i * 3 + 2] = valid ? nz : 0.0f;
+    }
+  }
+}
+
+void UD_CanonicalizeOctahedralCoords(const OctahedronToolBox &tool_box,
+                                     int32_t *coords, int num_coords) {
+  int32_t s[kBlockSize];
+  int32_t t[kBlockSize];
+  for (int begin = 0; begin < num_coords; begin += kBlockSize) {
+    const int n = std::min(kBlockSize, num_coords - begin);
+    int32_t *const block = coords + begin * 2;
+    for (int i = 0; i < n; ++i) {
+      s[i] = block[i * 2];
+      t[i] = block[i * 2 + 1];
+    }
+    CanonicalizeBlock(tool_box.max_value(), tool_box.center_value(), n, s, t);
+    for (int i = 0; i < n; ++i) {
+      block[i * 2] = s[i];
+      block[i * 2 + 1] = t[i];
+    }
+  }
+}
+
+void UD_InvertDiamonds(const OctahedronToolBox &tool_box, int32_t *coords,
+                       int num_coords) {
+  const int32_t center_value = tool_box.center_value();
+  for (int i = 0; i < num_coords; ++i) {
+    const int32_t s = coords[i * 2];
+    const int32_t t = coords[i * 2 + 1];
+    // Signs of the quadrant, points on an axis take the sign of the other
+    // coordinate.
+    const int32_t positive = (s >= 0) & (t >= 0);
+    const int32_t negative = (1 - positive) & (s <= 0) & (t <= 0);
+    const int32_t sign_s = positive ? 1 : ((negative | (s <= 0)) ? -1 : 1);
+    const int32_t sign_t = positive ? 1 : ((negative | (t <= 0)) ? -1 : 1);
+    const int32_t corner_point_s = sign_s * center_value;
+    const int32_t corner_point_t = sign_t * center_value;
+    const int32_t s2 = 2 * s - corner_point_s;
+    const int32_t t2 = 2 * t - corner_point_t;
+    // Mirror on the diagonal of the quadrant.
+    const int32_t same_sign = sign_s * sign_t >= 0;
+    coords[i * 2] = ((same_sign ? -t2 : t2) + corner_point_s) / 2;
+    coords[i * 2 + 1] = ((same_sign ? -s2 : s2) + corner_point_t) / 2;
+  }
+}
+
+}  // namespace draco
@@ -0,0 +1,411 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "ParallelDeduplication.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "draco/core/draco_types.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kEmptySlot = 0xffffffff;
+// Entries processed per parallel task.
+constexpr int kBlockSize = 16384;
+// The partitions are selected by the top kPartitionBits bits of the hashes,
+// the table slots by the low bits. Inputs of a single block use a single
+// partition.
+constexpr int kPartitionBits = 8;
+constexpr int kMaxPartitions = 1 << kPartitionBits;
+
+int NumBlocks(uint32_t size) {
+  return static_cast<int>((size + kBlockSize - 1) / kBlockSize);
+}
+
+// Finalizer of MurmurHash3, spreads every input bit over the whole hash.
+inline uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// Sets |first[i]| to the smallest index whose entry equals entry |i|, for
+// the |num_entries| entries hashed into |hashes|. |equal(a, b)| compares the
+// entries |a| and |b|.
+template <typename EqualT>
+void FindFirstOccurrences(const std::vector<uint64_t> &hashes,
+                          const EqualT &equal, std::vector<uint32_t> *first) {
+  const uint32_t num_entries = static_cast<uint32_t>(hashes.size());
+  const int num_blocks = NumBlocks(num_entries);
+  const int num_partitions = num_blocks > 1 ? kMaxPartitions : 1;
+  const auto partition_of = [&](uint64_t hash) {
+    return num_partitions > 1 ? static_cast<int>(hash >> (64 - kPartitionBits))
+                              : 0;
+  };
+  first->resize(num_entries);
+
+  // Stable radix partition of the entries, so that each partition lists its
+  // entries in index order.
+  std::vector<uint32_t> block_counts(num_blocks * num_partitions, 0);
+  ParallelFor(num_blocks, [&](int32 block) {
+    uint32_t *const counts = &block_counts[block * num_partitions];
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_entries);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      ++counts[partition_of(hashes[i])];
+    }
+  });
+  std::vector<uint32_t> partition_offsets(num_partitions + 1);
+  uint32_t offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_offsets[p] = offset;
+    for (int block = 0; block < num_blocks; ++block) {
+      uint32_t &count = block_counts[block * num_partitions + p];
+      const uint32_t block_count = count;
+      count = offset;
+      offset += block_count;
+    }
+  }
+  partition_offsets[num_partitions] = offset;
+  std::vector<uint32_t> partitioned(num_entries);
+  ParallelFor(num_blocks, [&](int32 block) {
+    uint32_t *const fill = &block_counts[block * num_partitions];
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_entries);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      partitioned[fill[partition_of(hashes[i])]++] = i;
+    }
+  });
+
+  // Only first occurrences are inserted, so a match is always the first
+  // occurrence of the entry.
+  ParallelFor(num_partitions, [&](int32 p) {
+    const uint32_t begin = partition_offsets[p];
+    const uint32_t end = partition_offsets[p + 1];
+    if (begin == end) {
+      return;
+    }
+    uint32_t capacity = 16;
+    while (capacity < 2 * (end - begin)) {
+      capacity *= 2;
+    }
+    const uint32_t slot_mask = capacity - 1;
+    std::vector<uint32_t> table(capacity, kEmptySlot);
+    for (uint32_t k = begin; k < end; ++k) {
+      const uint32_t i = partitioned[k];
+      const uint64_t hash = hashes[i];
+      uint32_t slot = static_cast<uint32_t>(hash) & slot_mask;
+      while (true) {
+        const uint32_t j = table[slot];
+        if (j == kEmptySlot) {
+          table[slot] = i;
+          (*first)[i] = i;
+          break;
+        }
+        if (hashes[j] == hash && equal(j, i)) {
+          (*first)[i] = j;
+          break;
+        }
+        slot = (slot + 1) & slot_mask;
+      }
+    }
+  });
+}
+
+// Numbers the first occurrences in index order into |new_ids| and sets the
+// id of every other entry to the one of its first occurrence. Returns the
+// number of unique entries.
+uint32_t NumberUniqueEntries(const std::vector<uint32_t> &first,
+                             std::vector<uint32_t> *new_ids) {
+  const uint32_t num_entries = static_cast<uint32_t>(first.size());
+  const int num_blocks = NumBlocks(num_entries);
+  new_ids->resize(num_entries);
+  std::vector<uint32_t> block_offsets(num_blocks + 1, 0);
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_entries);
+    uint32_t count = 0;
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      count += first[i] == i;
+    }
+    block_offsets[block + 1] = count;
+  });
+  for (int block = 0; block < num_blocks; ++block) {
+    block_offsets[block + 1] += block_offsets[block];
+  }
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_entries);
+    uint32_t id = block_offsets[block];
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      if (first[i] == i) {
+        (*new_ids)[i] = id++;
+      }
+    }
+  });
+  // First occurrences precede their duplicates, possibly in other blocks, so
+  // this pass waits for all of them to be numbered.
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_entries);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      if (first[i] != i) {
+        (*new_ids)[i] = (*new_ids)[first[i]];
+      }
+    }
+  });
+  return block_offsets[num_blocks];
+}
+
+}  // namespace
+
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+AttributeValueIndex::ValueType UD_DeduplicateValues(PointAttribute *att) {
+  // Same data types and component counts as
+  // PointAttribute::DeduplicateValues().
+  switch (att->data_type()) {
+    case DT_FLOAT32:
+    case DT_INT8:
+    case DT_UINT8:
+    case DT_BOOL:
+    case DT_INT16:
+    case DT_UINT16:
+    case DT_INT32:
+    case DT_UINT32:
+      break;
+    default:
+      return -1;
+  }
+  if (att->num_components() < 1 || att->num_components() > 4) {
+    return -1;
+  }
+  const uint32_t num_values = static_cast<uint32_t>(att->size());
+  const int value_size =
+      DataTypeLength(att->data_type()) * att->num_components();
+  const int num_blocks = NumBlocks(num_values);
+
+  std::vector<uint64_t> hashes(num_values);
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_values);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      uint64_t words[2] = {0, 0};
+      memcpy(words, att->GetAddress(AttributeValueIndex(i)), value_size);
+      hashes[i] = Mix(Mix(words[0]) ^ words[1]);
+    }
+  });
+  std::vector<uint32_t> first;
+  FindFirstOccurrences(
+      hashes,
+      [&](uint32_t a, uint32_t b) {
+        return memcmp(att->GetAddress(AttributeValueIndex(a)),
+                      att->GetAddress(AttributeValueIndex(b)),
+                      value_size) == 0;
+      },
+      &first);
+  hashes.clear();
+  hashes.shrink_to_fit();
+  std::vector<uint32_t> value_map;
+  const uint32_t num_unique_values = NumberUniqueEntries(first, &value_map);
+  if (num_unique_values == num_values) {
+    return num_values;
+  }
+
+  // Unique values move to lower indices, possibly over values other tasks
+  // still read, so they are gathered first.
+  std::vector<uint8_t> unique_values(
+      static_cast<size_t>(num_unique_values) * value_size);
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_values);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      if (first[i] == i) {
+        memcpy(&unique_values[static_cast<size_t>(value_map[i]) * value_size],
+               att->GetAddress(AttributeValueIndex(i)), value_size);
+      }
+    }
+  });
+  ParallelFor(NumBlocks(num_unique_values), [&](int32 block) {
+    const uint32_t end = std::min(
+        static_cast<uint32_t>(block + 1) * kBlockSize, num_unique_values);
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      memcpy(att->GetAddress(AttributeValueIndex(i)),
+             &unique_values[static_cast<size_t>(i) * value_size], value_size);
+    }
+  });
+
+  if (att->is_mapping_identity()) {
+    // One point per old value.
+    att->SetExplicitMapping(num_values);
+    ParallelFor(num_blocks, [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_values);
+      for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+           ++i) {
+        att->SetPointMapEntry(PointIndex(i), AttributeValueIndex(value_map[i]));
+      }
+    });
+  } else {
+    const uint32_t num_points =
+        static_cast<uint32_t>(att->indices_map_size());
+    ParallelFor(NumBlocks(num_points), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_points);
+      for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+           ++p) {
+        att->SetPointMapEntry(
+            p, AttributeValueIndex(value_map[att->mapped_index(p).value()]));
+      }
+    });
+  }
+  att->Resize(num_unique_values);
+  return num_unique_values;
+}
+
+bool UD_DeduplicateAttributeValues(PointCloud *pc) {
+  if (pc->num_points() == 0) {
+    return true;
+  }
+  for (int32_t att_id = 0; att_id < pc->num_attributes(); ++att_id) {
+    if (!UD_DeduplicateValues(pc->attribute(att_id))) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+void UD_DeduplicatePointIds(PointCloud *pc, Mesh *mesh) {
+  const uint32_t num_points = pc->num_points();
+  const int num_attributes = pc->num_attributes();
+  if (num_points == 0) {
+    return;
+  }
+
+  // Points are chained by their value of the attribute with the most values.
+  // Its value indices address the chain heads directly, so unlike a hash map
+  // the lookups need no hashing and touch a small, mostly sequentially
+  // accessed array. Out of range indices share the last chain.
+  const PointAttribute *key_att = nullptr;
+  for (int a = 0; a < num_attributes; ++a) {
+    const PointAttribute *const att = pc->attribute(a);
+    if (key_att == nullptr || att->size() > key_att->size()) {
+      key_att = att;
+    }
+  }
+  const uint32_t num_keys =
+      key_att == nullptr ? 0 : static_cast<uint32_t>(key_att->size());
+  const auto same_point = [&](PointIndex p0, PointIndex p1) {
+    for (int a = 0; a < num_attributes; ++a) {
+      const PointAttribute *const att = pc->attribute(a);
+      if (att->mapped_index(p0) != att->mapped_index(p1)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  std::vector<uint32_t> heads(num_keys + 1, kEmptySlot);
+  std::vector<uint32_t> next(num_points);
+  std::vector<uint32_t> point_map(num_points);
+  std::vector<uint32_t> unique_points;
+  // Chains only grow long when few points share the key value with many
+  // different values of other attributes. Draco's hash map handles those
+  // better, so the scan gives up past this many comparisons.
+  const uint64_t max_comparisons = 4 * static_cast<uint64_t>(num_points);
+  uint64_t num_comparisons = 0;
+  for (PointIndex p(0); p < num_points; ++p) {
+    const uint32_t key =
+        key_att == nullptr
+            ? 0
+            : std::min(key_att->mapped_index(p).value(), num_keys);
+    uint32_t u = heads[key];
+    while (u != kEmptySlot && !same_point(PointIndex(u), p)) {
+      u = next[u];
+      ++num_comparisons;
+    }
+    if (num_comparisons > max_comparisons) {
+      pc->DeduplicatePointIds();
+      return;
+    }
+    if (u != kEmptySlot) {
+      point_map[p.value()] = point_map[u];
+    } else {
+      point_map[p.value()] = static_cast<uint32_t>(unique_points.size());
+      unique_points.push_back(p.value());
+      next[p.value()] = heads[key];
+      heads[key] = p.value();
+    }
+  }
+  heads.clear();
+  heads.shrink_to_fit();
+  next.clear();
+  next.shrink_to_fit();
+  const uint32_t num_unique_points =
+      static_cast<uint32_t>(unique_points.size());
+  if (num_unique_points == num_points) {
+    return;
+  }
+
+  // The mapping of the first occurrence of every point moves to its new id,
+  // gathered first as the new entries overwrite old ones.
+  const int num_unique_blocks = NumBlocks(num_unique_points);
+  std::vector<AttributeValueIndex> unique_mapping(num_unique_points);
+  for (int a = 0; a < num_attributes; ++a) {
+    PointAttribute *const att = pc->attribute(a);
+    ParallelFor(num_unique_blocks, [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_unique_points);
+      for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+           ++i) {
+        unique_mapping[i] = att->mapped_index(PointIndex(unique_points[i]));
+      }
+    });
+    att->SetExplicitMapping(num_unique_points);
+    ParallelFor(num_unique_blocks, [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_unique_points);
+      for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+           ++p) {
+        att->SetPointMapEntry(p, unique_mapping[p.value()]);
+      }
+    });
+  }
+
+  if (mesh != nullptr) {
+    const uint32_t num_faces = mesh->num_faces();
+    ParallelFor(NumBlocks(num_faces), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+      for (FaceIndex f(static_cast<uint32_t>(block) * kBlockSize); f < end;
+           ++f) {
+        Mesh::Face face = mesh->face(f);
+        for (int c = 0; c < 3; ++c) {
+          face[c] = PointIndex(point_map[face[c].value()]);
+        }
+        mesh->SetFace(f, face);
+      }
+    });
+  }
+  pc->set_num_points(num_unique_points);
+}
+#endif
+
+}  // namespace draco
@@ -0,0 +1,366 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "ParallelMeshCleanup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kUnused = 0xffffffff;
+// Faces, points or values processed per parallel task.
+constexpr int kBlockSize = 16384;
+
+int NumBlocks(uint32_t size) {
+  return static_cast<int>((size + kBlockSize - 1) / kBlockSize);
+}
+
+// Bitset whose bits are set concurrently by parallel tasks. ParallelFor joins
+// its tasks before the bits are read, so relaxed ordering is enough.
+class AtomicBitset {
+ public:
+  explicit AtomicBitset(uint32_t size) : words_((size + 63) / 64) {}
+
+  // Sets |bits| in word |w|. Points are shared by several faces and values
+  // by several points, so the bits are often set already and the
+  // read-modify-write is skipped.
+  void Merge(uint32_t w, uint64_t bits) {
+    std::atomic<uint64_t> &word = words_[w];
+    if ((word.load(std::memory_order_relaxed) & bits) != bits) {
+      word.fetch_or(bits, std::memory_order_relaxed);
+    }
+  }
+
+  bool Get(uint32_t i) const {
+    return (words_[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+  }
+
+ private:
+  std::vector<std::atomic<uint64_t>> words_;
+};
+
+// Collects the bits a task sets in the current word of an AtomicBitset and
+// merges them when the task moves on to another word, with a single atomic
+// operation for the runs of nearby indices consecutive faces and points use.
+class AtomicBitsetWriter {
+ public:
+  explicit AtomicBitsetWriter(AtomicBitset *bitset)
+      : bitset_(bitset), word_(0), bits_(0) {}
+  ~AtomicBitsetWriter() { Flush(); }
+
+  void Set(uint32_t i) {
+    if ((i >> 6) != word_) {
+      Flush();
+      word_ = i >> 6;
+    }
+    bits_ |= uint64_t(1) << (i & 63);
+  }
+
+ private:
+  void Flush() {
+    if (bits_ != 0) {
+      bitset_->Merge(word_, bits_);
+      bits_ = 0;
+    }
+  }
+
+  AtomicBitset *const bitset_;
+  uint32_t word_;
+  uint64_t bits_;
+};
+
+// Numbers the |size| entries set in |used| in index order into |new_ids|,
+// kUnused for the others. Returns the number of used entries.
+uint32_t NumberUsedEntries(const AtomicBitset &used, uint32_t size,
+                           std::vector<uint32_t> *new_ids) {
+  const int num_blocks = NumBlocks(size);
+  new_ids->resize(size);
+  std::vector<uint32_t> block_offsets(num_blocks + 1, 0);
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, size);
+    uint32_t count = 0;
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      count += used.Get(i);
+    }
+    block_offsets[block + 1] = count;
+  });
+  for (int block = 0; block < num_blocks; ++block) {
+    block_offsets[block + 1] += block_offsets[block];
+  }
+  ParallelFor(num_blocks, [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, size);
+    uint32_t id = block_offsets[block];
+    for (uint32_t i = static_cast<uint32_t>(block) * kBlockSize; i < end;
+         ++i) {
+      (*new_ids)[i] = used.Get(i) ? id++ : kUnused;
+    }
+  });
+  return block_offsets[num_blocks];
+}
+
+// Moves the values of |att| marked in |value_map| to their new indices and
+// drops the others.
+void CompactValues(const std::vector<uint32_t> &value_map,
+                   uint32_t num_used_values, PointAttribute *att) {
+  const uint32_t num_values = static_cast<uint32_t>(value_map.size());
+  const size_t value_size = att->byte_stride();
+  // Values before the first unused one stay in place.
+  uint32_t first_moved = 0;
+  while (first_moved < num_values && value_map[first_moved] == first_moved) {
+    ++first_moved;
+  }
+  // The others move to lower indices, possibly over values other tasks still
+  // read, so they are gathered first.
+  const uint32_t num_moved = num_used_values - first_moved;
+  std::vector<uint8_t> moved_values(num_moved * value_size);
+  ParallelFor(NumBlocks(num_values - first_moved), [&](int32 block) {
+    const uint32_t begin = first_moved + block * kBlockSize;
+    const uint32_t end = std::min(begin + kBlockSize, num_values);
+    for (uint32_t i = begin; i < end; ++i) {
+      if (value_map[i] != kUnused) {
+        memcpy(&moved_values[(value_map[i] - first_moved) * value_size],
+               att->GetAddress(AttributeValueIndex(i)), value_size);
+      }
+    }
+  });
+  ParallelFor(NumBlocks(num_moved), [&](int32 block) {
+    const uint32_t begin = block * kBlockSize;
+    const uint32_t end = std::min(begin + kBlockSize, num_moved);
+    for (uint32_t i = begin; i < end; ++i) {
+      memcpy(att->GetAddress(AttributeValueIndex(first_moved + i)),
+             &moved_values[i * value_size], value_size);
+    }
+  });
+  att->Resize(num_used_values);
+}
+
+}  // namespace
+
+bool UD_CleanupMesh(Mesh *mesh, const MeshCleanupOptions &options) {
+  if (!options.remove_degenerated_faces && !options.remove_unused_attributes) {
+    return true;
+  }
+  const PointAttribute *const pos_att =
+      mesh->GetNamedAttribute(GeometryAttribute::POSITION);
+  if (pos_att == nullptr) {
+    return false;
+  }
+  const uint32_t num_faces = mesh->num_faces();
+  const uint32_t num_original_points = mesh->num_points();
+  const int num_attributes = mesh->num_attributes();
+  const int num_face_blocks = NumBlocks(num_faces);
+
+  // Fused pass over the faces: degenerate faces are flagged and counted per
+  // block, and the remaining ones mark their points.
+  std::vector<uint8_t> is_face_valid(num_faces, 1);
+  std::vector<uint32_t> face_offsets(num_face_blocks + 1, 0);
+  AtomicBitset used_points(
+      options.remove_unused_attributes ? num_original_points : 0);
+  ParallelFor(num_face_blocks, [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+    AtomicBitsetWriter point_writer(&used_points);
+    uint32_t num_valid = 0;
+    for (FaceIndex f(static_cast<uint32_t>(block) * kBlockSize); f < end;
+         ++f) {
+      const Mesh::Face &face = mesh->face(f);
+      if (options.remove_degenerated_faces) {
+        const AttributeValueIndex p0 = pos_att->mapped_index(face[0]);
+        const AttributeValueIndex p1 = pos_att->mapped_index(face[1]);
+        const AttributeValueIndex p2 = pos_att->mapped_index(face[2]);
+        if (p0 == p1 || p0 == p2 || p1 == p2) {
+          is_face_valid[f.value()] = 0;
+          continue;
+        }
+      }
+      ++num_valid;
+      if (options.remove_unused_attributes) {
+        point_writer.Set(face[0].value());
+        point_writer.Set(face[1].value());
+        point_writer.Set(face[2].value());
+      }
+    }
+    face_offsets[block + 1] = num_valid;
+  });
+  for (int block = 0; block < num_face_blocks; ++block) {
+    face_offsets[block + 1] += face_offsets[block];
+  }
+  const uint32_t num_valid_faces = face_offsets[num_face_blocks];
+
+  std::vector<uint32_t> point_map;
+  uint32_t num_new_points = num_original_points;
+  std::vector<std::unique_ptr<AtomicBitset>> used_values(num_attributes);
+  if (options.remove_unused_attributes) {
+    num_new_points =
+        NumberUsedEntries(used_points, num_original_points, &point_map);
+    // Values used by the remaining points. Attributes with a value per point
+    // use exactly the values of the remaining points and need no bitset.
+    for (int a = 0; a < num_attributes; ++a) {
+      const PointAttribute *const att = mesh->attribute(a);
+      if (!att->is_mapping_identity() ||
+          att->size() != num_original_points) {
+        used_values[a].reset(
+            new AtomicBitset(static_cast<uint32_t>(att->size())));
+      }
+    }
+    ParallelFor(NumBlocks(num_original_points), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_original_points);
+      for (int a = 0; a < num_attributes; ++a) {
+        if (used_values[a] == nullptr) {
+          continue;
+        }
+        const PointAttribute *const att = mesh->attribute(a);
+        AtomicBitsetWriter value_writer(used_values[a].get());
+        for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+             ++p) {
+          if (used_points.Get(p.value())) {
+            value_writer.Set(att->mapped_index(p).value());
+          }
+        }
+      }
+    });
+  }
+  const bool points_changed = num_new_points < num_original_points;
+
+  const auto renumber = [&](Mesh::Face *face) {
+    for (int c = 0; c < 3; ++c) {
+      (*face)[c] = PointIndex(point_map[(*face)[c].value()]);
+    }
+  };
+  if (num_valid_faces < num_faces) {
+    // Faces are compacted at their block offsets with their points
+    // renumbered. They move to lower indices, possibly over faces other tasks
+    // still read, so they are gathered first.
+    std::vector<Mesh::Face> new_faces(num_valid_faces);
+    ParallelFor(num_face_blocks, [&](int32 block) {
+      const uint32_t end =
+          std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+      uint32_t new_f = face_offsets[block];
+      for (FaceIndex f(static_cast<uint32_t>(block) * kBlockSize); f < end;
+           ++f) {
+        if (!is_face_valid[f.value()]) {
+          continue;
+        }
+        Mesh::Face face = mesh->face(f);
+        if (points_changed) {
+          renumber(&face);
+        }
+        new_faces[new_f++] = face;
+      }
+    });
+    mesh->SetNumFaces(num_valid_faces);
+    ParallelFor(NumBlocks(num_valid_faces), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_valid_faces);
+      for (FaceIndex f(static_cast<uint32_t>(block) * kBlockSize); f < end;
+           ++f) {
+        mesh->SetFace(f, new_faces[f.value()]);
+      }
+    });
+  } else if (points_changed) {
+    ParallelFor(num_face_blocks, [&](int32 block) {
+      const uint32_t end =
+          std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+      for (FaceIndex f(static_cast<uint32_t>(block) * kBlockSize); f < end;
+           ++f) {
+        Mesh::Face face = mesh->face(f);
+        renumber(&face);
+        mesh->SetFace(f, face);
+      }
+    });
+  }
+  if (!options.remove_unused_attributes) {
+    return true;
+  }
+  if (points_changed) {
+    mesh->set_num_points(num_new_points);
+  }
+
+  std::vector<uint32_t> att_value_map;
+  std::vector<AttributeValueIndex> new_mapping;
+  for (int a = 0; a < num_attributes; ++a) {
+    PointAttribute *const att = mesh->attribute(a);
+    const uint32_t num_values = static_cast<uint32_t>(att->size());
+    // Attributes without a bitset are numbered like the points.
+    const std::vector<uint32_t> &value_map =
+        used_values[a] == nullptr ? point_map : att_value_map;
+    uint32_t num_used_values = num_new_points;
+    if (used_values[a] != nullptr) {
+      num_used_values =
+          NumberUsedEntries(*used_values[a], num_values, &att_value_map);
+      used_values[a].reset();
+    }
+    const bool values_changed = num_used_values < num_values;
+    if (!points_changed && !values_changed) {
+      continue;
+    }
+    // The mapping stays the identity only if the remaining points and values
+    // still pair up one to one.
+    if (att->is_mapping_identity() && num_used_values == num_new_points) {
+      if (values_changed) {
+        CompactValues(value_map, num_used_values, att);
+      }
+      continue;
+    }
+
+    if (!points_changed && !att->is_mapping_identity()) {
+      CompactValues(value_map, num_used_values, att);
+      ParallelFor(NumBlocks(num_new_points), [&](int32 block) {
+        const uint32_t end = std::min(
+            static_cast<uint32_t>(block + 1) * kBlockSize, num_new_points);
+        for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+             ++p) {
+          att->SetPointMapEntry(
+              p, AttributeValueIndex(value_map[att->mapped_index(p).value()]));
+        }
+      });
+      continue;
+    }
+    // Mapping of the new points. Points move to lower indices and an identity
+    // mapping is replaced, so it is gathered first.
+    new_mapping.resize(num_new_points);
+    ParallelFor(NumBlocks(num_original_points), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_original_points);
+      for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+           ++p) {
+        const uint32_t new_p = points_changed ? point_map[p.value()] : p.value();
+        if (new_p == kUnused) {
+          continue;
+        }
+        const AttributeValueIndex value = att->mapped_index(p);
+        new_mapping[new_p] =
+            values_changed ? AttributeValueIndex(value_map[value.value()])
+                           : value;
+      }
+    });
+    if (values_changed) {
+      CompactValues(value_map, num_used_values, att);
+    }
+    att->SetExplicitMapping(num_new_points);
+    ParallelFor(NumBlocks(num_new_points), [&](int32 block) {
+      const uint32_t end = std::min(
+          static_cast<uint32_t>(block + 1) * kBlockSize, num_new_points);
+      for (PointIndex p(static_cast<uint32_t>(block) * kBlockSize); p < end;
+           ++p) {
+        att->SetPointMapEntry(p, new_mapping[p.value()]);
+      }
+    });
+  }
+  return true;
+}
+
+}  // namespace draco
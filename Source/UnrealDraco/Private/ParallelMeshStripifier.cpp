@@ -0,0 +1,407 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "ParallelMeshStripifier.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kInvalidCorner = 0xffffffff;
+// Faces or corners processed per parallel task.
+constexpr int kBlockSize = 16384;
+// Bits per axis of the grid the face centroids are sorted on.
+constexpr int kCellBits = 5;
+
+int NumBlocks(uint32_t size) {
+  return static_cast<int>((size + kBlockSize - 1) / kBlockSize);
+}
+
+inline uint32_t Next(uint32_t c) { return (c % 3 == 2) ? c - 2 : c + 1; }
+inline uint32_t Previous(uint32_t c) { return (c % 3 == 0) ? c + 2 : c - 1; }
+
+inline uint32_t CornerPoint(const Mesh &mesh, uint32_t c) {
+  return mesh.face(FaceIndex(c / 3))[c % 3].value();
+}
+
+bool IsDegenerate(const Mesh::Face &face) {
+  return face[0] == face[1] || face[1] == face[2] || face[2] == face[0];
+}
+
+// Spreads the low kCellBits bits of |v| to every third bit.
+uint32_t SpreadBits(uint32_t v) {
+  uint32_t out = 0;
+  for (int i = 0; i < kCellBits; ++i) {
+    out |= ((v >> i) & 1) << (3 * i);
+  }
+  return out;
+}
+
+// Opposite corner of every corner across an edge shared by exactly two
+// non-degenerate faces that use it in opposite directions, the same as
+// MeshStripifier::GetOppositeCorner() on a manifold mesh.
+std::vector<uint32_t> ComputeOppositeCorners(const Mesh &mesh) {
+  const uint32_t num_points = mesh.num_points();
+  const uint32_t num_faces = mesh.num_faces();
+  const uint32_t num_corners = num_faces * 3;
+
+  // Edges opposite to the corners of non-degenerate faces, bucketed by the
+  // point they start at, i.e. the point of the next corner.
+  struct Edge {
+    uint32_t corner;
+    uint32_t to;
+  };
+  std::vector<uint32_t> offsets(num_points + 1, 0);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    if (!IsDegenerate(face)) {
+      for (int c = 0; c < 3; ++c) {
+        ++offsets[face[c].value() + 1];
+      }
+    }
+  }
+  for (uint32_t p = 0; p < num_points; ++p) {
+    offsets[p + 1] += offsets[p];
+  }
+  std::vector<Edge> edges(offsets[num_points]);
+  std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    if (IsDegenerate(face)) {
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      const uint32_t corner = f.value() * 3 + c;
+      Edge &edge = edges[fill[CornerPoint(mesh, Next(corner))]++];
+      edge.corner = corner;
+      edge.to = CornerPoint(mesh, Previous(corner));
+    }
+  }
+
+  // Counts the edges from |from| to |to| and returns the corner of the last
+  // one in |out_corner|.
+  const auto find_edge = [&](uint32_t from, uint32_t to,
+                             uint32_t *out_corner) {
+    int count = 0;
+    for (uint32_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+      if (edges[i].to == to) {
+        *out_corner = edges[i].corner;
+        ++count;
+      }
+    }
+    return count;
+  };
+
+  std::vector<uint32_t> opposite(num_corners, kInvalidCorner);
+  ParallelFor(NumBlocks(num_points), [&](int32 block) {
+    const uint32_t end =
+        std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_points);
+    for (uint32_t from = static_cast<uint32_t>(block) * kBlockSize;
+         from < end; ++from) {
+      for (uint32_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+        uint32_t same = kInvalidCorner;
+        uint32_t reverse = kInvalidCorner;
+        if (find_edge(from, edges[i].to, &same) == 1 &&
+            find_edge(edges[i].to, from, &reverse) == 1) {
+          opposite[edges[i].corner] = reverse;
+        }
+      }
+    }
+  });
+  return opposite;
+}
+
+// Stripifies the faces of one region with the greedy heuristic of
+// MeshStripifier, treating faces of other regions as visited.
+class RegionStripifier {
+ public:
+  RegionStripifier(const Mesh &mesh, const std::vector<uint32_t> &opposite,
+                   const std::vector<uint32_t> &face_regions,
+                   uint32_t region, std::vector<uint8_t> *visited)
+      : mesh_(mesh),
+        opposite_(opposite),
+        face_regions_(face_regions),
+        region_(region),
+        visited_(*visited),
+        num_strips_(0) {}
+
+  // Appends the strips starting at |faces|, in order, to |out_indices|.
+  void Generate(const uint32_t *faces, uint32_t num_faces,
+                uint32_t primitive_restart_index,
+                std::vector<uint32_t> *out_indices) {
+    for (uint32_t i = 0; i < num_faces; ++i) {
+      const uint32_t f = faces[i];
+      if (visited_[f]) {
+        continue;
+      }
+      const int longest_strip_id = FindLongestStripFromFace(f);
+      if (num_strips_ > 0) {
+        out_indices->push_back(primitive_restart_index);
+      }
+      StoreStrip(longest_strip_id, out_indices);
+    }
+  }
+
+  int num_strips() const { return num_strips_; }
+
+ private:
+  bool IsFaceAvailable(uint32_t f) const {
+    return face_regions_[f] == region_ && !visited_[f];
+  }
+
+  int FindLongestStripFromFace(uint32_t f) {
+    const uint32_t first_c = f * 3;
+    int longest_strip_id = -1;
+    size_t longest_strip_length = 0;
+    for (int i = 0; i < 3; ++i) {
+      GenerateStripsFromCorner(i, first_c + i);
+      if (strip_faces_[i].size() > longest_strip_length) {
+        longest_strip_length = strip_faces_[i].size();
+        longest_strip_id = i;
+      }
+    }
+    return longest_strip_id;
+  }
+
+  // Same walk as MeshStripifier::GenerateStripsFromCorner(): grows the strip
+  // forward, then backward from the other side of the start face, moving the
+  // start corner to the last even face reached backward.
+  void GenerateStripsFromCorner(int local_strip_id, uint32_t c) {
+    std::vector<uint32_t> &strip_faces = strip_faces_[local_strip_id];
+    strip_faces.clear();
+    uint32_t start_c = c;
+    uint32_t f = c / 3;
+    for (int pass = 0; pass < 2; ++pass) {
+      if (pass == 1) {
+        if (opposite_[Previous(start_c)] == kInvalidCorner) {
+          break;
+        }
+        c = Next(opposite_[Previous(start_c)]);
+        f = c / 3;
+      }
+      int num_added_faces = 0;
+      while (IsFaceAvailable(f)) {
+        visited_[f] = 1;
+        strip_faces.push_back(f);
+        ++num_added_faces;
+        if (num_added_faces > 1) {
+          if (num_added_faces & 1) {
+            c = Next(c);
+          } else {
+            if (pass == 1) {
+              start_c = c;
+            }
+            c = Previous(c);
+          }
+        }
+        c = opposite_[c];
+        if (c == kInvalidCorner) {
+          break;
+        }
+        f = c / 3;
+      }
+      // An odd backward strip would start in the wrong direction.
+      if (pass == 1 && (num_added_faces & 1)) {
+        visited_[strip_faces.back()] = 0;
+        strip_faces.pop_back();
+      }
+    }
+    strip_start_corners_[local_strip_id] = start_c;
+    for (const uint32_t strip_face : strip_faces) {
+      visited_[strip_face] = 0;
+    }
+  }
+
+  void StoreStrip(int local_strip_id, std::vector<uint32_t> *out_indices) {
+    ++num_strips_;
+    const size_t num_strip_faces = strip_faces_[local_strip_id].size();
+    uint32_t c = strip_start_corners_[local_strip_id];
+    for (size_t i = 0; i < num_strip_faces; ++i) {
+      visited_[c / 3] = 1;
+      if (i == 0) {
+        out_indices->push_back(CornerPoint(mesh_, c));
+        out_indices->push_back(CornerPoint(mesh_, Next(c)));
+        out_indices->push_back(CornerPoint(mesh_, Previous(c)));
+      } else {
+        out_indices->push_back(CornerPoint(mesh_, c));
+        c = (i & 1) ? Previous(c) : Next(c);
+      }
+      c = opposite_[c];
+    }
+  }
+
+  const Mesh &mesh_;
+  const std::vector<uint32_t> &opposite_;
+  const std::vector<uint32_t> &face_regions_;
+  const uint32_t region_;
+  // Shared by all regions, each only touches the entries of its own faces.
+  std::vector<uint8_t> &visited_;
+  std::vector<uint32_t> strip_faces_[3];
+  uint32_t strip_start_corners_[3];
+  int num_strips_;
+};
+
+}  // namespace
+
+bool UD_ParallelMeshStripifier::GenerateTriangleStripsWithPrimitiveRestart(
+    const Mesh &mesh, uint32_t primitive_restart_index,
+    std::vector<uint32_t> *out_indices) {
+  num_strips_ = 0;
+  num_regions_ = 0;
+  out_indices->clear();
+  const PointAttribute *const position =
+      mesh.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (position == nullptr) {
+    return false;
+  }
+  const uint32_t num_faces = mesh.num_faces();
+  if (num_faces == 0) {
+    return true;
+  }
+  const uint32_t num_regions = static_cast<uint32_t>(
+      std::min<int64_t>(kUD_StripifierMaxRegions,
+                        std::max<int64_t>(1, num_faces /
+                                                 kUD_StripifierMinRegionFaces)));
+
+  // Faces in the order regions start strips at: face order for a single
+  // region, as MeshStripifier does, or sorted by the Morton code of the grid
+  // cell of their centroids, so that cutting the order into equal parts gives
+  // compact regions.
+  std::vector<uint32_t> face_order(num_faces);
+  if (num_regions == 1) {
+    for (uint32_t f = 0; f < num_faces; ++f) {
+      face_order[f] = f;
+    }
+  } else {
+    // Positions are converted once per value, faces share them.
+    const uint32_t num_values = static_cast<uint32_t>(position->size());
+    std::vector<float> values(num_values * 3);
+    ParallelFor(NumBlocks(num_values), [&](int32 block) {
+      const uint32_t end =
+          std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_values);
+      for (uint32_t v = static_cast<uint32_t>(block) * kBlockSize; v < end;
+           ++v) {
+        position->ConvertValue<float, 3>(AttributeValueIndex(v),
+                                         &values[v * 3]);
+      }
+    });
+    std::vector<float> centroids(num_faces * 3);
+    const int num_face_blocks = NumBlocks(num_faces);
+    std::vector<float> block_bounds(num_face_blocks * 6);
+    ParallelFor(num_face_blocks, [&](int32 block) {
+      float *const bounds = &block_bounds[block * 6];
+      std::fill(bounds, bounds + 3, std::numeric_limits<float>::max());
+      std::fill(bounds + 3, bounds + 6, std::numeric_limits<float>::lowest());
+      const uint32_t end =
+          std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+      for (uint32_t f = static_cast<uint32_t>(block) * kBlockSize; f < end;
+           ++f) {
+        const Mesh::Face &face = mesh.face(FaceIndex(f));
+        float *const centroid = &centroids[f * 3];
+        centroid[0] = centroid[1] = centroid[2] = 0.f;
+        for (int c = 0; c < 3; ++c) {
+          const float *const value =
+              &values[position->mapped_index(face[c]).value() * 3];
+          for (int i = 0; i < 3; ++i) {
+            centroid[i] += value[i];
+          }
+        }
+        for (int i = 0; i < 3; ++i) {
+          bounds[i] = std::min(bounds[i], centroid[i]);
+          bounds[i + 3] = std::max(bounds[i + 3], centroid[i]);
+        }
+      }
+    });
+    float bounds[6];
+    std::copy(block_bounds.begin(), block_bounds.begin() + 6, bounds);
+    for (int block = 1; block < num_face_blocks; ++block) {
+      for (int i = 0; i < 3; ++i) {
+        bounds[i] = std::min(bounds[i], block_bounds[block * 6 + i]);
+        bounds[i + 3] = std::max(bounds[i + 3], block_bounds[block * 6 + i + 3]);
+      }
+    }
+    // Cubic cells, so that flat or elongated meshes are not cut across their
+    // thin axes.
+    float extent = 0.f;
+    for (int i = 0; i < 3; ++i) {
+      extent = std::max(extent, bounds[i + 3] - bounds[i]);
+    }
+    const float scale = extent > 0.f ? ((1 << kCellBits) - 1) / extent : 0.f;
+
+    // Counting sort of the faces by cell, stable so that faces of a cell keep
+    // their order.
+    constexpr uint32_t kNumCells = 1u << (3 * kCellBits);
+    std::vector<uint32_t> face_cells(num_faces);
+    ParallelFor(num_face_blocks, [&](int32 block) {
+      const uint32_t end =
+          std::min(static_cast<uint32_t>(block + 1) * kBlockSize, num_faces);
+      for (uint32_t f = static_cast<uint32_t>(block) * kBlockSize; f < end;
+           ++f) {
+        uint32_t cell = 0;
+        for (int i = 0; i < 3; ++i) {
+          const uint32_t coord = static_cast<uint32_t>(
+              (centroids[f * 3 + i] - bounds[i]) * scale + 0.5f);
+          cell |= SpreadBits(coord) << i;
+        }
+        face_cells[f] = cell;
+      }
+    });
+    std::vector<uint32_t> cell_offsets(kNumCells + 1, 0);
+    for (uint32_t f = 0; f < num_faces; ++f) {
+      ++cell_offsets[face_cells[f] + 1];
+    }
+    for (uint32_t cell = 0; cell < kNumCells; ++cell) {
+      cell_offsets[cell + 1] += cell_offsets[cell];
+    }
+    for (uint32_t f = 0; f < num_faces; ++f) {
+      face_order[cell_offsets[face_cells[f]]++] = f;
+    }
+  }
+
+  std::vector<uint32_t> region_offsets(num_regions + 1);
+  for (uint32_t r = 0; r <= num_regions; ++r) {
+    region_offsets[r] = static_cast<uint32_t>(
+        static_cast<uint64_t>(num_faces) * r / num_regions);
+  }
+  std::vector<uint32_t> face_regions(num_faces);
+  ParallelFor(static_cast<int32>(num_regions), [&](int32 r) {
+    for (uint32_t i = region_offsets[r]; i < region_offsets[r + 1]; ++i) {
+      face_regions[face_order[i]] = r;
+    }
+  });
+
+  const std::vector<uint32_t> opposite = ComputeOppositeCorners(mesh);
+  std::vector<uint8_t> visited(num_faces, 0);
+  std::vector<std::vector<uint32_t>> region_indices(num_regions);
+  std::vector<int> region_strips(num_regions);
+  ParallelFor(static_cast<int32>(num_regions), [&](int32 r) {
+    RegionStripifier stripifier(mesh, opposite, face_regions, r, &visited);
+    stripifier.Generate(&face_order[region_offsets[r]],
+                        region_offsets[r + 1] - region_offsets[r],
+                        primitive_restart_index, &region_indices[r]);
+    region_strips[r] = stripifier.num_strips();
+  });
+
+  size_t num_indices = num_regions - 1;
+  for (uint32_t r = 0; r < num_regions; ++r) {
+    num_indices += region_indices[r].size();
+    num_strips_ += region_strips[r];
+  }
+  out_indices->reserve(num_indices);
+  for (uint32_t r = 0; r < num_regions; ++r) {
+    if (r > 0) {
+      out_indices->push_back(primitive_restart_index);
+    }
+    out_indices->insert(out_indices->end(), region_indices[r].begin(),
+                        region_indices[r].end());
+  }
+  num_regions_ = static_cast<int>(num_regions);
+  return true;
+}
+
+}  // namespace draco
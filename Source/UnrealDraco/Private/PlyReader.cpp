@@ -0,0 +1,511 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "PlyReader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "MappedFile.h"
+#include "ParallelDeduplication.h"
+#include "draco/core/draco_types.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int64_t kDefaultBlockSize = 1 << 16;
+
+// Triangle lists are the only variable-size data read in place; every list
+// is expected to hold three indices.
+constexpr int kListSize = 3;
+
+struct PlyPropertyLayout {
+  std::string name;
+  DataType data_type = DT_INVALID;
+  DataType list_type = DT_INVALID;
+  // Offset of the property inside a record.
+  int64_t offset = 0;
+};
+
+struct PlyElementLayout {
+  std::string name;
+  int64_t num_entries = 0;
+  std::vector<PlyPropertyLayout> properties;
+  int64_t record_size = 0;
+  // Offset of the first record from the start of the file.
+  int64_t data_offset = 0;
+
+  const PlyPropertyLayout *GetPropertyByName(const std::string &name) const {
+    for (const PlyPropertyLayout &property : properties) {
+      if (property.name == name) {
+        return &property;
+      }
+    }
+    return nullptr;
+  }
+};
+
+// Same names as PlyReader::GetDataTypeFromString().
+DataType GetDataTypeFromString(const std::string &name) {
+  if (name == "char" || name == "int8") {
+    return DT_INT8;
+  }
+  if (name == "uchar" || name == "uint8") {
+    return DT_UINT8;
+  }
+  if (name == "short" || name == "int16") {
+    return DT_INT16;
+  }
+  if (name == "ushort" || name == "uint16") {
+    return DT_UINT16;
+  }
+  if (name == "int" || name == "int32") {
+    return DT_INT32;
+  }
+  if (name == "uint" || name == "uint32") {
+    return DT_UINT32;
+  }
+  if (name == "float" || name == "float32") {
+    return DT_FLOAT32;
+  }
+  if (name == "double" || name == "float64") {
+    return DT_FLOAT64;
+  }
+  return DT_INVALID;
+}
+
+bool IsIntegerType(DataType data_type) {
+  return data_type == DT_INT8 || data_type == DT_UINT8 ||
+         data_type == DT_INT16 || data_type == DT_UINT16 ||
+         data_type == DT_INT32 || data_type == DT_UINT32;
+}
+
+std::vector<std::string> SplitWords(const char *begin, const char *end) {
+  std::vector<std::string> words;
+  const char *p = begin;
+  while (p < end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+      ++p;
+    }
+    const char *word = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') {
+      ++p;
+    }
+    if (p > word) {
+      words.emplace_back(word, p);
+    }
+  }
+  return words;
+}
+
+// Parses the header and computes the record layout of every element. Only
+// plain binary little-endian headers are accepted; lists are allowed for the
+// triangle indices of the "face" element.
+bool ParseLayout(const char *data, size_t data_size,
+                 std::vector<PlyElementLayout> *elements) {
+  const char *const data_end = data + data_size;
+  const char *p = data;
+  bool format_found = false;
+  bool first_line = true;
+  while (true) {
+    const char *line_end =
+        static_cast<const char *>(std::memchr(p, '\n', data_end - p));
+    if (line_end == nullptr) {
+      return false;
+    }
+    const std::vector<std::string> words = SplitWords(p, line_end);
+    p = line_end + 1;
+    if (first_line) {
+      if (words.size() != 1 || words[0] != "ply") {
+        return false;
+      }
+      first_line = false;
+      continue;
+    }
+    if (words.empty() || words[0] == "comment" || words[0] == "obj_info") {
+      continue;
+    }
+    if (words[0] == "format") {
+      if (words.size() != 3 || words[1] != "binary_little_endian") {
+        return false;
+      }
+      format_found = true;
+    } else if (words[0] == "element") {
+      if (words.size() != 3) {
+        return false;
+      }
+      char *count_end = nullptr;
+      const long long count = std::strtoll(words[2].c_str(), &count_end, 10);
+      if (*count_end != '\0' || count < 0 ||
+          count > std::numeric_limits<int32_t>::max()) {
+        return false;
+      }
+      PlyElementLayout element;
+      element.name = words[1];
+      element.num_entries = count;
+      elements->push_back(element);
+    } else if (words[0] == "property") {
+      if (elements->empty()) {
+        return false;
+      }
+      PlyPropertyLayout property;
+      if (words.size() == 5 && words[1] == "list") {
+        property.list_type = GetDataTypeFromString(words[2]);
+        property.data_type = GetDataTypeFromString(words[3]);
+        property.name = words[4];
+        if (!IsIntegerType(property.list_type) ||
+            !IsIntegerType(property.data_type)) {
+          return false;
+        }
+      } else if (words.size() == 3) {
+        property.data_type = GetDataTypeFromString(words[1]);
+        property.name = words[2];
+        if (property.data_type == DT_INVALID) {
+          return false;
+        }
+      } else {
+        return false;
+      }
+      elements->back().properties.push_back(property);
+    } else if (words[0] == "end_header") {
+      break;
+    } else {
+      return false;
+    }
+  }
+  if (!format_found) {
+    return false;
+  }
+
+  std::set<std::string> element_names;
+  int64_t offset = p - data;
+  for (PlyElementLayout &element : *elements) {
+    if (!element_names.insert(element.name).second) {
+      return false;
+    }
+    std::set<std::string> property_names;
+    int num_lists = 0;
+    for (PlyPropertyLayout &property : element.properties) {
+      if (!property_names.insert(property.name).second) {
+        return false;
+      }
+      property.offset = element.record_size;
+      if (property.list_type != DT_INVALID) {
+        if (element.name != "face" || (property.name != "vertex_indices" &&
+                                       property.name != "vertex_index")) {
+          return false;
+        }
+        ++num_lists;
+        element.record_size += DataTypeLength(property.list_type) +
+                               kListSize * DataTypeLength(property.data_type);
+      } else {
+        element.record_size += DataTypeLength(property.data_type);
+      }
+    }
+    if (num_lists > 1) {
+      return false;
+    }
+    element.data_offset = offset;
+    offset += element.num_entries * element.record_size;
+  }
+  return offset <= static_cast<int64_t>(data_size);
+}
+
+// Copies |num_columns| values of |kValueSize| bytes from every record in
+// [begin, end) to consecutive entries of |out|.
+template <int kValueSize>
+void CopyColumns(const char *records, int64_t record_size,
+                 const int64_t *column_offsets, int num_columns, int64_t begin,
+                 int64_t end, uint8_t *out) {
+  const int64_t out_stride = kValueSize * num_columns;
+  for (int64_t i = begin; i < end; ++i) {
+    const char *const record = records + i * record_size;
+    uint8_t *const entry = out + i * out_stride;
+    for (int c = 0; c < num_columns; ++c) {
+      std::memcpy(entry + c * kValueSize, record + column_offsets[c],
+                  kValueSize);
+    }
+  }
+}
+
+// Reads the triangles of records [begin, end). Returns false when a list does
+// not hold exactly three indices or an index is not a valid vertex.
+template <typename IndexT>
+bool CopyFaces(const char *records, const PlyElementLayout &face_element,
+               const PlyPropertyLayout &indices, uint32_t num_vertices,
+               int64_t begin, int64_t end, Mesh *mesh) {
+  const int count_size = DataTypeLength(indices.list_type);
+  for (int64_t i = begin; i < end; ++i) {
+    const char *const list = records + i * face_element.record_size +
+                             indices.offset;
+    // Little-endian integer equal to kListSize.
+    if (static_cast<uint8_t>(list[0]) != kListSize) {
+      return false;
+    }
+    for (int b = 1; b < count_size; ++b) {
+      if (list[b] != 0) {
+        return false;
+      }
+    }
+    Mesh::Face face;
+    for (int c = 0; c < kListSize; ++c) {
+      IndexT value;
+      std::memcpy(&value, list + count_size + c * sizeof(IndexT),
+                  sizeof(IndexT));
+      const uint32_t index = static_cast<uint32_t>(value);
+      if (index >= num_vertices) {
+        return false;
+      }
+      face[c] = PointIndex(index);
+    }
+    mesh->SetFace(FaceIndex(static_cast<uint32_t>(i)), face);
+  }
+  return true;
+}
+
+bool CopyFacesOfType(const char *records, const PlyElementLayout &face_element,
+                     const PlyPropertyLayout &indices, uint32_t num_vertices,
+                     int64_t begin, int64_t end, Mesh *mesh) {
+  switch (indices.data_type) {
+    case DT_INT8:
+      return CopyFaces<int8_t>(records, face_element, indices, num_vertices,
+                               begin, end, mesh);
+    case DT_UINT8:
+      return CopyFaces<uint8_t>(records, face_element, indices, num_vertices,
+                                begin, end, mesh);
+    case DT_INT16:
+      return CopyFaces<int16_t>(records, face_element, indices, num_vertices,
+                                begin, end, mesh);
+    case DT_UINT16:
+      return CopyFaces<uint16_t>(records, face_element, indices, num_vertices,
+                                 begin, end, mesh);
+    case DT_INT32:
+      return CopyFaces<int32_t>(records, face_element, indices, num_vertices,
+                                begin, end, mesh);
+    case DT_UINT32:
+      return CopyFaces<uint32_t>(records, face_element, indices, num_vertices,
+                                 begin, end, mesh);
+    default:
+      return false;
+  }
+}
+
+// Attribute filled from a set of scalar vertex properties.
+struct PlyColumnTarget {
+  PointAttribute *attribute = nullptr;
+  std::vector<int64_t> column_offsets;
+  int value_size = 0;
+};
+
+}  // namespace
+
+UD_PlyReader::UD_PlyReader() : block_size_(kDefaultBlockSize) {}
+
+StatusOr<std::unique_ptr<Mesh>> UD_PlyReader::ReadMeshFromFile(
+    const std::string &file_name) {
+  UD_MappedFile file;
+  if (!file.Open(file_name)) {
+    return Status(Status::IO_ERROR, "Unable to read input file.");
+  }
+  std::unique_ptr<Mesh> mesh(new Mesh());
+  DRACO_RETURN_IF_ERROR(
+      ReadFromBuffer(file.data(), file.size(), mesh.get(), mesh.get()));
+  return mesh;
+}
+
+StatusOr<std::unique_ptr<PointCloud>> UD_PlyReader::ReadPointCloudFromFile(
+    const std::string &file_name) {
+  UD_MappedFile file;
+  if (!file.Open(file_name)) {
+    return Status(Status::IO_ERROR, "Unable to read input file.");
+  }
+  std::unique_ptr<PointCloud> pc(new PointCloud());
+  DRACO_RETURN_IF_ERROR(
+      ReadFromBuffer(file.data(), file.size(), pc.get(), nullptr));
+  return pc;
+}
+
+Status UD_PlyReader::ReadFromBuffer(const char *data, size_t data_size,
+                                    PointCloud *out_point_cloud,
+                                    Mesh *out_mesh) {
+  std::vector<PlyElementLayout> elements;
+  if (!ParseLayout(data, data_size, &elements)) {
+    return Status(Status::DRACO_ERROR, "Unsupported PLY layout.");
+  }
+  const PlyElementLayout *vertex_element = nullptr;
+  const PlyElementLayout *face_element = nullptr;
+  for (const PlyElementLayout &element : elements) {
+    if (element.name == "vertex") {
+      vertex_element = &element;
+    } else if (element.name == "face") {
+      face_element = &element;
+    }
+  }
+  if (vertex_element == nullptr) {
+    return Status(Status::INVALID_PARAMETER, "vertex_element is null");
+  }
+
+  // Same attribute selection as PlyDecoder::DecodeVertexData().
+  const PlyPropertyLayout *const x = vertex_element->GetPropertyByName("x");
+  const PlyPropertyLayout *const y = vertex_element->GetPropertyByName("y");
+  const PlyPropertyLayout *const z = vertex_element->GetPropertyByName("z");
+  if (x == nullptr || y == nullptr || z == nullptr) {
+    return Status(Status::INVALID_PARAMETER, "x, y, or z property is missing");
+  }
+  const DataType position_type = x->data_type;
+  if (y->data_type != position_type || z->data_type != position_type ||
+      (position_type != DT_FLOAT32 && position_type != DT_INT32)) {
+    return Status(Status::INVALID_PARAMETER,
+                  "Unsupported type of x, y and z properties");
+  }
+  const PlyPropertyLayout *const nx = vertex_element->GetPropertyByName("nx");
+  const PlyPropertyLayout *const ny = vertex_element->GetPropertyByName("ny");
+  const PlyPropertyLayout *const nz = vertex_element->GetPropertyByName("nz");
+  const bool has_normals = nx != nullptr && ny != nullptr && nz != nullptr &&
+                           nx->data_type == DT_FLOAT32 &&
+                           ny->data_type == DT_FLOAT32 &&
+                           nz->data_type == DT_FLOAT32;
+  std::vector<const PlyPropertyLayout *> colors;
+  for (const char *name : {"red", "green", "blue", "alpha"}) {
+    const PlyPropertyLayout *const color =
+        vertex_element->GetPropertyByName(name);
+    if (color == nullptr) {
+      continue;
+    }
+    if (color->data_type != DT_UINT8) {
+      return Status(Status::INVALID_PARAMETER,
+                    "Color properties must be of type uint8");
+    }
+    colors.push_back(color);
+  }
+
+  // Same as PlyDecoder::DecodeFaceData(), meshes require a face element.
+  if (out_mesh != nullptr && face_element == nullptr) {
+    return Status(Status::INVALID_PARAMETER, "face_element is null");
+  }
+  const PlyPropertyLayout *face_indices = nullptr;
+  if (face_element != nullptr) {
+    face_indices = face_element->GetPropertyByName("vertex_indices");
+    if (face_indices == nullptr) {
+      face_indices = face_element->GetPropertyByName("vertex_index");
+    }
+    if (face_indices == nullptr || face_indices->list_type == DT_INVALID) {
+      return Status(Status::DRACO_ERROR, "No faces defined");
+    }
+  }
+
+  const uint32_t num_vertices =
+      static_cast<uint32_t>(vertex_element->num_entries);
+  out_point_cloud->set_num_points(num_vertices);
+
+  std::vector<PlyColumnTarget> targets;
+  {
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::POSITION, nullptr, 3, position_type, false,
+            DataTypeLength(position_type) * 3, 0);
+    PlyColumnTarget target;
+    target.attribute = out_point_cloud->attribute(
+        out_point_cloud->AddAttribute(va, true, num_vertices));
+    target.column_offsets = {x->offset, y->offset, z->offset};
+    target.value_size = DataTypeLength(position_type);
+    targets.push_back(target);
+  }
+  if (has_normals) {
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::NORMAL, nullptr, 3, DT_FLOAT32, false,
+            sizeof(float) * 3, 0);
+    PlyColumnTarget target;
+    target.attribute = out_point_cloud->attribute(
+        out_point_cloud->AddAttribute(va, true, num_vertices));
+    target.column_offsets = {nx->offset, ny->offset, nz->offset};
+    target.value_size = sizeof(float);
+    targets.push_back(target);
+  }
+  if (!colors.empty()) {
+    const int num_colors = static_cast<int>(colors.size());
+    GeometryAttribute va;
+    va.Init(GeometryAttribute::COLOR, nullptr, num_colors, DT_UINT8, true,
+            sizeof(uint8_t) * num_colors, 0);
+    PlyColumnTarget target;
+    target.attribute = out_point_cloud->attribute(
+        out_point_cloud->AddAttribute(va, true, num_vertices));
+    for (const PlyPropertyLayout *color : colors) {
+      target.column_offsets.push_back(color->offset);
+    }
+    target.value_size = sizeof(uint8_t);
+    targets.push_back(target);
+  }
+
+  const int64_t block_size = block_size_ > 0 ? block_size_ : kDefaultBlockSize;
+  const char *const vertex_records = data + vertex_element->data_offset;
+  const int32 num_vertex_blocks = static_cast<int32>(
+      (vertex_element->num_entries + block_size - 1) / block_size);
+  ParallelFor(num_vertex_blocks, [&](int32 block) {
+    const int64_t begin = block * block_size;
+    const int64_t end =
+        std::min<int64_t>(begin + block_size, vertex_element->num_entries);
+    for (const PlyColumnTarget &target : targets) {
+      uint8_t *const out = target.attribute->buffer()->data();
+      const int num_columns = static_cast<int>(target.column_offsets.size());
+      if (target.value_size == 1) {
+        CopyColumns<1>(vertex_records, vertex_element->record_size,
+                       target.column_offsets.data(), num_columns, begin, end,
+                       out);
+      } else {
+        CopyColumns<4>(vertex_records, vertex_element->record_size,
+                       target.column_offsets.data(), num_columns, begin, end,
+                       out);
+      }
+    }
+  });
+
+  // The faces are validated even for point clouds: the offsets of the
+  // elements stored after them assume three indices per list.
+  if (face_element != nullptr && face_element->num_entries > 0) {
+    Mesh scratch_mesh;
+    Mesh *const mesh = out_mesh != nullptr ? out_mesh : &scratch_mesh;
+    mesh->SetNumFaces(static_cast<size_t>(face_element->num_entries));
+    const char *const face_records = data + face_element->data_offset;
+    const int32 num_face_blocks = static_cast<int32>(
+        (face_element->num_entries + block_size - 1) / block_size);
+    std::vector<uint8_t> block_ok(num_face_blocks, 0);
+    ParallelFor(num_face_blocks, [&](int32 block) {
+      const int64_t begin = block * block_size;
+      const int64_t end =
+          std::min<int64_t>(begin + block_size, face_element->num_entries);
+      block_ok[block] =
+          CopyFacesOfType(face_records, *face_element, *face_indices,
+                          num_vertices, begin, end, mesh)
+              ? 1
+              : 0;
+    });
+    for (const uint8_t ok : block_ok) {
+      if (!ok) {
+        return Status(Status::DRACO_ERROR,
+                      "Faces are not triangles or use invalid indices.");
+      }
+    }
+  }
+
+  // Like PlyDecoder, point clouds are not deduplicated.
+  if (out_mesh != nullptr && out_mesh->num_faces() != 0) {
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+    if (!UD_DeduplicateAttributeValues(out_point_cloud)) {
+      return Status(Status::DRACO_ERROR,
+                    "Could not deduplicate attribute values");
+    }
+#endif
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+    UD_DeduplicatePointIds(out_point_cloud, out_mesh);
+#endif
+  }
+  return OkStatus();
+}
+
+}  // namespace draco
@@ -0,0 +1,233 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "PlyWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "draco/core/draco_types.h"
+#include "draco/io/file_writer_factory.h"
+#include "draco/io/file_writer_interface.h"
+#include "draco/io/ply_encoder.h"
+
+namespace draco {
+
+namespace {
+
+constexpr int64_t kDefaultBlockSize = 1 << 16;
+
+// Same names as PlyEncoder::GetAttributeDataType(); nullptr for the types it
+// does not support.
+const char *GetPlyDataType(const PointAttribute &att) {
+  switch (att.data_type()) {
+    case DT_FLOAT32:
+      return "float";
+    case DT_UINT8:
+      return "uchar";
+    case DT_INT32:
+      return "int";
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+void AppendProperty(const char *type, const char *name, std::string *out) {
+  out->append("property ");
+  out->append(type);
+  out->append(" ");
+  out->append(name);
+  out->append("\n");
+}
+
+// Attributes stored by PlyEncoder, nullptr when not stored.
+struct PlyAttributes {
+  const PointAttribute *pos_att = nullptr;
+  const PointAttribute *normal_att = nullptr;
+  const PointAttribute *tex_att = nullptr;
+  const PointAttribute *color_att = nullptr;
+  int64_t color_size = 0;
+};
+
+inline uint8_t *CopyValue(const PointAttribute &att, PointIndex point,
+                          int64_t size, uint8_t *out) {
+  memcpy(out, att.GetAddress(att.mapped_index(point)), size);
+  return out + size;
+}
+
+}  // namespace
+
+UD_PlyWriter::UD_PlyWriter() : block_size_(kDefaultBlockSize) {}
+
+bool UD_PlyWriter::WriteToFile(const PointCloud &pc,
+                               const std::string &file_name) {
+  std::unique_ptr<FileWriterInterface> file =
+      FileWriterFactory::OpenWriter(file_name);
+  if (!file) {
+    return false;
+  }
+  EncoderBuffer buffer;
+  if (!WriteToBuffer(pc, &buffer)) {
+    return false;
+  }
+  return file->Write(buffer.data(), buffer.size());
+}
+
+bool UD_PlyWriter::WriteToFile(const Mesh &mesh,
+                               const std::string &file_name) {
+  std::unique_ptr<FileWriterInterface> file =
+      FileWriterFactory::OpenWriter(file_name);
+  if (!file) {
+    return false;
+  }
+  EncoderBuffer buffer;
+  if (!WriteToBuffer(mesh, &buffer)) {
+    return false;
+  }
+  return file->Write(buffer.data(), buffer.size());
+}
+
+bool UD_PlyWriter::WriteToBuffer(const PointCloud &pc,
+                                 EncoderBuffer *out_buffer) {
+  return WriteToBufferInternal(pc, nullptr, out_buffer);
+}
+
+bool UD_PlyWriter::WriteToBuffer(const Mesh &mesh, EncoderBuffer *out_buffer) {
+  return WriteToBufferInternal(mesh, &mesh, out_buffer);
+}
+
+bool UD_PlyWriter::WriteToBufferInternal(const PointCloud &pc,
+                                         const Mesh *mesh,
+                                         EncoderBuffer *out_buffer) {
+  PlyAttributes atts;
+  atts.pos_att = pc.GetNamedAttribute(GeometryAttribute::POSITION);
+  if (atts.pos_att == nullptr) {
+    return false;
+  }
+  // Like PlyEncoder, normals are only stored with three components and
+  // texture coordinates with two.
+  atts.normal_att = pc.GetNamedAttribute(GeometryAttribute::NORMAL);
+  if (atts.normal_att && atts.normal_att->num_components() != 3) {
+    atts.normal_att = nullptr;
+  }
+  atts.tex_att = pc.GetNamedAttribute(GeometryAttribute::TEX_COORD);
+  if (atts.tex_att && atts.tex_att->num_components() != 2) {
+    atts.tex_att = nullptr;
+  }
+  atts.color_att = pc.GetNamedAttribute(GeometryAttribute::COLOR);
+  if (atts.color_att) {
+    atts.color_size =
+        std::min(4, static_cast<int>(atts.color_att->num_components())) *
+        DataTypeLength(atts.color_att->data_type());
+  }
+
+  const bool supported =
+      GetPlyDataType(*atts.pos_att) &&
+      (!atts.normal_att || GetPlyDataType(*atts.normal_att)) &&
+      (!atts.color_att || atts.color_att->num_components() == 0 ||
+       GetPlyDataType(*atts.color_att)) &&
+      (!mesh || !atts.tex_att || GetPlyDataType(*atts.tex_att));
+  if (!supported) {
+    PlyEncoder encoder;
+    return mesh ? encoder.EncodeToBuffer(*mesh, out_buffer)
+                : encoder.EncodeToBuffer(pc, out_buffer);
+  }
+
+  std::string header = "ply\nformat binary_little_endian 1.0\n";
+  header += "element vertex " + std::to_string(pc.num_points()) + "\n";
+  const char *const pos_type = GetPlyDataType(*atts.pos_att);
+  AppendProperty(pos_type, "x", &header);
+  AppendProperty(pos_type, "y", &header);
+  AppendProperty(pos_type, "z", &header);
+  if (atts.normal_att) {
+    const char *const normal_type = GetPlyDataType(*atts.normal_att);
+    AppendProperty(normal_type, "nx", &header);
+    AppendProperty(normal_type, "ny", &header);
+    AppendProperty(normal_type, "nz", &header);
+  }
+  if (atts.color_att) {
+    const char *const color_names[] = {"red", "green", "blue", "alpha"};
+    const int num_colors =
+        std::min(4, static_cast<int>(atts.color_att->num_components()));
+    for (int c = 0; c < num_colors; ++c) {
+      AppendProperty(GetPlyDataType(*atts.color_att), color_names[c], &header);
+    }
+  }
+  if (mesh) {
+    header += "element face " + std::to_string(mesh->num_faces()) + "\n";
+    header += "property list uchar int vertex_indices\n";
+    if (atts.tex_att) {
+      header += "property list uchar ";
+      header += GetPlyDataType(*atts.tex_att);
+      header += " texcoord\n";
+    }
+  }
+  header += "end_header\n";
+
+  const int64_t pos_size = atts.pos_att->byte_stride();
+  const int64_t normal_size =
+      atts.normal_att ? atts.normal_att->byte_stride() : 0;
+  const int64_t vertex_record_size = pos_size + normal_size + atts.color_size;
+  const int64_t tex_size =
+      (mesh && atts.tex_att) ? atts.tex_att->byte_stride() : 0;
+  const int64_t face_record_size =
+      1 + 3 * sizeof(uint32_t) + (tex_size > 0 ? 1 + 3 * tex_size : 0);
+  const int64_t num_points = pc.num_points();
+  const int64_t num_faces = mesh ? mesh->num_faces() : 0;
+
+  std::vector<char> *const out = out_buffer->buffer();
+  const int64_t header_offset = out->size();
+  const int64_t vertex_offset = header_offset + header.size();
+  const int64_t face_offset = vertex_offset + num_points * vertex_record_size;
+  out->resize(face_offset + num_faces * face_record_size);
+  memcpy(out->data() + header_offset, header.data(), header.size());
+
+  const int64_t block_size = std::max<int64_t>(block_size_, 1);
+  const int64_t num_vertex_blocks = (num_points + block_size - 1) / block_size;
+  const int64_t num_face_blocks = (num_faces + block_size - 1) / block_size;
+  uint8_t *const data = reinterpret_cast<uint8_t *>(out->data());
+  ParallelFor(static_cast<int32>(num_vertex_blocks + num_face_blocks),
+              [&](int32 block) {
+    if (block < num_vertex_blocks) {
+      const int64_t begin = block * block_size;
+      const int64_t end = std::min(begin + block_size, num_points);
+      uint8_t *p = data + vertex_offset + begin * vertex_record_size;
+      for (int64_t i = begin; i < end; ++i) {
+        const PointIndex point(static_cast<uint32_t>(i));
+        p = CopyValue(*atts.pos_att, point, pos_size, p);
+        if (atts.normal_att) {
+          p = CopyValue(*atts.normal_att, point, normal_size, p);
+        }
+        if (atts.color_att) {
+          p = CopyValue(*atts.color_att, point, atts.color_size, p);
+        }
+      }
+      return;
+    }
+    const int64_t begin = (block - num_vertex_blocks) * block_size;
+    const int64_t end = std::min(begin + block_size, num_faces);
+    uint8_t *p = data + face_offset + begin * face_record_size;
+    for (int64_t i = begin; i < end; ++i) {
+      const Mesh::Face &face = mesh->face(FaceIndex(static_cast<uint32_t>(i)));
+      *p++ = 3;
+      for (int c = 0; c < 3; ++c) {
+        const uint32_t index = face[c].value();
+        memcpy(p, &index, sizeof(index));
+        p += sizeof(index);
+      }
+      if (tex_size > 0) {
+        *p++ = 6;
+        for (int c = 0; c < 3; ++c) {
+          p = CopyValue(*atts.tex_att, face[c], tex_size, p);
+        }
+      }
+    }
+  });
+  return true;
+}
+
+}  // namespace draco
@@ -0,0 +1,181 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "QuantizationTuner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "OctahedronBulk.h"
+#include "draco/attributes/attribute_quantization_transform.h"
+#include "draco/compression/attributes/normal_compression_utils.h"
+#include "draco/core/quantization_utils.h"
+
+namespace draco {
+
+namespace {
+
+// A float32 carries 24 significant bits, more quantization bits can not
+// reduce the error any further.
+constexpr int kMaxTunedBits = 24;
+
+// Normals converted per call of the bulk octahedral conversions.
+constexpr int kNormalChunkSize = 4096;
+
+std::vector<float> GatherValues(const PointAttribute &att) {
+  const int num_components = att.num_components();
+  std::vector<float> values(att.size() * num_components);
+  for (AttributeValueIndex i(0); i < static_cast<uint32_t>(att.size()); ++i) {
+    att.ConvertValue<float>(i, static_cast<int8_t>(num_components),
+                            &values[i.value() * num_components]);
+  }
+  return values;
+}
+
+// Folds per value errors into the requested metric.
+class ErrorAccumulator {
+ public:
+  explicit ErrorAccumulator(UD_QuantizationErrorMetric metric)
+      : metric_(metric), max_error_(0.0), sum_squared_(0.0), count_(0) {}
+
+  void Add(double error) {
+    max_error_ = std::max(max_error_, error);
+    sum_squared_ += error * error;
+    ++count_;
+  }
+
+  double Result() const {
+    if (metric_ == UD_MAX_ERROR || count_ == 0) {
+      return max_error_;
+    }
+    return std::sqrt(sum_squared_ / count_);
+  }
+
+ private:
+  UD_QuantizationErrorMetric metric_;
+  double max_error_;
+  double sum_squared_;
+  int64_t count_;
+};
+
+}  // namespace
+
+UD_QuantizationTuner::UD_QuantizationTuner(UD_QuantizationErrorMetric metric)
+    : metric_(metric) {}
+
+int UD_QuantizationTuner::FindMinimalBits(const PointAttribute &att,
+                                          float tolerance) const {
+  if (att.data_type() != DT_FLOAT32 || att.size() == 0) {
+    return -1;
+  }
+  const bool is_normal = att.attribute_type() == GeometryAttribute::NORMAL;
+  if (is_normal && att.num_components() != 3) {
+    return -1;
+  }
+  // OctahedronToolBox requires at least two bits.
+  const int min_bits = is_normal ? 2 : 1;
+  const std::vector<float> values = GatherValues(att);
+
+  // Every candidate is independent, evaluate them all in parallel.
+  std::vector<double> errors(kMaxTunedBits + 1, 0.0);
+  ParallelFor(kMaxTunedBits - min_bits + 1, [&](int32 index) {
+    const int bits = min_bits + index;
+    errors[bits] = is_normal ? ComputeNormalError(values, bits)
+                             : ComputeQuantizationError(att, values, bits);
+  });
+
+  int best_bits = kMaxTunedBits;
+  for (int bits = kMaxTunedBits; bits >= min_bits; --bits) {
+    if (errors[bits] > tolerance) {
+      break;
+    }
+    best_bits = bits;
+  }
+  return best_bits;
+}
+
+double UD_QuantizationTuner::ComputeError(const PointAttribute &att,
+                                          int bits) const {
+  const std::vector<float> values = GatherValues(att);
+  if (att.attribute_type() == GeometryAttribute::NORMAL) {
+    return ComputeNormalError(values, bits);
+  }
+  return ComputeQuantizationError(att, values, bits);
+}
+
+double UD_QuantizationTuner::ComputeQuantizationError(
+    const PointAttribute &att, const std::vector<float> &values,
+    int bits) const {
+  // Use the same parameters the encoder derives for the attribute.
+  AttributeQuantizationTransform transform;
+  if (!transform.ComputeParameters(att, bits)) {
+    return std::numeric_limits<double>::max();
+  }
+  const int32_t max_quantized_value = (1 << bits) - 1;
+  Quantizer quantizer;
+  quantizer.Init(transform.range(), max_quantized_value);
+  Dequantizer dequantizer;
+  if (!dequantizer.Init(transform.range(), max_quantized_value)) {
+    return std::numeric_limits<double>::max();
+  }
+
+  const int num_components = att.num_components();
+  ErrorAccumulator accumulator(metric_);
+  for (size_t i = 0; i < values.size(); i += num_components) {
+    double squared_distance = 0.0;
+    for (int c = 0; c < num_components; ++c) {
+      const float min_value = transform.min_value(c);
+      const int32_t q = quantizer.QuantizeFloat(values[i + c] - min_value);
+      const float decoded = dequantizer.DequantizeFloat(q) + min_value;
+      const double diff = static_cast<double>(values[i + c]) - decoded;
+      squared_distance += diff * diff;
+    }
+    accumulator.Add(std::sqrt(squared_distance));
+  }
+  return accumulator.Result();
+}
+
+double UD_QuantizationTuner::ComputeNormalError(
+    const std::vector<float> &values, int bits) const {
+  OctahedronToolBox octahedron_tool_box;
+  if (!octahedron_tool_box.SetQuantizationBits(bits)) {
+    return std::numeric_limits<double>::max();
+  }
+  const double rad_to_deg = 180.0 / 3.14159265358979323846;
+  ErrorAccumulator accumulator(metric_);
+  // Normals are round tripped a chunk at a time with the bulk conversions.
+  const int num_normals = static_cast<int>(values.size() / 3);
+  std::vector<int32_t> coords(kNormalChunkSize * 2);
+  std::vector<float> decoded(kNormalChunkSize * 3);
+  for (int begin = 0; begin < num_normals; begin += kNormalChunkSize) {
+    const int n = std::min(kNormalChunkSize, num_normals - begin);
+    const float *const normals = &values[begin * 3];
+    UD_FloatVectorsToQuantizedOctahedralCoords(octahedron_tool_box, normals, n,
+                                               coords.data());
+    UD_QuantizedOctahedralCoordsToUnitVectors(octahedron_tool_box,
+                                              coords.data(), n, decoded.data());
+    for (int i = 0; i < n; ++i) {
+      const float *const normal = normals + i * 3;
+      const double length =
+          std::sqrt(static_cast<double>(normal[0]) * normal[0] +
+                    static_cast<double>(normal[1]) * normal[1] +
+                    static_cast<double>(normal[2]) * normal[2]);
+      if (length < 1e-6) {
+        // Degenerate normals have no direction to preserve.
+        continue;
+      }
+      const float *const decoded_normal = &decoded[i * 3];
+      const double cos_angle =
+          (normal[0] * decoded_normal[0] + normal[1] * decoded_normal[1] +
+           normal[2] * decoded_normal[2]) /
+          length;
+      accumulator.Add(std::acos(std::max(-1.0, std::min(1.0, cos_angle))) *
+                      rad_to_deg);
+    }
+  }
+  return accumulator.Result();
+}
+
+}  // namespace draco
@@ -0,0 +1,511 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "SymbolModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "CoreMinimal.h"
+#include "DecodeProfiler.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/entropy/rans_symbol_coding.h"
+#include "draco/compression/entropy/symbol_decoding.h"
+#include "draco/compression/entropy/symbol_encoding.h"
+#include "draco/core/bit_utils.h"
+#include "draco/core/hash_utils.h"
+#include "draco/core/varint_decoding.h"
+#include "draco/core/varint_encoding.h"
+
+namespace draco {
+
+namespace {
+
+// Coding of the stream that follows the method byte.
+enum UD_SymbolCodingMethod : uint8_t {
+  UD_SYMBOL_CODING_DRACO = 0,
+  UD_SYMBOL_CODING_MODEL = 1,
+  UD_SYMBOL_CODING_TABLE = 2,
+};
+
+constexpr uint32_t kAnsIoBase = 256;
+constexpr int kMinPrecisionBits = 12;
+constexpr int kMaxPrecisionBits = 20;
+// Largest alphabet coded with a per-stream table by the plugin, which keeps
+// the lookup tables kept by each thread small.
+constexpr int kMaxTableSymbols = 256;
+constexpr size_t kSymbolTableCacheSize = 8;
+
+struct SymbolTableCacheEntry {
+  uint64_t fingerprint;
+  std::vector<char> table;
+  std::unique_ptr<UD_SymbolModel> model;
+};
+
+// Returns the table serialized in |table|, building it unless it is one of
+// the last kSymbolTableCacheSize tables used by this thread. Sets |cache_hit|
+// when it was. Returns nullptr for invalid tables.
+const UD_SymbolModel *FindOrBuildTable(const char *table, size_t table_size,
+                                       bool *cache_hit) {
+  // Most recently used first.
+  thread_local std::vector<SymbolTableCacheEntry> cache;
+  const uint64_t fingerprint = FingerprintString(table, table_size);
+  for (size_t i = 0; i < cache.size(); ++i) {
+    if (cache[i].fingerprint == fingerprint &&
+        cache[i].table.size() == table_size &&
+        memcmp(cache[i].table.data(), table, table_size) == 0) {
+      std::rotate(cache.begin(), cache.begin() + i, cache.begin() + i + 1);
+      *cache_hit = true;
+      return cache[0].model.get();
+    }
+  }
+  *cache_hit = false;
+  DecoderBuffer buffer;
+  buffer.Init(table, table_size);
+  std::unique_ptr<UD_SymbolModel> model =
+      UD_SymbolModel::DecodeTable(0, true, &buffer);
+  if (model == nullptr || buffer.remaining_size() != 0) {
+    return nullptr;
+  }
+  if (cache.size() == kSymbolTableCacheSize) {
+    cache.pop_back();
+  }
+  SymbolTableCacheEntry entry;
+  entry.fingerprint = fingerprint;
+  entry.table.assign(table, table + table_size);
+  entry.model = std::move(model);
+  cache.insert(cache.begin(), std::move(entry));
+  return cache[0].model.get();
+}
+
+template <int precision_bits_t>
+void EncodeWithPrecision(const UD_SymbolModel &model,
+                         const uint32_t *symbols, int num_values,
+                         EncoderBuffer *target_buffer) {
+  // A symbol never costs more than |precision_bits_t| bits, and write_end()
+  // flushes at most four bytes of state.
+  std::vector<uint8_t> data(
+      static_cast<size_t>(num_values) * ((precision_bits_t + 7) / 8) + 8);
+  RAnsEncoder<precision_bits_t> ans;
+  ans.write_init(data.data());
+  // rANS decodes in the reverse order of encoding.
+  for (int i = num_values - 1; i >= 0; --i) {
+    ans.rans_write(&model.probability(symbols[i]));
+  }
+  const int data_size = ans.write_end();
+  EncodeVarint(static_cast<uint32_t>(data_size), target_buffer);
+  target_buffer->Encode(data.data(), data_size);
+}
+
+// Mirrors RAnsDecoder but reads the tables of |model| instead of building its
+// own.
+template <int precision_bits_t>
+bool DecodeWithPrecision(const UD_SymbolModel &model, const uint8_t *data,
+                         int data_size, uint32_t num_values,
+                         uint32_t *out_values) {
+  constexpr uint32_t precision = 1u << precision_bits_t;
+  constexpr uint32_t l_base = precision * 4;
+  if (data_size < 1) {
+    return false;
+  }
+  int offset;
+  uint32_t state;
+  switch (data[data_size - 1] >> 6) {
+    case 0:
+      offset = data_size - 1;
+      state = data[data_size - 1] & 0x3F;
+      break;
+    case 1:
+      if (data_size < 2) {
+        return false;
+      }
+      offset = data_size - 2;
+      state = mem_get_le16(data + offset) & 0x3FFF;
+      break;
+    case 2:
+      if (data_size < 3) {
+        return false;
+      }
+      offset = data_size - 3;
+      state = mem_get_le24(data + offset) & 0x3FFFFF;
+      break;
+    default:
+      if (data_size < 4) {
+        return false;
+      }
+      offset = data_size - 4;
+      state = mem_get_le32(data + offset) & 0x3FFFFFFF;
+      break;
+  }
+  state += l_base;
+  if (state >= l_base * kAnsIoBase) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_values; ++i) {
+    while (state < l_base && offset > 0) {
+      state = state * kAnsIoBase + data[--offset];
+    }
+    const uint32_t quo = state / precision;
+    const uint32_t rem = state % precision;
+    const uint32_t symbol = model.symbol_at(rem);
+    const rans_sym &sym = model.probability(symbol);
+    state = quo * sym.prob + rem - sym.cum_prob;
+    out_values[i] = symbol;
+  }
+  // The encoder started from |l_base| with an empty buffer.
+  while (state < l_base && offset > 0) {
+    state = state * kAnsIoBase + data[--offset];
+  }
+  return state == l_base && offset == 0;
+}
+
+// Dispatches |function| to the instantiation for |precision_bits|.
+#define UD_DISPATCH_PRECISION(precision_bits, function, ...) \
+  switch (precision_bits) {                                  \
+    case 12:                                                 \
+      return function<12>(__VA_ARGS__);                      \
+    case 13:                                                 \
+      return function<13>(__VA_ARGS__);                      \
+    case 14:                                                 \
+      return function<14>(__VA_ARGS__);                      \
+    case 15:                                                 \
+      return function<15>(__VA_ARGS__);                      \
+    case 16:                                                 \
+      return function<16>(__VA_ARGS__);                      \
+    case 17:                                                 \
+      return function<17>(__VA_ARGS__);                      \
+    case 18:                                                 \
+      return function<18>(__VA_ARGS__);                      \
+    case 19:                                                 \
+      return function<19>(__VA_ARGS__);                      \
+    default:                                                 \
+      return function<20>(__VA_ARGS__);                      \
+  }
+
+void EncodeWithModel(const UD_SymbolModel &model, const uint32_t *symbols,
+                     int num_values, EncoderBuffer *target_buffer) {
+  UD_DISPATCH_PRECISION(model.precision_bits(), EncodeWithPrecision, model,
+                        symbols, num_values, target_buffer);
+}
+
+bool DecodeWithModel(const UD_SymbolModel &model, const uint8_t *data,
+                     int data_size, uint32_t num_values,
+                     uint32_t *out_values) {
+  UD_DISPATCH_PRECISION(model.precision_bits(), DecodeWithPrecision, model,
+                        data, data_size, num_values, out_values);
+}
+
+#undef UD_DISPATCH_PRECISION
+
+// Estimated bits of EncodeSymbols() with a per-stream rANS table.
+double ComputeStreamBits(const std::vector<uint64_t> &frequencies,
+                         int num_values) {
+  double bits = 0;
+  int num_unique_symbols = 0;
+  for (const uint64_t frequency : frequencies) {
+    if (frequency > 0) {
+      bits += static_cast<double>(frequency) *
+              std::log2(static_cast<double>(num_values) /
+                        static_cast<double>(frequency));
+      ++num_unique_symbols;
+    }
+  }
+  return bits + static_cast<double>(ApproximateRAnsFrequencyTableBits(
+                    static_cast<int32_t>(frequencies.size()),
+                    num_unique_symbols));
+}
+
+}  // namespace
+
+std::unique_ptr<UD_SymbolModel> UD_SymbolModel::Train(
+    uint32_t id, const uint64_t *frequencies, int num_symbols) {
+  return Create(id, frequencies, num_symbols, true);
+}
+
+std::unique_ptr<UD_SymbolModel> UD_SymbolModel::Create(
+    uint32_t id, const uint64_t *frequencies, int num_symbols,
+    bool smooth) {
+  if (num_symbols <= 0) {
+    return nullptr;
+  }
+  const int precision_bits = ComputeRAnsPrecisionFromUniqueSymbolsBitLength(
+      MostSignificantBit(static_cast<uint32_t>(num_symbols)) + 1);
+  const uint32_t precision = 1u << precision_bits;
+  if (static_cast<uint32_t>(num_symbols) > precision) {
+    return nullptr;
+  }
+  std::unique_ptr<UD_SymbolModel> model(new UD_SymbolModel(id, precision_bits));
+  model->probability_table_.resize(num_symbols);
+
+  // When smoothing, every symbol is counted once more than observed so that
+  // symbols missing from the corpus remain codable.
+  const double bias = smooth ? 1 : 0;
+  double total = 0;
+  for (int i = 0; i < num_symbols; ++i) {
+    total += static_cast<double>(frequencies[i]) + bias;
+  }
+  if (total == 0) {
+    return nullptr;
+  }
+  int64_t total_prob = 0;
+  for (int i = 0; i < num_symbols; ++i) {
+    const double count = static_cast<double>(frequencies[i]) + bias;
+    const uint32_t rans_prob =
+        count == 0 ? 0
+                   : std::max(1u, static_cast<uint32_t>(
+                                      count / total *
+                                      static_cast<double>(precision)));
+    model->probability_table_[i].prob = rans_prob;
+    total_prob += rans_prob;
+  }
+  // Rounding leaves the total off by a little. The difference is taken from or
+  // given to the most probable symbols, which changes their cost the least.
+  std::vector<int> order(num_symbols);
+  for (int i = 0; i < num_symbols; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&model](int a, int b) {
+    return model->probability_table_[a].prob >
+           model->probability_table_[b].prob;
+  });
+  if (total_prob < precision) {
+    model->probability_table_[order[0]].prob +=
+        static_cast<uint32_t>(precision - total_prob);
+  } else {
+    for (int i = 0; i < num_symbols && total_prob > precision; ++i) {
+      rans_sym &sym = model->probability_table_[order[i]];
+      if (sym.prob <= 1) {
+        break;
+      }
+      const uint32_t fix = static_cast<uint32_t>(
+          std::min<int64_t>(sym.prob - 1, total_prob - precision));
+      sym.prob -= fix;
+      total_prob -= fix;
+    }
+  }
+  if (!model->BuildTables()) {
+    return nullptr;
+  }
+  return model;
+}
+
+void UD_SymbolModel::AccumulateFrequencies(const uint32_t *symbols,
+                                           int num_values,
+                                           std::vector<uint64_t> *frequencies) {
+  for (int i = 0; i < num_values; ++i) {
+    if (symbols[i] >= frequencies->size()) {
+      frequencies->resize(symbols[i] + 1, 0);
+    }
+    ++(*frequencies)[symbols[i]];
+  }
+}
+
+void UD_SymbolModel::Encode(EncoderBuffer *out_buffer) const {
+  EncodeVarint(id_, out_buffer);
+  EncodeTable(out_buffer);
+}
+
+std::unique_ptr<UD_SymbolModel> UD_SymbolModel::Decode(DecoderBuffer *buffer) {
+  uint32_t id;
+  if (!DecodeVarint(&id, buffer)) {
+    return nullptr;
+  }
+  return DecodeTable(id, false, buffer);
+}
+
+void UD_SymbolModel::EncodeTable(EncoderBuffer *out_buffer) const {
+  out_buffer->Encode(static_cast<uint8_t>(precision_bits_));
+  EncodeVarint(static_cast<uint32_t>(num_symbols()), out_buffer);
+  // A zero probability is followed by the number of zeros after it.
+  for (int i = 0; i < num_symbols(); ++i) {
+    EncodeVarint(probability_table_[i].prob, out_buffer);
+    if (probability_table_[i].prob == 0) {
+      int run = 0;
+      while (i + 1 < num_symbols() && probability_table_[i + 1].prob == 0) {
+        ++run;
+        ++i;
+      }
+      EncodeVarint(static_cast<uint32_t>(run), out_buffer);
+    }
+  }
+}
+
+std::unique_ptr<UD_SymbolModel> UD_SymbolModel::DecodeTable(
+    uint32_t id, bool allow_zero, DecoderBuffer *buffer) {
+  uint8_t precision_bits;
+  uint32_t num_symbols;
+  if (!buffer->Decode(&precision_bits) ||
+      precision_bits < kMinPrecisionBits ||
+      precision_bits > kMaxPrecisionBits ||
+      !DecodeVarint(&num_symbols, buffer) || num_symbols == 0 ||
+      num_symbols > (1u << precision_bits)) {
+    return nullptr;
+  }
+  std::unique_ptr<UD_SymbolModel> model(new UD_SymbolModel(id, precision_bits));
+  model->probability_table_.resize(num_symbols);
+  for (uint32_t i = 0; i < num_symbols; ++i) {
+    rans_sym &sym = model->probability_table_[i];
+    if (!DecodeVarint(&sym.prob, buffer)) {
+      return nullptr;
+    }
+    if (sym.prob == 0) {
+      uint32_t run;
+      if (!allow_zero || !DecodeVarint(&run, buffer) ||
+          run >= num_symbols - i) {
+        return nullptr;
+      }
+      // The table was zero initialized by resize().
+      i += run;
+    }
+  }
+  if (!model->BuildTables()) {
+    return nullptr;
+  }
+  return model;
+}
+
+bool UD_SymbolModel::BuildTables() {
+  const uint32_t precision = 1u << precision_bits_;
+  lut_table_.resize(precision);
+  uint32_t cum_prob = 0;
+  for (uint32_t i = 0; i < probability_table_.size(); ++i) {
+    rans_sym &sym = probability_table_[i];
+    if (sym.prob > precision - cum_prob) {
+      return false;
+    }
+    sym.cum_prob = cum_prob;
+    std::fill(lut_table_.begin() + cum_prob,
+              lut_table_.begin() + cum_prob + sym.prob, i);
+    cum_prob += sym.prob;
+  }
+  return cum_prob == precision;
+}
+
+double UD_SymbolModel::ComputeBits(const uint64_t *frequencies,
+                                   int num_symbols) const {
+  double bits = 0;
+  for (int i = 0; i < num_symbols; ++i) {
+    if (frequencies[i] > 0) {
+      bits += static_cast<double>(frequencies[i]) *
+              (precision_bits_ -
+               std::log2(static_cast<double>(probability_table_[i].prob)));
+    }
+  }
+  return bits;
+}
+
+UD_SymbolModelRegistry &UD_SymbolModelRegistry::Get() {
+  static UD_SymbolModelRegistry registry;
+  return registry;
+}
+
+bool UD_SymbolModelRegistry::Register(
+    std::unique_ptr<const UD_SymbolModel> model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t id = model->id();
+  return models_.emplace(id, std::move(model)).second;
+}
+
+const UD_SymbolModel *UD_SymbolModelRegistry::Find(uint32_t id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = models_.find(id);
+  return it == models_.end() ? nullptr : it->second.get();
+}
+
+bool UD_EncodeSymbols(const uint32_t *symbols, int num_values,
+                      int num_components, const UD_SymbolModel *model,
+                      const Options *options, EncoderBuffer *target_buffer) {
+  std::vector<uint64_t> frequencies;
+  UD_SymbolModel::AccumulateFrequencies(symbols, num_values, &frequencies);
+  const int num_symbols = static_cast<int>(frequencies.size());
+  // The model bits are compared against the method byte and varints of the
+  // per-stream coding too, both sides are rough estimates.
+  if (model != nullptr && num_values > 0 &&
+      num_symbols <= model->num_symbols() &&
+      model->ComputeBits(frequencies.data(), num_symbols) <=
+          ComputeStreamBits(frequencies, num_values)) {
+    target_buffer->Encode(static_cast<uint8_t>(UD_SYMBOL_CODING_MODEL));
+    EncodeVarint(model->id(), target_buffer);
+    EncodeWithModel(*model, symbols, num_values, target_buffer);
+    return true;
+  }
+  if (num_values > 0 && num_symbols <= kMaxTableSymbols) {
+    const std::unique_ptr<UD_SymbolModel> table =
+        UD_SymbolModel::Create(0, frequencies.data(), num_symbols, false);
+    if (table != nullptr) {
+      EncoderBuffer table_buffer;
+      table->EncodeTable(&table_buffer);
+      target_buffer->Encode(static_cast<uint8_t>(UD_SYMBOL_CODING_TABLE));
+      EncodeVarint(static_cast<uint32_t>(table_buffer.size()), target_buffer);
+      target_buffer->Encode(table_buffer.data(), table_buffer.size());
+      EncodeWithModel(*table, symbols, num_values, target_buffer);
+      return true;
+    }
+  }
+  target_buffer->Encode(static_cast<uint8_t>(UD_SYMBOL_CODING_DRACO));
+  return EncodeSymbols(symbols, num_values, num_components, options,
+                       target_buffer);
+}
+
+bool UD_DecodeSymbols(uint32_t num_values, int num_components,
+                      DecoderBuffer *src_buffer, uint32_t *out_values,
+                      UD_DecodeStats *out_stats) {
+  uint8_t method;
+  if (!src_buffer->Decode(&method)) {
+    return false;
+  }
+  if (method == UD_SYMBOL_CODING_DRACO) {
+    // EncodeSymbols() always writes the current bitstream version, which the
+    // source buffer does not necessarily declare.
+    DecoderBuffer buffer;
+    buffer.Init(src_buffer->data_head(), src_buffer->remaining_size(),
+                kDracoMeshBitstreamVersion);
+    if (!DecodeSymbols(num_values, num_components, &buffer, out_values)) {
+      return false;
+    }
+    src_buffer->Advance(buffer.decoded_size());
+    // Draco builds the tables of every stream.
+    if (out_stats) {
+      ++out_stats->symbol_table_misses;
+    }
+    return true;
+  }
+  const UD_SymbolModel *model = nullptr;
+  bool table_hit = true;
+  if (method == UD_SYMBOL_CODING_MODEL) {
+    uint32_t model_id;
+    if (!DecodeVarint(&model_id, src_buffer)) {
+      return false;
+    }
+    model = UD_SymbolModelRegistry::Get().Find(model_id);
+  } else if (method == UD_SYMBOL_CODING_TABLE) {
+    uint32_t table_size;
+    if (!DecodeVarint(&table_size, src_buffer) ||
+        table_size > src_buffer->remaining_size()) {
+      return false;
+    }
+    model = FindOrBuildTable(src_buffer->data_head(), table_size, &table_hit);
+    src_buffer->Advance(table_size);
+  }
+  uint32_t data_size;
+  if (model == nullptr || !DecodeVarint(&data_size, src_buffer) ||
+      data_size > src_buffer->remaining_size()) {
+    return false;
+  }
+  if (out_stats && table_hit) {
+    ++out_stats->symbol_table_hits;
+  } else if (out_stats) {
+    ++out_stats->symbol_table_misses;
+  }
+  const uint8_t *const data =
+      reinterpret_cast<const uint8_t *>(src_buffer->data_head());
+  if (num_values > 0 && !DecodeWithModel(*model, data,
+                                         static_cast<int>(data_size),
+                                         num_values, out_values)) {
+    return false;
+  }
+  src_buffer->Advance(data_size);
+  return true;
+}
+
+}  // namespace draco
@@ -0,0 +1,273 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "draco/metadata/geometry_metadata.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kUnassigned = 0xffffffff;
+
+// Faces using each point, in compressed sparse row form. A face using a point
+// twice is listed twice.
+struct PointFaces {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> faces;
+};
+
+PointFaces BuildPointFaces(const Mesh &mesh) {
+  const uint32_t num_points = mesh.num_points();
+  const uint32_t num_faces = mesh.num_faces();
+  PointFaces point_faces;
+  point_faces.offsets.assign(num_points + 1, 0);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    for (int c = 0; c < 3; ++c) {
+      ++point_faces.offsets[face[c].value() + 1];
+    }
+  }
+  for (uint32_t p = 0; p < num_points; ++p) {
+    point_faces.offsets[p + 1] += point_faces.offsets[p];
+  }
+  point_faces.faces.resize(point_faces.offsets[num_points]);
+  std::vector<uint32_t> fill(point_faces.offsets.begin(),
+                             point_faces.offsets.end() - 1);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    for (int c = 0; c < 3; ++c) {
+      point_faces.faces[fill[face[c].value()]++] = f.value();
+    }
+  }
+  return point_faces;
+}
+
+// Tipsify face order. Faces are emitted in fans around a point, the next
+// fanning point is the one of the last fan that stays in the cache longest
+// after its remaining faces are emitted, or when none of them has faces left
+// the most recently used point with faces left.
+std::vector<uint32_t> ComputeFaceOrder(const Mesh &mesh, int cache_size) {
+  const uint32_t num_points = mesh.num_points();
+  const uint32_t num_faces = mesh.num_faces();
+  const PointFaces point_faces = BuildPointFaces(mesh);
+
+  // Faces not emitted yet per point.
+  std::vector<uint32_t> live_faces(num_points);
+  for (uint32_t p = 0; p < num_points; ++p) {
+    live_faces[p] = point_faces.offsets[p + 1] - point_faces.offsets[p];
+  }
+  // Time stamp of the last cache insertion of each point.
+  std::vector<int64_t> cache_time(num_points, 0);
+  std::vector<uint8_t> emitted(num_faces, 0);
+  // Points of the emitted faces, most recent last, for dead ends.
+  std::vector<uint32_t> dead_end_stack;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> order;
+  order.reserve(num_faces);
+
+  int64_t time = cache_size + 1;
+  // Points below |cursor| have no faces left.
+  uint32_t cursor = 0;
+  int64_t fanning = 0;
+  while (fanning >= 0 && order.size() < num_faces) {
+    candidates.clear();
+    if (fanning < num_points) {
+      for (uint32_t i = point_faces.offsets[fanning];
+           i < point_faces.offsets[fanning + 1]; ++i) {
+        const uint32_t f = point_faces.faces[i];
+        if (emitted[f]) {
+          continue;
+        }
+        emitted[f] = 1;
+        order.push_back(f);
+        const Mesh::Face &face = mesh.face(FaceIndex(f));
+        for (int c = 0; c < 3; ++c) {
+          const uint32_t p = face[c].value();
+          dead_end_stack.push_back(p);
+          candidates.push_back(p);
+          --live_faces[p];
+          if (time - cache_time[p] > cache_size) {
+            cache_time[p] = time++;
+          }
+        }
+      }
+    }
+
+    // Next fanning point among the points of this fan.
+    fanning = -1;
+    int64_t best_priority = -1;
+    for (const uint32_t p : candidates) {
+      if (live_faces[p] == 0) {
+        continue;
+      }
+      // Points that would still be cached after emitting all their faces are
+      // preferred, the ones inserted earliest first.
+      int64_t priority = 0;
+      if (time - cache_time[p] + 2 * live_faces[p] <= cache_size) {
+        priority = time - cache_time[p];
+      }
+      if (priority > best_priority) {
+        best_priority = priority;
+        fanning = p;
+      }
+    }
+    if (fanning >= 0) {
+      continue;
+    }
+    // Dead end: restart at a recently used point, or at any point.
+    while (!dead_end_stack.empty()) {
+      const uint32_t p = dead_end_stack.back();
+      dead_end_stack.pop_back();
+      if (live_faces[p] > 0) {
+        fanning = p;
+        break;
+      }
+    }
+    while (fanning < 0 && cursor < num_points) {
+      if (live_faces[cursor] > 0) {
+        fanning = cursor;
+      }
+      ++cursor;
+    }
+  }
+  return order;
+}
+
+// Copies the values of |src| into |dst| for the points of |new_to_old_point|,
+// numbering the values in the order the points first use them.
+void CopyAttribute(const PointAttribute &src,
+                   const std::vector<PointIndex> &new_to_old_point,
+                   PointAttribute *dst) {
+  const uint32_t num_points = static_cast<uint32_t>(new_to_old_point.size());
+  const uint32_t num_values = static_cast<uint32_t>(src.size());
+  std::vector<uint32_t> old_to_new_value(num_values, kUnassigned);
+  std::vector<AttributeValueIndex> new_to_old_value;
+  new_to_old_value.reserve(num_values);
+  std::vector<AttributeValueIndex> point_values(num_points);
+  for (uint32_t p = 0; p < num_points; ++p) {
+    const AttributeValueIndex old_value =
+        src.mapped_index(new_to_old_point[p]);
+    uint32_t &new_value = old_to_new_value[old_value.value()];
+    if (new_value == kUnassigned) {
+      new_value = static_cast<uint32_t>(new_to_old_value.size());
+      new_to_old_value.push_back(old_value);
+    }
+    point_values[p] = AttributeValueIndex(new_value);
+  }
+  for (AttributeValueIndex v(0); v < num_values; ++v) {
+    if (old_to_new_value[v.value()] == kUnassigned) {
+      new_to_old_value.push_back(v);
+    }
+  }
+
+  dst->Init(src.attribute_type(), src.num_components(), src.data_type(),
+            src.normalized(), num_values);
+  for (AttributeValueIndex v(0); v < num_values; ++v) {
+    dst->SetAttributeValue(v, src.GetAddress(new_to_old_value[v.value()]));
+  }
+  // Points with values of their own get them in point order, the identity
+  // mapping stays valid.
+  if (src.is_mapping_identity()) {
+    dst->SetIdentityMapping();
+    return;
+  }
+  dst->SetExplicitMapping(num_points);
+  for (PointIndex p(0); p < num_points; ++p) {
+    dst->SetPointMapEntry(p, point_values[p.value()]);
+  }
+}
+
+}  // namespace
+
+UD_VertexCacheStats UD_ComputeVertexCacheStats(const Mesh &mesh,
+                                               int cache_size) {
+  UD_VertexCacheStats stats;
+  const uint32_t num_faces = mesh.num_faces();
+  if (num_faces == 0 || cache_size <= 0) {
+    return stats;
+  }
+  // FIFO of the cached points, |cache_time| holds the insertion time of each
+  // point or -1 when it never was.
+  std::vector<int64_t> cache_time(mesh.num_points(), -1);
+  int64_t time = 0;
+  uint32_t num_used_points = 0;
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    for (int c = 0; c < 3; ++c) {
+      int64_t &inserted = cache_time[face[c].value()];
+      if (inserted < 0) {
+        ++num_used_points;
+      } else if (time - inserted <= cache_size) {
+        continue;
+      }
+      inserted = time++;
+    }
+  }
+  stats.acmr = static_cast<double>(time) / num_faces;
+  stats.atvr = static_cast<double>(time) / num_used_points;
+  return stats;
+}
+
+std::unique_ptr<Mesh> UD_OptimizeVertexCache(const Mesh &mesh,
+                                             int cache_size) {
+  const uint32_t num_points = mesh.num_points();
+  const uint32_t num_faces = mesh.num_faces();
+  const std::vector<uint32_t> face_order =
+      ComputeFaceOrder(mesh, std::max(cache_size, 1));
+
+  // Points in the order of their first use by the reordered faces.
+  std::vector<PointIndex> old_to_new_point(num_points, kInvalidPointIndex);
+  std::vector<PointIndex> new_to_old_point;
+  new_to_old_point.reserve(num_points);
+  std::unique_ptr<Mesh> out(new Mesh());
+  out->SetNumFaces(num_faces);
+  for (uint32_t i = 0; i < num_faces; ++i) {
+    Mesh::Face face = mesh.face(FaceIndex(face_order[i]));
+    for (int c = 0; c < 3; ++c) {
+      PointIndex &mapped = old_to_new_point[face[c].value()];
+      if (mapped == kInvalidPointIndex) {
+        mapped = PointIndex(static_cast<uint32_t>(new_to_old_point.size()));
+        new_to_old_point.push_back(face[c]);
+      }
+      face[c] = mapped;
+    }
+    out->SetFace(FaceIndex(i), face);
+  }
+  for (PointIndex p(0); p < num_points; ++p) {
+    if (old_to_new_point[p.value()] == kInvalidPointIndex) {
+      new_to_old_point.push_back(p);
+    }
+  }
+  out->set_num_points(num_points);
+
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const src = mesh.attribute(i);
+    std::unique_ptr<PointAttribute> dst(new PointAttribute());
+    CopyAttribute(*src, new_to_old_point, dst.get());
+    const int att_id = out->AddAttribute(std::move(dst));
+    out->attribute(att_id)->set_unique_id(src->unique_id());
+    out->SetAttributeElementType(att_id, mesh.GetAttributeElementType(i));
+  }
+
+  if (mesh.GetMetadata() != nullptr) {
+    const GeometryMetadata &src_metadata = *mesh.GetMetadata();
+    // Copies the entries only, the attribute metadata is not copyable.
+    std::unique_ptr<GeometryMetadata> metadata(
+        new GeometryMetadata(static_cast<const Metadata &>(src_metadata)));
+    for (const auto &src_att_metadata : src_metadata.attribute_metadatas()) {
+      std::unique_ptr<AttributeMetadata> att_metadata(
+          new AttributeMetadata(*src_att_metadata));
+      att_metadata->set_att_unique_id(src_att_metadata->att_unique_id());
+      metadata->AddAttributeMetadata(std::move(att_metadata));
+    }
+    out->AddMetadata(std::move(metadata));
+  }
+  return out;
+}
+
+}  // namespace draco
@@ -0,0 +1,138 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "draco/compression/config/compression_shared.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/status_or.h"
+#include "draco/io/file_writer_interface.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+class UD_MappedFile;
+
+// Uncompressed binary geometry format (.udm) used for the on-disk decode cache
+// and as a fast intermediate format. The file is a header followed by a table
+// of attribute descriptors and raw sections: the faces, and for each attribute
+// its tightly packed values and, unless the mapping is the identity, the
+// point-to-value index map. Every section starts at a multiple of
+// kUD_BinaryMeshAlignment so that a memory mapped file can be used in place.
+// Values are stored in the byte order of the writer. Metadata is not stored.
+constexpr uint64_t kUD_BinaryMeshAlignment = 64;
+
+struct UD_BinaryMeshHeader {
+  char magic[4];
+  uint32_t version;
+  int32_t geometry_type;
+  uint32_t num_points;
+  uint32_t num_faces;
+  uint32_t num_attributes;
+  // Offset of |num_attributes| UD_BinaryMeshAttribute descriptors.
+  uint64_t attributes_offset;
+  // Offset of |num_faces| Mesh::Face entries, 0 for point clouds.
+  uint64_t faces_offset;
+  uint64_t file_size;
+};
+
+struct UD_BinaryMeshAttribute {
+  int32_t attribute_type;
+  int32_t data_type;
+  int32_t num_components;
+  int32_t normalized;
+  uint32_t unique_id;
+  int32_t element_type;
+  uint32_t num_values;
+  uint32_t reserved;
+  // Offset of |num_values| values of num_components * DataTypeLength(data_type)
+  // bytes each.
+  uint64_t values_offset;
+  // Offset of |num_points| uint32_t value indices, 0 for identity mappings.
+  uint64_t indices_offset;
+};
+
+// Writes geometry in the .udm format. Created like the Draco file writers,
+// through Open().
+class UD_BinaryMeshWriter {
+ public:
+  // Returns nullptr when |file_name| cannot be opened for writing.
+  static std::unique_ptr<UD_BinaryMeshWriter> Open(
+      const std::string &file_name);
+
+  UD_BinaryMeshWriter() = delete;
+  UD_BinaryMeshWriter(const UD_BinaryMeshWriter &) = delete;
+  UD_BinaryMeshWriter &operator=(const UD_BinaryMeshWriter &) = delete;
+
+  // Writes |pc|, with the faces of |mesh| when it is not nullptr. |mesh| must
+  // be the same object as |pc| then. Returns true for success.
+  bool Write(const PointCloud &pc, const Mesh *mesh);
+
+  static bool WriteToBuffer(const PointCloud &pc, const Mesh *mesh,
+                            EncoderBuffer *out_buffer);
+
+ private:
+  explicit UD_BinaryMeshWriter(std::unique_ptr<FileWriterInterface> file)
+      : file_(std::move(file)) {}
+
+  std::unique_ptr<FileWriterInterface> file_;
+};
+
+// Reads .udm files. The file is memory mapped and all sections are validated
+// by Open(), after which they can be accessed in place without any parsing,
+// or copied into a Draco geometry section by section.
+class UD_BinaryMeshReader {
+ public:
+  // Returns nullptr when the file cannot be read or is not a valid .udm file.
+  static std::unique_ptr<UD_BinaryMeshReader> Open(
+      const std::string &file_name);
+  // Same for a file already in memory. |data| must outlive the reader and be
+  // aligned to kUD_BinaryMeshAlignment for in-place access.
+  static std::unique_ptr<UD_BinaryMeshReader> OpenBuffer(const char *data,
+                                                         size_t data_size);
+
+  UD_BinaryMeshReader() = delete;
+  UD_BinaryMeshReader(const UD_BinaryMeshReader &) = delete;
+  UD_BinaryMeshReader &operator=(const UD_BinaryMeshReader &) = delete;
+
+  ~UD_BinaryMeshReader();
+
+  // Returns true when |data| starts with the .udm magic.
+  static bool IsBinaryMesh(const char *data, size_t data_size);
+
+  const UD_BinaryMeshHeader &header() const { return *header_; }
+  bool is_mesh() const { return header_->geometry_type == TRIANGULAR_MESH; }
+
+  // In-place views of the sections.
+  const UD_BinaryMeshAttribute &attribute(int att_id) const {
+    return attributes_[att_id];
+  }
+  const Mesh::Face *faces() const;
+  const uint8_t *values(int att_id) const;
+  // nullptr for identity mappings.
+  const uint32_t *indices(int att_id) const;
+
+  // Copies the geometry into a new Mesh, or a PointCloud when the file does
+  // not hold a mesh.
+  StatusOr<std::unique_ptr<PointCloud>> ReadGeometry() const;
+
+ private:
+  UD_BinaryMeshReader(std::unique_ptr<UD_MappedFile> file, const char *data,
+                      size_t data_size);
+
+  // Checks that the header and all sections lie inside the file.
+  bool Validate();
+
+  std::unique_ptr<UD_MappedFile> file_;
+  const char *data_;
+  size_t data_size_;
+  const UD_BinaryMeshHeader *header_;
+  const UD_BinaryMeshAttribute *attributes_;
+};
+
+}  // namespace draco
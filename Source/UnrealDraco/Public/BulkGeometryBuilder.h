@@ -0,0 +1,85 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "draco/attributes/geometry_attribute.h"
+#include "draco/core/draco_types.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Bulk counterparts of PointCloudBuilder and TriangleSoupMeshBuilder for
+// geometry that is in memory already. Each attribute is filled from a whole
+// array in one call instead of a call per point or face, either interleaved,
+// with consecutive values a fixed stride apart as in a vertex buffer, or
+// planar, with an array per component. The arrays are copied into the
+// attribute buffers in parallel blocks, tightly packed ones with one memcpy per
+// block. Draco's DataBuffer owns its storage, so the memory of the caller
+// cannot be adopted and is always copied once.
+//
+// Finalize() deduplicates attribute values and point ids with the parallel
+// functions of ParallelDeduplication.h, with the same results as the Draco
+// builders, unless the caller guarantees unique vertices and opts out.
+
+class UD_PointCloudBulkBuilder {
+ public:
+  // Starts a point cloud of |num_points| points, discarding any unfinished
+  // one.
+  void Start(PointIndex::ValueType num_points);
+
+  // Adds an attribute with a value per point read from |values|, consecutive
+  // values |byte_stride| bytes apart, or tightly packed when |byte_stride| is 0.
+  // Returns the attribute id, or -1 for an invalid format or before Start().
+  int AddAttribute(GeometryAttribute::Type attribute_type,
+                   int8_t num_components, DataType data_type, bool normalized,
+                   const void *values, int64_t byte_stride);
+
+  // Adds an attribute with a value per point, component c of all the points
+  // read from the tightly packed array |components[c]|. Returns the attribute
+  // id, or -1 for an invalid format or before Start().
+  int AddPlanarAttribute(GeometryAttribute::Type attribute_type,
+                         int8_t num_components, DataType data_type,
+                         bool normalized, const void *const *components);
+
+  // Returns the point cloud, or nullptr on error or before Start(). The
+  // builder needs a new Start() afterwards.
+  std::unique_ptr<PointCloud> Finalize(bool deduplicate_points);
+
+ private:
+  std::unique_ptr<PointCloud> point_cloud_;
+};
+
+class UD_MeshBulkBuilder {
+ public:
+  UD_MeshBulkBuilder() : valid_faces_(false) {}
+
+  // Starts a mesh of |num_points| points and |num_faces| faces, the point ids
+  // of face f read from |indices| [3 * f] to [3 * f + 2]. Discards any
+  // unfinished mesh.
+  void Start(PointIndex::ValueType num_points,
+             FaceIndex::ValueType num_faces, const uint32_t *indices);
+
+  // Same as UD_PointCloudBulkBuilder::AddAttribute().
+  int AddAttribute(GeometryAttribute::Type attribute_type,
+                   int8_t num_components, DataType data_type, bool normalized,
+                   const void *values, int64_t byte_stride);
+
+  // Same as UD_PointCloudBulkBuilder::AddPlanarAttribute().
+  int AddPlanarAttribute(GeometryAttribute::Type attribute_type,
+                         int8_t num_components, DataType data_type,
+                         bool normalized, const void *const *components);
+
+  // Returns the mesh, or nullptr on error, before Start() or when an index was
+  // out of range. The builder needs a new Start() afterwards.
+  std::unique_ptr<Mesh> Finalize(bool deduplicate_points);
+
+ private:
+  std::unique_ptr<Mesh> mesh_;
+  bool valid_faces_;
+};
+
+}  // namespace draco
@@ -0,0 +1,121 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "DecodeProfiler.h"
+#include "draco/compression/decode.h"
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Result of a cached decode. |mesh| points into |pc| when the encoded
+// geometry was a triangular mesh and is nullptr for point clouds.
+struct UD_DecodedGeometry {
+  std::shared_ptr<const PointCloud> pc;
+  const Mesh *mesh = nullptr;
+};
+
+// LRU cache of decoded geometry keyed by the fingerprint of the compressed
+// buffer and the decoder options that influence the output. Entries are
+// evicted once the estimated size of all cached geometry exceeds the byte
+// budget. When a disk directory is set, decoded geometry is also stored there
+// in the .udm format of BinaryMesh.h so that a later session can load it
+// without decoding.
+class UD_DecodeCache {
+ public:
+  explicit UD_DecodeCache(size_t byte_budget);
+
+  UD_DecodeCache(const UD_DecodeCache &) = delete;
+  UD_DecodeCache &operator=(const UD_DecodeCache &) = delete;
+
+  // Returns the process-wide cache used by UFlib_DracoUtilities.
+  static UD_DecodeCache &Get();
+
+  // Decodes |data| with the options of |decoder| unless an equivalent decode
+  // is cached. When |out_stats| is set it receives the per-stage timings of
+  // the decode, or just the origin of the geometry on a cache hit.
+  StatusOr<UD_DecodedGeometry> Decode(const char *data, size_t data_size,
+                                      Decoder *decoder,
+                                      UD_DecodeStats *out_stats = nullptr);
+
+  // Shrinks the cache immediately if the new budget is smaller.
+  void SetByteBudget(size_t byte_budget);
+  size_t byte_budget() const;
+
+  // Enables the on-disk tier in |directory|. Empty string disables it.
+  // Geometry decoded with skipped attribute transforms is only cached in
+  // memory, as .udm files do not store the attribute transform data.
+  void SetDiskDirectory(const std::string &directory);
+
+  void Clear();
+
+  // Counters are read under the lock, decodes on other threads update them.
+  size_t size_in_bytes() const;
+  int64_t num_hits() const;
+  int64_t num_disk_hits() const;
+  int64_t num_misses() const;
+
+  // Returns an estimate of the memory held by |pc| (attribute buffers, index
+  // maps and faces).
+  static size_t EstimateGeometrySize(const PointCloud &pc, const Mesh *mesh);
+
+ private:
+  struct Key {
+    uint64_t fingerprint;
+    uint64_t options_hash;
+    bool operator==(const Key &other) const {
+      return fingerprint == other.fingerprint &&
+             options_hash == other.options_hash;
+    }
+  };
+  struct KeyHasher {
+    size_t operator()(const Key &key) const {
+      return static_cast<size_t>(
+          HashCombine(key.fingerprint, key.options_hash));
+    }
+  };
+  struct Entry {
+    Key key;
+    UD_DecodedGeometry geometry;
+    size_t size;
+  };
+  typedef std::list<Entry> EntryList;
+
+  static uint64_t HashDecoderOptions(Decoder *decoder);
+
+  static std::string GetDiskPath(const std::string &directory,
+                                 const Key &key);
+  static std::unique_ptr<PointCloud> LoadFromDisk(const std::string &directory,
+                                                  const Key &key,
+                                                  const Mesh **out_mesh);
+  static void StoreOnDisk(const std::string &directory, const Key &key,
+                          const PointCloud &pc, const Mesh *mesh);
+
+  // Inserts |geometry| as the most recently used entry. Requires |mutex_|.
+  void Insert(const Key &key, const UD_DecodedGeometry &geometry);
+  // Drops least recently used entries until the budget is met. Requires
+  // |mutex_|.
+  void EvictToBudget();
+
+  mutable std::mutex mutex_;
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHasher> lookup_;
+  size_t byte_budget_;
+  size_t size_in_bytes_;
+  std::string disk_directory_;
+  int64_t num_hits_;
+  int64_t num_disk_hits_;
+  int64_t num_misses_;
+};
+
+}  // namespace draco
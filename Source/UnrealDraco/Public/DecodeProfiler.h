@@ -0,0 +1,102 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "draco/attributes/geometry_attribute.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/config/decoder_options.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/status_or.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Where the geometry of a decode request came from.
+enum UD_DecodeOrigin {
+  UD_DECODED = 0,
+  UD_MEMORY_CACHE,
+  UD_DISK_CACHE,
+};
+
+// Time and input bytes spent by one attributes decoder. A decoder handles
+// all attributes that share the same connectivity, so with Edgebreaker the
+// position decoder usually also decodes the attributes without seams.
+struct UD_AttributeDecoderStats {
+  std::vector<int32_t> attribute_ids;
+  std::vector<GeometryAttribute::Type> attribute_types;
+  double ms = 0.0;
+  // Position of the decoder data in the input buffer and its size.
+  int64_t offset = 0;
+  int64_t bytes = 0;
+};
+
+// Time and input bytes of the attributes decoded with one prediction scheme,
+// including their entropy decoding and dequantization. Attributes are
+// resolved one by one when the profiler creates their decoders, which it does
+// for the sequential encoding methods, or when they have an attributes decoder
+// to themselves. The attributes sharing a decoder created inside the Draco
+// library, such as the Edgebreaker positions and the attributes without seams,
+// are counted together under PREDICTION_UNDEFINED. Kd-tree coded attributes
+// are not predicted and count as PREDICTION_NONE.
+struct UD_PredictionSchemeStats {
+  int prediction_scheme = PREDICTION_UNDEFINED;
+  int num_attributes = 0;
+  int64_t num_values = 0;
+  double ms = 0.0;
+  int64_t bytes = 0;
+};
+
+// Per-stage breakdown of a single decode. Stages follow the layout of the
+// bitstream: header and metadata, decoder initialization, geometry data
+// (connectivity for meshes), attribute decoder setup (decoder creation,
+// sequencers and attribute descriptors), the attribute decoders themselves
+// (entropy decoding, prediction and dequantization) and the final
+// post-processing done by the mesh decoder.
+struct UD_DecodeStats {
+  UD_DecodeOrigin origin = UD_DECODED;
+  EncodedGeometryType geometry_type = INVALID_GEOMETRY_TYPE;
+  int encoder_method = -1;
+  uint32_t num_points = 0;
+  uint32_t num_faces = 0;
+
+  double header_ms = 0.0;
+  double initialize_ms = 0.0;
+  double connectivity_ms = 0.0;
+  double attribute_setup_ms = 0.0;
+  double attributes_ms = 0.0;
+  double post_decode_ms = 0.0;
+  double total_ms = 0.0;
+
+  int64_t header_bytes = 0;
+  int64_t initialize_bytes = 0;
+  int64_t connectivity_bytes = 0;
+  int64_t attribute_setup_bytes = 0;
+  int64_t attributes_bytes = 0;
+
+  // Symbol streams of UD_DecodeSymbols() decoded before the Draco bitstream,
+  // such as .uda archive members coded with the symbol model of the archive.
+  // The time is part of total_ms. Streams whose rANS tables were ready, in a
+  // registered model or the per-thread table cache, are table hits, the
+  // others built their tables.
+  double symbols_ms = 0.0;
+  int64_t symbols_bytes = 0;
+  int64_t symbol_table_hits = 0;
+  int64_t symbol_table_misses = 0;
+
+  std::vector<UD_AttributeDecoderStats> attribute_decoders;
+  // Sorted by prediction scheme.
+  std::vector<UD_PredictionSchemeStats> prediction_schemes;
+};
+
+// Decodes a point cloud or mesh from |in_buffer| like
+// Decoder::DecodePointCloudFromBuffer() while filling |out_stats|. Meshes are
+// returned as Mesh objects; check |out_stats->geometry_type| before casting.
+StatusOr<std::unique_ptr<PointCloud>> UD_DecodeWithStats(
+    DecoderBuffer *in_buffer, const DecoderOptions &options,
+    UD_DecodeStats *out_stats);
+
+}  // namespace draco
@@ -0,0 +1,111 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EncoderTuner.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Quantization bits used by one benchmark pass.
+struct UD_BenchmarkQuantization {
+  std::string label;
+  int position_bits;
+  int tex_coord_bits;
+  int normal_bits;
+  int generic_bits;
+};
+
+// Encode and decode measurements of one geometry at one setting.
+struct UD_BenchmarkResult {
+  std::string name;
+  bool is_mesh = false;
+  int compression_level = 0;
+  std::string quantization;
+  UD_ParallelogramSearch parallelogram_search =
+      UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE;
+  bool ok = false;
+  uint32_t num_points = 0;
+  uint32_t num_faces = 0;
+  size_t raw_bytes = 0;
+  size_t encoded_bytes = 0;
+  double encode_ms = 0.0;
+  double decode_ms = 0.0;
+  // Physical memory used above the level sampled before encoding: the process
+  // peak when the measurement raised it, otherwise the larger of the levels
+  // sampled with the encoded buffer and with the decoded geometry alive.
+  // Memory released to the allocator but not to the system, and allocations of
+  // other threads, are counted as well.
+  uint64_t peak_memory_delta_bytes = 0;
+
+  double CompressionRatio() const;
+  // Uncompressed bytes consumed per second while encoding.
+  double EncodeMegaBytesPerSecond() const;
+  // Uncompressed bytes produced per second while decoding.
+  double DecodeMegaBytesPerSecond() const;
+  double DecodeTrianglesPerSecond() const;
+  double DecodePointsPerSecond() const;
+};
+
+// Runs encode and decode over a corpus of synthetic and user supplied
+// geometry at every requested compression level and quantization setting.
+class UD_Benchmark {
+ public:
+  UD_Benchmark();
+
+  // Adds generated spheres and noisy point clouds of increasing size.
+  void AddSyntheticCorpus();
+  // Adds an .obj, .ply or .drc file. Returns false when it cannot be loaded.
+  bool AddFile(const std::string &file_name);
+  void AddGeometry(const std::string &name, std::unique_ptr<PointCloud> pc,
+                   bool is_mesh);
+
+  void set_compression_levels(const std::vector<int> &levels) {
+    compression_levels_ = levels;
+  }
+  void set_quantizations(const std::vector<UD_BenchmarkQuantization> &q) {
+    quantizations_ = q;
+  }
+  // Position prediction searches compared on meshes at the compression levels
+  // where they apply (9 and 10). Other levels only run the first one.
+  void set_parallelogram_searches(
+      const std::vector<UD_ParallelogramSearch> &searches) {
+    parallelogram_searches_ = searches;
+  }
+  // Each measurement is repeated and the fastest run is reported.
+  void set_repetitions(int repetitions) { repetitions_ = repetitions; }
+
+  std::vector<UD_BenchmarkResult> Run() const;
+
+  // Uncompressed size of the attribute values, index maps and faces.
+  static size_t ComputeRawSize(const PointCloud &pc, const Mesh *mesh);
+
+  static std::unique_ptr<Mesh> CreateSphere(int num_segments);
+  static std::unique_ptr<PointCloud> CreateNoisyPointCloud(int num_points,
+                                                           uint32_t seed);
+
+ private:
+  struct CorpusEntry {
+    std::string name;
+    std::unique_ptr<PointCloud> pc;
+    bool is_mesh;
+  };
+
+  UD_BenchmarkResult Measure(const CorpusEntry &entry, int compression_level,
+                             const UD_BenchmarkQuantization &q,
+                             UD_ParallelogramSearch search) const;
+
+  std::vector<CorpusEntry> corpus_;
+  std::vector<int> compression_levels_;
+  std::vector<UD_BenchmarkQuantization> quantizations_;
+  std::vector<UD_ParallelogramSearch> parallelogram_searches_;
+  int repetitions_;
+};
+
+}  // namespace draco
@@ -0,0 +1,28 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DracoBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs encode and decode over synthetic geometry and an optional corpus directory at every
+ * compression level and writes a JSON report. When a baseline report is given, results that
+ * got slower or larger than the tolerance allows are listed and the commandlet returns 1.
+ * -parallelogram compares the position prediction searches, -kernels times the plugin's
+ * attribute kernels against the Draco ones on the meshes of the corpus.
+ *
+ * Usage: -run=DracoBenchmark [-corpus=<dir>] [-out=<report.json>] [-baseline=<report.json>]
+ *        [-tolerance=0.1] [-quick] [-parallelogram] [-kernels]
+ */
+UCLASS()
+class UNREALDRACO_API UDracoBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDracoBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
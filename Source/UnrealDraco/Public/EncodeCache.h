@@ -0,0 +1,45 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace draco {
+
+// Directory of previously encoded .drc and .glb files keyed by a hash of the
+// source file contents, the files it references, the serialized encoder
+// settings and the output container. Used to skip encoding of assets that
+// did not change since the last run.
+class UD_EncodeCache {
+ public:
+  explicit UD_EncodeCache(const std::string &directory);
+
+  // Returns the cache key of |input|, the contents of |file_name|, encoded
+  // with |serialized_options| to |out_file|. The container the extension of
+  // |out_file| selects, a GLB wrapper or a bare Draco bitstream, is hashed
+  // too. For OBJ files the material libraries named by mtllib statements are
+  // hashed as well, as they define the material ids.
+  static uint64_t ComputeKey(const std::string &file_name,
+                             const std::vector<char> &input,
+                             const std::string &serialized_options,
+                             const std::string &out_file);
+
+  // Copies the cached result for |key| to |out_file|. Returns false when the
+  // key is not cached in the container of |out_file| or the copy failed.
+  bool Fetch(uint64_t key, const std::string &out_file) const;
+
+  // Stores the encoded |file| under |key|, in an entry named after its
+  // container.
+  bool Store(uint64_t key, const std::string &file) const;
+
+  bool IsValid() const { return !directory_.empty(); }
+
+ private:
+  std::string GetEntryPath(uint64_t key, const std::string &file) const;
+
+  std::string directory_;
+};
+
+}  // namespace draco
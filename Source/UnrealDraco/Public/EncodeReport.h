@@ -0,0 +1,74 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "draco/attributes/geometry_attribute.h"
+#include "draco/compression/config/compression_shared.h"
+#include "draco/compression/config/encoder_options.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/status_or.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Contiguous part of an encoded buffer.
+struct UD_EncodeSection {
+  std::string name;
+  int64_t offset = 0;
+  int64_t size = 0;
+};
+
+// Bytes spent on one attribute. The split into header, entropy tables,
+// symbols, prediction data and transform parameters is only available for
+// attributes written by the sequential attribute encoders; |resolved| is
+// false when the layout could not be followed (kd-tree point clouds).
+struct UD_AttributeSizeReport {
+  GeometryAttribute::Type attribute_type = GeometryAttribute::INVALID;
+  int32_t unique_id = -1;
+  bool resolved = false;
+  int prediction_scheme = PREDICTION_NONE;
+  int prediction_transform = PREDICTION_TRANSFORM_NONE;
+
+  int64_t header_bytes = 0;
+  int64_t entropy_table_bytes = 0;
+  int64_t symbol_bytes = 0;
+  int64_t prediction_data_bytes = 0;
+  int64_t transform_bytes = 0;
+
+  // Number of entropy coded symbols and the size ShannonEntropyTracker
+  // predicts for them (data plus rANS table), in bytes.
+  int64_t num_symbols = 0;
+  int64_t estimated_entropy_bytes = 0;
+
+  int64_t TotalBytes() const {
+    return header_bytes + entropy_table_bytes + symbol_bytes +
+           prediction_data_bytes + transform_bytes;
+  }
+};
+
+// Where the bytes of an encoded point cloud or mesh went. |sections| covers
+// the whole buffer in write order: header, metadata, encoder data,
+// connectivity, attribute encoder setup and one section per attributes
+// encoder.
+struct UD_EncodeReport {
+  int64_t total_bytes = 0;
+  std::vector<UD_EncodeSection> sections;
+  std::vector<UD_AttributeSizeReport> attributes;
+
+  // Human readable table of the report.
+  std::string ToString() const;
+};
+
+// Builds the report for |buffer|, produced by encoding |pc| with |options|.
+// The encoders in the Draco library do not expose their section writers, so
+// the buffer is read back with UD_DecodeWithStats() and the attribute data is
+// walked with the same layout rules the sequential attribute decoders use.
+StatusOr<UD_EncodeReport> UD_BuildEncodeReport(const PointCloud &pc,
+                                               const EncoderOptions &options,
+                                               const EncoderBuffer &buffer);
+
+}  // namespace draco
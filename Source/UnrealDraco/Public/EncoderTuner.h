@@ -0,0 +1,127 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "draco/compression/encode.h"
+#include "draco/compression/expert_encode.h"
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Encoder settings explored by UD_EncoderTuner. Prediction schemes set to
+// PREDICTION_UNDEFINED are left to the encoder.
+struct UD_EncoderConfig {
+  UD_EncoderConfig()
+      : encoding_method(-1),
+        encoding_submethod(-1),
+        speed(5),
+        position_prediction(PREDICTION_UNDEFINED),
+        tex_coord_prediction(PREDICTION_UNDEFINED),
+        normal_prediction(PREDICTION_UNDEFINED) {}
+
+  // Applies the configuration to |encoder| created for |pc|.
+  Status Apply(const PointCloud &pc, ExpertEncoder *encoder) const;
+
+  int encoding_method;
+  int encoding_submethod;
+  int speed;
+  int position_prediction;
+  int tex_coord_prediction;
+  int normal_prediction;
+};
+
+// How the position prediction is searched at the speeds where Draco uses
+// constrained multi-parallelogram prediction (speed 0 and 1). The constrained
+// search is the slowest part of those encodes and on some meshes does not pay
+// off. Set in the EncoderOptions with UD_SetParallelogramSearch() and applied
+// by UD_EncodeMeshWithParallelogramSearch().
+enum UD_ParallelogramSearch {
+  // Draco's constrained multi-parallelogram search.
+  UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE = 0,
+  // Encodes a sample of about 6% of the faces, at most 16k, with both
+  // constrained and single parallelogram prediction and encodes the mesh once
+  // with the one that gave the smaller sample. The sample is split into runs
+  // of consecutive faces spread over the mesh, which are encoded in parallel.
+  // Meshes under 32k faces keep the constrained prediction.
+  UD_PARALLELOGRAM_SEARCH_SAMPLED,
+  // Single parallelogram prediction, as at speed 2.
+  UD_PARALLELOGRAM_SEARCH_SINGLE,
+};
+
+// Stores |search| as a global option of |options|, exhaustive by default.
+// The options of an Encoder carry over to UD_CreateExpertEncoderOptions().
+template <typename EncoderOptionsT>
+void UD_SetParallelogramSearch(UD_ParallelogramSearch search,
+                               EncoderOptionsT *options) {
+  options->SetGlobalInt("ud_parallelogram_search", search);
+}
+UD_ParallelogramSearch UD_GetParallelogramSearch(
+    const EncoderOptions &options);
+
+// Converts the options of |encoder|, keyed by attribute type, to the options
+// of an ExpertEncoder for |pc|, as Draco does inside Encoder::EncodeToBuffer().
+EncoderOptions UD_CreateExpertEncoderOptions(const Encoder &encoder,
+                                             const PointCloud &pc);
+
+// Encodes |mesh| with |options| like ExpertEncoder::EncodeToBuffer(), first
+// choosing the position prediction with the parallelogram search of
+// |options|. The search is skipped when |options| sets the position
+// prediction scheme. On success |options| sets the chosen scheme, so that
+// encoding with them again gives the same bitstream without a search.
+Status UD_EncodeMeshWithParallelogramSearch(const Mesh &mesh,
+                                            EncoderOptions *options,
+                                            EncoderBuffer *out_buffer);
+
+// Measured result of one candidate configuration.
+struct UD_EncoderTrial {
+  UD_EncoderConfig config;
+  bool ok = false;
+  size_t encoded_size = 0;
+  double decode_ms = 0.0;
+  // Not dominated in both size and decode time by another trial.
+  bool pareto_optimal = false;
+};
+
+// Encodes a geometry with a set of method, submethod and prediction scheme
+// combinations, measures size and decode time of each and picks the smallest
+// encoding whose decode time stays within a budget.
+class UD_EncoderTuner {
+ public:
+  // |quantization_bits| is indexed by GeometryAttribute::Type, values <= 0
+  // leave the attribute unquantized.
+  UD_EncoderTuner(const PointCloud &pc, const Mesh *mesh,
+                  const std::array<int, GeometryAttribute::NAMED_ATTRIBUTES_COUNT>
+                      &quantization_bits);
+
+  // Runs all candidates and returns the chosen trial. When no candidate
+  // decodes within |max_decode_ms| (or it is <= 0) the fastest decoding
+  // candidate is returned if a budget was set, else the smallest.
+  StatusOr<UD_EncoderTrial> Tune(double max_decode_ms);
+
+  const std::vector<UD_EncoderTrial> &trials() const { return trials_; }
+
+  // Number of decodes per candidate, the fastest one is reported.
+  void set_decode_repetitions(int repetitions) {
+    decode_repetitions_ = repetitions;
+  }
+
+ private:
+  std::vector<UD_EncoderConfig> GenerateCandidates() const;
+  Status Encode(const UD_EncoderConfig &config, EncoderBuffer *buffer) const;
+  double MeasureDecodeTime(const EncoderBuffer &buffer) const;
+  void MarkParetoOptimal();
+
+  const PointCloud &pc_;
+  const Mesh *mesh_;
+  std::array<int, GeometryAttribute::NAMED_ATTRIBUTES_COUNT> quantization_bits_;
+  int decode_repetitions_;
+  std::vector<UD_EncoderTrial> trials_;
+};
+
+}  // namespace draco
@@ -15,6 +15,7 @@
 #include "draco/point_cloud/point_cloud.h"
 #include "draco/mesh/mesh.h"
 #include "draco/compression/encode.h"
+#include "draco/compression/expert_encode.h"
 #include "draco/io/file_writer_interface.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(UDLog, Log, All);
@@ -86,6 +87,15 @@ private:
 	static bool registered_in_factory_;
 };
 
+// Encodes the geometry and writes the result to |file|. Returns -1 on failure.
+// Meshes are encoded with the parallelogram search set in the options of
+// |encoder|, see UD_SetParallelogramSearch().
+int EncodeMeshToFile(const draco::Mesh& mesh, const std::string& file,
+	draco::Encoder* encoder);
+int EncodePointCloudToFile(const draco::PointCloud& pc, const std::string& file,
+	draco::Encoder* encoder);
+int EncodeWithExpertEncoderToFile(draco::ExpertEncoder* encoder,
+	const std::string& file);
 
 }  // namespace draco
 
@@ -9,6 +9,61 @@
 
 
 
+UENUM(BlueprintType)
+enum class EQuantizationErrorMetric : uint8
+{
+	Max,
+	RMS
+};
+
+// Position prediction search at compression levels 9 and 10, see draco::UD_ParallelogramSearch.
+UENUM(BlueprintType)
+enum class EParallelogramSearch : uint8
+{
+	// Draco's constrained multi-parallelogram search, smallest output on most meshes.
+	Exhaustive,
+	// Tries constrained and single parallelogram prediction on about 6% of the faces and encodes the
+	// mesh once with the smaller. Meshes under 32k faces keep the constrained prediction.
+	Sampled,
+	// Single parallelogram prediction, fastest.
+	Single
+};
+
+// Encoder method and prediction schemes chosen by UFlib_DracoUtilities::TuneEncoder.
+// Values map to draco's MeshEncoderMethod, MeshEdgebreakerConnectivityEncodingMethod
+// and PredictionSchemeMethod enums, -1 leaves the choice to the encoder.
+USTRUCT(BlueprintType)
+struct FEncoderConfig
+{
+	GENERATED_BODY()
+		FEncoderConfig() :valid(false),
+		encoding_method(-1),
+		encoding_submethod(-1),
+		speed(5),
+		position_prediction_scheme(-1),
+		tex_coords_prediction_scheme(-1),
+		normals_prediction_scheme(-1)
+		{}
+
+
+public:
+	// Encoder uses this configuration instead of compression_level when set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool valid;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int encoding_method;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int encoding_submethod;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int speed;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int position_prediction_scheme;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int tex_coords_prediction_scheme;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int normals_prediction_scheme;
+};
+
 USTRUCT(BlueprintType)
 struct FOptions 
 {
@@ -22,7 +77,15 @@ struct FOptions
 		generic_quantization_bits(8),
 		generic_deleted(false),
 		compression_level(7),
-		use_metadata(false) 
+		use_metadata(false),
+		auto_tune_quantization(false),
+		error_metric(EQuantizationErrorMetric::Max),
+		pos_tolerance(0.1f),
+		tex_coords_tolerance(0.0005f),
+		normals_tolerance_degrees(1.0f),
+		parallelogram_search(EParallelogramSearch::Exhaustive),
+		cleanup_mesh(false),
+		encoder_config()
 		{}
 
 
@@ -47,11 +110,197 @@ public:
 	int compression_level;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool use_metadata;
+	// Replaces the position, tex coord and normal quantization bits with the smallest values
+	// that keep the reconstruction error under the tolerances below.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool auto_tune_quantization;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EQuantizationErrorMetric error_metric;
+	// Maximum position error in mesh units.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float pos_tolerance;
+	// Maximum texture coordinate error in UV units.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float tex_coords_tolerance;
+	// Maximum angle between original and decoded normals.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float normals_tolerance_degrees;
+	// Trades encode time for size at compression levels 9 and 10, ignored with encoder_config.
+	// Passed to the encoder options with draco::UD_SetParallelogramSearch.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EParallelogramSearch parallelogram_search;
+	// Removes degenerate faces and unused points and attribute values from meshes before encoding.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool cleanup_mesh;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FEncoderConfig encoder_config;
+
+
+};
+
+
+USTRUCT(BlueprintType)
+struct FEncodeBatchStats
+{
+	GENERATED_BODY()
+		FEncodeBatchStats() :hits(0),
+		misses(0),
+		failures(0)
+		{}
+
+
+public:
+	// Assets copied from the encode cache without re-encoding.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int hits;
+	// Assets that had to be encoded.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int misses;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int failures;
+};
+
+
+// Post-decode processing of UFlib_DracoUtilities::DecoderWithOptions.
+USTRUCT(BlueprintType)
+struct FDecodeOptions
+{
+	GENERATED_BODY()
+		FDecodeOptions() :optimize_vertex_cache(false),
+		vertex_cache_size(16),
+		generate_triangle_strips(false)
+		{}
+
+
+public:
+	// Reorders the faces and vertices of decoded meshes for the GPU vertex cache before they are
+	// written, see draco::UD_OptimizeVertexCache. Ignored for GLB output, which keeps the bitstream.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool optimize_vertex_cache;
+	// Entries of the FIFO vertex cache the faces are ordered for.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int vertex_cache_size;
+	// Stripifies decoded meshes in parallel, see draco::UD_ParallelMeshStripifier, and returns
+	// the strip indices from DecoderWithOptions. None of the output formats stores strips.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool generate_triangle_strips;
+};
+
+
+// Attributes decoded with one prediction scheme, see draco::UD_PredictionSchemeStats.
+USTRUCT(BlueprintType)
+struct FDecodePredictionSchemeStats
+{
+	GENERATED_BODY()
+		FDecodePredictionSchemeStats() :prediction_scheme(-1),
+		attribute_count(0),
+		value_count(0),
+		ms(0.0f),
+		bytes(0)
+		{}
 
 
+public:
+	// draco::PredictionSchemeMethod: -2 for none, -1 for attributes sharing a decoder whose
+	// schemes the profiler cannot tell apart.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int prediction_scheme;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int attribute_count;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int value_count;
+	// Entropy decoding, prediction and dequantization of the attributes.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int bytes;
 };
 
 
+// Per-stage timings of UFlib_DracoUtilities::DecoderWithStats, in milliseconds.
+USTRUCT(BlueprintType)
+struct FDecodeStats
+{
+	GENERATED_BODY()
+		FDecodeStats() :from_cache(false),
+		header_ms(0.0f),
+		connectivity_ms(0.0f),
+		attribute_setup_ms(0.0f),
+		attributes_ms(0.0f),
+		post_decode_ms(0.0f),
+		total_ms(0.0f),
+		connectivity_bytes(0),
+		attributes_bytes(0),
+		symbols_ms(0.0f),
+		symbol_table_hit_rate(0.0f),
+		vertex_cache_ms(0.0f),
+		acmr_before(0.0f),
+		acmr_after(0.0f),
+		atvr_before(0.0f),
+		atvr_after(0.0f),
+		strips_ms(0.0f),
+		strip_count(0),
+		strip_index_count(0)
+		{}
+
+
+public:
+	// The geometry came from the decode cache, only total_ms is set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool from_cache;
+	// Draco header, metadata and decoder initialization.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float header_ms;
+	// Mesh connectivity (Edgebreaker or sequential indices), point count for point clouds.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float connectivity_ms;
+	// Attribute decoder creation, traversal sequencers and attribute descriptors.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float attribute_setup_ms;
+	// Entropy decoding, prediction and dequantization of all attributes.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float attributes_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float post_decode_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float total_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int connectivity_bytes;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int attributes_bytes;
+	// Time of each attribute decoder in bitstream order.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<float> attribute_decoders_ms;
+	// attributes_ms and attributes_bytes split by prediction scheme.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FDecodePredictionSchemeStats> prediction_schemes;
+	// Decoding of archive members coded with the symbol model of the archive, and the share of
+	// its symbol streams whose rANS tables were ready, see draco::UD_DecodeStats.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float symbols_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float symbol_table_hit_rate;
+	// Vertex cache optimization, with the average cache miss and transform to vertex ratios of
+	// the faces before and after it. Only set when FDecodeOptions::optimize_vertex_cache applied.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float vertex_cache_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float acmr_before;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float acmr_after;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float atvr_before;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float atvr_after;
+	// Triangle strips with primitive restarts, only set when FDecodeOptions::generate_triangle_strips
+	// applied. strip_index_count includes the restart indices.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float strips_ms;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int strip_count;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int strip_index_count;
+};
 
 
 UCLASS()
@@ -63,8 +312,48 @@ class UNREALDRACO_API UFlib_DracoUtilities : public UBlueprintFunctionLibrary
 public:
 	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
 		static bool Encoder(const FString& inFileName,  const FString& outFileName, FOptions options);
+	// Encodes the input with every supported method and prediction scheme combination and returns
+	// the smallest configuration whose decode time stays under maxDecodeMs (<= 0 for no limit).
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool TuneEncoder(const FString& inFileName, FOptions options, float maxDecodeMs, FEncoderConfig& outConfig);
+	// Encodes the input in memory and returns how the bytes split into header, connectivity and
+	// attributes, and per attribute into prediction data, entropy tables and symbols.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool EncoderReport(const FString& inFileName, FOptions options, FString& outReport);
+	// Encodes inFileNames[i] to outFileNames[i], skipping files whose contents and options are
+	// unchanged since they were last encoded into cacheDirectory.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static FEncodeBatchStats EncoderBatch(const TArray<FString>& inFileNames, const TArray<FString>& outFileNames, FOptions options, const FString& cacheDirectory);
+	// Packs already encoded .drc files into one .uda archive, each member named after its file.
+	// trainSymbolModel shares the entropy statistics of the members through a symbol model trained
+	// on them, see draco::UD_MeshArchiveWriter.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool CreateArchive(const TArray<FString>& inFileNames, const FString& outFileName, bool trainSymbolModel);
+	// Lists the members of a .uda archive.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool ReadArchive(const FString& archiveFileName, TArray<FString>& outMemberNames);
+	// Same as DecoderWithOptions for the member memberName of a .uda archive.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool DecodeArchiveEntry(const FString& archiveFileName, const FString& memberName, const FString& outFileName, FDecodeOptions options, FDecodeStats& outStats, TArray<int32>& outStripIndices);
 	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
 		static bool Decoder(const FString& inFileName, const FString& outFileName);
+	// Same as Decoder, also returning where the decode time went.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool DecoderWithStats(const FString& inFileName, const FString& outFileName, FDecodeStats& outStats);
+	// Same as DecoderWithStats, with post-decode processing of the geometry before it is written.
+	// outStripIndices receives the triangle strips of FDecodeOptions::generate_triangle_strips,
+	// point ids of the written geometry separated by -1 restart indices, and is empty otherwise.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static bool DecoderWithOptions(const FString& inFileName, const FString& outFileName, FDecodeOptions options, FDecodeStats& outStats, TArray<int32>& outStripIndices);
+
+	// Memory budget of the decode cache shared by all Decoder calls.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static void SetDecodeCacheBudget(int32 budgetInMegaBytes);
+	// Directory for decoded attribute blobs reused across sessions. Empty disables the disk tier.
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static void SetDecodeCacheDirectory(const FString& directory);
+	UFUNCTION(BlueprintCallable, Category = UnrealDraco)
+		static void ClearDecodeCache();
 
 
 };
@@ -0,0 +1,46 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Draco compressed primitive found in a GLB file.
+struct UD_GlbDracoPrimitive {
+  // Bitstream inside the binary chunk of the file.
+  const char *data = nullptr;
+  size_t size = 0;
+  // glTF attribute semantic (POSITION, TEXCOORD_0, ...) and the unique id of
+  // the Draco attribute it is stored in.
+  std::vector<std::pair<std::string, int>> attributes;
+};
+
+// Reads meshes from binary glTF 2.0 (GLB) files that use the
+// KHR_draco_mesh_compression extension, such as the ones UD_GlbWriter
+// produces. Only the first compressed primitive of the file is read.
+class UD_GlbReader {
+ public:
+  // Returns true when |data| starts with the GLB header magic.
+  static bool IsGlb(const char *data, size_t data_size);
+
+  // Locates the compressed primitive without decoding it. The returned
+  // bitstream points into |data|.
+  static StatusOr<UD_GlbDracoPrimitive> FindDracoPrimitive(const char *data,
+                                                           size_t data_size);
+
+  // Decodes the compressed primitive and checks that every attribute the
+  // extension maps is present in the decoded mesh.
+  StatusOr<std::unique_ptr<Mesh>> ReadFromFile(const std::string &file_name);
+  StatusOr<std::unique_ptr<Mesh>> ReadFromBuffer(const char *data,
+                                                 size_t data_size);
+};
+
+}  // namespace draco
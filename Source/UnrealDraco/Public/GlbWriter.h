@@ -0,0 +1,36 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/status.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Writes binary glTF 2.0 (GLB) files holding one mesh compressed with the
+// KHR_draco_mesh_compression extension. The Draco bitstream is stored as is
+// in the binary chunk and referenced by a single buffer view, so no geometry
+// is re-encoded or converted to text. The accessors describe the decoded
+// mesh: one for the indices and one per attribute, which the extension maps
+// to the attribute unique ids of the bitstream. Attributes glTF cannot
+// describe (64-bit, double and 32-bit signed values, more than four
+// components) are left out of the mapping with a warning each. Point clouds
+// have no GLB form and are rejected.
+class UD_GlbWriter {
+ public:
+  // |mesh| must be the mesh |encoded_data| decodes to.
+  Status WriteToFile(const char *encoded_data, size_t encoded_size,
+                     const Mesh &mesh, const std::string &file_name);
+  Status WriteToBuffer(const char *encoded_data, size_t encoded_size,
+                       const Mesh &mesh, EncoderBuffer *out_buffer);
+
+  // Same as above, decoding |encoded_data| first to describe the accessors.
+  Status WriteToFile(const char *encoded_data, size_t encoded_size,
+                     const std::string &file_name);
+};
+
+}  // namespace draco
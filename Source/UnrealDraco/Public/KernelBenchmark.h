@@ -0,0 +1,59 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Timing of one optimized attribute kernel against the Draco implementation
+// it replaces, on the same input.
+struct UD_KernelBenchmarkResult {
+  std::string kernel;
+  std::string name;
+  int num_entries = 0;
+  double reference_ms = 0.0;
+  double optimized_ms = 0.0;
+  // Whether both implementations produced the same values.
+  bool identical = false;
+
+  double Speedup() const {
+    return optimized_ms > 0.0 ? reference_ms / optimized_ms : 0.0;
+  }
+};
+
+// Runs the plugin's attribute kernels and the matching Draco kernels over
+// the attributes of a corpus of meshes and checks that both produce identical
+// output. Normals are quantized with the default settings. Deduplication runs
+// on copies of the meshes with a point per corner, as mesh readers produce
+// them, and the geometry builders are fed the same corners as arrays.
+class UD_KernelBenchmark {
+ public:
+  UD_KernelBenchmark();
+
+  // Adds the generated spheres of UD_Benchmark.
+  void AddSyntheticCorpus();
+  // Adds a mesh file. Returns false when it cannot be loaded or has no faces.
+  bool AddFile(const std::string &file_name);
+  void AddMesh(const std::string &name, std::unique_ptr<Mesh> mesh);
+
+  // Each measurement is repeated and the fastest run is reported.
+  void set_repetitions(int repetitions) { repetitions_ = repetitions; }
+
+  std::vector<UD_KernelBenchmarkResult> Run() const;
+
+ private:
+  struct CorpusEntry {
+    std::string name;
+    std::unique_ptr<Mesh> mesh;
+  };
+
+  std::vector<CorpusEntry> corpus_;
+  int repetitions_;
+};
+
+}  // namespace draco
@@ -0,0 +1,40 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace draco {
+
+// Read-only view of a whole file. The file is memory mapped through the
+// platform file layer when possible, otherwise it is read into memory with
+// draco::ReadFileToBuffer().
+class UD_MappedFile {
+ public:
+  UD_MappedFile();
+  ~UD_MappedFile();
+
+  UD_MappedFile(const UD_MappedFile &) = delete;
+  UD_MappedFile &operator=(const UD_MappedFile &) = delete;
+
+  // Returns false when the file cannot be read.
+  bool Open(const std::string &file_name);
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  std::unique_ptr<IMappedFileHandle> handle_;
+  std::unique_ptr<IMappedFileRegion> region_;
+  std::vector<char> buffer_;
+  const char *data_;
+  size_t size_;
+};
+
+}  // namespace draco
@@ -0,0 +1,130 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DecodeCache.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/status.h"
+#include "draco/core/status_or.h"
+
+namespace draco {
+
+class UD_MappedFile;
+
+// Archive of many Draco encoded geometries in one file (.uda). The members
+// are stored back to back after a small header and followed by a directory
+// with the size and the name of every member, both varint encoded, so that an
+// archive of small props costs a few bytes per member on top of the Draco
+// bitstreams instead of one file each.
+//
+// Optionally the archive also stores a UD_SymbolModel of the bytes of its
+// members, trained when it is written. Members that get smaller when coded
+// with it through UD_EncodeSymbols() are stored coded. Their headers,
+// attribute descriptors and rANS probability tables share their statistics
+// across the archive, which saves most on small meshes, where these are a
+// large part of the bitstream.
+class UD_MeshArchiveWriter {
+ public:
+  UD_MeshArchiveWriter() : train_symbol_model_(false) {}
+
+  // Adds a Draco bitstream under |name|. Names must be unique and non-empty.
+  Status AddMember(const std::string &name, const char *data,
+                   size_t data_size);
+  // Adds the contents of a .drc file, named after the file without its
+  // directory and extension.
+  Status AddFile(const std::string &file_name);
+
+  int num_members() const { return static_cast<int>(names_.size()); }
+
+  // Trains the shared symbol model when the archive is written.
+  void set_train_symbol_model(bool train) { train_symbol_model_ = train; }
+
+  Status WriteToFile(const std::string &file_name) const;
+  void WriteToBuffer(EncoderBuffer *out_buffer) const;
+
+ private:
+  std::vector<std::string> names_;
+  std::vector<size_t> sizes_;
+  std::vector<char> data_;
+  std::unordered_map<std::string, int> name_to_index_;
+  bool train_symbol_model_;
+};
+
+// Reads .uda archives. The archive is memory mapped, only the directory is
+// parsed on Open() and members are decoded on demand, several at a time on
+// all cores with DecodeMembers(). The symbol model of an archive is
+// registered in UD_SymbolModelRegistry on Open() under an id derived from its
+// probabilities, so archives with the same model share it.
+class UD_MeshArchiveReader {
+ public:
+  // Returns nullptr when the file cannot be read or is not a valid archive, or
+  // when its symbol model id is registered for a different model.
+  static std::unique_ptr<UD_MeshArchiveReader> Open(
+      const std::string &file_name);
+  // Same for an archive already in memory. |data| must outlive the reader.
+  static std::unique_ptr<UD_MeshArchiveReader> OpenBuffer(const char *data,
+                                                          size_t data_size);
+
+  UD_MeshArchiveReader(const UD_MeshArchiveReader &) = delete;
+  UD_MeshArchiveReader &operator=(const UD_MeshArchiveReader &) = delete;
+
+  ~UD_MeshArchiveReader();
+
+  int num_members() const { return static_cast<int>(names_.size()); }
+  const std::string &member_name(int index) const { return names_[index]; }
+  // Returns -1 when there is no member called |name|.
+  int FindMember(const std::string &name) const;
+
+  // Bytes of a member as stored inside the archive, coded with the symbol
+  // model of the archive when member_coded().
+  const char *member_data(int index) const { return data_ + offsets_[index]; }
+  size_t member_size(int index) const { return sizes_[index]; }
+  bool member_coded(int index) const { return bitstream_sizes_[index] > 0; }
+
+  // Copies the Draco bitstream of a member to |out_bitstream|, decoding it
+  // with the symbol model when it is coded. The symbol decode is added to the
+  // symbols_* fields of |out_stats| when set.
+  Status ReadMemberBitstream(int index, std::vector<char> *out_bitstream,
+                             UD_DecodeStats *out_stats = nullptr) const;
+
+  // Members are decoded through |cache| when set, e.g. UD_DecodeCache::Get().
+  void set_decode_cache(UD_DecodeCache *cache) { cache_ = cache; }
+
+  // Fills |out_stats| when set, including the symbol decode of coded members.
+  StatusOr<UD_DecodedGeometry> DecodeMember(
+      int index, UD_DecodeStats *out_stats = nullptr) const;
+  StatusOr<UD_DecodedGeometry> DecodeMember(
+      const std::string &name, UD_DecodeStats *out_stats = nullptr) const;
+
+  // Decodes the members at |indices| in parallel. On failure the error of the
+  // first failing member in |indices| order is returned.
+  Status DecodeMembers(const std::vector<int> &indices,
+                       std::vector<UD_DecodedGeometry> *out_geometry) const;
+
+ private:
+  UD_MeshArchiveReader(std::unique_ptr<UD_MappedFile> file, const char *data,
+                       size_t data_size);
+
+  // Parses the header and the directory.
+  bool ReadDirectory();
+
+  std::unique_ptr<UD_MappedFile> file_;
+  const char *data_;
+  size_t data_size_;
+  UD_DecodeCache *cache_;
+  std::vector<std::string> names_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> sizes_;
+  // Size of the decoded bitstream of coded members, 0 for the others.
+  std::vector<size_t> bitstream_sizes_;
+  std::unordered_map<std::string, int> name_to_index_;
+};
+
+}  // namespace draco
@@ -0,0 +1,35 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Drop-in replacements of draco::ReadMeshFromFile() and
+// draco::ReadPointCloudFromFile() with default options. OBJ meshes are read
+// with UD_ObjReader, binary PLY files with UD_PlyReader, Draco compressed GLB
+// files with UD_GlbReader and .udm files with UD_BinaryMeshReader. Other
+// formats, and any OBJ or PLY file one of these readers rejects, go through
+// the Draco decoders, which also produce the error message for invalid input.
+StatusOr<std::unique_ptr<Mesh>> UD_ReadMeshFromFile(
+    const std::string &file_name);
+StatusOr<std::unique_ptr<PointCloud>> UD_ReadPointCloudFromFile(
+    const std::string &file_name);
+
+// Same for the contents of |file_name| already read into |data|, so that
+// callers hashing the input do not read it twice. |file_name| selects the
+// format and locates OBJ material libraries. OBJ files UD_ObjReader rejects
+// are still read from the file by ObjDecoder.
+StatusOr<std::unique_ptr<Mesh>> UD_ReadMeshFromBuffer(
+    const std::string &file_name, const char *data, size_t data_size);
+StatusOr<std::unique_ptr<PointCloud>> UD_ReadPointCloudFromBuffer(
+    const std::string &file_name, const char *data, size_t data_size);
+
+}  // namespace draco
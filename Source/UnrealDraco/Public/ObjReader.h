@@ -0,0 +1,48 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Reads Wavefront OBJ files into the same Mesh that draco::ObjDecoder builds
+// without metadata. The input is memory mapped, split into line ranges and
+// parsed on all cores in two passes: the first counts the definitions of every
+// range and the second writes the values directly into the attribute buffers
+// at the offsets given by the counts of the preceding ranges.
+// Inputs outside of what is reproduced exactly (polygons with more than four
+// vertices, empty material names, malformed lines) make the reader return an
+// error so that the caller can fall back to ObjDecoder; see
+// UD_ReadMeshFromFile() in MeshReader.h.
+class UD_ObjReader {
+ public:
+  UD_ObjReader();
+
+  StatusOr<std::unique_ptr<Mesh>> ReadFromFile(const std::string &file_name);
+  StatusOr<std::unique_ptr<Mesh>> ReadFromBuffer(const char *data,
+                                                 size_t data_size);
+  // Same for the contents of |file_name| already in memory. |file_name| is
+  // only used to locate material libraries.
+  StatusOr<std::unique_ptr<Mesh>> ReadFromBuffer(const char *data,
+                                                 size_t data_size,
+                                                 const std::string &file_name);
+
+  // Approximate number of bytes parsed by one task. Ranges always end on a
+  // line break.
+  void set_chunk_size(size_t chunk_size) { chunk_size_ = chunk_size; }
+
+  // Same as ObjDecoder::set_deduplicate_input_values(). Default: true.
+  void set_deduplicate_input_values(bool v) { deduplicate_input_values_ = v; }
+
+ private:
+  size_t chunk_size_;
+  bool deduplicate_input_values_;
+};
+
+}  // namespace draco
@@ -0,0 +1,50 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "draco/core/encoder_buffer.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Writes a Mesh or a PointCloud as Wavefront OBJ with the same statements and
+// in the same order as draco::ObjEncoder. The v/vt/vn/f lines are split into
+// blocks that are formatted on all cores and concatenated afterwards.
+// Floats are printed with the shortest representation that reads back to the
+// same value instead of ObjEncoder's "%f", which also makes the output
+// lossless. Geometry with metadata (materials, sub-objects) is passed on to
+// ObjEncoder unchanged.
+class UD_ObjWriter {
+ public:
+  UD_ObjWriter();
+
+  // Returns false when the geometry has no positions or when the file could
+  // not be opened.
+  bool WriteToFile(const PointCloud &pc, const std::string &file_name);
+  bool WriteToFile(const Mesh &mesh, const std::string &file_name);
+
+  bool WriteToBuffer(const PointCloud &pc, EncoderBuffer *out_buffer);
+  bool WriteToBuffer(const Mesh &mesh, EncoderBuffer *out_buffer);
+
+  // Number of lines formatted by one task.
+  void set_block_size(int64_t block_size) { block_size_ = block_size; }
+
+ private:
+  // Formats the whole file into |out_blocks|, in file order. |mesh| is
+  // nullptr for point clouds.
+  bool Format(const PointCloud &pc, const Mesh *mesh,
+              std::vector<std::string> *out_blocks) const;
+  bool WriteToFileInternal(const PointCloud &pc, const Mesh *mesh,
+                           const std::string &file_name);
+  bool WriteToBufferInternal(const PointCloud &pc, const Mesh *mesh,
+                             EncoderBuffer *out_buffer);
+
+  int64_t block_size_;
+};
+
+}  // namespace draco
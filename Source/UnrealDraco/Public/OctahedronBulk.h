@@ -0,0 +1,42 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+
+#include "draco/compression/attributes/normal_compression_utils.h"
+
+namespace draco {
+
+// Array versions of the per value conversions of OctahedronToolBox, with the
+// same results. Values are processed in blocks that are split into one array
+// per component, where the branches of the tool box become selects, so that
+// the compiler vectorizes the conversions. |tool_box| must be initialized.
+//
+// These serve the encoder side tools only: the normal error measurement of
+// UD_QuantizationTuner and the kernel benchmark. Decoding converts normals
+// inside the prebuilt Draco attribute decoders, which keep using
+// OctahedronToolBox.
+
+// FloatVectorToQuantizedOctahedralCoords() for |num_vectors| xyz triples.
+// Writes an s, t pair per vector to |out_coords|.
+void UD_FloatVectorsToQuantizedOctahedralCoords(
+    const OctahedronToolBox &tool_box, const float *vectors, int num_vectors,
+    int32_t *out_coords);
+
+// QuantizedOctaherdalCoordsToUnitVector() for |num_coords| s, t pairs. Writes
+// an xyz triple per pair to |out_vectors|.
+void UD_QuantizedOctahedralCoordsToUnitVectors(
+    const OctahedronToolBox &tool_box, const int32_t *coords, int num_coords,
+    float *out_vectors);
+
+// CanonicalizeOctahedralCoords() in place for |num_coords| s, t pairs.
+void UD_CanonicalizeOctahedralCoords(const OctahedronToolBox &tool_box,
+                                     int32_t *coords, int num_coords);
+
+// InvertDiamond() in place for |num_coords| s, t pairs centered at the
+// origin.
+void UD_InvertDiamonds(const OctahedronToolBox &tool_box, int32_t *coords,
+                       int num_coords);
+
+}  // namespace draco
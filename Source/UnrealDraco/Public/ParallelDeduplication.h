@@ -0,0 +1,42 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include "draco/attributes/point_attribute.h"
+#include "draco/draco_features.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Faster counterparts of the Draco deduplication functions, with identical
+// results: values and points keep the order of their first occurrence and the
+// mappings and faces are the same. Draco looks every value or point up in a
+// std::unordered_map one after another. Here all values are hashed at once,
+// partitioned by the high bits of their hashes, and each partition is matched
+// against its own open addressing table in parallel, in index order, so that
+// every value finds the first occurrence of its duplicates. Unique values are
+// then numbered with a parallel prefix sum. Points are matched in a single
+// pass over chains addressed by attribute value indices, see
+// UD_DeduplicatePointIds().
+
+#ifdef DRACO_ATTRIBUTE_VALUES_DEDUPLICATION_SUPPORTED
+// Same as PointAttribute::DeduplicateValues(*att). Returns the number of
+// unique values, or -1 for data types and component counts Draco does not
+// deduplicate.
+AttributeValueIndex::ValueType UD_DeduplicateValues(PointAttribute *att);
+
+// Same as PointCloud::DeduplicateAttributeValues().
+bool UD_DeduplicateAttributeValues(PointCloud *pc);
+#endif
+
+#ifdef DRACO_ATTRIBUTE_INDICES_DEDUPLICATION_SUPPORTED
+// Same as PointCloud::DeduplicatePointIds(). |mesh| must be nullptr or the
+// same object as |pc|, its faces are remapped to the merged points then.
+// Points are chained by the value index of the attribute with the most
+// values, which needs no hashing. Inputs whose chains grow long are passed
+// to PointCloud::DeduplicatePointIds() instead.
+void UD_DeduplicatePointIds(PointCloud *pc, Mesh *mesh);
+#endif
+
+}  // namespace draco
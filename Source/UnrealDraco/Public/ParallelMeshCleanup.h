@@ -0,0 +1,26 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include "draco/mesh/mesh.h"
+#include "draco/mesh/mesh_cleanup.h"
+
+namespace draco {
+
+// Parallel counterpart of MeshCleanup::operator(): degenerate faces, whose
+// corners share a position value, are removed keeping the order of the others,
+// then unused points and attribute values are removed keeping the order of the
+// used ones. MeshCleanup walks the faces and then the points once per
+// attribute. Here a single pass over blocks of faces filters the degenerate
+// ones, counts the rest per block and marks the points they use in an atomic
+// bitset, the used points mark the attribute values in one bitset per
+// attribute, and faces, points and values are compacted in parallel at the
+// offsets of prefix sums over the blocks.
+//
+// The results are the same as MeshCleanup's, except for attributes that keep
+// all their values while points are removed: Draco 1.3.6 remaps their points
+// with the value map of the previous attribute, here they keep their values.
+// Returns false when |mesh| has no position attribute.
+bool UD_CleanupMesh(Mesh *mesh, const MeshCleanupOptions &options);
+
+}  // namespace draco
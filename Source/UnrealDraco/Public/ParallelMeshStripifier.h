@@ -0,0 +1,53 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Meshes with fewer faces than this are stripified as a single region.
+constexpr int kUD_StripifierMinRegionFaces = 16384;
+// Upper bound on the number of regions stripified concurrently.
+constexpr int kUD_StripifierMaxRegions = 256;
+
+// Parallel counterpart of MeshStripifier::
+// GenerateTriangleStripsWithPrimitiveRestart(). The faces are partitioned into
+// spatially coherent regions of about the same size by the Morton order of
+// their centroids. Each region is stripified on its own thread with the greedy
+// heuristic of MeshStripifier, which starts a strip at the next unvisited face
+// and keeps the longest of the three strips through it, and the regions are
+// joined with primitive restarts. Strips do not cross region borders, so the
+// output has a few more strips than MeshStripifier's, and the same strips when
+// the mesh is a single region.
+//
+// Instead of the corner table MeshStripifier builds from the position
+// attribute, faces are connected directly through edges of matching point ids,
+// which is all a strip can cross anyway. Non-manifold edges and degenerate
+// faces end strips.
+class UD_ParallelMeshStripifier {
+ public:
+  UD_ParallelMeshStripifier() : num_strips_(0), num_regions_(0) {}
+
+  // Replaces |out_indices| with the point indices of the strips, separated by
+  // |primitive_restart_index|. Returns false when |mesh| has no position
+  // attribute.
+  bool GenerateTriangleStripsWithPrimitiveRestart(
+      const Mesh &mesh, uint32_t primitive_restart_index,
+      std::vector<uint32_t> *out_indices);
+
+  // Returns the number of strips generated by the last call of
+  // GenerateTriangleStripsWithPrimitiveRestart().
+  int num_strips() const { return num_strips_; }
+  // Returns the number of regions the faces were split into by the last call.
+  int num_regions() const { return num_regions_; }
+
+ private:
+  int num_strips_;
+  int num_regions_;
+};
+
+}  // namespace draco
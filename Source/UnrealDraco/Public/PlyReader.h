@@ -0,0 +1,47 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "draco/core/status.h"
+#include "draco/core/status_or.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Reads binary little-endian PLY files into the same geometry that
+// draco::PlyDecoder builds. Every element with fixed-size records is read in
+// place: the record layout is computed once from the header and the columns
+// used by the decoder (x/y/z, nx/ny/nz, red/green/blue/alpha and triangle
+// vertex indices) are copied straight into the attribute buffers and faces in
+// parallel blocks of records.
+// ASCII files, faces that are not triangles and other layouts the decoder
+// handles differently make the reader return an error so that the caller can
+// fall back to PlyDecoder; see UD_ReadMeshFromFile() in MeshReader.h.
+class UD_PlyReader {
+ public:
+  UD_PlyReader();
+
+  StatusOr<std::unique_ptr<Mesh>> ReadMeshFromFile(
+      const std::string &file_name);
+  StatusOr<std::unique_ptr<PointCloud>> ReadPointCloudFromFile(
+      const std::string &file_name);
+
+  // |out_mesh| may be nullptr, faces are ignored then. Otherwise it must be
+  // the same object as |out_point_cloud|.
+  Status ReadFromBuffer(const char *data, size_t data_size,
+                        PointCloud *out_point_cloud, Mesh *out_mesh);
+
+  // Number of records copied by one task.
+  void set_block_size(int64_t block_size) { block_size_ = block_size; }
+
+ private:
+  int64_t block_size_;
+};
+
+}  // namespace draco
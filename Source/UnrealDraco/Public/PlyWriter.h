@@ -0,0 +1,42 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "draco/core/encoder_buffer.h"
+#include "draco/mesh/mesh.h"
+#include "draco/point_cloud/point_cloud.h"
+
+namespace draco {
+
+// Writes a Mesh or a PointCloud as binary little-endian PLY, byte for byte the
+// same file that draco::PlyEncoder produces. The header is written first, then
+// the vertex and face records are copied into their final place in the output
+// in parallel blocks of records, since every record has a fixed size.
+// Attributes of a type PlyEncoder cannot describe in the header are passed on
+// to PlyEncoder unchanged.
+class UD_PlyWriter {
+ public:
+  UD_PlyWriter();
+
+  // Returns false when the geometry has no positions or when the file could
+  // not be opened.
+  bool WriteToFile(const PointCloud &pc, const std::string &file_name);
+  bool WriteToFile(const Mesh &mesh, const std::string &file_name);
+
+  bool WriteToBuffer(const PointCloud &pc, EncoderBuffer *out_buffer);
+  bool WriteToBuffer(const Mesh &mesh, EncoderBuffer *out_buffer);
+
+  // Number of records copied by one task.
+  void set_block_size(int64_t block_size) { block_size_ = block_size; }
+
+ private:
+  bool WriteToBufferInternal(const PointCloud &pc, const Mesh *mesh,
+                             EncoderBuffer *out_buffer);
+
+  int64_t block_size_;
+};
+
+}  // namespace draco
@@ -0,0 +1,42 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <vector>
+
+#include "draco/attributes/point_attribute.h"
+
+namespace draco {
+
+enum UD_QuantizationErrorMetric {
+  UD_MAX_ERROR = 0,
+  UD_RMS_ERROR,
+};
+
+// Searches the smallest number of quantization bits that keeps the
+// reconstruction error of an attribute under a tolerance. Positions, texture
+// coordinates and generic attributes are measured as the euclidean distance
+// between the original and the dequantized value, normals as the angle in
+// degrees between the original and the decoded octahedral direction.
+class UD_QuantizationTuner {
+ public:
+  explicit UD_QuantizationTuner(UD_QuantizationErrorMetric metric);
+
+  // Returns the minimal number of bits for |att| so that every larger number
+  // of bits also satisfies |tolerance|. Returns the largest candidate when the
+  // tolerance cannot be met and -1 when |att| is not a float attribute.
+  int FindMinimalBits(const PointAttribute &att, float tolerance) const;
+
+  // Returns the reconstruction error of |att| encoded with |bits|.
+  double ComputeError(const PointAttribute &att, int bits) const;
+
+ private:
+  double ComputeQuantizationError(const PointAttribute &att,
+                                  const std::vector<float> &values,
+                                  int bits) const;
+  double ComputeNormalError(const std::vector<float> &values, int bits) const;
+
+  UD_QuantizationErrorMetric metric_;
+};
+
+}  // namespace draco
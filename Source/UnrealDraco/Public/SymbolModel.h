@@ -0,0 +1,128 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "draco/compression/entropy/ans.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/core/options.h"
+
+namespace draco {
+
+struct UD_DecodeStats;
+
+// Static rANS probability model for symbols in [0, num_symbols()), trained
+// offline from the symbol frequencies of a representative corpus. Streams
+// coded with a model only store its id, so they carry no probability table
+// and the decoder skips parsing the table and building the lookup table,
+// which dominates the cost of small streams. UD_MeshArchiveWriter trains one
+// per archive to code its members.
+class UD_SymbolModel {
+ public:
+  // Builds a model from |frequencies| of |num_symbols| symbols. Every symbol
+  // gets a non-zero probability, so any input within the alphabet can be
+  // coded. Returns nullptr when the alphabet is empty or too large.
+  static std::unique_ptr<UD_SymbolModel> Train(uint32_t id,
+                                               const uint64_t *frequencies,
+                                               int num_symbols);
+  // Same as Train() when |smooth| is true. Otherwise symbols that do not occur
+  // get a zero probability, as in per-stream tables.
+  static std::unique_ptr<UD_SymbolModel> Create(uint32_t id,
+                                                const uint64_t *frequencies,
+                                                int num_symbols, bool smooth);
+  // Adds the histogram of |symbols| to |frequencies|, growing it as needed.
+  static void AccumulateFrequencies(const uint32_t *symbols, int num_values,
+                                    std::vector<uint64_t> *frequencies);
+
+  // Serialization of trained models, e.g. to ship them with the game.
+  void Encode(EncoderBuffer *out_buffer) const;
+  // Returns nullptr when |buffer| does not hold a valid model.
+  static std::unique_ptr<UD_SymbolModel> Decode(DecoderBuffer *buffer);
+  // Same without the id, as stored in front of per-stream coded symbols.
+  // Zero probabilities are only accepted with |allow_zero|.
+  void EncodeTable(EncoderBuffer *out_buffer) const;
+  static std::unique_ptr<UD_SymbolModel> DecodeTable(uint32_t id,
+                                                     bool allow_zero,
+                                                     DecoderBuffer *buffer);
+
+  UD_SymbolModel(const UD_SymbolModel &) = delete;
+  UD_SymbolModel &operator=(const UD_SymbolModel &) = delete;
+
+  uint32_t id() const { return id_; }
+  int num_symbols() const {
+    return static_cast<int>(probability_table_.size());
+  }
+  int precision_bits() const { return precision_bits_; }
+  const rans_sym &probability(uint32_t symbol) const {
+    return probability_table_[symbol];
+  }
+  // Symbol whose cumulative probability range contains |slot|, for slot in
+  // [0, 1 << precision_bits()).
+  uint32_t symbol_at(uint32_t slot) const { return lut_table_[slot]; }
+
+  // Estimated number of bits for coding symbols with the histogram
+  // |frequencies| using this model.
+  double ComputeBits(const uint64_t *frequencies, int num_symbols) const;
+
+ private:
+  UD_SymbolModel(uint32_t id, int precision_bits)
+      : id_(id), precision_bits_(precision_bits) {}
+
+  // Computes the cumulative probabilities and the lookup table. Returns false
+  // when the probabilities do not add up to the precision.
+  bool BuildTables();
+
+  uint32_t id_;
+  int precision_bits_;
+  std::vector<rans_sym> probability_table_;
+  std::vector<uint32_t> lut_table_;
+};
+
+// Process-wide set of models that UD_DecodeSymbols() resolves ids against.
+// Models are never removed, so returned pointers stay valid.
+class UD_SymbolModelRegistry {
+ public:
+  static UD_SymbolModelRegistry &Get();
+
+  // Returns false when a model with the same id is already registered.
+  bool Register(std::unique_ptr<const UD_SymbolModel> model);
+  // Returns nullptr for unknown ids.
+  const UD_SymbolModel *Find(uint32_t id) const;
+
+ private:
+  UD_SymbolModelRegistry() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<uint32_t, std::unique_ptr<const UD_SymbolModel>> models_;
+};
+
+// Same contract as EncodeSymbols() in symbol_encoding.h. The symbols are coded
+// with |model| when it covers all of them and is estimated to be smaller than
+// a per-stream probability table and symbols. Otherwise small alphabets are
+// coded with a per-stream table that decoders cache once built, and larger
+// ones with EncodeSymbols(). The model must be
+// registered in UD_SymbolModelRegistry wherever the stream is decoded.
+bool UD_EncodeSymbols(const uint32_t *symbols, int num_values,
+                      int num_components, const UD_SymbolModel *model,
+                      const Options *options, EncoderBuffer *target_buffer);
+
+// Decodes a stream written by UD_EncodeSymbols(). Returns false on error or
+// when the stream references a model that is not registered.
+//
+// Each decoding thread keeps the last few per-stream tables it built, keyed by
+// a fingerprint of the serialized table, so consecutive streams and decodes
+// with identical probabilities skip parsing the table and building the
+// lookup table. When |out_stats| is set, the stream is added to its
+// symbol_table_hits when its tables were ready, from a registered model or the
+// cache, and to its symbol_table_misses otherwise.
+bool UD_DecodeSymbols(uint32_t num_values, int num_components,
+                      DecoderBuffer *src_buffer, uint32_t *out_values,
+                      UD_DecodeStats *out_stats = nullptr);
+
+}  // namespace draco
@@ -0,0 +1,41 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <memory>
+
+#include "draco/mesh/mesh.h"
+
+namespace draco {
+
+// Cache size of the GPU post-transform vertex cache simulated by default.
+constexpr int kUD_DefaultVertexCacheSize = 16;
+
+// Post-transform vertex cache efficiency of the faces of a mesh, simulated
+// with a FIFO cache.
+struct UD_VertexCacheStats {
+  UD_VertexCacheStats() : acmr(0.0), atvr(0.0) {}
+
+  // Average cache miss ratio: vertex transforms per face, 3 without any
+  // reuse and approaching 0.5 on large regular meshes.
+  double acmr;
+  // Average transform to vertex ratio: vertex transforms per point used by
+  // the faces, 1 at best.
+  double atvr;
+};
+
+// Simulates drawing the faces of |mesh| in order through a FIFO vertex cache
+// of |cache_size| points.
+UD_VertexCacheStats UD_ComputeVertexCacheStats(const Mesh &mesh,
+                                               int cache_size);
+
+// Returns a copy of |mesh| reordered for the GPU. Faces are sorted for the
+// post-transform vertex cache with Tipsify (Sander et al., "Fast
+// Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007), then
+// points and the values of every attribute are renumbered in the order the
+// faces first use them, so that vertex fetches walk memory forward. Attribute
+// values shared by several points stay shared, unused points and values are
+// kept at the end. Metadata is copied.
+std::unique_ptr<Mesh> UD_OptimizeVertexCache(const Mesh &mesh, int cache_size);
+
+}  // namespace draco
@@ -0,0 +1,112 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Misc/Paths.h"
+#include "BinaryMesh.h"
+#include "GeometryTestUtils.h"
+
+namespace draco {
+
+namespace {
+
+// Copies |buffer| into |out_storage|, which is aligned for in-place access,
+// and returns the number of bytes.
+size_t CopyAligned(const EncoderBuffer &buffer,
+                   std::vector<uint64_t> *out_storage) {
+  out_storage->assign((buffer.size() + 7) / 8, 0);
+  memcpy(out_storage->data(), buffer.data(), buffer.size());
+  return buffer.size();
+}
+
+// Returns true when the in-place views of |reader| hold the faces and values
+// of |mesh|.
+bool SameSections(const UD_BinaryMeshReader &reader, const Mesh &mesh) {
+  if (reader.header().num_faces != mesh.num_faces() ||
+      reader.header().num_attributes !=
+          static_cast<uint32_t>(mesh.num_attributes())) {
+    return false;
+  }
+  if (mesh.num_faces() > 0 &&
+      memcmp(reader.faces(), &mesh.face(FaceIndex(0)),
+             mesh.num_faces() * sizeof(Mesh::Face)) != 0) {
+    return false;
+  }
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const att = mesh.attribute(i);
+    if (reader.attribute(i).num_values != att->size() ||
+        memcmp(reader.values(i), att->GetAddress(AttributeValueIndex(0)),
+               att->size() * att->byte_stride()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoBinaryMeshTest,
+                                 "UnrealDraco.BinaryMesh",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoBinaryMeshTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // The normals split points, so the positions have a non-identity mapping.
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, true);
+  EncoderBuffer udm;
+  TestTrue(TEXT("Mesh is written"),
+           UD_BinaryMeshWriter::WriteToBuffer(*mesh, mesh.get(), &udm));
+  std::vector<uint64_t> storage;
+  const size_t udm_size = CopyAligned(udm, &storage);
+  const char *const udm_data = reinterpret_cast<const char *>(storage.data());
+  TestTrue(TEXT(".udm header is recognized"),
+           UD_BinaryMeshReader::IsBinaryMesh(udm_data, udm_size));
+  std::unique_ptr<UD_BinaryMeshReader> reader =
+      UD_BinaryMeshReader::OpenBuffer(udm_data, udm_size);
+  if (!TestTrue(TEXT("Mesh is opened"), reader != nullptr)) {
+    return false;
+  }
+  TestTrue(TEXT("Mesh is a mesh"), reader->is_mesh());
+  TestTrue(TEXT("Sections hold the mesh in place"),
+           SameSections(*reader, *mesh));
+  auto statusor = reader->ReadGeometry();
+  TestTrue(TEXT("Mesh is read"), statusor.ok());
+  if (statusor.ok()) {
+    const Mesh *const read_mesh = dynamic_cast<Mesh *>(statusor.value().get());
+    TestTrue(TEXT("Same mesh"),
+             read_mesh != nullptr && UD_TestSameMesh(*read_mesh, *mesh));
+  }
+  TestTrue(TEXT("Truncated files are rejected"),
+           UD_BinaryMeshReader::OpenBuffer(udm_data, udm_size / 2) == nullptr);
+
+  // Point clouds go through a memory mapped file.
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(1000, false);
+  const std::string file_name = TCHAR_TO_UTF8(
+      *FPaths::Combine(FPaths::AutomationTransientDir(),
+                       TEXT("UnrealDracoPointCloud.udm")));
+  std::unique_ptr<UD_BinaryMeshWriter> writer =
+      UD_BinaryMeshWriter::Open(file_name);
+  TestTrue(TEXT("Point cloud is written"),
+           writer != nullptr && writer->Write(*pc, nullptr));
+  writer.reset();
+  reader = UD_BinaryMeshReader::Open(file_name);
+  if (!TestTrue(TEXT("Point cloud is opened"), reader != nullptr)) {
+    return false;
+  }
+  TestFalse(TEXT("Point cloud is not a mesh"), reader->is_mesh());
+  auto pc_statusor = reader->ReadGeometry();
+  TestTrue(TEXT("Same point cloud"),
+           pc_statusor.ok() && UD_TestSameGeometry(*pc_statusor.value(), *pc));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,169 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <vector>
+
+#include "BulkGeometryBuilder.h"
+#include "GeometryTestUtils.h"
+
+namespace draco {
+
+namespace {
+
+// Vertex with padding, read with a byte stride larger than its values.
+struct PaddedNormal {
+  float normal[3];
+  float padding;
+};
+
+// Corners of a generated mesh as a triangle soup, one vertex per corner, in
+// the layouts the bulk builders accept: interleaved positions, planar tex
+// coords and padded normals.
+struct SoupArrays {
+  std::vector<uint32_t> indices;
+  std::vector<float> positions;
+  std::vector<float> tex_u;
+  std::vector<float> tex_v;
+  std::vector<PaddedNormal> normals;
+};
+
+SoupArrays CreateSoupArrays(const Mesh &mesh) {
+  const PointAttribute *const pos =
+      mesh.GetNamedAttribute(GeometryAttribute::POSITION);
+  const PointAttribute *const tex =
+      mesh.GetNamedAttribute(GeometryAttribute::TEX_COORD);
+  const PointAttribute *const norm =
+      mesh.GetNamedAttribute(GeometryAttribute::NORMAL);
+  SoupArrays arrays;
+  for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+    for (int c = 0; c < 3; ++c) {
+      const PointIndex p = mesh.face(f)[c];
+      arrays.indices.push_back(static_cast<uint32_t>(arrays.indices.size()));
+      float value[3];
+      pos->GetMappedValue(p, value);
+      arrays.positions.insert(arrays.positions.end(), value, value + 3);
+      tex->GetMappedValue(p, value);
+      arrays.tex_u.push_back(value[0]);
+      arrays.tex_v.push_back(value[1]);
+      PaddedNormal normal = {{0.0f, 0.0f, 0.0f}, -1.0f};
+      norm->GetMappedValue(p, normal.normal);
+      arrays.normals.push_back(normal);
+    }
+  }
+  return arrays;
+}
+
+// Builds the soup of |arrays| with TriangleSoupMeshBuilder.
+std::unique_ptr<Mesh> BuildTriangleSoup(const SoupArrays &arrays) {
+  const int num_faces = static_cast<int>(arrays.indices.size() / 3);
+  TriangleSoupMeshBuilder builder;
+  builder.Start(num_faces);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int tex_att_id =
+      builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32);
+  const int norm_att_id =
+      builder.AddAttribute(GeometryAttribute::NORMAL, 3, DT_FLOAT32);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const uint32_t i = 3 * f.value();
+    const float *const pos = &arrays.positions[3 * i];
+    builder.SetAttributeValuesForFace(pos_att_id, f, pos, pos + 3, pos + 6);
+    float tex[3][2];
+    for (int c = 0; c < 3; ++c) {
+      tex[c][0] = arrays.tex_u[i + c];
+      tex[c][1] = arrays.tex_v[i + c];
+    }
+    builder.SetAttributeValuesForFace(tex_att_id, f, tex[0], tex[1], tex[2]);
+    builder.SetAttributeValuesForFace(
+        norm_att_id, f, arrays.normals[i].normal, arrays.normals[i + 1].normal,
+        arrays.normals[i + 2].normal);
+  }
+  return builder.Finalize();
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoBulkGeometryBuilderTest,
+                                 "UnrealDraco.BulkGeometryBuilder",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoBulkGeometryBuilderTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const SoupArrays arrays =
+      CreateSoupArrays(*UD_TestCreateMesh(64, true, true));
+  const uint32_t num_corners = static_cast<uint32_t>(arrays.indices.size());
+  const void *const tex_components[2] = {arrays.tex_u.data(),
+                                         arrays.tex_v.data()};
+
+  // Deduplicated meshes are the ones TriangleSoupMeshBuilder builds.
+  UD_MeshBulkBuilder mesh_builder;
+  mesh_builder.Start(num_corners, num_corners / 3, arrays.indices.data());
+  TestEqual(TEXT("Positions are added"),
+            mesh_builder.AddAttribute(GeometryAttribute::POSITION, 3,
+                                      DT_FLOAT32, false,
+                                      arrays.positions.data(), 0),
+            0);
+  TestEqual(TEXT("Planar tex coords are added"),
+            mesh_builder.AddPlanarAttribute(GeometryAttribute::TEX_COORD, 2,
+                                            DT_FLOAT32, false, tex_components),
+            1);
+  TestEqual(TEXT("Padded normals are added"),
+            mesh_builder.AddAttribute(GeometryAttribute::NORMAL, 3,
+                                      DT_FLOAT32, false,
+                                      arrays.normals.data(),
+                                      sizeof(PaddedNormal)),
+            2);
+  TestEqual(TEXT("Invalid formats are rejected"),
+            mesh_builder.AddAttribute(GeometryAttribute::GENERIC, 0,
+                                      DT_FLOAT32, false,
+                                      arrays.positions.data(), 0),
+            -1);
+  const std::unique_ptr<Mesh> mesh = mesh_builder.Finalize(true);
+  const std::unique_ptr<Mesh> expected = BuildTriangleSoup(arrays);
+  TestTrue(TEXT("Same mesh as TriangleSoupMeshBuilder"),
+           mesh != nullptr && UD_TestSameMesh(*mesh, *expected));
+
+  std::vector<uint32_t> bad_indices = arrays.indices;
+  bad_indices.back() = num_corners;
+  mesh_builder.Start(num_corners, num_corners / 3, bad_indices.data());
+  mesh_builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32, false,
+                            arrays.positions.data(), 0);
+  TestTrue(TEXT("Out of range indices are rejected"),
+           mesh_builder.Finalize(true) == nullptr);
+
+  // Point clouds match PointCloudBuilder with and without deduplication.
+  for (const bool deduplicate_points : {false, true}) {
+    PointCloudBuilder builder;
+    builder.Start(num_corners);
+    const int pos_att_id =
+        builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+    builder.SetAttributeValuesForAllPoints(pos_att_id, arrays.positions.data(),
+                                           0);
+    const int norm_att_id =
+        builder.AddAttribute(GeometryAttribute::NORMAL, 3, DT_FLOAT32);
+    builder.SetAttributeValuesForAllPoints(norm_att_id, arrays.normals.data(),
+                                           sizeof(PaddedNormal));
+    const std::unique_ptr<PointCloud> expected_pc =
+        builder.Finalize(deduplicate_points);
+
+    UD_PointCloudBulkBuilder pc_builder;
+    pc_builder.Start(num_corners);
+    pc_builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32, false,
+                            arrays.positions.data(), 0);
+    pc_builder.AddAttribute(GeometryAttribute::NORMAL, 3, DT_FLOAT32, false,
+                            arrays.normals.data(), sizeof(PaddedNormal));
+    const std::unique_ptr<PointCloud> pc =
+        pc_builder.Finalize(deduplicate_points);
+    TestTrue(TEXT("Same point cloud as PointCloudBuilder"),
+             pc != nullptr && UD_TestSameGeometry(*pc, *expected_pc));
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,151 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include "Misc/Paths.h"
+#include "DecodeCache.h"
+#include "GeometryTestUtils.h"
+#include "draco/core/hash_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Encoded mesh with the mesh Draco decodes from it.
+struct CachedInput {
+  EncoderBuffer buffer;
+  std::unique_ptr<Mesh> expected;
+  size_t size = 0;
+};
+
+// Encodes a generated mesh of |grid_size| and decodes it with Draco. |size|
+// is the estimate the cache charges for it.
+bool CreateCachedInput(int grid_size, CachedInput *input) {
+  if (!UD_TestEncode(*UD_TestCreateMesh(grid_size, true, true), 7,
+                     &input->buffer)) {
+    return false;
+  }
+  input->expected =
+      UD_TestDecodeMesh(input->buffer.data(), input->buffer.size());
+  if (input->expected == nullptr) {
+    return false;
+  }
+  input->size = UD_DecodeCache::EstimateGeometrySize(*input->expected,
+                                                     input->expected.get());
+  return true;
+}
+
+// Decodes |input| through |cache| and returns where its geometry came from,
+// or -1 when it is not the mesh Draco decodes.
+int DecodeCached(UD_DecodeCache *cache, const CachedInput &input) {
+  Decoder decoder;
+  UD_DecodeStats stats;
+  auto statusor = cache->Decode(input.buffer.data(), input.buffer.size(),
+                                &decoder, &stats);
+  if (!statusor.ok() || statusor.value().mesh == nullptr ||
+      !UD_TestSameMesh(*statusor.value().mesh, *input.expected)) {
+    return -1;
+  }
+  return stats.origin;
+}
+
+// Removes the disk entry of |input| left by an earlier run.
+void RemoveDiskEntry(const std::string &directory, const CachedInput &input) {
+  char name[64];
+  snprintf(name, sizeof(name), "%016" PRIx64 "_0000.udm",
+           FingerprintString(input.buffer.data(), input.buffer.size()));
+  remove((directory + "/" + name).c_str());
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoDecodeCacheTest,
+                                 "UnrealDraco.DecodeCache",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoDecodeCacheTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  CachedInput a;
+  CachedInput b;
+  CachedInput c;
+  if (!TestTrue(TEXT("Inputs are encoded"), CreateCachedInput(8, &a) &&
+                                                 CreateCachedInput(10, &b) &&
+                                                 CreateCachedInput(12, &c))) {
+    return false;
+  }
+
+  // The budget holds a with either b or c, but not all three.
+  {
+    UD_DecodeCache cache(a.size + c.size);
+    TestEqual(TEXT("A is decoded"), DecodeCached(&cache, a),
+              static_cast<int>(UD_DECODED));
+    TestEqual(TEXT("B is decoded"), DecodeCached(&cache, b),
+              static_cast<int>(UD_DECODED));
+    TestEqual(TEXT("A is served from memory"), DecodeCached(&cache, a),
+              static_cast<int>(UD_MEMORY_CACHE));
+    TestTrue(TEXT("A and B are charged"),
+             cache.size_in_bytes() == a.size + b.size);
+    // A was used last, so c evicts b.
+    TestEqual(TEXT("C is decoded"), DecodeCached(&cache, c),
+              static_cast<int>(UD_DECODED));
+    TestTrue(TEXT("B is evicted"), cache.size_in_bytes() == a.size + c.size);
+    TestEqual(TEXT("A stays in memory"), DecodeCached(&cache, a),
+              static_cast<int>(UD_MEMORY_CACHE));
+    TestEqual(TEXT("C stays in memory"), DecodeCached(&cache, c),
+              static_cast<int>(UD_MEMORY_CACHE));
+    TestEqual(TEXT("Hits are counted"), static_cast<int>(cache.num_hits()),
+              3);
+    TestEqual(TEXT("Misses are counted"), static_cast<int>(cache.num_misses()),
+              3);
+
+    // Lowering the budget evicts the least recently used a.
+    cache.SetByteBudget(c.size);
+    TestTrue(TEXT("Budget is shrunk"), cache.size_in_bytes() == c.size);
+    TestEqual(TEXT("A is decoded again"), DecodeCached(&cache, a),
+              static_cast<int>(UD_DECODED));
+    TestEqual(TEXT("No disk hits without a directory"),
+              static_cast<int>(cache.num_disk_hits()), 0);
+  }
+
+  // Entries evicted from memory are loaded from the disk tier.
+  {
+    const std::string directory =
+        TCHAR_TO_UTF8(*FPaths::AutomationTransientDir());
+    RemoveDiskEntry(directory, a);
+    RemoveDiskEntry(directory, c);
+    UD_DecodeCache cache(c.size);
+    cache.SetDiskDirectory(directory);
+    TestEqual(TEXT("A is decoded to disk"), DecodeCached(&cache, a),
+              static_cast<int>(UD_DECODED));
+    TestEqual(TEXT("C is decoded to disk"), DecodeCached(&cache, c),
+              static_cast<int>(UD_DECODED));
+    TestTrue(TEXT("A is evicted from memory"),
+             cache.size_in_bytes() == c.size);
+    TestEqual(TEXT("A is loaded from disk"), DecodeCached(&cache, a),
+              static_cast<int>(UD_DISK_CACHE));
+    TestEqual(TEXT("A is then served from memory"), DecodeCached(&cache, a),
+              static_cast<int>(UD_MEMORY_CACHE));
+    TestEqual(TEXT("Disk hits are counted"),
+              static_cast<int>(cache.num_disk_hits()), 1);
+    TestEqual(TEXT("Disk hits are not misses"),
+              static_cast<int>(cache.num_misses()), 2);
+
+    cache.Clear();
+    TestEqual(TEXT("Clear keeps the disk tier"), DecodeCached(&cache, c),
+              static_cast<int>(UD_DISK_CACHE));
+    RemoveDiskEntry(directory, a);
+    RemoveDiskEntry(directory, c);
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,191 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <algorithm>
+#include <vector>
+
+#include "DecodeProfiler.h"
+#include "GeometryTestUtils.h"
+#include "draco/compression/expert_encode.h"
+
+namespace draco {
+
+namespace {
+
+// Decodes |buffer| with UD_DecodeWithStats(). Returns the decoded geometry,
+// or nullptr when it differs from what Draco's Decoder decodes.
+std::unique_ptr<PointCloud> DecodeProfiled(const EncoderBuffer &buffer,
+                                           UD_DecodeStats *stats) {
+  DecoderBuffer profiled_buffer;
+  profiled_buffer.Init(buffer.data(), buffer.size());
+  auto statusor =
+      UD_DecodeWithStats(&profiled_buffer, DecoderOptions(), stats);
+  DecoderBuffer draco_buffer;
+  draco_buffer.Init(buffer.data(), buffer.size());
+  Decoder decoder;
+  if (!statusor.ok() || statusor.value() == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<PointCloud> pc = std::move(statusor).value();
+  if (stats->geometry_type == TRIANGULAR_MESH) {
+    auto expected = decoder.DecodeMeshFromBuffer(&draco_buffer);
+    if (!expected.ok() ||
+        !UD_TestSameMesh(*static_cast<const Mesh *>(pc.get()),
+                         *expected.value())) {
+      return nullptr;
+    }
+  } else {
+    auto expected = decoder.DecodePointCloudFromBuffer(&draco_buffer);
+    if (!expected.ok() || !UD_TestSameGeometry(*pc, *expected.value())) {
+      return nullptr;
+    }
+  }
+  return pc;
+}
+
+// Returns true when the stages of |stats| account for every byte of the
+// |buffer_size| input and every attribute of |pc| once.
+bool StatsCoverDecode(const UD_DecodeStats &stats, size_t buffer_size,
+                      const PointCloud &pc) {
+  if (stats.header_bytes + stats.initialize_bytes + stats.connectivity_bytes +
+          stats.attribute_setup_bytes + stats.attributes_bytes !=
+      static_cast<int64_t>(buffer_size)) {
+    return false;
+  }
+  std::vector<int> num_decodes(pc.num_attributes(), 0);
+  int64_t decoder_bytes = 0;
+  for (const UD_AttributeDecoderStats &decoder : stats.attribute_decoders) {
+    for (const int32_t att_id : decoder.attribute_ids) {
+      if (att_id < 0 || att_id >= pc.num_attributes()) {
+        return false;
+      }
+      ++num_decodes[att_id];
+    }
+    decoder_bytes += decoder.bytes;
+  }
+  int num_scheme_attributes = 0;
+  int64_t scheme_bytes = 0;
+  for (const UD_PredictionSchemeStats &scheme : stats.prediction_schemes) {
+    num_scheme_attributes += scheme.num_attributes;
+    scheme_bytes += scheme.bytes;
+  }
+  return std::count(num_decodes.begin(), num_decodes.end(), 1) ==
+             pc.num_attributes() &&
+         num_scheme_attributes == pc.num_attributes() &&
+         decoder_bytes == stats.attributes_bytes &&
+         scheme_bytes == stats.attributes_bytes;
+}
+
+// Returns the stats of |prediction_scheme| in |stats|, nullptr if it was not
+// used.
+const UD_PredictionSchemeStats *FindPredictionScheme(
+    const UD_DecodeStats &stats, int prediction_scheme) {
+  for (const UD_PredictionSchemeStats &scheme : stats.prediction_schemes) {
+    if (scheme.prediction_scheme == prediction_scheme) {
+      return &scheme;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoDecodeProfilerTest,
+                                 "UnrealDraco.DecodeProfiler",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoDecodeProfilerTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(16, true, true);
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(500, true);
+
+  // Edgebreaker and sequential meshes, kd-tree and sequential point clouds.
+  for (const int speed : {0, 5, 10}) {
+    for (const PointCloud *const input :
+         {static_cast<const PointCloud *>(mesh.get()),
+          static_cast<const PointCloud *>(pc.get())}) {
+      EncoderBuffer buffer;
+      TestTrue(TEXT("Input is encoded"), UD_TestEncode(*input, speed, &buffer));
+      UD_DecodeStats stats;
+      const std::unique_ptr<PointCloud> decoded =
+          DecodeProfiled(buffer, &stats);
+      if (!TestTrue(TEXT("Same geometry as Draco"), decoded != nullptr)) {
+        return false;
+      }
+      const bool is_mesh = input == mesh.get();
+      TestEqual(TEXT("Geometry type is reported"),
+                static_cast<int>(stats.geometry_type),
+                static_cast<int>(is_mesh ? TRIANGULAR_MESH : POINT_CLOUD));
+      int method = speed == 10 ? POINT_CLOUD_SEQUENTIAL_ENCODING
+                               : POINT_CLOUD_KD_TREE_ENCODING;
+      if (is_mesh) {
+        method = speed == 10 ? MESH_SEQUENTIAL_ENCODING
+                             : MESH_EDGEBREAKER_ENCODING;
+      }
+      TestEqual(TEXT("Encoding method is reported"), stats.encoder_method,
+                method);
+      TestTrue(TEXT("Counts are reported"),
+               stats.num_points == decoded->num_points() &&
+                   stats.num_faces ==
+                       (is_mesh ? static_cast<const Mesh *>(decoded.get())
+                                      ->num_faces()
+                                : 0u));
+      TestTrue(TEXT("Stages cover the decode"),
+               StatsCoverDecode(stats, buffer.size(), *decoded));
+      TestTrue(TEXT("Origin is a decode"), stats.origin == UD_DECODED);
+      if (!is_mesh && speed < 10) {
+        // Kd-tree coded attributes are not predicted.
+        const UD_PredictionSchemeStats *const none =
+            FindPredictionScheme(stats, PREDICTION_NONE);
+        TestTrue(TEXT("Kd-tree attributes are not predicted"),
+                 none != nullptr &&
+                     none->num_attributes == decoded->num_attributes());
+      }
+    }
+  }
+
+  // Attributes decoded one by one are reported with the scheme they were
+  // encoded with.
+  ExpertEncoder encoder(*mesh);
+  encoder.SetEncodingMethod(MESH_SEQUENTIAL_ENCODING);
+  const int pos_id = mesh->GetNamedAttributeId(GeometryAttribute::POSITION);
+  const int tex_id = mesh->GetNamedAttributeId(GeometryAttribute::TEX_COORD);
+  const int norm_id = mesh->GetNamedAttributeId(GeometryAttribute::NORMAL);
+  for (const int att_id : {pos_id, tex_id, norm_id}) {
+    encoder.SetAttributeQuantization(att_id, 10);
+  }
+  encoder.SetAttributePredictionScheme(pos_id, PREDICTION_DIFFERENCE);
+  encoder.SetAttributePredictionScheme(tex_id, PREDICTION_NONE);
+  encoder.SetAttributePredictionScheme(norm_id, PREDICTION_DIFFERENCE);
+  EncoderBuffer buffer;
+  TestTrue(TEXT("Schemes are encoded"), encoder.EncodeToBuffer(&buffer).ok());
+  UD_DecodeStats stats;
+  const std::unique_ptr<PointCloud> decoded = DecodeProfiled(buffer, &stats);
+  if (!TestTrue(TEXT("Same mesh as Draco"), decoded != nullptr)) {
+    return false;
+  }
+  TestTrue(TEXT("Stages cover the decode"),
+           StatsCoverDecode(stats, buffer.size(), *decoded));
+  const UD_PredictionSchemeStats *const difference =
+      FindPredictionScheme(stats, PREDICTION_DIFFERENCE);
+  const UD_PredictionSchemeStats *const none =
+      FindPredictionScheme(stats, PREDICTION_NONE);
+  TestTrue(TEXT("Difference prediction is reported"),
+           difference != nullptr && difference->num_attributes == 2 &&
+               difference->num_values ==
+                   static_cast<int64_t>(decoded->attribute(pos_id)->size() +
+                                        decoded->attribute(norm_id)->size()));
+  TestTrue(TEXT("Unpredicted tex coords are reported"),
+           none != nullptr && none->num_attributes == 1 &&
+               none->num_values ==
+                   static_cast<int64_t>(decoded->attribute(tex_id)->size()));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,119 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Misc/Paths.h"
+#include "EncodeCache.h"
+#include "GeometryTestUtils.h"
+#include "GlbReader.h"
+#include "GlbWriter.h"
+#include "draco/io/file_utils.h"
+
+namespace draco {
+
+namespace {
+
+// Returns the path of |name| in the automation transient directory.
+std::string GetTransientPath(const TCHAR *name) {
+  return TCHAR_TO_UTF8(*FPaths::Combine(FPaths::AutomationTransientDir(),
+                                        name));
+}
+
+// Returns the name of the entry of |key| in the container |extension|.
+std::string GetEntryName(uint64_t key, const char *extension) {
+  char name[32];
+  snprintf(name, sizeof(name), "%016" PRIx64 ".%s", key, extension);
+  return name;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoEncodeCacheTest,
+                                 "UnrealDraco.EncodeCache",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoEncodeCacheTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // One input encoded to both containers, as Encoder() writes them.
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, true);
+  EncoderBuffer drc;
+  TestTrue(TEXT("Mesh is encoded"), UD_TestEncode(*mesh, 5, &drc));
+  const std::unique_ptr<Mesh> decoded =
+      UD_TestDecodeMesh(drc.data(), drc.size());
+  if (!TestTrue(TEXT("Mesh is decoded"), decoded != nullptr)) {
+    return false;
+  }
+  EncoderBuffer glb;
+  TestTrue(TEXT("GLB is written"),
+           UD_GlbWriter()
+               .WriteToBuffer(drc.data(), drc.size(), *decoded, &glb)
+               .ok());
+  const std::string directory =
+      TCHAR_TO_UTF8(*FPaths::AutomationTransientDir());
+  const std::string drc_file = GetTransientPath(TEXT("encode_cache.drc"));
+  const std::string glb_file = GetTransientPath(TEXT("encode_cache.glb"));
+  TestTrue(TEXT("Outputs are written"),
+           WriteBufferToFile(drc.data(), drc.size(), drc_file) &&
+               WriteBufferToFile(glb.data(), glb.size(), glb_file));
+
+  // The container is part of the key and of the entry name.
+  const std::vector<char> input(drc.data(), drc.data() + drc.size());
+  const std::string input_file = GetTransientPath(TEXT("encode_cache.ply"));
+  const std::string options = "cl=7";
+  const uint64_t drc_key =
+      UD_EncodeCache::ComputeKey(input_file, input, options, drc_file);
+  const uint64_t glb_key =
+      UD_EncodeCache::ComputeKey(input_file, input, options, glb_file);
+  TestTrue(TEXT("Containers have different keys"), drc_key != glb_key);
+  TestTrue(TEXT("Extensions are compared without case"),
+           UD_EncodeCache::ComputeKey(input_file, input, options,
+                                      GetTransientPath(TEXT("A.DRC"))) ==
+               drc_key);
+
+  const UD_EncodeCache cache(directory);
+  TestTrue(TEXT("Outputs are stored"),
+           cache.Store(drc_key, drc_file) && cache.Store(glb_key, glb_file));
+  TestTrue(TEXT("Entries are named after their container"),
+           GetFileSize(directory + "/" + GetEntryName(drc_key, "drc")) ==
+                   drc.size() &&
+               GetFileSize(directory + "/" + GetEntryName(glb_key, "glb")) ==
+                   glb.size());
+
+  // Every output is served from the entry of its own container.
+  const std::string fetched_drc_file =
+      GetTransientPath(TEXT("encode_cache_fetched.drc"));
+  const std::string fetched_glb_file =
+      GetTransientPath(TEXT("encode_cache_fetched.glb"));
+  TestTrue(TEXT("Outputs are fetched"),
+           cache.Fetch(drc_key, fetched_drc_file) &&
+               cache.Fetch(glb_key, fetched_glb_file));
+  std::vector<char> fetched_drc;
+  std::vector<char> fetched_glb;
+  TestTrue(TEXT("Fetched outputs are read"),
+           ReadFileToBuffer(fetched_drc_file, &fetched_drc) &&
+               ReadFileToBuffer(fetched_glb_file, &fetched_glb));
+  const std::unique_ptr<Mesh> fetched_mesh =
+      UD_TestDecodeMesh(fetched_drc.data(), fetched_drc.size());
+  TestTrue(TEXT("Fetched .drc is the Draco bitstream"),
+           fetched_mesh != nullptr && UD_TestSameMesh(*fetched_mesh, *decoded));
+  auto glb_statusor =
+      UD_GlbReader().ReadFromBuffer(fetched_glb.data(), fetched_glb.size());
+  TestTrue(TEXT("Fetched .glb is the GLB file"),
+           glb_statusor.ok() &&
+               UD_TestSameMesh(*glb_statusor.value(), *decoded));
+  TestFalse(TEXT("GLB entries are not served to .drc outputs"),
+            cache.Fetch(glb_key, fetched_drc_file));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
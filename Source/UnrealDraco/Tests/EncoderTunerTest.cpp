@@ -0,0 +1,115 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "EncoderTuner.h"
+#include "GeometryTestUtils.h"
+
+namespace draco {
+
+namespace {
+
+// Returns the options the plugin encodes |mesh| with at |speed|, with
+// |search| as the parallelogram search.
+EncoderOptions CreateSearchOptions(const Mesh &mesh, int speed,
+                                   UD_ParallelogramSearch search) {
+  Encoder encoder;
+  encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(GeometryAttribute::TEX_COORD, 10);
+  encoder.SetAttributeQuantization(GeometryAttribute::NORMAL, 8);
+  encoder.SetSpeedOptions(speed, speed);
+  UD_SetParallelogramSearch(search, &encoder.options());
+  return UD_CreateExpertEncoderOptions(encoder, mesh);
+}
+
+// Encodes |mesh| with |options| and no search.
+bool EncodeWithOptions(const Mesh &mesh, const EncoderOptions &options,
+                       EncoderBuffer *out_buffer) {
+  ExpertEncoder encoder(mesh);
+  encoder.Reset(options);
+  return encoder.EncodeToBuffer(out_buffer).ok();
+}
+
+// Returns the position prediction scheme recorded in |options|.
+int GetPositionPrediction(const Mesh &mesh, const EncoderOptions &options) {
+  return options.GetAttributeInt(
+      mesh.GetNamedAttributeId(GeometryAttribute::POSITION),
+      "prediction_scheme", PREDICTION_UNDEFINED);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoParallelogramSearchTest,
+                                 "UnrealDraco.ParallelogramSearch",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoParallelogramSearchTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // 2 * 130 * 130 faces are sampled, 2 * 24 * 24 are below the sampled size.
+  for (const int grid_size : {24, 130}) {
+    const std::unique_ptr<Mesh> mesh =
+        UD_TestCreateMesh(grid_size, true, true);
+    EncoderBuffer exhaustive;
+    EncoderOptions exhaustive_options =
+        CreateSearchOptions(*mesh, 0, UD_PARALLELOGRAM_SEARCH_EXHAUSTIVE);
+    TestTrue(TEXT("Exhaustive search encodes"),
+             UD_EncodeMeshWithParallelogramSearch(*mesh, &exhaustive_options,
+                                                  &exhaustive)
+                 .ok());
+    TestEqual(TEXT("Exhaustive search records no scheme"),
+              GetPositionPrediction(*mesh, exhaustive_options),
+              static_cast<int>(PREDICTION_UNDEFINED));
+
+    for (const UD_ParallelogramSearch search :
+         {UD_PARALLELOGRAM_SEARCH_SAMPLED, UD_PARALLELOGRAM_SEARCH_SINGLE}) {
+      EncoderOptions options = CreateSearchOptions(*mesh, 0, search);
+      EncoderBuffer buffer;
+      if (!TestTrue(TEXT("Search encodes"),
+                    UD_EncodeMeshWithParallelogramSearch(*mesh, &options,
+                                                         &buffer)
+                        .ok())) {
+        return false;
+      }
+      const int prediction = GetPositionPrediction(*mesh, options);
+      if (search == UD_PARALLELOGRAM_SEARCH_SINGLE) {
+        TestEqual(TEXT("Single search records parallelogram"), prediction,
+                  static_cast<int>(MESH_PREDICTION_PARALLELOGRAM));
+      } else if (grid_size == 24) {
+        TestEqual(TEXT("Small meshes record the constrained prediction"),
+                  prediction,
+                  static_cast<int>(
+                      MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM));
+        TestTrue(TEXT("Small meshes are encoded as by Draco"),
+                 UD_TestSameBytes(buffer, exhaustive));
+      } else {
+        TestTrue(TEXT("Sampled search records a candidate"),
+                 prediction == MESH_PREDICTION_PARALLELOGRAM ||
+                     prediction ==
+                         MESH_PREDICTION_CONSTRAINED_MULTI_PARALLELOGRAM);
+      }
+
+      // The recorded options reproduce the encode without a search. Position
+      // prediction is lossless, so the encode decodes to the same mesh as
+      // Draco's own encode.
+      EncoderBuffer reencoded;
+      TestTrue(TEXT("Recorded options give the same bitstream"),
+               EncodeWithOptions(*mesh, options, &reencoded) &&
+                   UD_TestSameBytes(buffer, reencoded));
+      const std::unique_ptr<Mesh> decoded =
+          UD_TestDecodeMesh(buffer.data(), buffer.size());
+      const std::unique_ptr<Mesh> expected =
+          UD_TestDecodeMesh(exhaustive.data(), exhaustive.size());
+      TestTrue(TEXT("Encode round-trips"),
+               decoded != nullptr && expected != nullptr &&
+                   UD_TestSameMesh(*decoded, *expected));
+    }
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,188 @@
+// Copyright VJ. All Rights Reserved.
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+
+#include "draco/compression/decode.h"
+#include "draco/compression/encode.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/encoder_buffer.h"
+#include "draco/mesh/mesh.h"
+#include "draco/mesh/triangle_soup_mesh_builder.h"
+#include "draco/point_cloud/point_cloud.h"
+#include "draco/point_cloud/point_cloud_builder.h"
+
+namespace draco {
+
+// Geometry and comparisons shared by the automation tests of the plugin. The
+// tests run every reader, writer and geometry pass of the plugin next to the
+// Draco implementation it replaces on small generated geometry and require
+// the same results.
+
+// Returns a height field of |grid_size| x |grid_size| quads split into
+// triangles. It is built with TriangleSoupMeshBuilder, so corners of
+// neighboring faces share points as in decoded meshes. Coordinates are
+// multiples of 1/8 and tex coords multiples of 1/64, which "%f" prints
+// exactly. Normals are set per face and axis aligned, which splits the points
+// along the face borders.
+inline std::unique_ptr<Mesh> UD_TestCreateMesh(int grid_size, bool tex_coords,
+                                               bool normals) {
+  TriangleSoupMeshBuilder builder;
+  builder.Start(2 * grid_size * grid_size);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int tex_att_id =
+      tex_coords
+          ? builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32)
+          : -1;
+  const int norm_att_id =
+      normals ? builder.AddAttribute(GeometryAttribute::NORMAL, 3, DT_FLOAT32)
+              : -1;
+  const auto position = [](int x, int y, float *out) {
+    out[0] = 0.5f * x;
+    out[1] = 0.5f * y;
+    out[2] = 0.125f * ((x * 7 + y * 3) % 5);
+  };
+  const auto tex_coord = [](int x, int y, float *out) {
+    out[0] = x / 64.0f;
+    out[1] = y / 64.0f;
+  };
+  FaceIndex face(0);
+  for (int y = 0; y < grid_size; ++y) {
+    for (int x = 0; x < grid_size; ++x) {
+      // Two triangles per quad, with corners (x, y) (x + 1, y) (x + 1, y + 1)
+      // and (x, y) (x + 1, y + 1) (x, y + 1).
+      const int corners[2][3][2] = {{{x, y}, {x + 1, y}, {x + 1, y + 1}},
+                                    {{x, y}, {x + 1, y + 1}, {x, y + 1}}};
+      for (int t = 0; t < 2; ++t, ++face) {
+        float pos[3][3];
+        float tex[3][2];
+        for (int c = 0; c < 3; ++c) {
+          position(corners[t][c][0], corners[t][c][1], pos[c]);
+          tex_coord(corners[t][c][0], corners[t][c][1], tex[c]);
+        }
+        builder.SetAttributeValuesForFace(pos_att_id, face, pos[0], pos[1],
+                                          pos[2]);
+        if (tex_att_id >= 0) {
+          builder.SetAttributeValuesForFace(tex_att_id, face, tex[0], tex[1],
+                                            tex[2]);
+        }
+        if (norm_att_id >= 0) {
+          float normal[3] = {0.0f, 0.0f, 0.0f};
+          normal[face.value() % 3] = 1.0f;
+          builder.SetPerFaceAttributeValueForFace(norm_att_id, face, normal);
+        }
+      }
+    }
+  }
+  return builder.Finalize();
+}
+
+// Returns a point cloud of |num_points| points with a position and an RGB
+// color attribute. A quarter of the points repeat earlier positions and
+// colors, so that deduplication has work to do when |deduplicate_points| is
+// false.
+inline std::unique_ptr<PointCloud> UD_TestCreatePointCloud(
+    int num_points, bool deduplicate_points) {
+  PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int color_att_id =
+      builder.AddAttribute(GeometryAttribute::COLOR, 3, DT_UINT8);
+  const int num_unique = num_points - num_points / 4;
+  for (PointIndex p(0); p < num_points; ++p) {
+    const int i = static_cast<int>(p.value()) % num_unique;
+    const float pos[3] = {0.25f * (i % 13), 0.25f * (i % 7), 0.125f * i};
+    const uint8_t color[3] = {static_cast<uint8_t>(i * 13),
+                              static_cast<uint8_t>(i % 3 * 100),
+                              static_cast<uint8_t>(255 - i)};
+    builder.SetAttributeValueForPoint(pos_att_id, p, pos);
+    builder.SetAttributeValueForPoint(color_att_id, p, color);
+  }
+  return builder.Finalize(deduplicate_points);
+}
+
+// Returns true when |a| and |b| have the same attributes with the same values
+// in the same order and the same point to value mappings.
+inline bool UD_TestSameGeometry(const PointCloud &a, const PointCloud &b) {
+  if (a.num_points() != b.num_points() ||
+      a.num_attributes() != b.num_attributes()) {
+    return false;
+  }
+  for (int i = 0; i < a.num_attributes(); ++i) {
+    const PointAttribute *const x = a.attribute(i);
+    const PointAttribute *const y = b.attribute(i);
+    if (x->attribute_type() != y->attribute_type() ||
+        x->num_components() != y->num_components() ||
+        x->data_type() != y->data_type() ||
+        x->normalized() != y->normalized() ||
+        x->byte_stride() != y->byte_stride() || x->size() != y->size()) {
+      return false;
+    }
+    if (x->size() > 0 &&
+        memcmp(x->GetAddress(AttributeValueIndex(0)),
+               y->GetAddress(AttributeValueIndex(0)),
+               x->size() * x->byte_stride()) != 0) {
+      return false;
+    }
+    for (PointIndex p(0); p < a.num_points(); ++p) {
+      if (x->mapped_index(p) != y->mapped_index(p)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Same as UD_TestSameGeometry(), also requiring the same faces.
+inline bool UD_TestSameMesh(const Mesh &a, const Mesh &b) {
+  if (!UD_TestSameGeometry(a, b) || a.num_faces() != b.num_faces()) {
+    return false;
+  }
+  for (FaceIndex f(0); f < a.num_faces(); ++f) {
+    if (a.face(f) != b.face(f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true when |a| and |b| hold the same bytes.
+inline bool UD_TestSameBytes(const EncoderBuffer &a, const EncoderBuffer &b) {
+  return a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// Encodes |pc| with the quantization the plugin uses by default. |pc| is
+// encoded as a mesh when it has faces.
+inline bool UD_TestEncode(const PointCloud &pc, int speed,
+                          EncoderBuffer *out_buffer) {
+  Encoder encoder;
+  encoder.SetAttributeQuantization(GeometryAttribute::POSITION, 11);
+  encoder.SetAttributeQuantization(GeometryAttribute::TEX_COORD, 10);
+  encoder.SetAttributeQuantization(GeometryAttribute::NORMAL, 8);
+  encoder.SetAttributeQuantization(GeometryAttribute::COLOR, 8);
+  encoder.SetSpeedOptions(speed, speed);
+  const Mesh *const mesh = dynamic_cast<const Mesh *>(&pc);
+  if (mesh != nullptr && mesh->num_faces() > 0) {
+    return encoder.EncodeMeshToBuffer(*mesh, out_buffer).ok();
+  }
+  return encoder.EncodePointCloudToBuffer(pc, out_buffer).ok();
+}
+
+// Decodes |data| with the Draco decoder. Returns nullptr on error.
+inline std::unique_ptr<Mesh> UD_TestDecodeMesh(const char *data,
+                                               size_t data_size) {
+  DecoderBuffer buffer;
+  buffer.Init(data, data_size);
+  Decoder decoder;
+  auto statusor = decoder.DecodeMeshFromBuffer(&buffer);
+  if (!statusor.ok()) {
+    return nullptr;
+  }
+  return std::move(statusor).value();
+}
+
+}  // namespace draco
@@ -0,0 +1,84 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GeometryTestUtils.h"
+#include "ObjWriter.h"
+#include "PlyWriter.h"
+#include "draco/io/obj_decoder.h"
+#include "draco/io/obj_encoder.h"
+#include "draco/io/ply_encoder.h"
+
+namespace draco {
+
+namespace {
+
+// Returns true when ObjDecoder reads UD_ObjWriter's and ObjEncoder's files of
+// |geometry| into the same geometry. The generated values print exactly with
+// ObjEncoder's "%f", so both files hold the same numbers.
+template <typename GeometryT>
+bool WritesObjLikeObjEncoder(const GeometryT &geometry, int64_t block_size) {
+  UD_ObjWriter writer;
+  writer.set_block_size(block_size);
+  EncoderBuffer obj;
+  EncoderBuffer expected_obj;
+  if (!writer.WriteToBuffer(geometry, &obj) ||
+      !ObjEncoder().EncodeToBuffer(geometry, &expected_obj)) {
+    return false;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(obj.data(), obj.size());
+  DecoderBuffer expected_buffer;
+  expected_buffer.Init(expected_obj.data(), expected_obj.size());
+  GeometryT decoded;
+  GeometryT expected;
+  if (!ObjDecoder().DecodeFromBuffer(&buffer, &decoded).ok() ||
+      !ObjDecoder().DecodeFromBuffer(&expected_buffer, &expected).ok()) {
+    return false;
+  }
+  return UD_TestSameGeometry(decoded, expected);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoGeometryWriterTest,
+                                 "UnrealDraco.GeometryWriter",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoGeometryWriterTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, true);
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(1000, false);
+
+  TestTrue(TEXT("OBJ mesh reads like ObjEncoder's"),
+           WritesObjLikeObjEncoder(*mesh, 1 << 16));
+  TestTrue(TEXT("OBJ mesh in small blocks reads like ObjEncoder's"),
+           WritesObjLikeObjEncoder(*mesh, 7));
+  TestTrue(TEXT("OBJ point cloud reads like ObjEncoder's"),
+           WritesObjLikeObjEncoder(*pc, 7));
+
+  // UD_PlyWriter writes the same bytes as PlyEncoder.
+  UD_PlyWriter ply_writer;
+  ply_writer.set_block_size(7);
+  EncoderBuffer ply;
+  EncoderBuffer expected_ply;
+  TestTrue(TEXT("PLY mesh is written"), ply_writer.WriteToBuffer(*mesh, &ply));
+  PlyEncoder().EncodeToBuffer(*mesh, &expected_ply);
+  TestTrue(TEXT("PLY mesh has PlyEncoder's bytes"),
+           UD_TestSameBytes(ply, expected_ply));
+  ply.Clear();
+  expected_ply.Clear();
+  TestTrue(TEXT("PLY point cloud is written"),
+           ply_writer.WriteToBuffer(*pc, &ply));
+  PlyEncoder().EncodeToBuffer(*pc, &expected_ply);
+  TestTrue(TEXT("PLY point cloud has PlyEncoder's bytes"),
+           UD_TestSameBytes(ply, expected_ply));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
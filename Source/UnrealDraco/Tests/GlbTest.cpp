@@ -0,0 +1,75 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cstring>
+#include <string>
+
+#include "Misc/Paths.h"
+#include "GeometryTestUtils.h"
+#include "GlbReader.h"
+#include "GlbWriter.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoGlbTest, "UnrealDraco.Glb",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoGlbTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, true);
+  EncoderBuffer encoded;
+  TestTrue(TEXT("Mesh is encoded"), UD_TestEncode(*mesh, 5, &encoded));
+  const std::unique_ptr<Mesh> decoded =
+      UD_TestDecodeMesh(encoded.data(), encoded.size());
+  if (!TestTrue(TEXT("Mesh is decoded"), decoded != nullptr)) {
+    return false;
+  }
+
+  EncoderBuffer glb;
+  TestTrue(TEXT("GLB is written"),
+           UD_GlbWriter()
+               .WriteToBuffer(encoded.data(), encoded.size(), *decoded, &glb)
+               .ok());
+  TestTrue(TEXT("GLB header is recognized"),
+           UD_GlbReader::IsGlb(glb.data(), glb.size()));
+
+  // The bitstream is stored as is and every attribute is mapped.
+  auto primitive_statusor =
+      UD_GlbReader::FindDracoPrimitive(glb.data(), glb.size());
+  if (TestTrue(TEXT("Compressed primitive is found"),
+               primitive_statusor.ok())) {
+    const UD_GlbDracoPrimitive &primitive = primitive_statusor.value();
+    TestTrue(TEXT("Bitstream is stored unchanged"),
+             primitive.size == encoded.size() &&
+                 memcmp(primitive.data, encoded.data(), encoded.size()) == 0);
+    TestEqual(TEXT("Every attribute is mapped"),
+              static_cast<int>(primitive.attributes.size()),
+              decoded->num_attributes());
+  }
+
+  // UD_GlbReader returns the mesh the Draco decoder returns.
+  auto mesh_statusor = UD_GlbReader().ReadFromBuffer(glb.data(), glb.size());
+  TestTrue(TEXT("GLB is read"), mesh_statusor.ok());
+  if (mesh_statusor.ok()) {
+    TestTrue(TEXT("Same mesh as the Draco decoder"),
+             UD_TestSameMesh(*mesh_statusor.value(), *decoded));
+  }
+
+  // Point clouds have no GLB form.
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(1000, true);
+  EncoderBuffer encoded_pc;
+  TestTrue(TEXT("Point cloud is encoded"),
+           UD_TestEncode(*pc, 5, &encoded_pc));
+  const std::string file_name = TCHAR_TO_UTF8(
+      *FPaths::Combine(FPaths::AutomationTransientDir(),
+                       TEXT("UnrealDracoPointCloud.glb")));
+  TestFalse(TEXT("Point clouds are rejected"),
+            UD_GlbWriter()
+                .WriteToFile(encoded_pc.data(), encoded_pc.size(), file_name)
+                .ok());
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,125 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GeometryTestUtils.h"
+#include "MeshArchive.h"
+
+namespace draco {
+
+namespace {
+
+// Returns true when |geometry| is what the Draco decoder decodes from
+// |bitstream|.
+bool DecodedLikeDracoDecoder(const UD_DecodedGeometry &geometry,
+                             const EncoderBuffer &bitstream) {
+  DecoderBuffer buffer;
+  buffer.Init(bitstream.data(), bitstream.size());
+  Decoder decoder;
+  auto statusor = decoder.DecodePointCloudFromBuffer(&buffer);
+  if (!statusor.ok() || geometry.pc == nullptr) {
+    return false;
+  }
+  const Mesh *const expected_mesh =
+      dynamic_cast<const Mesh *>(statusor.value().get());
+  if ((geometry.mesh != nullptr) != (expected_mesh != nullptr)) {
+    return false;
+  }
+  return expected_mesh != nullptr
+             ? UD_TestSameMesh(*geometry.mesh, *expected_mesh)
+             : UD_TestSameGeometry(*geometry.pc, *statusor.value());
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoMeshArchiveTest,
+                                 "UnrealDraco.MeshArchive",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoMeshArchiveTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // Small props, where the archive saves most, and a point cloud.
+  std::vector<EncoderBuffer> bitstreams(9);
+  for (int i = 0; i < 8; ++i) {
+    UD_TestEncode(*UD_TestCreateMesh(2 + i, i % 2 == 0, i % 3 == 0), 5,
+                  &bitstreams[i]);
+  }
+  UD_TestEncode(*UD_TestCreatePointCloud(500, true), 5, &bitstreams[8]);
+
+  for (const bool train_symbol_model : {false, true}) {
+    UD_MeshArchiveWriter writer;
+    writer.set_train_symbol_model(train_symbol_model);
+    for (size_t i = 0; i < bitstreams.size(); ++i) {
+      TestTrue(TEXT("Member is added"),
+               writer
+                   .AddMember("member" + std::to_string(i),
+                              bitstreams[i].data(), bitstreams[i].size())
+                   .ok());
+    }
+    TestFalse(TEXT("Duplicate names are rejected"),
+              writer
+                  .AddMember("member0", bitstreams[0].data(),
+                             bitstreams[0].size())
+                  .ok());
+    EncoderBuffer archive;
+    writer.WriteToBuffer(&archive);
+
+    std::unique_ptr<UD_MeshArchiveReader> reader =
+        UD_MeshArchiveReader::OpenBuffer(archive.data(), archive.size());
+    if (!TestTrue(TEXT("Archive is opened"), reader != nullptr)) {
+      return false;
+    }
+    TestEqual(TEXT("Every member is listed"), reader->num_members(),
+              static_cast<int>(bitstreams.size()));
+    TestEqual(TEXT("Unknown members are not found"),
+              reader->FindMember("missing"), -1);
+
+    int num_coded = 0;
+    std::vector<int> indices;
+    for (size_t i = 0; i < bitstreams.size(); ++i) {
+      const int index = reader->FindMember("member" + std::to_string(i));
+      if (!TestTrue(TEXT("Member is found"), index >= 0)) {
+        continue;
+      }
+      indices.push_back(index);
+      if (reader->member_coded(index)) {
+        ++num_coded;
+      }
+      std::vector<char> bitstream;
+      TestTrue(TEXT("Member bitstream is read back unchanged"),
+               reader->ReadMemberBitstream(index, &bitstream).ok() &&
+                   bitstream.size() == bitstreams[i].size() &&
+                   memcmp(bitstream.data(), bitstreams[i].data(),
+                          bitstream.size()) == 0);
+      auto statusor = reader->DecodeMember(index);
+      TestTrue(TEXT("Member decodes like the Draco decoder"),
+               statusor.ok() &&
+                   DecodedLikeDracoDecoder(statusor.value(), bitstreams[i]));
+    }
+    if (train_symbol_model) {
+      TestTrue(TEXT("Members are coded with the symbol model"), num_coded > 0);
+    } else {
+      TestEqual(TEXT("Members are stored as is"), num_coded, 0);
+    }
+
+    std::vector<UD_DecodedGeometry> geometry;
+    TestTrue(TEXT("Members are decoded in parallel"),
+             reader->DecodeMembers(indices, &geometry).ok());
+    for (size_t i = 0; i < geometry.size(); ++i) {
+      TestTrue(TEXT("Parallel decode is the same"),
+               DecodedLikeDracoDecoder(geometry[i], bitstreams[i]));
+    }
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,98 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <string>
+
+#include "GeometryTestUtils.h"
+#include "ObjReader.h"
+#include "draco/io/obj_decoder.h"
+#include "draco/io/obj_encoder.h"
+
+namespace draco {
+
+namespace {
+
+// Statements ObjEncoder never writes: quads, negative indices, comments and
+// blank lines.
+constexpr char kQuadsObj[] =
+    "# Quads and negative indices.\n"
+    "v 0 0 0\n"
+    "v 1 0 0\n"
+    "v 1 1 0\n"
+    "v 0 1 0\n"
+    "v 0.5 0.5 1\n"
+    "\n"
+    "vt 0 0\n"
+    "vt 1 0\n"
+    "vt 1 1\n"
+    "vt 0 1\n"
+    "vn 0 0 1\n"
+    "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+    "f -5/-4/-1 -4/-3/-1 -1/-1/-1\n";
+
+constexpr char kMalformedObj[] =
+    "v 0 0 0\n"
+    "v 1 0 0\n"
+    "v 0 1 0\n"
+    "f 1 2 x\n";
+
+// Returns true when UD_ObjReader reads |text| into the same mesh as
+// ObjDecoder.
+bool ReadsLikeObjDecoder(const std::string &text, size_t chunk_size,
+                         bool deduplicate_input_values) {
+  UD_ObjReader reader;
+  reader.set_chunk_size(chunk_size);
+  reader.set_deduplicate_input_values(deduplicate_input_values);
+  auto statusor = reader.ReadFromBuffer(text.data(), text.size());
+  if (!statusor.ok()) {
+    return false;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(text.data(), text.size());
+  ObjDecoder decoder;
+  decoder.set_deduplicate_input_values(deduplicate_input_values);
+  Mesh expected;
+  if (!decoder.DecodeFromBuffer(&buffer, &expected).ok()) {
+    return false;
+  }
+  return UD_TestSameMesh(*statusor.value(), expected);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoObjReaderTest,
+                                 "UnrealDraco.ObjReader",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoObjReaderTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, true);
+  EncoderBuffer obj;
+  TestTrue(TEXT("ObjEncoder writes the mesh"),
+           ObjEncoder().EncodeToBuffer(*mesh, &obj));
+  const std::string text(obj.data(), obj.size());
+  // The default chunk size reads the text as one range, 64 bytes splits it
+  // into hundreds.
+  TestTrue(TEXT("Same mesh as ObjDecoder"),
+           ReadsLikeObjDecoder(text, 1 << 20, true));
+  TestTrue(TEXT("Same mesh as ObjDecoder in small chunks"),
+           ReadsLikeObjDecoder(text, 64, true));
+  TestTrue(TEXT("Same mesh as ObjDecoder without deduplication"),
+           ReadsLikeObjDecoder(text, 64, false));
+  TestTrue(TEXT("Same quads as ObjDecoder"),
+           ReadsLikeObjDecoder(kQuadsObj, 16, true));
+
+  UD_ObjReader reader;
+  TestFalse(TEXT("Malformed faces are rejected"),
+            reader.ReadFromBuffer(kMalformedObj, sizeof(kMalformedObj) - 1)
+                .ok());
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,133 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "OctahedronBulk.h"
+
+namespace draco {
+
+namespace {
+
+// Not a multiple of the block size of the bulk conversions, so that the
+// remainder path is covered as well.
+constexpr int kNumOctahedronValues = 1003;
+
+// Returns a value in [min_value, max_value].
+int32_t NextOctahedronTestInt(std::mt19937 *random, int32_t min_value,
+                              int32_t max_value) {
+  return std::uniform_int_distribution<int32_t>(min_value, max_value)(*random);
+}
+
+// Returns vectors in every octant with lengths other than one, including
+// the zero vector and the axes.
+std::vector<float> CreateOctahedronTestVectors() {
+  std::vector<float> vectors = {
+      0.0f, 0.0f, 0.0f,   //
+      1.0f, 0.0f, 0.0f,   //
+      0.0f, -1.0f, 0.0f,  //
+      0.0f, 0.0f, 2.0f,   //
+      -1.0f, -1.0f, -1.0f};
+  std::mt19937 random(12345);
+  std::uniform_real_distribution<float> component(-2.0f, 2.0f);
+  while (vectors.size() < 3 * kNumOctahedronValues) {
+    vectors.push_back(component(random));
+  }
+  return vectors;
+}
+
+template <typename T>
+bool SameValues(const std::vector<T> &a, const std::vector<T> &b) {
+  return a.size() == b.size() &&
+         memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoOctahedronBulkTest,
+                                 "UnrealDraco.OctahedronBulk",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoOctahedronBulkTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::vector<float> vectors = CreateOctahedronTestVectors();
+  const int n = kNumOctahedronValues;
+  for (const int bits : {2, 3, 7, 8, 10, 12, 16, 20, 24, 30}) {
+    OctahedronToolBox tool_box;
+    if (!TestTrue(TEXT("Tool box is initialized"),
+                  tool_box.SetQuantizationBits(bits))) {
+      return false;
+    }
+    std::mt19937 random(bits);
+
+    // Float vectors to quantized coords.
+    std::vector<int32_t> coords(2 * n);
+    std::vector<int32_t> expected_coords(2 * n);
+    UD_FloatVectorsToQuantizedOctahedralCoords(tool_box, vectors.data(), n,
+                                               coords.data());
+    for (int i = 0; i < n; ++i) {
+      tool_box.FloatVectorToQuantizedOctahedralCoords(
+          &vectors[3 * i], &expected_coords[2 * i],
+          &expected_coords[2 * i + 1]);
+    }
+    TestTrue(TEXT("Quantized coords match the tool box"),
+             SameValues(coords, expected_coords));
+
+    // Quantized coords to unit vectors, both for the coords of the vectors
+    // and for any coords in range.
+    for (int i = n; i < 2 * n; ++i) {
+      coords[i] =
+          NextOctahedronTestInt(&random, 0, tool_box.max_quantized_value());
+    }
+    std::vector<float> unit_vectors(3 * n);
+    std::vector<float> expected_unit_vectors(3 * n);
+    UD_QuantizedOctahedralCoordsToUnitVectors(tool_box, coords.data(), n,
+                                              unit_vectors.data());
+    for (int i = 0; i < n; ++i) {
+      tool_box.QuantizedOctaherdalCoordsToUnitVector(
+          coords[2 * i], coords[2 * i + 1], &expected_unit_vectors[3 * i]);
+    }
+    TestTrue(TEXT("Unit vectors match the tool box"),
+             SameValues(unit_vectors, expected_unit_vectors));
+
+    // Canonicalization of coords in [0, max_value].
+    for (int i = 0; i < 2 * n; ++i) {
+      coords[i] = NextOctahedronTestInt(&random, 0, tool_box.max_value());
+    }
+    coords[0] = 0;
+    coords[1] = tool_box.max_value();
+    for (int i = 0; i < n; ++i) {
+      tool_box.CanonicalizeOctahedralCoords(coords[2 * i], coords[2 * i + 1],
+                                            &expected_coords[2 * i],
+                                            &expected_coords[2 * i + 1]);
+    }
+    UD_CanonicalizeOctahedralCoords(tool_box, coords.data(), n);
+    TestTrue(TEXT("Canonical coords match the tool box"),
+             SameValues(coords, expected_coords));
+
+    // Diamond inversion of coords centered at the origin.
+    const int32_t center = tool_box.center_value();
+    for (int i = 0; i < 2 * n; ++i) {
+      coords[i] = NextOctahedronTestInt(&random, -center, center);
+    }
+    expected_coords = coords;
+    for (int i = 0; i < n; ++i) {
+      tool_box.InvertDiamond(&expected_coords[2 * i],
+                             &expected_coords[2 * i + 1]);
+    }
+    UD_InvertDiamonds(tool_box, coords.data(), n);
+    TestTrue(TEXT("Inverted diamonds match the tool box"),
+             SameValues(coords, expected_coords));
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
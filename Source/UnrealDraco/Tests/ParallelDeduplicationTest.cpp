@@ -0,0 +1,126 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GeometryTestUtils.h"
+#include "ParallelDeduplication.h"
+
+namespace draco {
+
+namespace {
+
+// Returns a copy of |mesh| with a point and attribute values of its own for
+// every corner, as a triangle soup before deduplication.
+std::unique_ptr<Mesh> CreateCornerMesh(const Mesh &mesh) {
+  std::unique_ptr<Mesh> soup(new Mesh());
+  const uint32_t num_corners = 3 * mesh.num_faces();
+  soup->set_num_points(num_corners);
+  for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+    const uint32_t first = 3 * f.value();
+    soup->AddFace({{PointIndex(first), PointIndex(first + 1),
+                    PointIndex(first + 2)}});
+  }
+  for (int i = 0; i < mesh.num_attributes(); ++i) {
+    const PointAttribute *const src = mesh.attribute(i);
+    GeometryAttribute att;
+    att.Init(src->attribute_type(), nullptr, src->num_components(),
+             src->data_type(), src->normalized(), src->byte_stride(), 0);
+    PointAttribute *const dst =
+        soup->attribute(soup->AddAttribute(att, true, num_corners));
+    for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+      for (int c = 0; c < 3; ++c) {
+        dst->SetAttributeValue(
+            AttributeValueIndex(3 * f.value() + c),
+            src->GetAddress(src->mapped_index(mesh.face(f)[c])));
+      }
+    }
+  }
+  return soup;
+}
+
+// Returns a point cloud of every combination of |num_values| positions and
+// |num_values| colors, twice. Each position is shared by |num_values|
+// different points.
+std::unique_ptr<PointCloud> CreateCombinationPointCloud(int num_values) {
+  const int num_points = 2 * num_values * num_values;
+  PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int color_att_id =
+      builder.AddAttribute(GeometryAttribute::COLOR, 3, DT_UINT8);
+  for (PointIndex p(0); p < num_points; ++p) {
+    const int combination = p.value() % (num_values * num_values);
+    const float pos[3] = {static_cast<float>(combination / num_values), 0.0f,
+                          1.0f};
+    const uint8_t color[3] = {static_cast<uint8_t>(combination % num_values),
+                              0, 255};
+    builder.SetAttributeValueForPoint(pos_att_id, p, pos);
+    builder.SetAttributeValueForPoint(color_att_id, p, color);
+  }
+  return builder.Finalize(false);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoParallelDeduplicationTest,
+                                 "UnrealDraco.ParallelDeduplication",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoParallelDeduplicationTest::RunTest(
+    const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<Mesh> source = UD_TestCreateMesh(64, true, true);
+  const std::unique_ptr<Mesh> mesh = CreateCornerMesh(*source);
+  const std::unique_ptr<Mesh> expected = CreateCornerMesh(*source);
+
+  // Single attributes return the number of unique values.
+  TestEqual(TEXT("Same number of unique positions as Draco"),
+            static_cast<int>(UD_DeduplicateValues(mesh->attribute(0))),
+            static_cast<int>(
+                expected->attribute(0)->DeduplicateValues(
+                    *expected->attribute(0))));
+
+  TestTrue(TEXT("Mesh values are deduplicated"),
+           UD_DeduplicateAttributeValues(mesh.get()));
+  expected->DeduplicateAttributeValues();
+  TestTrue(TEXT("Same mesh values as Draco"),
+           UD_TestSameMesh(*mesh, *expected));
+  UD_DeduplicatePointIds(mesh.get(), mesh.get());
+  expected->DeduplicatePointIds();
+  TestTrue(TEXT("Same mesh points as Draco"),
+           UD_TestSameMesh(*mesh, *expected));
+
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(5000, false);
+  const std::unique_ptr<PointCloud> expected_pc =
+      UD_TestCreatePointCloud(5000, false);
+  TestTrue(TEXT("Point cloud values are deduplicated"),
+           UD_DeduplicateAttributeValues(pc.get()));
+  UD_DeduplicatePointIds(pc.get(), nullptr);
+  expected_pc->DeduplicateAttributeValues();
+  expected_pc->DeduplicatePointIds();
+  TestTrue(TEXT("Same point cloud as Draco"),
+           UD_TestSameGeometry(*pc, *expected_pc));
+
+  // Points sharing their values with many others are matched by Draco.
+  const std::unique_ptr<PointCloud> combinations =
+      CreateCombinationPointCloud(64);
+  const std::unique_ptr<PointCloud> expected_combinations =
+      CreateCombinationPointCloud(64);
+  UD_DeduplicateAttributeValues(combinations.get());
+  UD_DeduplicatePointIds(combinations.get(), nullptr);
+  expected_combinations->DeduplicateAttributeValues();
+  expected_combinations->DeduplicatePointIds();
+  TestEqual(TEXT("Combinations are merged"),
+            static_cast<int>(combinations->num_points()), 64 * 64);
+  TestTrue(TEXT("Same combinations as Draco"),
+           UD_TestSameGeometry(*combinations, *expected_combinations));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,80 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GeometryTestUtils.h"
+#include "ParallelMeshCleanup.h"
+#include "draco/mesh/mesh_cleanup.h"
+
+namespace draco {
+
+namespace {
+
+// Returns a strip of |num_faces| triangles in which one face out of every
+// |degenerate_every| has two corners at the same position. Those faces are
+// placed apart with tex coords of their own, so that removing them leaves
+// points and values of every attribute unused. Attributes keeping all their
+// values while points are removed are the one case where UD_CleanupMesh()
+// differs from Draco 1.3.6 on purpose.
+std::unique_ptr<Mesh> CreateMeshWithDegenerateFaces(int num_faces,
+                                                    int degenerate_every) {
+  TriangleSoupMeshBuilder builder;
+  builder.Start(num_faces);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int tex_att_id =
+      builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32);
+  for (FaceIndex f(0); f < num_faces; ++f) {
+    const float x = 0.5f * f.value();
+    float pos[3][3] = {{x, 0.0f, 0.0f}, {x + 0.5f, 0.0f, 0.0f},
+                       {x, 1.0f, 0.0f}};
+    float tex[3][2] = {{x, 0.0f}, {x + 0.5f, 0.0f}, {x, 1.0f}};
+    if (f.value() % degenerate_every == 0) {
+      for (int c = 0; c < 3; ++c) {
+        pos[c][2] = 100.0f;
+        tex[c][1] += 100.0f + c;
+      }
+      pos[1][0] = pos[0][0];
+    }
+    builder.SetAttributeValuesForFace(pos_att_id, f, pos[0], pos[1], pos[2]);
+    builder.SetAttributeValuesForFace(tex_att_id, f, tex[0], tex[1], tex[2]);
+  }
+  return builder.Finalize();
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoParallelMeshCleanupTest,
+                                 "UnrealDraco.ParallelMeshCleanup",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoParallelMeshCleanupTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  for (const bool remove_unused_attributes : {true, false}) {
+    MeshCleanupOptions options;
+    options.remove_unused_attributes = remove_unused_attributes;
+    const std::unique_ptr<Mesh> mesh =
+        CreateMeshWithDegenerateFaces(50000, 7);
+    const std::unique_ptr<Mesh> expected =
+        CreateMeshWithDegenerateFaces(50000, 7);
+    TestTrue(TEXT("Mesh is cleaned up"), UD_CleanupMesh(mesh.get(), options));
+    MeshCleanup()(expected.get(), options);
+    TestTrue(TEXT("Degenerate faces are removed"),
+             mesh->num_faces() < 50000);
+    TestTrue(TEXT("Same mesh as MeshCleanup"),
+             UD_TestSameMesh(*mesh, *expected));
+  }
+
+  // The position attribute is required.
+  Mesh empty_mesh;
+  TestFalse(TEXT("Meshes without positions are rejected"),
+            UD_CleanupMesh(&empty_mesh, MeshCleanupOptions()));
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,102 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "GeometryTestUtils.h"
+#include "ParallelMeshStripifier.h"
+#include "draco/mesh/mesh_stripifier.h"
+
+namespace draco {
+
+namespace {
+
+constexpr uint32_t kRestartIndex = std::numeric_limits<uint32_t>::max();
+
+typedef std::array<uint32_t, 3> Triangle;
+
+// Returns the triangles of |mesh| with their point ids sorted, in sorted
+// order, so that faces compare regardless of winding and order.
+std::vector<Triangle> SortedFaces(const Mesh &mesh) {
+  std::vector<Triangle> triangles;
+  for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+    const Mesh::Face &face = mesh.face(f);
+    Triangle triangle = {face[0].value(), face[1].value(), face[2].value()};
+    std::sort(triangle.begin(), triangle.end());
+    triangles.push_back(triangle);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+// Same for the triangles of strips separated by kRestartIndex.
+std::vector<Triangle> SortedStripTriangles(
+    const std::vector<uint32_t> &indices) {
+  std::vector<Triangle> triangles;
+  size_t strip_start = 0;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (indices[i] == kRestartIndex) {
+      strip_start = i + 1;
+    } else if (i >= strip_start + 2) {
+      Triangle triangle = {indices[i - 2], indices[i - 1], indices[i]};
+      std::sort(triangle.begin(), triangle.end());
+      triangles.push_back(triangle);
+    }
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoParallelMeshStripifierTest,
+                                 "UnrealDraco.ParallelMeshStripifier",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoParallelMeshStripifierTest::RunTest(
+    const FString &Parameters) {
+  using namespace draco;
+  // Without normals the points are shared wherever the positions are, so
+  // the point ids connect the same faces as MeshStripifier's corner table.
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, true, false);
+  UD_ParallelMeshStripifier stripifier;
+  std::vector<uint32_t> indices;
+  TestTrue(TEXT("Mesh is stripified"),
+           stripifier.GenerateTriangleStripsWithPrimitiveRestart(
+               *mesh, kRestartIndex, &indices));
+  std::vector<uint32_t> expected;
+  MeshStripifier().GenerateTriangleStripsWithPrimitiveRestart(
+      *mesh, kRestartIndex, std::back_inserter(expected));
+  TestEqual(TEXT("Small meshes are a single region"), stripifier.num_regions(),
+            1);
+  TestTrue(TEXT("Single regions have MeshStripifier's strips"),
+           indices == expected);
+
+  // Larger meshes are split into regions, whose strips still cover every
+  // face exactly once.
+  const std::unique_ptr<Mesh> large_mesh = UD_TestCreateMesh(128, true, true);
+  TestTrue(TEXT("Large mesh is stripified"),
+           stripifier.GenerateTriangleStripsWithPrimitiveRestart(
+               *large_mesh, kRestartIndex, &indices));
+  TestTrue(TEXT("Large meshes are split into regions"),
+           stripifier.num_regions() > 1);
+  TestTrue(TEXT("Strips cover every face once"),
+           SortedStripTriangles(indices) == SortedFaces(*large_mesh));
+  TestEqual(TEXT("Every strip is counted"), stripifier.num_strips(),
+            static_cast<int>(std::count(indices.begin(), indices.end(),
+                                        kRestartIndex)) +
+                1);
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,105 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GeometryTestUtils.h"
+#include "PlyReader.h"
+#include "draco/io/ply_decoder.h"
+#include "draco/io/ply_encoder.h"
+
+namespace draco {
+
+namespace {
+
+// UD_PlyReader leaves ASCII files to PlyDecoder.
+constexpr char kAsciiPly[] =
+    "ply\n"
+    "format ascii 1.0\n"
+    "element vertex 3\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "element face 1\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n"
+    "0 0 0\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "3 0 1 2\n";
+
+// Returns true when UD_PlyReader reads |ply| into the same mesh as
+// PlyDecoder.
+bool ReadsMeshLikePlyDecoder(const EncoderBuffer &ply, int64_t block_size) {
+  UD_PlyReader reader;
+  reader.set_block_size(block_size);
+  Mesh mesh;
+  if (!reader.ReadFromBuffer(ply.data(), ply.size(), &mesh, &mesh).ok()) {
+    return false;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(ply.data(), ply.size());
+  Mesh expected;
+  if (!PlyDecoder().DecodeFromBuffer(&buffer, &expected).ok()) {
+    return false;
+  }
+  return UD_TestSameMesh(mesh, expected);
+}
+
+// Same for point clouds.
+bool ReadsPointCloudLikePlyDecoder(const EncoderBuffer &ply,
+                                   int64_t block_size) {
+  UD_PlyReader reader;
+  reader.set_block_size(block_size);
+  PointCloud pc;
+  if (!reader.ReadFromBuffer(ply.data(), ply.size(), &pc, nullptr).ok()) {
+    return false;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(ply.data(), ply.size());
+  PointCloud expected;
+  if (!PlyDecoder().DecodeFromBuffer(&buffer, &expected).ok()) {
+    return false;
+  }
+  return UD_TestSameGeometry(pc, expected);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoPlyReaderTest,
+                                 "UnrealDraco.PlyReader",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoPlyReaderTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // PlyEncoder writes binary little-endian files.
+  const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(24, false, true);
+  EncoderBuffer mesh_ply;
+  TestTrue(TEXT("PlyEncoder writes the mesh"),
+           PlyEncoder().EncodeToBuffer(*mesh, &mesh_ply));
+  TestTrue(TEXT("Same mesh as PlyDecoder"),
+           ReadsMeshLikePlyDecoder(mesh_ply, 1 << 16));
+  TestTrue(TEXT("Same mesh as PlyDecoder in small blocks"),
+           ReadsMeshLikePlyDecoder(mesh_ply, 7));
+
+  const std::unique_ptr<PointCloud> pc = UD_TestCreatePointCloud(1000, false);
+  EncoderBuffer pc_ply;
+  TestTrue(TEXT("PlyEncoder writes the point cloud"),
+           PlyEncoder().EncodeToBuffer(*pc, &pc_ply));
+  TestTrue(TEXT("Same point cloud as PlyDecoder"),
+           ReadsPointCloudLikePlyDecoder(pc_ply, 7));
+
+  Mesh ascii_mesh;
+  TestFalse(TEXT("ASCII files are left to PlyDecoder"),
+            UD_PlyReader()
+                .ReadFromBuffer(kAsciiPly, sizeof(kAsciiPly) - 1, &ascii_mesh,
+                                &ascii_mesh)
+                .ok());
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,154 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeometryTestUtils.h"
+#include "QuantizationTuner.h"
+
+namespace draco {
+
+namespace {
+
+// Returns a point cloud of |num_points| points with positions, tex coords
+// and normals spread over irregular values, so that every bit count has a
+// different error.
+std::unique_ptr<PointCloud> CreateTuningPointCloud(int num_points) {
+  PointCloudBuilder builder;
+  builder.Start(num_points);
+  const int pos_att_id =
+      builder.AddAttribute(GeometryAttribute::POSITION, 3, DT_FLOAT32);
+  const int tex_att_id =
+      builder.AddAttribute(GeometryAttribute::TEX_COORD, 2, DT_FLOAT32);
+  const int norm_att_id =
+      builder.AddAttribute(GeometryAttribute::NORMAL, 3, DT_FLOAT32);
+  for (PointIndex p(0); p < num_points; ++p) {
+    const float i = static_cast<float>(p.value());
+    const float pos[3] = {10.0f * std::sin(0.37f * i),
+                          3.0f * std::cos(0.11f * i), 0.013f * i};
+    const float tex[2] = {0.618f * i - std::floor(0.618f * i),
+                          0.414f * i - std::floor(0.414f * i)};
+    float normal[3] = {std::sin(i), std::cos(1.7f * i),
+                       0.3f + std::sin(0.5f * i)};
+    const float length = std::sqrt(normal[0] * normal[0] +
+                                   normal[1] * normal[1] +
+                                   normal[2] * normal[2]);
+    for (float &value : normal) {
+      value /= length;
+    }
+    builder.SetAttributeValueForPoint(pos_att_id, p, pos);
+    builder.SetAttributeValueForPoint(tex_att_id, p, tex);
+    builder.SetAttributeValueForPoint(norm_att_id, p, normal);
+  }
+  return builder.Finalize(false);
+}
+
+// Encodes |pc| with Draco, quantizing attributes of |type| with |bits|, and
+// returns the largest error of its decoded values of |type|: the euclidean
+// distance, or the angle in degrees for normals. The sequential encoding
+// keeps the point order. Returns a negative value on error.
+double MeasureDracoError(const PointCloud &pc, GeometryAttribute::Type type,
+                         int bits) {
+  Encoder encoder;
+  encoder.SetEncodingMethod(POINT_CLOUD_SEQUENTIAL_ENCODING);
+  encoder.SetAttributeQuantization(type, bits);
+  EncoderBuffer buffer;
+  if (!encoder.EncodePointCloudToBuffer(pc, &buffer).ok()) {
+    return -1.0;
+  }
+  DecoderBuffer decoder_buffer;
+  decoder_buffer.Init(buffer.data(), buffer.size());
+  Decoder decoder;
+  auto statusor = decoder.DecodePointCloudFromBuffer(&decoder_buffer);
+  if (!statusor.ok() ||
+      statusor.value()->num_points() != pc.num_points()) {
+    return -1.0;
+  }
+  const PointAttribute *const src = pc.GetNamedAttribute(type);
+  const PointAttribute *const dst = statusor.value()->GetNamedAttribute(type);
+  const double rad_to_deg = 180.0 / 3.14159265358979323846;
+  double max_error = 0.0;
+  for (PointIndex p(0); p < pc.num_points(); ++p) {
+    float original[3] = {0.0f, 0.0f, 0.0f};
+    float decoded[3] = {0.0f, 0.0f, 0.0f};
+    src->GetMappedValue(p, original);
+    dst->GetMappedValue(p, decoded);
+    double error = 0.0;
+    if (type == GeometryAttribute::NORMAL) {
+      const double length =
+          std::sqrt(static_cast<double>(original[0]) * original[0] +
+                    static_cast<double>(original[1]) * original[1] +
+                    static_cast<double>(original[2]) * original[2]);
+      const double cos_angle =
+          (original[0] * decoded[0] + original[1] * decoded[1] +
+           original[2] * decoded[2]) /
+          length;
+      error = std::acos(std::max(-1.0, std::min(1.0, cos_angle))) *
+              rad_to_deg;
+    } else {
+      double squared_distance = 0.0;
+      for (int c = 0; c < src->num_components(); ++c) {
+        const double diff = static_cast<double>(original[c]) - decoded[c];
+        squared_distance += diff * diff;
+      }
+      error = std::sqrt(squared_distance);
+    }
+    max_error = std::max(max_error, error);
+  }
+  return max_error;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoQuantizationTunerTest,
+                                 "UnrealDraco.QuantizationTuner",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoQuantizationTunerTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::unique_ptr<PointCloud> pc = CreateTuningPointCloud(2000);
+  const UD_QuantizationTuner tuner(UD_MAX_ERROR);
+  const struct {
+    GeometryAttribute::Type type;
+    float tolerance;
+  } cases[] = {{GeometryAttribute::POSITION, 0.01f},
+               {GeometryAttribute::TEX_COORD, 0.001f},
+               {GeometryAttribute::NORMAL, 1.0f}};
+  for (const auto &test_case : cases) {
+    const PointAttribute &att = *pc->GetNamedAttribute(test_case.type);
+    const int bits = tuner.FindMinimalBits(att, test_case.tolerance);
+    if (!TestTrue(TEXT("Bits are found"), bits > 2 && bits < 24)) {
+      return false;
+    }
+    // The predicted errors are the ones of Draco's own encode and decode.
+    for (const int b : {bits - 1, bits, bits + 1}) {
+      const double draco_error = MeasureDracoError(*pc, test_case.type, b);
+      TestTrue(TEXT("Draco encodes and decodes"), draco_error >= 0.0);
+      TestTrue(TEXT("Predicted error is Draco's"),
+               std::abs(tuner.ComputeError(att, b) - draco_error) <= 1e-6);
+    }
+    TestTrue(TEXT("Draco stays within the tolerance"),
+             MeasureDracoError(*pc, test_case.type, bits) <=
+                 test_case.tolerance);
+    TestTrue(TEXT("One bit less exceeds the tolerance"),
+             MeasureDracoError(*pc, test_case.type, bits - 1) >
+                 test_case.tolerance);
+  }
+
+  TestEqual(TEXT("Integer attributes are not tuned"),
+            tuner.FindMinimalBits(
+                *UD_TestCreatePointCloud(16, false)->GetNamedAttribute(
+                    GeometryAttribute::COLOR),
+                1.0f),
+            -1);
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
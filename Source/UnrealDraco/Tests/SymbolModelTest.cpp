@@ -0,0 +1,226 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "DecodeProfiler.h"
+#include "SymbolModel.h"
+#include "draco/compression/entropy/symbol_encoding.h"
+#include "draco/core/decoder_buffer.h"
+#include "draco/core/encoder_buffer.h"
+
+namespace draco {
+
+namespace {
+
+// Id of the model the tests register. Registered models are never removed,
+// so later runs find the model of the first one.
+constexpr uint32_t kTestModelId = 0x55445401;
+
+// Returns |num_values| deterministic symbols in [0, num_symbols), mostly
+// small ones as in Draco's prediction residuals.
+std::vector<uint32_t> GenerateSymbols(int num_values, uint32_t num_symbols,
+                                      uint32_t seed) {
+  std::vector<uint32_t> symbols(num_values);
+  uint32_t state = seed;
+  for (uint32_t &symbol : symbols) {
+    state = state * 1664525u + 1013904223u;
+    // Squaring a uniform 24-bit value skews it towards 0.
+    const uint64_t r = state >> 8;
+    symbol = static_cast<uint32_t>(((r * r) >> 32) * num_symbols >> 16);
+  }
+  return symbols;
+}
+
+// Codes |symbols| with UD_EncodeSymbols() into |out_buffer| and returns true
+// when UD_DecodeSymbols() decodes them back.
+bool RoundTripsSymbols(const std::vector<uint32_t> &symbols,
+                       int num_components, const UD_SymbolModel *model,
+                       EncoderBuffer *out_buffer) {
+  const int num_values = static_cast<int>(symbols.size());
+  if (!UD_EncodeSymbols(symbols.data(), num_values, num_components, model,
+                        nullptr, out_buffer)) {
+    return false;
+  }
+  DecoderBuffer buffer;
+  buffer.Init(out_buffer->data(), out_buffer->size());
+  std::vector<uint32_t> decoded(symbols.size());
+  if (!UD_DecodeSymbols(num_values, num_components, &buffer, decoded.data())) {
+    return false;
+  }
+  return decoded == symbols && buffer.remaining_size() == 0;
+}
+
+// Returns the stream EncodeSymbols() writes for |symbols|.
+EncoderBuffer EncodeWithDraco(const std::vector<uint32_t> &symbols,
+                              int num_components) {
+  EncoderBuffer buffer;
+  EncodeSymbols(symbols.data(), static_cast<int>(symbols.size()),
+                num_components, nullptr, &buffer);
+  return buffer;
+}
+
+// Returns the model registered under kTestModelId, trained on |symbols| by
+// the first call.
+const UD_SymbolModel *GetTestModel(const std::vector<uint32_t> &symbols) {
+  UD_SymbolModelRegistry &registry = UD_SymbolModelRegistry::Get();
+  if (registry.Find(kTestModelId) == nullptr) {
+    std::vector<uint64_t> frequencies;
+    UD_SymbolModel::AccumulateFrequencies(
+        symbols.data(), static_cast<int>(symbols.size()), &frequencies);
+    registry.Register(UD_SymbolModel::Train(
+        kTestModelId, frequencies.data(),
+        static_cast<int>(frequencies.size())));
+  }
+  return registry.Find(kTestModelId);
+}
+
+// Decodes |num_values| symbols of one component from |stream|, adding the
+// table statistics to |stats|.
+bool DecodeSymbolsWithStats(const EncoderBuffer &stream, int num_values,
+                            UD_DecodeStats *stats) {
+  DecoderBuffer buffer;
+  buffer.Init(stream.data(), stream.size());
+  std::vector<uint32_t> decoded(num_values);
+  return UD_DecodeSymbols(num_values, 1, &buffer, decoded.data(), stats);
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoSymbolModelTest,
+                                 "UnrealDraco.SymbolModel",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoSymbolModelTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::vector<uint32_t> symbols = GenerateSymbols(4096, 16, 1);
+  const UD_SymbolModel *const model = GetTestModel(symbols);
+  if (!TestTrue(TEXT("Model is registered"), model != nullptr)) {
+    return false;
+  }
+
+  // Serialized models read back with the same probabilities.
+  EncoderBuffer model_buffer;
+  model->Encode(&model_buffer);
+  DecoderBuffer model_decoder_buffer;
+  model_decoder_buffer.Init(model_buffer.data(), model_buffer.size());
+  const std::unique_ptr<UD_SymbolModel> decoded_model =
+      UD_SymbolModel::Decode(&model_decoder_buffer);
+  bool same_model = decoded_model != nullptr &&
+                    decoded_model->id() == model->id() &&
+                    decoded_model->num_symbols() == model->num_symbols();
+  for (int i = 0; same_model && i < model->num_symbols(); ++i) {
+    same_model = decoded_model->probability(i).prob ==
+                     model->probability(i).prob &&
+                 decoded_model->probability(i).cum_prob ==
+                     model->probability(i).cum_prob;
+  }
+  TestTrue(TEXT("Model is serialized"), same_model);
+
+  // Streams coded with the model carry no table and are smaller than Draco's.
+  EncoderBuffer model_stream;
+  TestTrue(TEXT("Symbols round trip with the model"),
+           RoundTripsSymbols(symbols, 1, model, &model_stream));
+  TestTrue(TEXT("Model stream is smaller than Draco's"),
+           model_stream.size() < EncodeWithDraco(symbols, 1).size());
+
+  // Symbols outside of the model fall back to a per-stream table.
+  EncoderBuffer table_stream;
+  TestTrue(TEXT("Symbols outside of the model round trip"),
+           RoundTripsSymbols(GenerateSymbols(4096, 200, 2), 1, model,
+                             &table_stream));
+
+  // Large alphabets are coded by EncodeSymbols() after a method byte.
+  const std::vector<uint32_t> large_symbols =
+      GenerateSymbols(6000, 1 << 18, 3);
+  EncoderBuffer draco_stream;
+  TestTrue(TEXT("Large alphabets round trip"),
+           RoundTripsSymbols(large_symbols, 3, nullptr, &draco_stream));
+  const EncoderBuffer expected = EncodeWithDraco(large_symbols, 3);
+  TestTrue(TEXT("Large alphabets are coded like EncodeSymbols()"),
+           draco_stream.size() == expected.size() + 1 &&
+               memcmp(draco_stream.data() + 1, expected.data(),
+                      expected.size()) == 0);
+
+  // Every coding method with different sizes, alphabets and components.
+  int num_failed = 0;
+  uint32_t seed = 4;
+  for (const int num_values : {3, 99, 6000}) {
+    for (const uint32_t num_symbols : {1u, 2u, 16u, 256u, 300u, 70000u}) {
+      for (const int num_components : {1, 3}) {
+        for (const bool use_model : {true, false}) {
+          EncoderBuffer stream;
+          if (!RoundTripsSymbols(
+                  GenerateSymbols(num_values, num_symbols, seed++),
+                  num_components, use_model ? model : nullptr, &stream)) {
+            ++num_failed;
+          }
+        }
+      }
+    }
+  }
+  TestEqual(TEXT("Generated streams round trip"), num_failed, 0);
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoSymbolTableCacheTest,
+                                 "UnrealDraco.SymbolTableCache",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoSymbolTableCacheTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  const std::vector<uint32_t> symbols = GenerateSymbols(4096, 16, 1);
+  const UD_SymbolModel *const model = GetTestModel(symbols);
+  const std::vector<uint32_t> table_symbols = GenerateSymbols(4096, 40, 5);
+  const std::vector<uint32_t> large_symbols =
+      GenerateSymbols(4096, 1 << 18, 6);
+  EncoderBuffer model_stream;
+  EncoderBuffer table_stream;
+  EncoderBuffer draco_stream;
+  if (!TestTrue(TEXT("Streams are coded"),
+                model != nullptr &&
+                    RoundTripsSymbols(symbols, 1, model, &model_stream) &&
+                    RoundTripsSymbols(table_symbols, 1, nullptr,
+                                      &table_stream) &&
+                    RoundTripsSymbols(large_symbols, 1, nullptr,
+                                      &draco_stream))) {
+    return false;
+  }
+
+  // Registered models never build tables.
+  UD_DecodeStats stats;
+  TestTrue(TEXT("Model stream is decoded"),
+           DecodeSymbolsWithStats(model_stream, 4096, &stats));
+  TestTrue(TEXT("Model streams are hits"),
+           stats.symbol_table_hits == 1 && stats.symbol_table_misses == 0);
+
+  // The table of a stream decoded again on the same thread is cached. The
+  // first decode may already hit the table of an earlier test run.
+  stats = UD_DecodeStats();
+  TestTrue(TEXT("Table stream is decoded"),
+           DecodeSymbolsWithStats(table_stream, 4096, &stats) &&
+               DecodeSymbolsWithStats(table_stream, 4096, &stats));
+  TestTrue(TEXT("Every table decode is counted"),
+           stats.symbol_table_hits + stats.symbol_table_misses == 2);
+  TestTrue(TEXT("Repeated tables are hits"), stats.symbol_table_hits >= 1);
+
+  // Draco builds the tables of every stream.
+  stats = UD_DecodeStats();
+  TestTrue(TEXT("Draco stream is decoded"),
+           DecodeSymbolsWithStats(draco_stream, 4096, &stats) &&
+               DecodeSymbolsWithStats(draco_stream, 4096, &stats));
+  TestTrue(TEXT("Draco streams are misses"),
+           stats.symbol_table_hits == 0 && stats.symbol_table_misses == 2);
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
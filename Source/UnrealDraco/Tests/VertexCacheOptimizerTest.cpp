@@ -0,0 +1,129 @@
+// Copyright VJ. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "GeometryTestUtils.h"
+#include "VertexCacheOptimizer.h"
+
+namespace draco {
+
+namespace {
+
+// Returns the faces of |mesh| as the attribute values of their corners,
+// each face rotated to start at its smallest corner and the faces sorted, so
+// that meshes with the same triangles in any order compare equal.
+std::vector<std::string> GetSortedTriangles(const Mesh &mesh) {
+  std::vector<std::string> triangles;
+  for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+    std::string corners[3];
+    for (int c = 0; c < 3; ++c) {
+      for (int i = 0; i < mesh.num_attributes(); ++i) {
+        const PointAttribute *const att = mesh.attribute(i);
+        const uint8_t *const value =
+            att->GetAddress(att->mapped_index(mesh.face(f)[c]));
+        corners[c].append(reinterpret_cast<const char *>(value),
+                          att->byte_stride());
+      }
+    }
+    const int first = static_cast<int>(
+        std::min_element(corners, corners + 3) - corners);
+    triangles.push_back(corners[first] + corners[(first + 1) % 3] +
+                        corners[(first + 2) % 3]);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+// Returns true when the faces of |mesh| use its points in increasing order
+// of first use.
+bool UsesPointsInOrder(const Mesh &mesh) {
+  uint32_t num_used = 0;
+  for (FaceIndex f(0); f < mesh.num_faces(); ++f) {
+    for (int c = 0; c < 3; ++c) {
+      const uint32_t p = mesh.face(f)[c].value();
+      if (p > num_used) {
+        return false;
+      }
+      num_used = std::max(num_used, p + 1);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+}  // namespace draco
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealDracoVertexCacheOptimizerTest,
+                                 "UnrealDraco.VertexCacheOptimizer",
+                                 EAutomationTestFlags::ApplicationContextMask |
+                                     EAutomationTestFlags::EngineFilter)
+
+bool FUnrealDracoVertexCacheOptimizerTest::RunTest(const FString &Parameters) {
+  using namespace draco;
+  // The cache simulation on a strip of two triangles sharing an edge.
+  Mesh strip;
+  strip.set_num_points(4);
+  strip.AddFace({{PointIndex(0), PointIndex(1), PointIndex(2)}});
+  strip.AddFace({{PointIndex(2), PointIndex(1), PointIndex(3)}});
+  const UD_VertexCacheStats strip_stats = UD_ComputeVertexCacheStats(strip, 16);
+  TestTrue(TEXT("Shared points are cache hits"),
+           strip_stats.acmr == 2.0 && strip_stats.atvr == 1.0);
+  const UD_VertexCacheStats small_cache_stats =
+      UD_ComputeVertexCacheStats(strip, 1);
+  TestTrue(TEXT("A cache of one point only keeps the last one"),
+           small_cache_stats.acmr == 2.5 && small_cache_stats.atvr == 1.25);
+
+  // Meshes in the face order Draco decodes them, with Edgebreaker and with
+  // the sequential encoding. The per face normals split the points along
+  // every face border, without them neighboring faces share their points.
+  for (const bool normals : {true, false}) {
+    const std::unique_ptr<Mesh> mesh = UD_TestCreateMesh(32, true, normals);
+    for (const int speed : {5, 10}) {
+      EncoderBuffer buffer;
+      TestTrue(TEXT("Mesh is encoded"), UD_TestEncode(*mesh, speed, &buffer));
+      const std::unique_ptr<Mesh> decoded =
+          UD_TestDecodeMesh(buffer.data(), buffer.size());
+      if (!TestTrue(TEXT("Mesh is decoded"), decoded != nullptr)) {
+        return false;
+      }
+      const std::unique_ptr<Mesh> optimized =
+          UD_OptimizeVertexCache(*decoded, kUD_DefaultVertexCacheSize);
+      if (!TestTrue(TEXT("Mesh is optimized"), optimized != nullptr)) {
+        return false;
+      }
+      TestTrue(TEXT("Counts are kept"),
+               optimized->num_faces() == decoded->num_faces() &&
+                   optimized->num_points() == decoded->num_points() &&
+                   optimized->num_attributes() == decoded->num_attributes());
+      for (int i = 0; i < decoded->num_attributes(); ++i) {
+        TestTrue(TEXT("Attribute values are kept"),
+                 optimized->attribute(i)->size() ==
+                     decoded->attribute(i)->size());
+      }
+      TestTrue(TEXT("Same triangles as Draco's decode"),
+               GetSortedTriangles(*optimized) ==
+                   GetSortedTriangles(*decoded));
+      TestTrue(TEXT("Points are renumbered in first use order"),
+               UsesPointsInOrder(*optimized));
+
+      const UD_VertexCacheStats before =
+          UD_ComputeVertexCacheStats(*decoded, kUD_DefaultVertexCacheSize);
+      const UD_VertexCacheStats after =
+          UD_ComputeVertexCacheStats(*optimized, kUD_DefaultVertexCacheSize);
+      TestTrue(TEXT("ACMR does not get worse than Draco's order"),
+               after.acmr <= before.acmr);
+      TestTrue(TEXT("Shared points reach a low ACMR"),
+               normals || after.acmr < 0.7);
+    }
+  }
+  return true;
+}
+
+#endif  // WITH_DEV_AUTOMATION_TESTS
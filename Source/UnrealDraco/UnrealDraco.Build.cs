@@ -48,6 +48,7 @@ public class UnrealDraco : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"Json",
 				
 				// ... add private dependencies that you statically link with here ...	
 			}